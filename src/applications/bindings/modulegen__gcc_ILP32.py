@@ -8679,6 +8679,11 @@ def register_Ns3NetDevice_methods(root_module, cls):
                    'bool', 
                    [], 
                    is_pure_virtual=True, is_const=True, is_virtual=True)
+    ## net-device.h (module 'network'): bool ns3::NetDevice::SupportsTso() const [member function]
+    cls.add_method('SupportsTso', 
+                   'bool', 
+                   [], 
+                   is_const=True, is_virtual=True)
     return
 
 def register_Ns3NetDeviceQueue_methods(root_module, cls):
@@ -11092,6 +11097,11 @@ def register_Ns3SimpleNetDevice_methods(root_module, cls):
                    'bool', 
                    [], 
                    is_const=True, is_virtual=True)
+    ## simple-net-device.h (module 'network'): bool ns3::SimpleNetDevice::SupportsTso() const [member function]
+    cls.add_method('SupportsTso', 
+                   'bool', 
+                   [], 
+                   is_const=True, is_virtual=True)
     ## simple-net-device.h (module 'network'): void ns3::SimpleNetDevice::DoDispose() [member function]
     cls.add_method('DoDispose', 
                    'void', 
@@ -0,0 +1,551 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+#include "flow-generator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowGenerator");
+
+NS_OBJECT_ENSURE_REGISTERED (FlowGenerator);
+
+TypeId
+FlowGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlowGenerator")
+    .SetParent<Application> ()
+    .SetGroupName("Applications")
+    .AddConstructor<FlowGenerator> ()
+    .AddAttribute ("Protocol", "The type of protocol to use: "
+                   "ns3::TcpSocketFactory or ns3::UdpSocketFactory.",
+                   TypeIdValue (TcpSocketFactory::GetTypeId ()),
+                   MakeTypeIdAccessor (&FlowGenerator::m_tid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("Remote", "The address of the destination, "
+                   "if no destination is added with AddRemote.",
+                   AddressValue (),
+                   MakeAddressAccessor (&FlowGenerator::m_peer),
+                   MakeAddressChecker ())
+    .AddAttribute ("SendSize", "The amount of data to send each time, "
+                   "and the size of the UDP packets.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FlowGenerator::m_sendSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FlowSize", "A RandomVariableStream used to pick the size "
+                   "of the flows, in bytes.",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=100000]"),
+                   MakePointerAccessor (&FlowGenerator::m_flowSize),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("InterArrivalTime", "A RandomVariableStream used to pick the "
+                   "time between the starts of two flows, in seconds.",
+                   StringValue ("ns3::ExponentialRandomVariable[Mean=0.01]"),
+                   MakePointerAccessor (&FlowGenerator::m_interArrival),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("MaxFlows",
+                   "The number of flows to start. "
+                   "The value zero means that there is no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FlowGenerator::m_maxFlows),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("TraceFile",
+                   "A file of the flows to start, instead of random flows: "
+                   "one flow per line, with its start time in seconds from the "
+                   "start of the application, its size in bytes and optionally "
+                   "the index of its remote address, sorted by start time.",
+                   StringValue (""),
+                   MakeStringAccessor (&FlowGenerator::m_traceFileName),
+                   MakeStringChecker ())
+    .AddAttribute ("ReuseConnections",
+                   "Send TCP flows on the idle connections of completed flows "
+                   "to the same destination, rather than on new connections.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&FlowGenerator::m_reuse),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UdpDataRate", "The data rate of each UDP flow.",
+                   DataRateValue (DataRate ("10Mb/s")),
+                   MakeDataRateAccessor (&FlowGenerator::m_udpRate),
+                   MakeDataRateChecker ())
+    .AddTraceSource ("Tx", "A new packet is created and is sent",
+                     MakeTraceSourceAccessor (&FlowGenerator::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("FlowCompleted", "A flow is completed",
+                     MakeTraceSourceAccessor (&FlowGenerator::m_flowCompletedTrace),
+                     "ns3::FlowGenerator::FlowCompletedTracedCallback")
+  ;
+  return tid;
+}
+
+
+FlowGenerator::FlowGenerator ()
+  : m_tcp (true),
+    m_nCompleted (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_remoteRng = CreateObject<UniformRandomVariable> ();
+}
+
+FlowGenerator::~FlowGenerator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+FlowGenerator::AddRemote (Address remote)
+{
+  NS_LOG_FUNCTION (this << remote);
+  m_remotes.push_back (remote);
+  m_idle.resize (m_remotes.size ());
+  m_udpSockets.resize (m_remotes.size ());
+  return m_remotes.size () - 1;
+}
+
+uint32_t
+FlowGenerator::GetNFlows (void) const
+{
+  return m_flows.size ();
+}
+
+uint32_t
+FlowGenerator::GetNCompletedFlows (void) const
+{
+  return m_nCompleted;
+}
+
+const FlowGenerator::FlowRecord &
+FlowGenerator::GetFlow (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  return m_flows[flow];
+}
+
+Time
+FlowGenerator::GetFlowCompletionTime (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  if (m_flows[flow].completion < 0)
+    {
+      return TimeStep (-1);
+    }
+  return TimeStep (m_flows[flow].completion - m_flows[flow].start);
+}
+
+int64_t
+FlowGenerator::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_flowSize->SetStream (stream);
+  m_interArrival->SetStream (stream + 1);
+  m_remoteRng->SetStream (stream + 2);
+  return 3;
+}
+
+void
+FlowGenerator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_connections.clear ();
+  m_socketConnections.clear ();
+  m_udpSockets.clear ();
+  m_flowSize = 0;
+  m_interArrival = 0;
+  m_remoteRng = 0;
+  // chain up
+  Application::DoDispose ();
+}
+
+// Application Methods
+void FlowGenerator::StartApplication (void) // Called at time specified by Start
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ABORT_MSG_UNLESS (m_tid == TcpSocketFactory::GetTypeId () || m_tid == UdpSocketFactory::GetTypeId (),
+                       "FlowGenerator supports TCP and UDP only");
+  m_tcp = (m_tid == TcpSocketFactory::GetTypeId ());
+  if (m_remotes.empty ())
+    {
+      NS_ABORT_MSG_IF (m_peer.IsInvalid (), "FlowGenerator has no remote address");
+      AddRemote (m_peer);
+    }
+
+  if (!m_traceFileName.empty ())
+    {
+      m_traceFile.open (m_traceFileName.c_str ());
+      NS_ABORT_MSG_UNLESS (m_traceFile.is_open (), "Can not open trace file " << m_traceFileName);
+      m_traceStart = Simulator::Now ();
+      ReadTrace ();
+    }
+  else if (m_maxFlows == 0 || m_flows.size () < m_maxFlows)
+    {
+      m_arrivalEvent = Simulator::Schedule (Seconds (m_interArrival->GetValue ()),
+                                            &FlowGenerator::RandomArrival, this);
+    }
+}
+
+void FlowGenerator::StopApplication (void) // Called at time specified by Stop
+{
+  NS_LOG_FUNCTION (this);
+
+  m_arrivalEvent.Cancel ();
+  if (m_traceFile.is_open ())
+    {
+      m_traceFile.close ();
+    }
+
+  // The flows in progress are left incomplete
+  for (std::vector<Connection>::iterator it = m_connections.begin (); it != m_connections.end (); it++)
+    {
+      it->sendEvent.Cancel ();
+      if (m_tcp && it->socket)
+        {
+          it->socket->Close ();
+        }
+    }
+  for (std::vector<Ptr<Socket> >::iterator it = m_udpSockets.begin (); it != m_udpSockets.end (); it++)
+    {
+      if (*it)
+        {
+          (*it)->Close ();
+          *it = 0;
+        }
+    }
+  m_connections.clear ();
+  m_freeConnections.clear ();
+  m_socketConnections.clear ();
+  for (uint32_t i = 0; i < m_idle.size (); i++)
+    {
+      m_idle[i].clear ();
+    }
+}
+
+void
+FlowGenerator::RandomArrival (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t size = std::max<uint32_t> (m_flowSize->GetInteger (), 1);
+  uint32_t remote = 0;
+  if (m_remotes.size () > 1)
+    {
+      remote = m_remoteRng->GetInteger (0, m_remotes.size () - 1);
+    }
+  StartFlow (size, remote);
+
+  if (m_maxFlows == 0 || m_flows.size () < m_maxFlows)
+    {
+      m_arrivalEvent = Simulator::Schedule (Seconds (m_interArrival->GetValue ()),
+                                            &FlowGenerator::RandomArrival, this);
+    }
+}
+
+void
+FlowGenerator::ReadTrace (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_maxFlows != 0 && m_flows.size () >= m_maxFlows)
+    {
+      m_traceFile.close ();
+      return;
+    }
+
+  std::string line;
+  while (std::getline (m_traceFile, line))
+    {
+      std::istringstream iss (line);
+      std::string first;
+      if (!(iss >> first) || first[0] == '#')
+        {
+          continue;
+        }
+      iss.clear ();
+      iss.str (line);
+      double start;
+      uint32_t size;
+      uint32_t remote = 0;
+      iss >> start >> size;
+      NS_ABORT_MSG_IF (iss.fail (), "Invalid flow in trace file " << m_traceFileName << ": " << line);
+      if (!(iss >> remote))
+        {
+          remote = 0;
+        }
+      NS_ABORT_MSG_IF (remote >= m_remotes.size (), "Invalid remote address index in trace file "
+                       << m_traceFileName << ": " << line);
+
+      Time delay = Max (m_traceStart + Seconds (start) - Simulator::Now (), Time (0));
+      m_arrivalEvent = Simulator::Schedule (delay, &FlowGenerator::TraceArrival, this,
+                                            std::max<uint32_t> (size, 1), remote);
+      return;
+    }
+  m_traceFile.close ();
+}
+
+void
+FlowGenerator::TraceArrival (uint32_t size, uint32_t remote)
+{
+  NS_LOG_FUNCTION (this << size << remote);
+  StartFlow (size, remote);
+  ReadTrace ();
+}
+
+void
+FlowGenerator::StartFlow (uint32_t size, uint32_t remote)
+{
+  NS_LOG_FUNCTION (this << size << remote);
+
+  FlowRecord record;
+  record.start = Simulator::Now ().GetTimeStep ();
+  record.completion = -1;
+  record.size = size;
+  record.remote = remote;
+  m_flows.push_back (record);
+
+  uint32_t c = GetConnection (remote);
+  Connection &connection = m_connections[c];
+  connection.flow = m_flows.size () - 1;
+  connection.left = size;
+  NS_LOG_LOGIC ("Flow " << connection.flow << " of " << size << " bytes on connection " << c);
+  if (!m_tcp)
+    {
+      SendUdpPacket (c);
+    }
+  else if (connection.connected)
+    {
+      SendData (c);
+    }
+}
+
+uint32_t
+FlowGenerator::GetConnection (uint32_t remote)
+{
+  NS_LOG_FUNCTION (this << remote);
+
+  if (m_tcp && m_reuse && !m_idle[remote].empty ())
+    {
+      uint32_t c = m_idle[remote].back ();
+      m_idle[remote].pop_back ();
+      return c;
+    }
+
+  uint32_t c;
+  if (m_freeConnections.empty ())
+    {
+      c = m_connections.size ();
+      m_connections.push_back (Connection ());
+    }
+  else
+    {
+      c = m_freeConnections.back ();
+      m_freeConnections.pop_back ();
+    }
+
+  Ptr<Socket> socket = m_tcp ? Ptr<Socket> (0) : m_udpSockets[remote];
+  if (!socket)
+    {
+      socket = Socket::CreateSocket (GetNode (), m_tid);
+      const Address &peer = m_remotes[remote];
+      if (Inet6SocketAddress::IsMatchingType (peer))
+        {
+          if (socket->Bind6 () == -1)
+            {
+              NS_FATAL_ERROR ("Failed to bind socket");
+            }
+        }
+      else if (InetSocketAddress::IsMatchingType (peer))
+        {
+          if (socket->Bind () == -1)
+            {
+              NS_FATAL_ERROR ("Failed to bind socket");
+            }
+        }
+      socket->Connect (peer);
+      socket->ShutdownRecv ();
+      if (m_tcp)
+        {
+          socket->SetConnectCallback (
+            MakeCallback (&FlowGenerator::ConnectionSucceeded, this),
+            MakeCallback (&FlowGenerator::ConnectionFailed, this));
+          socket->SetSendCallback (
+            MakeCallback (&FlowGenerator::DataSend, this));
+          m_socketConnections[socket] = c;
+        }
+      else
+        {
+          m_udpSockets[remote] = socket;
+        }
+    }
+
+  Connection &connection = m_connections[c];
+  connection.socket = socket;
+  connection.remote = remote;
+  connection.flow = NO_FLOW;
+  connection.left = 0;
+  connection.bufferSize = socket->GetTxAvailable ();
+  connection.connected = !m_tcp;
+  return c;
+}
+
+void
+FlowGenerator::SendData (uint32_t c)
+{
+  NS_LOG_FUNCTION (this << c);
+
+  Connection &connection = m_connections[c];
+  while (connection.left > 0)
+    {
+      uint32_t toSend = std::min (std::min (m_sendSize, connection.left),
+                                  connection.socket->GetTxAvailable ());
+      if (toSend == 0)
+        {
+          break;
+        }
+      Ptr<Packet> packet = Create<Packet> (toSend);
+      int actual = connection.socket->Send (packet);
+      if (actual <= 0)
+        {
+          break;
+        }
+      m_txTrace (packet);
+      connection.left -= actual;
+    }
+
+  // The flow is completed when all its data is acknowledged
+  if (connection.left == 0 && connection.socket->GetTxAvailable () == connection.bufferSize)
+    {
+      CompleteFlow (c);
+    }
+}
+
+void
+FlowGenerator::SendUdpPacket (uint32_t c)
+{
+  NS_LOG_FUNCTION (this << c);
+
+  Connection &connection = m_connections[c];
+  uint32_t size = std::min (m_sendSize, connection.left);
+  Ptr<Packet> packet = Create<Packet> (size);
+  connection.socket->Send (packet);
+  m_txTrace (packet);
+  connection.left -= size;
+  if (connection.left == 0)
+    {
+      CompleteFlow (c);
+    }
+  else
+    {
+      connection.sendEvent = Simulator::Schedule (m_udpRate.CalculateBytesTxTime (size),
+                                                  &FlowGenerator::SendUdpPacket, this, c);
+    }
+}
+
+void
+FlowGenerator::CompleteFlow (uint32_t c)
+{
+  NS_LOG_FUNCTION (this << c);
+
+  Connection &connection = m_connections[c];
+  FlowRecord &record = m_flows[connection.flow];
+  record.completion = Simulator::Now ().GetTimeStep ();
+  m_nCompleted++;
+  uint32_t flow = connection.flow;
+  connection.flow = NO_FLOW;
+
+  if (m_tcp && m_reuse)
+    {
+      m_idle[connection.remote].push_back (c);
+    }
+  else
+    {
+      if (m_tcp)
+        {
+          m_socketConnections.erase (connection.socket);
+          connection.socket->Close ();
+        }
+      connection.socket = 0;
+      m_freeConnections.push_back (c);
+    }
+
+  m_flowCompletedTrace (flow, record.size, TimeStep (record.completion - record.start));
+}
+
+void
+FlowGenerator::ConnectionSucceeded (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map<Ptr<Socket>, uint32_t>::iterator it = m_socketConnections.find (socket);
+  if (it == m_socketConnections.end ())
+    {
+      return;
+    }
+  m_connections[it->second].connected = true;
+  SendData (it->second);
+}
+
+void
+FlowGenerator::ConnectionFailed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map<Ptr<Socket>, uint32_t>::iterator it = m_socketConnections.find (socket);
+  if (it == m_socketConnections.end ())
+    {
+      return;
+    }
+  // The flow is left incomplete
+  NS_LOG_LOGIC ("FlowGenerator, Connection Failed");
+  Connection &connection = m_connections[it->second];
+  connection.socket = 0;
+  connection.flow = NO_FLOW;
+  m_freeConnections.push_back (it->second);
+  m_socketConnections.erase (it);
+}
+
+void
+FlowGenerator::DataSend (Ptr<Socket> socket, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << socket << available);
+
+  std::map<Ptr<Socket>, uint32_t>::iterator it = m_socketConnections.find (socket);
+  if (it == m_socketConnections.end ())
+    {
+      return;
+    }
+  Connection &connection = m_connections[it->second];
+  if (connection.connected && connection.flow != NO_FLOW)
+    {
+      SendData (it->second);
+    }
+}
+
+} // Namespace ns3
@@ -0,0 +1,263 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_GENERATOR_H
+#define FLOW_GENERATOR_H
+
+#include <fstream>
+#include <map>
+#include <vector>
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+class Socket;
+class RandomVariableStream;
+class UniformRandomVariable;
+
+/**
+ * \ingroup applications
+ * \defgroup flowgenerator FlowGenerator
+ *
+ * This traffic generator starts many finite flows from a single
+ * application, rather than one application per flow.
+ */
+
+/**
+ * \ingroup flowgenerator
+ *
+ * \brief Generate many finite TCP or UDP flows from a single application.
+ *
+ * Flows arrive after random inter-arrival times, with random sizes, and
+ * are sent to one of the remote addresses of the application chosen at
+ * random, until MaxFlows flows are started.  When a TraceFile is set, the
+ * flows are read from it instead, one per line:
+ * \verbatim
+   <start time in seconds> <size in bytes> [<index of the remote address>]
+   \endverbatim
+ * The trace file is read as the simulation goes, so that it can hold
+ * millions of flows.  Empty lines and lines starting with '#' are ignored.
+ *
+ * A TCP flow is sent as fast as its connection allows, and completes when
+ * its last byte is acknowledged.  When ReuseConnections is true, the
+ * connection is then kept open and the next flow to the same remote address
+ * is sent on it, without a new handshake; otherwise it is closed.  A UDP
+ * flow is sent at UdpDataRate and completes when its last packet is sent;
+ * a single UDP socket is used for each remote address.
+ *
+ * The start and completion times of every flow are kept in a compact
+ * array, and the FlowCompleted trace source is fired as each flow
+ * completes.
+ */
+class FlowGenerator : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  FlowGenerator ();
+
+  virtual ~FlowGenerator ();
+
+  /**
+   * \brief Record of a flow
+   */
+  struct FlowRecord
+  {
+    int64_t start;       //!< Start time, in time steps
+    int64_t completion;  //!< Completion time, in time steps, -1 if not completed
+    uint32_t size;       //!< Size, in bytes
+    uint32_t remote;     //!< Index of the remote address
+  };
+
+  /**
+   * \brief Add a remote address flows can be sent to.
+   *
+   * If no remote address is added, the flows are sent to the Remote
+   * attribute.
+   *
+   * \param remote the address
+   * \return the index of the address
+   */
+  uint32_t AddRemote (Address remote);
+
+  /**
+   * \return the number of flows started
+   */
+  uint32_t GetNFlows (void) const;
+
+  /**
+   * \return the number of flows completed
+   */
+  uint32_t GetNCompletedFlows (void) const;
+
+  /**
+   * \param flow the index of the flow, in the order flows were started
+   * \return the record of the flow
+   */
+  const FlowRecord & GetFlow (uint32_t flow) const;
+
+  /**
+   * \param flow the index of the flow, in the order flows were started
+   * \return the flow completion time, or a negative time if the flow is
+   * not completed
+   */
+  Time GetFlowCompletionTime (uint32_t flow) const;
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * TracedCallback signature for completed flows.
+   *
+   * \param [in] flow The index of the flow.
+   * \param [in] size The size of the flow, in bytes.
+   * \param [in] fct The flow completion time.
+   */
+  typedef void (* FlowCompletedTracedCallback)(uint32_t flow, uint32_t size, Time fct);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);    // Called at time specified by Start
+  virtual void StopApplication (void);     // Called at time specified by Stop
+
+  /// Index of no flow
+  static const uint32_t NO_FLOW = 0xffffffff;
+
+  /**
+   * \brief State of a flow being sent
+   */
+  struct Connection
+  {
+    Ptr<Socket> socket;  //!< The socket
+    uint32_t remote;     //!< Index of the remote address
+    uint32_t flow;       //!< Flow being sent, or NO_FLOW
+    uint32_t left;       //!< Bytes of the flow not given to the socket yet
+    uint32_t bufferSize; //!< Size of the send buffer of a TCP socket
+    bool connected;      //!< The TCP connection is established
+    EventId sendEvent;   //!< Next UDP packet
+  };
+
+  /**
+   * \brief Start a flow now.
+   * \param size size of the flow, in bytes
+   * \param remote index of the remote address
+   */
+  void StartFlow (uint32_t size, uint32_t remote);
+  /**
+   * \brief Start a random flow and schedule the next one.
+   */
+  void RandomArrival (void);
+  /**
+   * \brief Start the flow read from the trace file, and read the next one.
+   * \param size size of the flow, in bytes
+   * \param remote index of the remote address
+   */
+  void TraceArrival (uint32_t size, uint32_t remote);
+  /**
+   * \brief Read the next flow of the trace file and schedule its start.
+   */
+  void ReadTrace (void);
+  /**
+   * \brief Get a connection to a remote address ready for a new flow.
+   * \param remote index of the remote address
+   * \return the index of the connection
+   */
+  uint32_t GetConnection (uint32_t remote);
+  /**
+   * \brief Give the socket of a TCP flow as much data as it takes.
+   * \param c index of the connection
+   */
+  void SendData (uint32_t c);
+  /**
+   * \brief Send the next packet of a UDP flow.
+   * \param c index of the connection
+   */
+  void SendUdpPacket (uint32_t c);
+  /**
+   * \brief Record the completion of the flow of a connection, and release
+   * or keep the connection.
+   * \param c index of the connection
+   */
+  void CompleteFlow (uint32_t c);
+  /**
+   * \brief Connection Succeeded (called by Socket through a callback)
+   * \param socket the connected socket
+   */
+  void ConnectionSucceeded (Ptr<Socket> socket);
+  /**
+   * \brief Connection Failed (called by Socket through a callback)
+   * \param socket the connected socket
+   */
+  void ConnectionFailed (Ptr<Socket> socket);
+  /**
+   * \brief Send more data as soon as some has been transmitted.
+   * \param socket the socket
+   * \param available space available in the send buffer
+   */
+  void DataSend (Ptr<Socket> socket, uint32_t available);
+
+  TypeId          m_tid;             //!< The type of protocol to use.
+  bool            m_tcp;             //!< The protocol is connection oriented
+  Address         m_peer;            //!< Default remote address
+  std::vector<Address> m_remotes;    //!< Remote addresses
+  uint32_t        m_sendSize;        //!< Size of data to send each time
+  Ptr<RandomVariableStream> m_flowSize;     //!< Size of the flows, in bytes
+  Ptr<RandomVariableStream> m_interArrival; //!< Time between flows, in seconds
+  Ptr<UniformRandomVariable> m_remoteRng;   //!< Selection of the remote address
+  uint32_t        m_maxFlows;        //!< Number of flows to start, 0 for no limit
+  std::string     m_traceFileName;   //!< File of the flows to start
+  std::ifstream   m_traceFile;       //!< Trace file being read
+  Time            m_traceStart;      //!< Time the trace file was opened
+  bool            m_reuse;           //!< Keep TCP connections open for the next flows
+  DataRate        m_udpRate;         //!< Rate of each UDP flow
+  EventId         m_arrivalEvent;    //!< Next flow arrival
+
+  std::vector<FlowRecord> m_flows;             //!< Record of the flows started
+  uint32_t        m_nCompleted;                //!< Number of flows completed
+  std::vector<Connection> m_connections;       //!< Connections, some unused
+  std::vector<uint32_t> m_freeConnections;     //!< Unused connections
+  std::vector<std::vector<uint32_t> > m_idle;  //!< Idle TCP connections to each remote address
+  std::vector<Ptr<Socket> > m_udpSockets;      //!< UDP socket of each remote address
+  std::map<Ptr<Socket>, uint32_t> m_socketConnections; //!< Connection of each TCP socket
+
+  /// Traced Callback: sent packets
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  /// Traced Callback: completed flows
+  TracedCallback<uint32_t, uint32_t, Time> m_flowCompletedTrace;
+};
+
+} // namespace ns3
+
+#endif /* FLOW_GENERATOR_H */
@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/mac48-address.h"
+#include "ns3/trace-helper.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "pcap-replay-application.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplayApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapReplayApplication);
+
+TypeId
+PcapReplayApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapReplayApplication")
+    .SetParent<Application> ()
+    .SetGroupName("Applications")
+    .AddConstructor<PcapReplayApplication> ()
+    .AddAttribute ("Filename",
+                   "Name of the pcap file to replay.",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapReplayApplication::m_filename),
+                   MakeStringChecker ())
+    .AddAttribute ("DeviceIndex",
+                   "Index, on the node, of the NetDevice to send the packets on.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_deviceIndex),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PadTruncated",
+                   "Pad the packets truncated by the capture snap length "
+                   "to their original length.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&PcapReplayApplication::m_pad),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Tx", "A packet of the capture is handed to the device",
+                     MakeTraceSourceAccessor (&PcapReplayApplication::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Drop", "A packet of the capture is not supported "
+                     "or was refused by the device",
+                     MakeTraceSourceAccessor (&PcapReplayApplication::m_dropTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+PcapReplayApplication::PcapReplayApplication ()
+  : m_device (0),
+    m_dataLinkType (0),
+    m_firstTimestamp (0),
+    m_sent (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReplayApplication::~PcapReplayApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+PcapReplayApplication::GetSent (void) const
+{
+  return m_sent;
+}
+
+void
+PcapReplayApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_device = 0;
+  m_file.Close ();
+  // chain up
+  Application::DoDispose ();
+}
+
+// Application Methods
+void PcapReplayApplication::StartApplication (void) // Called at time specified by Start
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ABORT_MSG_UNLESS (m_deviceIndex < GetNode ()->GetNDevices (),
+                       "PcapReplayApplication: node " << GetNode ()->GetId () <<
+                       " has no device " << m_deviceIndex);
+  m_device = GetNode ()->GetDevice (m_deviceIndex);
+  NS_ABORT_MSG_UNLESS (m_file.Open (m_filename),
+                       "PcapReplayApplication: unable to read pcap file " << m_filename);
+  m_dataLinkType = m_file.GetDataLinkType ();
+  NS_ABORT_MSG_UNLESS (m_dataLinkType == PcapHelper::DLT_EN10MB ||
+                       m_dataLinkType == PcapHelper::DLT_PPP ||
+                       m_dataLinkType == PcapHelper::DLT_RAW,
+                       "PcapReplayApplication: unsupported link type " << m_dataLinkType <<
+                       " in " << m_filename);
+
+  m_current = m_file.Begin ();
+  if (m_current == m_file.End ())
+    {
+      NS_LOG_WARN ("PcapReplayApplication: no packet in " << m_filename);
+      return;
+    }
+  m_firstTimestamp = (*m_current).timestamp;
+  m_startTime = Simulator::Now ();
+  SendPackets ();
+}
+
+void PcapReplayApplication::StopApplication (void) // Called at time specified by Stop
+{
+  NS_LOG_FUNCTION (this);
+
+  Simulator::Cancel (m_sendEvent);
+  m_file.Close ();
+}
+
+void
+PcapReplayApplication::ScheduleNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time at = m_startTime + NanoSeconds ((*m_current).timestamp - m_firstTimestamp);
+  m_sendEvent = Simulator::Schedule (at - Simulator::Now (), &PcapReplayApplication::SendPackets, this);
+}
+
+void
+PcapReplayApplication::SendPackets (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  while (m_current != m_file.End ())
+    {
+      MappedPcapFile::Record record = *m_current;
+      // Records out of order in the capture are sent right away
+      if (record.timestamp > m_firstTimestamp &&
+          m_startTime + NanoSeconds (record.timestamp - m_firstTimestamp) > now)
+        {
+          ScheduleNext ();
+          return;
+        }
+      Send (record);
+      ++m_current;
+    }
+  NS_LOG_LOGIC ("End of " << m_filename << " reached, " << m_sent << " packets sent");
+}
+
+void
+PcapReplayApplication::Send (MappedPcapFile::Record const &record)
+{
+  NS_LOG_FUNCTION (this << record.timestamp << record.inclLen);
+  const uint8_t *data = record.data;
+  uint32_t len = record.inclLen;
+  uint16_t protocol = 0;
+  Mac48Address from;
+  Mac48Address to;
+  bool ethernet = false;
+
+  switch (m_dataLinkType)
+    {
+    case PcapHelper::DLT_EN10MB:
+      if (len >= 14)
+        {
+          to.CopyFrom (data);
+          from.CopyFrom (data + 6);
+          protocol = (data[12] << 8) | data[13];
+          // Values below 0x600 are 802.3 lengths
+          if (protocol < 0x600)
+            {
+              protocol = 0;
+            }
+          data += 14;
+          len -= 14;
+          ethernet = true;
+        }
+      break;
+    case PcapHelper::DLT_PPP:
+      if (len >= 2 && data[0] == 0xff && data[1] == 0x03)
+        {
+          data += 2;
+          len -= 2;
+        }
+      if (len >= 2)
+        {
+          uint16_t ppp = (data[0] << 8) | data[1];
+          protocol = (ppp == 0x0021) ? 0x0800 : (ppp == 0x0057) ? 0x86dd : 0;
+          data += 2;
+          len -= 2;
+        }
+      break;
+    case PcapHelper::DLT_RAW:
+      if (len >= 1)
+        {
+          uint8_t version = data[0] >> 4;
+          protocol = (version == 4) ? 0x0800 : (version == 6) ? 0x86dd : 0;
+        }
+      break;
+    }
+
+  Ptr<Packet> p = Create<Packet> (data, len);
+  if (m_pad && record.origLen > record.inclLen)
+    {
+      p->AddPaddingAtEnd (record.origLen - record.inclLen);
+    }
+  if (protocol == 0)
+    {
+      NS_LOG_LOGIC ("Dropping unsupported frame of " << record.inclLen << " bytes");
+      m_dropTrace (p);
+      return;
+    }
+
+  // Trace the packet before the device adds its own header
+  m_txTrace (p);
+  bool sent;
+  if (!ethernet)
+    {
+      sent = m_device->Send (p, m_device->GetBroadcast (), protocol);
+    }
+  else if (m_device->SupportsSendFrom ())
+    {
+      sent = m_device->SendFrom (p, from, to, protocol);
+    }
+  else
+    {
+      sent = m_device->Send (p, to, protocol);
+    }
+  if (sent)
+    {
+      m_sent++;
+    }
+  else
+    {
+      m_dropTrace (p);
+    }
+}
+
+} // Namespace ns3
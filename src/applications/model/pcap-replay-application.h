@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_APPLICATION_H
+#define PCAP_REPLAY_APPLICATION_H
+
+#include <string>
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+#include "ns3/mapped-pcap-file.h"
+
+namespace ns3 {
+
+class NetDevice;
+class Packet;
+
+/**
+ * \ingroup applications
+ * \defgroup pcapreplay PcapReplayApplication
+ *
+ * This traffic generator replays the packets of a pcap capture,
+ * handing them to a NetDevice of its node at the times they were
+ * captured.
+ */
+
+/**
+ * \ingroup pcapreplay
+ *
+ * \brief Replay a pcap capture on a NetDevice
+ *
+ * The capture is read through a MappedPcapFile, so it is never loaded
+ * in memory as a whole, and only the next packet to send is scheduled.
+ * The first packet of the capture is sent when the application starts,
+ * and each following packet after the same delay, relative to the first
+ * one, as in the capture.
+ *
+ * The link-layer header of each captured packet is removed and the
+ * packet is sent with NetDevice::Send (or NetDevice::SendFrom, when the
+ * device supports it, for Ethernet captures) so that the device adds its
+ * own header.  The supported link types are:
+ *   - DLT_EN10MB: Ethernet II frames, sent to their captured destination;
+ *     802.3 frames with a length field are not supported and dropped.
+ *   - DLT_PPP: IPv4 and IPv6 packets, with or without the address and
+ *     control fields, sent to the broadcast address of the device.
+ *   - DLT_RAW: IPv4 and IPv6 packets, sent to the broadcast address of
+ *     the device.
+ *
+ * Packets truncated by the capture snap length are padded with zeros to
+ * their original length unless the PadTruncated attribute is false.
+ */
+class PcapReplayApplication : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapReplayApplication ();
+
+  virtual ~PcapReplayApplication ();
+
+  /**
+   * \return the number of packets accepted by the device so far
+   */
+  uint64_t GetSent (void) const;
+
+protected:
+  virtual void DoDispose (void);
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);    // Called at time specified by Start
+  virtual void StopApplication (void);     // Called at time specified by Stop
+
+  /**
+   * \brief Schedule the sending of the current record
+   */
+  void ScheduleNext (void);
+  /**
+   * \brief Send the current record and all the following ones which
+   * are due, then schedule the next one
+   */
+  void SendPackets (void);
+  /**
+   * \brief Strip the link-layer header of a record and send it
+   * \param record the record to send
+   */
+  void Send (MappedPcapFile::Record const &record);
+
+  std::string     m_filename;     //!< name of the capture file
+  uint32_t        m_deviceIndex;  //!< index of the device on the node
+  bool            m_pad;          //!< pad truncated packets to their original length
+  Ptr<NetDevice>  m_device;       //!< device packets are sent on
+  MappedPcapFile  m_file;         //!< the capture
+  uint32_t        m_dataLinkType; //!< data link type of the capture
+  MappedPcapFile::Iterator m_current; //!< next record to send
+  uint64_t        m_firstTimestamp; //!< timestamp of the first record, in nanoseconds
+  Time            m_startTime;    //!< time at which the first record was sent
+  EventId         m_sendEvent;    //!< event to send the next record
+  uint64_t        m_sent;         //!< number of packets sent
+
+  /// Traced Callback: packets handed to the device
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  /// Traced Callback: packets not supported or refused by the device
+  TracedCallback<Ptr<const Packet> > m_dropTrace;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_APPLICATION_H */
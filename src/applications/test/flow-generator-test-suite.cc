@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/flow-generator.h"
+#include "ns3/flow-generator-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications
+ * \defgroup flowgenerator-test FlowGenerator tests
+ */
+
+/**
+ * \ingroup flowgenerator-test
+ * \ingroup tests
+ *
+ * Many short TCP flows started by a single FlowGenerator must all complete
+ * and reach the sink, on as many connections as flows, or on fewer when
+ * connections are reused.
+ */
+class FlowGeneratorTcpTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param reuse reuse the TCP connections
+   */
+  FlowGeneratorTcpTestCase (bool reuse);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Completed flow trace sink
+   * \param flow the index of the flow
+   * \param size the size of the flow
+   * \param fct the flow completion time
+   */
+  void FlowCompleted (uint32_t flow, uint32_t size, Time fct);
+
+  bool m_reuse;             //!< Reuse the TCP connections
+  uint32_t m_nCompleted;    //!< Flows completed
+};
+
+FlowGeneratorTcpTestCase::FlowGeneratorTcpTestCase (bool reuse)
+  : TestCase (reuse ? "Check TCP flows on reused connections" : "Check TCP flows on new connections"),
+    m_reuse (reuse)
+{
+}
+
+void
+FlowGeneratorTcpTestCase::FlowCompleted (uint32_t flow, uint32_t size, Time fct)
+{
+  m_nCompleted++;
+}
+
+void
+FlowGeneratorTcpTestCase::DoRun (void)
+{
+  const uint32_t nFlows = 50;
+  const uint32_t flowSize = 20000;
+  m_nCompleted = 0;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+  devHelper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  NetDeviceContainer devices = devHelper.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+  Ptr<PacketSink> sink = DynamicCast<PacketSink> (sinkHelper.Install (nodes.Get (1)).Get (0));
+
+  FlowGeneratorHelper helper ("ns3::TcpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), 9));
+  helper.SetAttribute ("FlowSize", StringValue ("ns3::ConstantRandomVariable[Constant=20000]"));
+  helper.SetAttribute ("InterArrivalTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.25]"));
+  helper.SetAttribute ("MaxFlows", UintegerValue (nFlows));
+  helper.SetAttribute ("ReuseConnections", BooleanValue (m_reuse));
+  Ptr<FlowGenerator> generator = DynamicCast<FlowGenerator> (helper.Install (nodes.Get (0)).Get (0));
+  generator->TraceConnectWithoutContext ("FlowCompleted", MakeCallback (&FlowGeneratorTcpTestCase::FlowCompleted, this));
+  generator->SetStartTime (Seconds (1));
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (generator->GetNFlows (), nFlows, "wrong number of flows started");
+  NS_TEST_EXPECT_MSG_EQ (generator->GetNCompletedFlows (), nFlows, "flows not completed");
+  NS_TEST_EXPECT_MSG_EQ (m_nCompleted, nFlows, "FlowCompleted not fired for every flow");
+  NS_TEST_EXPECT_MSG_EQ (sink->GetTotalRx (), nFlows * flowSize, "wrong number of bytes received");
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      const FlowGenerator::FlowRecord &record = generator->GetFlow (i);
+      NS_TEST_EXPECT_MSG_EQ (record.size, flowSize, "wrong flow size");
+      NS_TEST_EXPECT_MSG_EQ (TimeStep (record.start), Seconds (1) + MilliSeconds (250 * (i + 1)), "wrong flow start");
+      // At least one round trip, and the transmission of the flow
+      NS_TEST_EXPECT_MSG_GT (generator->GetFlowCompletionTime (i), MilliSeconds (2), "flow completed too early");
+    }
+  // Each flow completes before the next one starts
+  if (m_reuse)
+    {
+      NS_TEST_EXPECT_MSG_EQ (sink->GetAcceptedSockets ().size (), 1, "connection not reused");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (sink->GetAcceptedSockets ().size (), nFlows, "connections reused");
+    }
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup flowgenerator-test
+ * \ingroup tests
+ *
+ * UDP flows read from a trace file must start at the times of the file,
+ * be sent to the remote addresses of the file at the UDP rate, and
+ * complete when their last packet is sent.
+ */
+class FlowGeneratorTraceTestCase : public TestCase
+{
+public:
+  FlowGeneratorTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowGeneratorTraceTestCase::FlowGeneratorTraceTestCase ()
+  : TestCase ("Check UDP flows read from a trace file")
+{
+}
+
+void
+FlowGeneratorTraceTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("flows.txt");
+  std::ofstream file (fileName.c_str ());
+  file << "# start size remote" << std::endl
+       << "0.1 10000 0" << std::endl
+       << std::endl
+       << "0.2 5000 1" << std::endl
+       << "0.2 3000" << std::endl;
+  file.close ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+  NetDeviceContainer devices = devHelper.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+  Ptr<PacketSink> sink0 = DynamicCast<PacketSink> (sinkHelper.Install (nodes.Get (1)).Get (0));
+  sinkHelper.SetAttribute ("Local", AddressValue (InetSocketAddress (Ipv4Address::GetAny (), 10)));
+  Ptr<PacketSink> sink1 = DynamicCast<PacketSink> (sinkHelper.Install (nodes.Get (1)).Get (0));
+
+  FlowGeneratorHelper helper ("ns3::UdpSocketFactory", Address ());
+  helper.SetAttribute ("TraceFile", StringValue (fileName));
+  helper.SetAttribute ("SendSize", UintegerValue (1000));
+  helper.SetAttribute ("UdpDataRate", DataRateValue (DataRate ("8Mbps")));
+  Ptr<FlowGenerator> generator = DynamicCast<FlowGenerator> (helper.Install (nodes.Get (0)).Get (0));
+  generator->AddRemote (InetSocketAddress (interfaces.GetAddress (1), 9));
+  generator->AddRemote (InetSocketAddress (interfaces.GetAddress (1), 10));
+  generator->SetStartTime (Seconds (1));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (generator->GetNFlows (), 3, "wrong number of flows started");
+  NS_TEST_EXPECT_MSG_EQ (generator->GetNCompletedFlows (), 3, "flows not completed");
+  NS_TEST_EXPECT_MSG_EQ (sink0->GetTotalRx (), 13000, "wrong number of bytes received by the first remote");
+  NS_TEST_EXPECT_MSG_EQ (sink1->GetTotalRx (), 5000, "wrong number of bytes received by the second remote");
+
+  uint32_t sizes[] = { 10000, 5000, 3000 };
+  uint32_t remotes[] = { 0, 1, 0 };
+  Time starts[] = { MilliSeconds (1100), MilliSeconds (1200), MilliSeconds (1200) };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      const FlowGenerator::FlowRecord &record = generator->GetFlow (i);
+      NS_TEST_EXPECT_MSG_EQ (record.size, sizes[i], "wrong flow size");
+      NS_TEST_EXPECT_MSG_EQ (record.remote, remotes[i], "wrong flow remote address");
+      NS_TEST_EXPECT_MSG_EQ (TimeStep (record.start), starts[i], "wrong flow start");
+      // One packet of 1000 bytes every millisecond
+      NS_TEST_EXPECT_MSG_EQ (generator->GetFlowCompletionTime (i), MilliSeconds (sizes[i] / 1000 - 1),
+                             "wrong flow completion time");
+    }
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup flowgenerator-test
+ * \ingroup tests
+ *
+ * FlowGenerator TestSuite
+ */
+class FlowGeneratorTestSuite : public TestSuite
+{
+public:
+  FlowGeneratorTestSuite ()
+    : TestSuite ("flow-generator", UNIT)
+  {
+    AddTestCase (new FlowGeneratorTcpTestCase (true), TestCase::QUICK);
+    AddTestCase (new FlowGeneratorTcpTestCase (false), TestCase::QUICK);
+    AddTestCase (new FlowGeneratorTraceTestCase, TestCase::QUICK);
+  }
+};
+
+static FlowGeneratorTestSuite g_flowGeneratorTestSuite; //!< Static variable for test initialization
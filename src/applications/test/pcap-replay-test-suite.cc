@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file.h"
+#include "ns3/mac48-address.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/pcap-replay-application.h"
+#include "ns3/pcap-replay-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplayTestSuite");
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that a PcapReplayApplication sends the packets of an Ethernet
+ * capture at their recorded times, to their recorded destination.
+ */
+class PcapReplayTestCase : public TestCase
+{
+public:
+  PcapReplayTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Protocol handler of the receiving node
+   * \param device receiving device
+   * \param p received packet
+   * \param protocol protocol number
+   * \param from source address
+   * \param to destination address
+   * \param type packet type
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType type);
+
+  /**
+   * Write an Ethernet frame to the capture
+   * \param f the capture
+   * \param tsSec timestamp, seconds
+   * \param tsUsec timestamp, microseconds
+   * \param dst destination address
+   * \param src source address
+   * \param type ethertype or 802.3 length
+   * \param payload payload size
+   */
+  void WriteFrame (PcapFile &f, uint32_t tsSec, uint32_t tsUsec, Mac48Address dst,
+                   Mac48Address src, uint16_t type, uint32_t payload);
+
+  std::string m_testFilename;       //!< File name
+  std::vector<Time> m_rxTimes;      //!< reception times
+  std::vector<uint32_t> m_rxSizes;  //!< sizes of the received packets
+  std::vector<uint16_t> m_rxProtocols; //!< protocols of the received packets
+  std::vector<Address> m_rxFrom;    //!< sources of the received packets
+  uint32_t m_drops;                 //!< number of packets dropped by the application
+};
+
+PcapReplayTestCase::PcapReplayTestCase ()
+  : TestCase ("Check that PcapReplayApplication replays an Ethernet capture"),
+    m_drops (0)
+{
+}
+
+void
+PcapReplayTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcap");
+}
+
+void
+PcapReplayTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+PcapReplayTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                             const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  m_rxSizes.push_back (p->GetSize ());
+  m_rxProtocols.push_back (protocol);
+  m_rxFrom.push_back (from);
+}
+
+void
+PcapReplayTestCase::WriteFrame (PcapFile &f, uint32_t tsSec, uint32_t tsUsec, Mac48Address dst,
+                                Mac48Address src, uint16_t type, uint32_t payload)
+{
+  std::vector<uint8_t> frame (14 + payload, 0);
+  dst.CopyTo (&frame[0]);
+  src.CopyTo (&frame[6]);
+  frame[12] = type >> 8;
+  frame[13] = type & 0xff;
+  f.Write (tsSec, tsUsec, &frame[0], frame.size ());
+}
+
+static void
+CountDrop (uint32_t *drops, Ptr<const Packet> p)
+{
+  (*drops)++;
+}
+
+void
+PcapReplayTestCase::DoRun (void)
+{
+  Ptr<Node> txNode = CreateObject<Node> ();
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> txDevice = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDevice = CreateObject<SimpleNetDevice> ();
+  txDevice->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+  rxDevice->SetAddress (Mac48Address ("00:00:00:00:00:02"));
+  txDevice->SetChannel (channel);
+  rxDevice->SetChannel (channel);
+  txNode->AddDevice (txDevice);
+  rxNode->AddDevice (rxDevice);
+  rxNode->RegisterProtocolHandler (MakeCallback (&PcapReplayTestCase::Receive, this), 0, rxDevice);
+
+  Mac48Address rxAddress = Mac48Address::ConvertFrom (rxDevice->GetAddress ());
+  Mac48Address captured ("00:00:00:00:00:aa");
+  PcapFile f;
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Unable to create " << m_testFilename);
+  f.Init (1);
+  WriteFrame (f, 100, 0, rxAddress, captured, 0x0800, 100);
+  WriteFrame (f, 100, 500, rxAddress, captured, 0x0806, 28);
+  // 802.3 frame: not supported, dropped by the application
+  WriteFrame (f, 100, 600, rxAddress, captured, 0x0040, 64);
+  // Frame for another station: sent, but ignored by the receiver
+  WriteFrame (f, 100, 700, Mac48Address ("00:00:00:00:00:03"), captured, 0x0800, 64);
+  WriteFrame (f, 100, 250000, rxAddress, captured, 0x86dd, 1000);
+  f.Close ();
+
+  PcapReplayHelper helper (m_testFilename);
+  ApplicationContainer apps = helper.Install (txNode);
+  apps.Get (0)->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&CountDrop, &m_drops));
+  apps.Start (Seconds (1));
+  apps.Stop (Seconds (10));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 3, "Unexpected number of received packets");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[0], Seconds (1), "Unexpected time of first packet");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[1], Seconds (1) + MicroSeconds (500), "Unexpected time of second packet");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[2], Seconds (1) + MicroSeconds (250000), "Unexpected time of third packet");
+  NS_TEST_EXPECT_MSG_EQ (m_rxSizes[0], 100, "Link-layer header not removed");
+  NS_TEST_EXPECT_MSG_EQ (m_rxSizes[1], 28, "Link-layer header not removed");
+  NS_TEST_EXPECT_MSG_EQ (m_rxSizes[2], 1000, "Link-layer header not removed");
+  NS_TEST_EXPECT_MSG_EQ (m_rxProtocols[0], 0x0800, "Unexpected protocol");
+  NS_TEST_EXPECT_MSG_EQ (m_rxProtocols[1], 0x0806, "Unexpected protocol");
+  NS_TEST_EXPECT_MSG_EQ (m_rxProtocols[2], 0x86dd, "Unexpected protocol");
+  NS_TEST_EXPECT_MSG_EQ (m_rxFrom[0], Address (captured), "Captured source not used");
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "802.3 frame not dropped");
+  NS_TEST_EXPECT_MSG_EQ (DynamicCast<PcapReplayApplication> (apps.Get (0))->GetSent (), 4,
+                         "Unexpected number of packets sent");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief PcapReplayApplication TestSuite
+ */
+class PcapReplayTestSuite : public TestSuite
+{
+public:
+  PcapReplayTestSuite ();
+};
+
+PcapReplayTestSuite::PcapReplayTestSuite ()
+  : TestSuite ("pcap-replay", UNIT)
+{
+  AddTestCase (new PcapReplayTestCase, TestCase::QUICK);
+}
+
+static PcapReplayTestSuite pcapReplayTestSuite; //!< Static variable for test initialization
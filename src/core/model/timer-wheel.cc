@@ -0,0 +1,354 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "timer-wheel.h"
+#include "simulator.h"
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimerWheel and ns3::WheelTimer implementations.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheel");
+
+TimerWheel::TimerWheel (Time granularity)
+  : m_granularity (granularity.GetTimeStep ()),
+    m_current (Simulator::Now ().GetTimeStep () / std::max<int64_t> (granularity.GetTimeStep (), 1)),
+    m_nTimers (0),
+    m_eventTs (-1),
+    m_nEvents (0)
+{
+  NS_LOG_FUNCTION (this << granularity);
+  NS_ASSERT_MSG (m_granularity > 0, "TimerWheel granularity must be strictly positive");
+  for (uint32_t i = 0; i < LEVELS * SLOTS; i++)
+    {
+      m_head[i] = 0;
+      m_tail[i] = 0;
+    }
+  for (uint32_t k = 0; k < LEVELS; k++)
+    {
+      m_occupied[k] = 0;
+    }
+}
+
+TimerWheel::~TimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_nTimers == 0);
+  m_event.Cancel ();
+}
+
+Time
+TimerWheel::GetGranularity (void) const
+{
+  return TimeStep (m_granularity);
+}
+
+uint32_t
+TimerWheel::GetNTimers (void) const
+{
+  return m_nTimers;
+}
+
+uint64_t
+TimerWheel::GetNEvents (void) const
+{
+  return m_nEvents;
+}
+
+void
+TimerWheel::Link (WheelTimer *timer)
+{
+  uint64_t tick = timer->m_expiry / m_granularity;
+  NS_ASSERT (tick >= m_current);
+  uint64_t diff = tick ^ m_current;
+  uint32_t level = diff == 0 ? 0 : (63 - __builtin_clzll (diff)) / LEVEL_BITS;
+  uint32_t slot = (tick >> (level * LEVEL_BITS)) & (SLOTS - 1);
+  uint32_t list = level * SLOTS + slot;
+
+  timer->m_list = list;
+  timer->m_next = 0;
+  timer->m_prev = m_tail[list];
+  if (m_tail[list] != 0)
+    {
+      m_tail[list]->m_next = timer;
+    }
+  else
+    {
+      m_head[list] = timer;
+      m_occupied[level] |= uint64_t (1) << slot;
+    }
+  m_tail[list] = timer;
+}
+
+void
+TimerWheel::Insert (WheelTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer << timer->m_expiry);
+  Link (timer);
+  m_nTimers++;
+  ScheduleEvent (timer->m_expiry);
+}
+
+void
+TimerWheel::Remove (WheelTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  uint32_t list = timer->m_list;
+  NS_ASSERT (list != WheelTimer::NOT_LINKED);
+  if (timer->m_prev != 0)
+    {
+      timer->m_prev->m_next = timer->m_next;
+    }
+  else
+    {
+      m_head[list] = timer->m_next;
+    }
+  if (timer->m_next != 0)
+    {
+      timer->m_next->m_prev = timer->m_prev;
+    }
+  else
+    {
+      m_tail[list] = timer->m_prev;
+    }
+  if (m_head[list] == 0)
+    {
+      m_occupied[list / SLOTS] &= ~(uint64_t (1) << (list % SLOTS));
+    }
+  timer->m_list = WheelTimer::NOT_LINKED;
+  timer->m_prev = 0;
+  timer->m_next = 0;
+  m_nTimers--;
+}
+
+void
+TimerWheel::Advance (uint64_t tick)
+{
+  uint64_t old = m_current;
+  if (tick <= old)
+    {
+      return;
+    }
+  m_current = tick;
+  // The list of the new current tick at each level entered holds the
+  // timers to move to the lower levels.  All the other lists passed are
+  // empty, since no timer expires before the new current tick.
+  for (uint32_t level = LEVELS - 1; level > 0; level--)
+    {
+      uint32_t shift = level * LEVEL_BITS;
+      if ((old >> shift) == (tick >> shift))
+        {
+          continue;
+        }
+      uint32_t slot = (tick >> shift) & (SLOTS - 1);
+      uint32_t list = level * SLOTS + slot;
+      WheelTimer *timer = m_head[list];
+      m_head[list] = 0;
+      m_tail[list] = 0;
+      m_occupied[level] &= ~(uint64_t (1) << slot);
+      while (timer != 0)
+        {
+          WheelTimer *next = timer->m_next;
+          Link (timer);
+          timer = next;
+        }
+    }
+}
+
+int64_t
+TimerWheel::GetNextEventTs (void) const
+{
+  for (uint32_t level = 0; level < LEVELS; level++)
+    {
+      uint32_t shift = level * LEVEL_BITS;
+      uint32_t index = (m_current >> shift) & (SLOTS - 1);
+      uint64_t occupied = m_occupied[level];
+      if (level == 0)
+        {
+          occupied &= ~uint64_t (0) << index;
+        }
+      else
+        {
+          // The list of the current tick was emptied when it was entered
+          occupied = index == SLOTS - 1 ? 0 : occupied & (~uint64_t (0) << (index + 1));
+        }
+      if (occupied == 0)
+        {
+          continue;
+        }
+      uint64_t slot = __builtin_ctzll (occupied);
+      if (level == 0)
+        {
+          // Timers of the same tick expire at their own time
+          int64_t ts = -1;
+          for (WheelTimer *timer = m_head[slot]; timer != 0; timer = timer->m_next)
+            {
+              if (ts < 0 || timer->m_expiry < ts)
+                {
+                  ts = timer->m_expiry;
+                }
+            }
+          return ts;
+        }
+      // Wake up when the list is entered, to move its timers down
+      uint32_t high = shift + LEVEL_BITS;
+      uint64_t base = high >= 64 ? 0 : (m_current >> high) << high;
+      return (base | (slot << shift)) * m_granularity;
+    }
+  return -1;
+}
+
+void
+TimerWheel::ScheduleEvent (int64_t ts)
+{
+  if (m_eventTs >= 0 && m_eventTs <= ts)
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("wheel event moved to " << TimeStep (ts));
+  m_event.Cancel ();
+  m_eventTs = ts;
+  m_nEvents++;
+  m_event = Simulator::Schedule (TimeStep (ts - Simulator::Now ().GetTimeStep ()), &TimerWheel::Expire, this);
+}
+
+void
+TimerWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The expired functions may release the last references to the wheel
+  Ptr<TimerWheel> self = this;
+  m_eventTs = -1;
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  Advance (now / m_granularity);
+
+  uint32_t list = m_current & (SLOTS - 1);
+  while (true)
+    {
+      WheelTimer *timer = m_head[list];
+      while (timer != 0 && timer->m_expiry > now)
+        {
+          timer = timer->m_next;
+        }
+      if (timer == 0)
+        {
+          break;
+        }
+      // The function may schedule or cancel any timer, including this one
+      Remove (timer);
+      timer->m_impl->Invoke ();
+    }
+
+  int64_t next = GetNextEventTs ();
+  if (next >= 0)
+    {
+      ScheduleEvent (next);
+    }
+}
+
+
+WheelTimer::WheelTimer ()
+  : m_impl (0),
+    m_wheel (0),
+    m_event (),
+    m_expiry (0),
+    m_list (NOT_LINKED),
+    m_prev (0),
+    m_next (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+WheelTimer::~WheelTimer ()
+{
+  NS_LOG_FUNCTION (this);
+  Cancel ();
+  delete m_impl;
+}
+
+void
+WheelTimer::SetWheel (Ptr<TimerWheel> wheel)
+{
+  NS_LOG_FUNCTION (this << wheel);
+  NS_ASSERT_MSG (!IsRunning (), "cannot change the wheel of a running WheelTimer");
+  m_wheel = wheel;
+}
+
+Ptr<TimerWheel>
+WheelTimer::GetWheel (void) const
+{
+  return m_wheel;
+}
+
+void
+WheelTimer::Schedule (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  NS_ASSERT_MSG (m_impl != 0, "You cannot schedule a WheelTimer before setting its function.");
+  NS_ASSERT (!delay.IsStrictlyNegative ());
+  if (m_wheel == 0)
+    {
+      m_event.Cancel ();
+      m_event = m_impl->Schedule (delay);
+      return;
+    }
+  if (m_list != NOT_LINKED)
+    {
+      m_wheel->Remove (this);
+    }
+  m_expiry = Simulator::Now ().GetTimeStep () + delay.GetTimeStep ();
+  m_wheel->Insert (this);
+}
+
+void
+WheelTimer::Cancel (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_list != NOT_LINKED)
+    {
+      m_wheel->Remove (this);
+    }
+  m_event.Cancel ();
+}
+
+bool
+WheelTimer::IsRunning (void) const
+{
+  return m_list != NOT_LINKED || m_event.IsRunning ();
+}
+
+bool
+WheelTimer::IsExpired (void) const
+{
+  return !IsRunning ();
+}
+
+Time
+WheelTimer::GetDelayLeft (void) const
+{
+  if (m_list != NOT_LINKED)
+    {
+      return TimeStep (m_expiry - Simulator::Now ().GetTimeStep ());
+    }
+  return Simulator::GetDelayLeft (m_event);
+}
+
+} // namespace ns3
@@ -0,0 +1,318 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "nstime.h"
+#include "event-id.h"
+#include "ptr.h"
+#include "simple-ref-count.h"
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimerWheel and ns3::WheelTimer declarations.
+ */
+
+namespace ns3 {
+
+class TimerImpl;
+class WheelTimer;
+
+/**
+ * \ingroup timer
+ * \brief A hierarchical timer wheel sharing few simulator events among
+ * many timers.
+ *
+ * Protocols often arm a timer on every packet and cancel or push it back
+ * on the next one, so that most of their timers never expire.  Scheduled
+ * as simulator events, every such timer costs an insertion in the
+ * scheduler and a cancelled event left in it.  WheelTimer objects
+ * attached to a TimerWheel are instead kept in the lists of the wheel,
+ * and arming, cancelling or moving them only relinks them, in constant
+ * time.  The wheel keeps a single simulator event, scheduled no later
+ * than the earliest timer, and moves it earlier only when a timer
+ * expiring before it is armed: cancelling or pushing back timers leaves
+ * the event in place, to find nothing to do or to be scheduled again
+ * when it runs.
+ *
+ * The wheel has 11 levels of 64 lists, the lists of level \f$k\f$
+ * covering \f$64^k\f$ ticks of the granularity of the wheel each.  A
+ * timer is stored at the level of the highest digit, in base 64, in
+ * which its expiration tick differs from the current tick, and moves to
+ * the lower levels as the current tick gets closer.  The granularity
+ * does not round the expiration times: the timers of the current tick
+ * are expired at their own time.  It only sets how many timers share a
+ * list, and how often the wheel event runs to move timers to lower
+ * levels while they wait.
+ */
+class TimerWheel : public SimpleRefCount<TimerWheel>
+{
+public:
+  /**
+   * \brief Constructor
+   * \param [in] granularity duration of a tick of the wheel, strictly positive
+   */
+  TimerWheel (Time granularity);
+  /** Destructor. */
+  ~TimerWheel ();
+
+  /**
+   * \returns the duration of a tick of the wheel
+   */
+  Time GetGranularity (void) const;
+  /**
+   * \returns the number of timers running on this wheel
+   */
+  uint32_t GetNTimers (void) const;
+  /**
+   * \returns the number of simulator events scheduled by this wheel
+   */
+  uint64_t GetNEvents (void) const;
+
+private:
+  friend class WheelTimer;
+
+  /**
+   * \brief Copy constructor, not implemented
+   * \param [in] o object to copy
+   */
+  TimerWheel (TimerWheel const &o);
+  /**
+   * \brief Assignment operator, not implemented
+   * \param [in] o object to copy
+   * \returns the object
+   */
+  TimerWheel &operator = (TimerWheel const &o);
+
+  /**
+   * \brief Add a timer to the wheel
+   * \param [in] timer the timer, whose expiration time is set
+   */
+  void Insert (WheelTimer *timer);
+  /**
+   * \brief Add a timer to the list of its expiration tick
+   * \param [in] timer the timer
+   */
+  void Link (WheelTimer *timer);
+  /**
+   * \brief Remove a timer from the wheel
+   * \param [in] timer the timer, running on this wheel
+   */
+  void Remove (WheelTimer *timer);
+  /**
+   * \brief Move the current tick forward, moving the timers of the lists
+   * entered to the lower levels
+   * \param [in] tick the new current tick, not after the expiration of any timer
+   */
+  void Advance (uint64_t tick);
+  /**
+   * \returns the time, in time steps, at which the wheel event must run
+   * next, or -1 if the wheel is empty
+   */
+  int64_t GetNextEventTs (void) const;
+  /**
+   * \brief Make sure the wheel event runs no later than a given time
+   * \param [in] ts the time, in time steps
+   */
+  void ScheduleEvent (int64_t ts);
+  /** Expire the timers due and schedule the next wheel event. */
+  void Expire (void);
+
+  static const uint32_t LEVEL_BITS = 6;                  //!< Bits of a tick for each level
+  static const uint32_t SLOTS = 1 << LEVEL_BITS;          //!< Lists in each level
+  static const uint32_t LEVELS = 11;                     //!< Levels, to cover 64 bits ticks
+
+  int64_t m_granularity;                   //!< Duration of a tick, in time steps
+  uint64_t m_current;                      //!< Current tick
+  WheelTimer *m_head[LEVELS * SLOTS];      //!< First timer of each list
+  WheelTimer *m_tail[LEVELS * SLOTS];      //!< Last timer of each list
+  uint64_t m_occupied[LEVELS];             //!< Bitmap of the lists holding timers, for each level
+  uint32_t m_nTimers;                      //!< Number of timers running
+  EventId m_event;                         //!< The wheel event
+  int64_t m_eventTs;                       //!< Time of the wheel event, -1 if none is pending
+  uint64_t m_nEvents;                      //!< Number of wheel events scheduled
+};
+
+/**
+ * \ingroup timer
+ * \brief A timer kept on a TimerWheel
+ *
+ * A WheelTimer is used like a Timer whose function is invoked only once
+ * per call to Schedule: scheduling it again while it runs moves its
+ * expiration time, and Cancel stops it.  Without a wheel, the timer
+ * schedules its own simulator events, like a Timer.
+ *
+ * A wheel can only be set while the timer is not running.  WheelTimer
+ * objects cannot be copied.
+ */
+class WheelTimer
+{
+public:
+  /** Constructor. */
+  WheelTimer ();
+  /** Destructor, cancels the timer. */
+  ~WheelTimer ();
+
+  /**
+   * \brief Set the wheel used by this timer
+   * \param [in] wheel the wheel, or 0 to schedule simulator events
+   */
+  void SetWheel (Ptr<TimerWheel> wheel);
+  /**
+   * \returns the wheel used by this timer, or 0 if none
+   */
+  Ptr<TimerWheel> GetWheel (void) const;
+
+  /**
+   * Set the function to execute when the timer expires.
+   *
+   * \tparam FN \deduced The type of the function.
+   * \param [in] fn The function
+   */
+  template <typename FN>
+  void SetFunction (FN fn);
+  /**
+   * Set the function to execute when the timer expires.
+   *
+   * \tparam MEM_PTR \deduced Class method function type.
+   * \tparam OBJ_PTR \deduced Class type containing the function.
+   * \param [in] memPtr The member function pointer
+   * \param [in] objPtr The pointer to object
+   */
+  template <typename MEM_PTR, typename OBJ_PTR>
+  void SetFunction (MEM_PTR memPtr, OBJ_PTR objPtr);
+
+  /**
+   * Set the arguments to be used when invoking the expire function.
+   */
+  /**@{*/
+  /**
+   * \tparam T1 \deduced Type of the first argument.
+   * \param [in] a1 The first argument
+   */
+  template <typename T1>
+  void SetArguments (T1 a1);
+  /**
+   * \tparam T1 \deduced Type of the first argument.
+   * \tparam T2 \deduced Type of the second argument.
+   * \param [in] a1 the first argument
+   * \param [in] a2 the second argument
+   */
+  template <typename T1, typename T2>
+  void SetArguments (T1 a1, T2 a2);
+  /**@}*/
+
+  /**
+   * \brief Start the timer, or move its expiration time if it runs
+   * \param [in] delay delay after which the function is invoked
+   */
+  void Schedule (Time delay);
+  /** Stop the timer, if it runs. */
+  void Cancel (void);
+  /**
+   * \returns true if the timer runs
+   */
+  bool IsRunning (void) const;
+  /**
+   * \returns true if the timer does not run
+   */
+  bool IsExpired (void) const;
+  /**
+   * \returns the time left before the timer expires, zero if it does not run
+   */
+  Time GetDelayLeft (void) const;
+
+private:
+  friend class TimerWheel;
+
+  /**
+   * \brief Copy constructor, not implemented
+   * \param [in] o object to copy
+   */
+  WheelTimer (WheelTimer const &o);
+  /**
+   * \brief Assignment operator, not implemented
+   * \param [in] o object to copy
+   * \returns the object
+   */
+  WheelTimer &operator = (WheelTimer const &o);
+
+  static const uint32_t NOT_LINKED = 0xffffffff; //!< m_list of a timer not on a wheel list
+
+  TimerImpl *m_impl;          //!< The function and arguments
+  Ptr<TimerWheel> m_wheel;    //!< The wheel, if any
+  EventId m_event;            //!< Simulator event of a timer without wheel
+  int64_t m_expiry;           //!< Expiration time, in time steps, of a timer on a wheel
+  uint32_t m_list;            //!< Wheel list holding the timer, or NOT_LINKED
+  WheelTimer *m_prev;         //!< Previous timer in the wheel list
+  WheelTimer *m_next;         //!< Next timer in the wheel list
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+#include "timer-impl.h"
+
+namespace ns3 {
+
+template <typename FN>
+void
+WheelTimer::SetFunction (FN fn)
+{
+  delete m_impl;
+  m_impl = MakeTimerImpl (fn);
+}
+
+template <typename MEM_PTR, typename OBJ_PTR>
+void
+WheelTimer::SetFunction (MEM_PTR memPtr, OBJ_PTR objPtr)
+{
+  delete m_impl;
+  m_impl = MakeTimerImpl (memPtr, objPtr);
+}
+
+template <typename T1>
+void
+WheelTimer::SetArguments (T1 a1)
+{
+  if (m_impl == 0)
+    {
+      NS_FATAL_ERROR ("You cannot set the arguments of a WheelTimer before setting its function.");
+      return;
+    }
+  m_impl->SetArgs (a1);
+}
+
+template <typename T1, typename T2>
+void
+WheelTimer::SetArguments (T1 a1, T2 a2)
+{
+  if (m_impl == 0)
+    {
+      NS_FATAL_ERROR ("You cannot set the arguments of a WheelTimer before setting its function.");
+      return;
+    }
+  m_impl->SetArgs (a1, a2);
+}
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <vector>
+#include "ns3/timer-wheel.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup timer
+ * \ingroup timer-tests
+ * TimerWheel test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup timer-tests
+ * Check that timers on a wheel expire exactly when scheduled, while they
+ * are randomly scheduled, moved and cancelled.
+ */
+class TimerWheelTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param useWheel attach the timers to a wheel
+   */
+  TimerWheelTestCase (bool useWheel);
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Function invoked when a timer expires.
+   * \param i index of the timer
+   */
+  void Expire (uint32_t i);
+  /** Randomly schedule or cancel a timer. */
+  void Step (void);
+  /**
+   * \returns a random delay, from nanoseconds to hours
+   */
+  Time RandomDelay (void);
+
+  static const uint32_t N_TIMERS = 200;  //!< Number of timers
+  static const uint32_t N_STEPS = 20000; //!< Number of random operations
+
+  bool m_useWheel;                       //!< Attach the timers to a wheel
+  Ptr<UniformRandomVariable> m_rng;      //!< Random number generator
+  std::vector<WheelTimer *> m_timers;    //!< The timers
+  std::vector<Time> m_expected;          //!< Expected expiration times, negative if not running
+  uint32_t m_steps;                      //!< Operations done
+  uint32_t m_nSchedules;                 //!< Number of calls to WheelTimer::Schedule
+  uint32_t m_nExpired;                   //!< Timers expired
+  bool m_failed;                         //!< A check failed
+};
+
+TimerWheelTestCase::TimerWheelTestCase (bool useWheel)
+  : TestCase (useWheel ? "Check timers on a TimerWheel" : "Check WheelTimer without wheel"),
+    m_useWheel (useWheel)
+{
+}
+
+Time
+TimerWheelTestCase::RandomDelay (void)
+{
+  switch (m_rng->GetInteger (0, 4))
+    {
+    case 0:
+      return NanoSeconds (m_rng->GetInteger (0, 2000));
+    case 1:
+      return MicroSeconds (m_rng->GetInteger (0, 5000));
+    case 2:
+      return MilliSeconds (m_rng->GetInteger (0, 5000));
+    case 3:
+      return Seconds (m_rng->GetValue (0, 100));
+    default:
+      return Seconds (m_rng->GetValue (0, 20000));
+    }
+}
+
+void
+TimerWheelTestCase::Expire (uint32_t i)
+{
+  if (m_expected[i] != Simulator::Now () || m_timers[i]->IsRunning ())
+    {
+      m_failed = true;
+    }
+  m_expected[i] = Seconds (-1);
+  m_nExpired++;
+  // Expired functions may schedule timers again
+  if (m_rng->GetValue () < 0.3)
+    {
+      Time delay = RandomDelay ();
+      m_timers[i]->Schedule (delay);
+      m_expected[i] = Simulator::Now () + delay;
+      m_nSchedules++;
+    }
+}
+
+void
+TimerWheelTestCase::Step (void)
+{
+  uint32_t i = m_rng->GetInteger (0, N_TIMERS - 1);
+  if (m_timers[i]->IsRunning () != m_expected[i].IsPositive ()
+      || (m_timers[i]->IsRunning () && m_timers[i]->GetDelayLeft () != m_expected[i] - Simulator::Now ()))
+    {
+      m_failed = true;
+    }
+  if (m_rng->GetValue () < 0.2)
+    {
+      m_timers[i]->Cancel ();
+      m_expected[i] = Seconds (-1);
+    }
+  else
+    {
+      Time delay = RandomDelay ();
+      m_timers[i]->Schedule (delay);
+      m_expected[i] = Simulator::Now () + delay;
+      m_nSchedules++;
+    }
+  if (++m_steps < N_STEPS)
+    {
+      Simulator::Schedule (MicroSeconds (m_rng->GetInteger (0, 100000)), &TimerWheelTestCase::Step, this);
+    }
+}
+
+void
+TimerWheelTestCase::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+  m_steps = 0;
+  m_nSchedules = 0;
+  m_nExpired = 0;
+  m_failed = false;
+
+  Ptr<TimerWheel> wheel = m_useWheel ? Create<TimerWheel> (MilliSeconds (1)) : 0;
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      WheelTimer *timer = new WheelTimer ();
+      timer->SetWheel (wheel);
+      timer->SetFunction (&TimerWheelTestCase::Expire, this);
+      timer->SetArguments (i);
+      m_timers.push_back (timer);
+      m_expected.push_back (Seconds (-1));
+    }
+
+  Simulator::Schedule (Seconds (1), &TimerWheelTestCase::Step, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_failed, false, "timer expired at the wrong time or in the wrong state");
+  NS_TEST_EXPECT_MSG_EQ (m_steps, N_STEPS, "simulation stopped early");
+  NS_TEST_EXPECT_MSG_GT (m_nExpired, N_STEPS / 20, "too few timers expired");
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_timers[i]->IsRunning (), false, "timer left running");
+      NS_TEST_EXPECT_MSG_EQ (m_expected[i].IsStrictlyNegative (), true, "timer did not expire");
+      delete m_timers[i];
+    }
+  m_timers.clear ();
+  m_expected.clear ();
+  if (m_useWheel)
+    {
+      NS_TEST_EXPECT_MSG_EQ (wheel->GetNTimers (), 0, "timers left on the wheel");
+    }
+}
+
+
+/**
+ * \ingroup timer-tests
+ * Check that timers pushed back on every use, like retransmission
+ * timers, cost few simulator events.
+ */
+class TimerWheelPushBackTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  TimerWheelPushBackTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /** Function invoked when a timer expires. */
+  void Expire (void);
+  /**
+   * Push back a timer.
+   * \param i index of the timer
+   */
+  void Push (uint32_t i);
+
+  static const uint32_t N_TIMERS = 100; //!< Number of timers
+
+  WheelTimer m_timers[N_TIMERS];        //!< The timers
+  uint32_t m_nSchedules;                //!< Number of calls to WheelTimer::Schedule
+  uint32_t m_nExpired;                  //!< Timers expired
+};
+
+TimerWheelPushBackTestCase::TimerWheelPushBackTestCase ()
+  : TestCase ("Check the events of timers pushed back on a TimerWheel")
+{
+}
+
+void
+TimerWheelPushBackTestCase::Expire (void)
+{
+  m_nExpired++;
+}
+
+void
+TimerWheelPushBackTestCase::Push (uint32_t i)
+{
+  m_timers[i].Schedule (MilliSeconds (200));
+  m_nSchedules++;
+  if (Simulator::Now () < Seconds (1))
+    {
+      Simulator::Schedule (MicroSeconds (997), &TimerWheelPushBackTestCase::Push, this, i);
+    }
+}
+
+void
+TimerWheelPushBackTestCase::DoRun (void)
+{
+  m_nSchedules = 0;
+  m_nExpired = 0;
+  Ptr<TimerWheel> wheel = Create<TimerWheel> (MilliSeconds (1));
+  for (uint32_t i = 0; i < N_TIMERS; i++)
+    {
+      m_timers[i].SetWheel (wheel);
+      m_timers[i].SetFunction (&TimerWheelPushBackTestCase::Expire, this);
+      Simulator::Schedule (MicroSeconds (10 * i), &TimerWheelPushBackTestCase::Push, this, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nExpired, N_TIMERS, "every timer must expire once, after its last push");
+  NS_TEST_ASSERT_MSG_GT (m_nSchedules, 100000, "too few timers scheduled");
+  // One event per timer expiring, and a few to move the timers down
+  NS_TEST_ASSERT_MSG_LT (wheel->GetNEvents (), N_TIMERS + 20, "too many wheel events");
+}
+
+
+/**
+ * \ingroup timer-tests
+ * TimerWheel test suite
+ */
+class TimerWheelTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  TimerWheelTestSuite ()
+    : TestSuite ("timer-wheel", UNIT)
+  {
+    AddTestCase (new TimerWheelTestCase (true), TestCase::QUICK);
+    AddTestCase (new TimerWheelTestCase (false), TestCase::QUICK);
+    AddTestCase (new TimerWheelPushBackTestCase (), TestCase::QUICK);
+  }
+};
+
+/**
+ * \ingroup timer-tests
+ * TimerWheelTestSuite instance variable.
+ */
+static TimerWheelTestSuite g_timerWheelTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
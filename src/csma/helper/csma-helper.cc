@@ -112,6 +112,28 @@ CsmaHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool prom
     }
 }
 
+void
+CsmaHelper::EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+  Ptr<CsmaNetDevice> device = nd->GetObject<CsmaNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("CsmaHelper::EnablePcapNgInternal(): Device " << device << " not of type ns3::CsmaNetDevice");
+      return;
+    }
+
+  PcapHelper pcapHelper;
+  uint32_t interfaceId = file->AddInterface (PcapHelper::DLT_EN10MB, pcapHelper.GetInterfaceNameFromDevice (device));
+  if (promiscuous)
+    {
+      pcapHelper.HookDefaultSink<CsmaNetDevice> (device, "PromiscSniffer", file, interfaceId);
+    }
+  else
+    {
+      pcapHelper.HookDefaultSink<CsmaNetDevice> (device, "Sniffer", file, interfaceId);
+    }
+}
+
 void 
 CsmaHelper::EnableAsciiInternal (
   Ptr<OutputStreamWrapper> stream, 
@@ -213,6 +235,34 @@ CsmaHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+
+void
+CsmaHelper::EnableBinaryInternal (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd)
+{
+  Ptr<CsmaNetDevice> device = nd->GetObject<CsmaNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("CsmaHelper::EnableBinaryInternal(): Device " << device <<
+                   " not of type ns3::CsmaNetDevice");
+      return;
+    }
+
+  //
+  // Hook the same trace sources as the ascii traces, but unlike those the
+  // binary sinks do not need packet printing.
+  //
+  AsciiTraceHelper asciiTraceHelper;
+  uint32_t nodeid = nd->GetNode ()->GetId ();
+  uint32_t deviceid = nd->GetIfIndex ();
+
+  asciiTraceHelper.HookBinarySink<CsmaNetDevice> (device, "MacRx", file, BinaryTraceFile::RECEIVE, nodeid, deviceid);
+
+  Ptr<Queue<Packet> > queue = device->GetQueue ();
+  asciiTraceHelper.HookBinarySink<Queue<Packet> > (queue, "Enqueue", file, BinaryTraceFile::ENQUEUE, nodeid, deviceid);
+  asciiTraceHelper.HookBinarySink<Queue<Packet> > (queue, "Drop", file, BinaryTraceFile::DROP, nodeid, deviceid);
+  asciiTraceHelper.HookBinarySink<Queue<Packet> > (queue, "Dequeue", file, BinaryTraceFile::DEQUEUE, nodeid, deviceid);
+}
+
 NetDeviceContainer
 CsmaHelper::Install (Ptr<Node> node) const
 {
@@ -30,6 +30,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/tso-tag.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
 #include "ns3/net-device-queue-interface.h"
@@ -386,6 +387,7 @@ CsmaNetDevice::AddHeader (Ptr<Packet> p,   Mac48Address source,  Mac48Address de
         NS_LOG_LOGIC ("Encapsulating packet as LLC (length interpretation)");
 
         LlcSnapHeader llc;
+        TsoTag tsoTag;
         llc.SetType (protocolNumber);
         p->AddHeader (llc);
 
@@ -410,7 +412,7 @@ CsmaNetDevice::AddHeader (Ptr<Packet> p,   Mac48Address source,  Mac48Address de
             p->AddAtEnd (padd);
           }
 
-        NS_ASSERT_MSG (p->GetSize () <= GetMtu (),
+        NS_ASSERT_MSG (p->GetSize () <= GetMtu () || p->PeekPacketTag (tsoTag),
                        "CsmaNetDevice::AddHeader(): 802.3 Length/Type field with LLC/SNAP: "
                        "length interpretation must not exceed device frame size minus overhead");
       }
@@ -558,7 +560,14 @@ CsmaNetDevice::TransmitStart (void)
           m_backoff.ResetBackoffTime ();
           m_txMachineState = BUSY;
 
-          Time tEvent = m_bps.CalculateBytesTxTime (m_currentPkt->GetSize ());
+          //
+          // A TCP super-segment holds the channel for all the segments it
+          // stands for, each one with its own framing and followed by an
+          // interframe gap.
+          //
+          uint32_t nSegments;
+          uint32_t wireSize = TsoTag::GetWireSize (m_currentPkt, nSegments);
+          Time tEvent = m_bps.CalculateBytesTxTime (wireSize) + m_tInterframeGap * int64_t (nSegments - 1);
           NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << tEvent.GetSeconds () << "sec");
           Simulator::Schedule (tEvent, &CsmaNetDevice::TransmitCompleteEvent, this);
         }
@@ -1084,6 +1093,13 @@ CsmaNetDevice::SupportsSendFrom () const
   return true;
 }
 
+bool
+CsmaNetDevice::SupportsTso () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
 int64_t
 CsmaNetDevice::AssignStreams (int64_t stream)
 {
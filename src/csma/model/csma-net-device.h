@@ -327,6 +327,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsTso (void) const;
 
  /**
   * Assign a fixed random variable stream number to the random variables
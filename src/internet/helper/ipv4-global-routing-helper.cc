@@ -63,12 +63,26 @@ Ipv4GlobalRoutingHelper::PopulateRoutingTables (void)
   GlobalRouteManager::BuildGlobalRoutingDatabase ();
   GlobalRouteManager::InitializeRoutes ();
 }
-void 
-Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
+void
+Ipv4GlobalRoutingHelper::PopulateRoutingTablesFromFile (std::string filename)
 {
-  GlobalRouteManager::DeleteGlobalRoutes ();
   GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  if (GlobalRouteManager::LoadRoutingTables (filename))
+    {
+      NS_LOG_INFO ("Loaded the routing tables from " << filename);
+      return;
+    }
   GlobalRouteManager::InitializeRoutes ();
+  if (!GlobalRouteManager::SaveRoutingTables (filename))
+    {
+      NS_LOG_WARN ("Unable to save the routing tables to " << filename);
+    }
+}
+
+void 
+Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
+{
+  GlobalRouteManager::RecomputeRoutingTables ();
 }
 
 
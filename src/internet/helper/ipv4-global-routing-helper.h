@@ -20,6 +20,7 @@
 #ifndef IPV4_GLOBAL_ROUTING_HELPER_H
 #define IPV4_GLOBAL_ROUTING_HELPER_H
 
+#include <string>
 #include "ns3/node-container.h"
 #include "ns3/ipv4-routing-helper.h"
 
@@ -71,6 +72,18 @@ public:
    *
    */
   static void PopulateRoutingTables (void);
+  /**
+   * \brief Build a routing database and initialize the routing tables of
+   * the nodes in the simulation from a routing tables file.
+   *
+   * If the file holds routing tables saved for the same topology, they are
+   * installed instead of being computed.  Otherwise, the routing tables are
+   * computed as PopulateRoutingTables() does and saved to the file, for the
+   * next runs of the same topology.
+   *
+   * \param filename the name of the routing tables file
+   */
+  static void PopulateRoutingTablesFromFile (std::string filename);
   /**
    * \brief Remove all routes that were previously installed in a prior call
    * to either PopulateRoutingTables() or RecomputeRoutingTables(), and 
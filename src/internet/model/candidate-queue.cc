@@ -49,24 +49,27 @@ operator<< (std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream& 
 operator<< (std::ostream& os, const CandidateQueue& q)
 {
-  typedef CandidateQueue::CandidateList_t List_t;
-  typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  typedef CandidateQueue::CandidateHeap_t Heap_t;
+  Heap_t sorted = q.m_candidates;
+  std::sort (sorted.begin (), sorted.end (), &CandidateQueue::Before);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-  for (CIter_t iter = list.begin (); iter != list.end (); iter++)
+  for (Heap_t::const_iterator iter = sorted.begin (); iter != sorted.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_positions (),
+    m_lastSequence (0),
+    m_firstSequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +97,13 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  c.distance = vNew->GetDistanceFromRoot ();
+  c.sequence = ++m_lastSequence;
+  m_candidates.push_back (c);
+  m_positions[vNew->GetVertexId ()] = m_candidates.size () - 1;
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -110,8 +115,15 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  m_positions.erase (v->GetVertexId ());
+  Candidate last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -124,7 +136,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -145,18 +157,12 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_positions.find (addr);
+  if (i == m_positions.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return 0;
     }
-
-  return 0;
+  return m_candidates[i->second].vertex;
 }
 
 void
@@ -164,37 +170,134 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  //
+  // Update the candidates whose distance changed in their current order,
+  // so that the equal candidates keep the order a stable sort would give
+  // them.
+  //
+  CandidateHeap_t changed;
+  for (CandidateHeap_t::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      if (i->distance != i->vertex->GetDistanceFromRoot ())
+        {
+          changed.push_back (*i);
+        }
+    }
+  std::sort (changed.begin (), changed.end (), &CandidateQueue::Before);
+  for (CandidateHeap_t::const_iterator i = changed.begin (); i != changed.end (); i++)
+    {
+      Update (m_positions[i->vertex->GetVertexId ()]);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_positions.find (v->GetVertexId ());
+  NS_ASSERT_MSG (i != m_positions.end () && m_candidates[i->second].vertex == v,
+                 "CandidateQueue::Reorder (): vertex not in the queue");
+  Update (i->second);
+}
+
+void
+CandidateQueue::Update (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  uint32_t distance = c.vertex->GetDistanceFromRoot ();
+  if (distance < c.distance)
+    {
+      c.distance = distance;
+      c.sequence = ++m_lastSequence;
+      Place (i, c);
+      SiftUp (i);
+    }
+  else if (distance > c.distance)
+    {
+      c.distance = distance;
+      c.sequence = --m_firstSequence;
+      Place (i, c);
+      SiftDown (i);
+    }
+}
+
+void
+CandidateQueue::Place (uint32_t i, const Candidate &c)
+{
+  m_candidates[i] = c;
+  m_positions[c.vertex->GetVertexId ()] = i;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / 2;
+      if (!Before (c, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (i, m_candidates[parent]);
+      i = parent;
+    }
+  Place (i, c);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  uint32_t n = m_candidates.size ();
+  for (;;)
+    {
+      uint32_t child = 2 * i + 1;
+      if (child >= n)
+        {
+          break;
+        }
+      if (child + 1 < n && Before (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!Before (m_candidates[child], c))
+        {
+          break;
+        }
+      Place (i, m_candidates[child]);
+      i = child;
+    }
+  Place (i, c);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
  * In case of a tie, NetworkLSA is always ranked before RouterLSA.
  *
  * This ordering is necessary for implementing ECMP
+ *
+ * The distances compared are the ones the candidates were last ordered
+ * with, and the remaining ties are broken by sequence number.
  */
-bool 
-CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
+bool
+CandidateQueue::Before (const Candidate &c1, const Candidate &c2)
 {
-  NS_LOG_FUNCTION (&v1 << &v2);
-
-  bool result = false;
-  if (v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ())
+  if (c1.distance != c2.distance)
     {
-      result = true;
+      return c1.distance < c2.distance;
     }
-  else if (v1->GetDistanceFromRoot () == v2->GetDistanceFromRoot ())
+  bool network1 = c1.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  bool network2 = c2.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  if (network1 != network2)
     {
-      if (v1->GetVertexType () == SPFVertex::VertexNetwork 
-          && v2->GetVertexType () == SPFVertex::VertexRouter)
-        {
-          result = true;
-        }
+      return network1;
     }
-  return result;
+  return c1.sequence < c2.sequence;
 }
 
 } // namespace ns3
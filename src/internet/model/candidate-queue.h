@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +48,11 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap indexed by vertex ID, so that Push, Pop,
+ * Find and the reordering of a single vertex take a logarithmic time.
+ * Vertices which compare equal are popped in the order they were pushed
+ * or last reordered in, as if they were kept in a sorted list.
  */
 class CandidateQueue
 {
@@ -154,6 +160,18 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restores the order of the Candidate Queue after the value of the
+ * field m_distanceFromRoot of one of its vertices has changed.
+ *
+ * This is equivalent to, but faster than, Reorder () when a single vertex
+ * has changed.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance has changed.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -171,21 +189,64 @@ private:
  * \return copied object
  */
   CandidateQueue& operator= (CandidateQueue& sr);
-/**
- * \brief return true if v1 < v2
- *
- * SPFVertexes are added into the queue according to the ordering
- * defined by this method. If v1 should be popped before v2, this 
- * method return true; false otherwise
- *
- * \param v1 first operand
- * \param v2 second operand
- * \return True if v1 should be popped before v2; false otherwise
- */
-  static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /**
+   * \brief A vertex of the heap
+   */
+  struct Candidate
+  {
+    SPFVertex *vertex;   //!< the vertex
+    uint32_t distance;   //!< distance of the vertex when it was last ordered
+    int64_t sequence;    //!< order of the vertex among the equal vertices
+  };
+
+  /**
+   * \brief return true if c1 should be popped before c2
+   *
+   * SPFVertexes are added into the queue according to the ordering
+   * defined by this method.
+   *
+   * \param c1 first operand
+   * \param c2 second operand
+   * \return True if c1 should be popped before c2; false otherwise
+   */
+  static bool Before (const Candidate &c1, const Candidate &c2);
+
+  /**
+   * \brief Store a candidate at a position of the heap
+   * \param i the position
+   * \param c the candidate
+   */
+  void Place (uint32_t i, const Candidate &c);
+
+  /**
+   * \brief Move the candidate at a position of the heap towards the top
+   * \param i the position
+   */
+  void SiftUp (uint32_t i);
+
+  /**
+   * \brief Move the candidate at a position of the heap towards the bottom
+   * \param i the position
+   */
+  void SiftDown (uint32_t i);
+
+  /**
+   * \brief Give a candidate the current distance of its vertex and restore
+   * its place in the heap
+   *
+   * A vertex whose distance decreased is placed after, and a vertex whose
+   * distance increased before, the vertices it now compares equal to.
+   *
+   * \param i the position of the candidate
+   */
+  void Update (uint32_t i);
+
+  typedef std::vector<Candidate> CandidateHeap_t; //!< binary heap of candidates
+  CandidateHeap_t m_candidates;  //!< SPFVertex candidates
+  std::map<Ipv4Address, uint32_t> m_positions;  //!< position of each vertex in the heap
+  int64_t m_lastSequence;   //!< sequence number of the last vertex placed after its equals
+  int64_t m_firstSequence;  //!< sequence number of the last vertex placed before its equals
 
   /**
    * \brief Stream insertion operator.
@@ -27,6 +27,9 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include <functional>
+#include <fstream>
+#include <cstring>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -35,6 +38,14 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <unistd.h>
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -44,6 +55,16 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * Number of threads computing the global routes
+ */
+static GlobalValue g_globalRoutingThreads ("GlobalRoutingThreads",
+                                           "The number of threads computing the routes of the global "
+                                           "routers, zero for one thread per processor.",
+                                           UintegerValue (1),
+                                           MakeUintegerChecker<uint32_t> ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -420,10 +441,13 @@ SPFVertex::ClearVertexProcessed (void)
 //
 // ---------------------------------------------------------------------------
 
+const uint32_t GlobalRouteManagerLSDB::NO_LSA;
+
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
-    m_extdatabase ()
+    m_extdatabase (),
+    m_indexed (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -471,6 +495,7 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
   else
     {
       m_database.insert (LSDBPair_t (addr, lsa));
+      m_indexed = false;
     }
 }
 
@@ -495,13 +520,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -511,24 +533,131 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of one of its transit network records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  if (!m_indexed)
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+      BuildIndex ();
+    }
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_linkDataIndexes.find (addr);
+  if (i != m_linkDataIndexes.end ())
+    {
+      return m_lsas[i->second];
+    }
+  return 0;
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_indexed)
+    {
+      BuildIndex ();
+    }
+  return m_lsas.size ();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  if (!m_indexed)
+    {
+      BuildIndex ();
+    }
+  return m_lsas.at (index);
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetLSAIndex (Ipv4Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  if (!m_indexed)
+    {
+      BuildIndex ();
+    }
+  std::vector<Ipv4Address>::const_iterator i = std::lower_bound (m_keys.begin (), m_keys.end (), addr);
+  if (i != m_keys.end () && *i == addr)
+    {
+      return i - m_keys.begin ();
+    }
+  return NO_LSA;
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNeighborIndex (uint32_t index, uint32_t n) const
+{
+  NS_LOG_FUNCTION (this << index << n);
+  if (!m_indexed)
+    {
+      BuildIndex ();
+    }
+  return m_neighbors.at (index).at (n);
+}
+
+void
+GlobalRouteManagerLSDB::BuildIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_keys.clear ();
+  m_lsas.clear ();
+  m_linkDataIndexes.clear ();
+  m_neighbors.clear ();
+//
+// Number the LSAs in the order of the database map, so that the first LSA
+// found in that order is kept for each link data.
+//
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      GlobalRoutingLSA* lsa = i->second;
+      uint32_t index = m_lsas.size ();
+      m_keys.push_back (i->first);
+      m_lsas.push_back (lsa);
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
         {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
             {
-              return temp;
+              m_linkDataIndexes.insert (std::make_pair (lr->GetLinkData (), index));
+            }
+        }
+    }
+  m_indexed = true;
+//
+// Resolve the links as SPF follows them.
+//
+  m_neighbors.resize (m_lsas.size ());
+  for (uint32_t index = 0; index < m_lsas.size (); index++)
+    {
+      GlobalRoutingLSA* lsa = m_lsas[index];
+      std::vector<uint32_t> &neighbors = m_neighbors[index];
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+              if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                  || lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  neighbors.push_back (GetLSAIndex (lr->GetLinkId ()));
+                }
+              else
+                {
+                  neighbors.push_back (NO_LSA);
+                }
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              std::map<Ipv4Address, uint32_t>::const_iterator i =
+                m_linkDataIndexes.find (lsa->GetAttachedRouter (j));
+              neighbors.push_back (i != m_linkDataIndexes.end () ? i->second : NO_LSA);
             }
         }
     }
-  return 0;
 }
 
 // ---------------------------------------------------------------------------
@@ -539,16 +668,29 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_lsdbOwner (true),
+    m_hasNodes (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl (const GlobalRouteManagerImpl *manager)
+  :
+    m_spfroot (0),
+    m_lsdb (manager->m_lsdb),
+    m_lsdbOwner (false),
+    m_routerNodes (manager->m_routerNodes),
+    m_hasNodes (manager->m_hasNodes)
+{
+  NS_LOG_FUNCTION (this << manager);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_lsdb)
+  if (m_lsdb && m_lsdbOwner)
     {
       delete m_lsdb;
     }
@@ -565,6 +707,22 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
   m_lsdb = lsdb;
 }
 
+void
+GlobalRouteManagerImpl::ClearRoutes (Ptr<Ipv4GlobalRouting> gr)
+{
+  NS_LOG_FUNCTION (this << gr);
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j);
+      gr->RemoveRoute (0);
+    }
+}
+
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
 {
@@ -579,19 +737,10 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
           continue;
         }
       Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
       NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      ClearRoutes (gr);
     }
+  m_tableGenerations.clear ();
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
@@ -696,10 +845,22 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("About to start SPF calculation");
+  FindRouterNodes ();
+  SPFCalculateAll (GetRoots ());
+  SaveTableGenerations ();
+  m_routerNodes.clear ();
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+std::vector<Ipv4Address>
+GlobalRouteManagerImpl::GetRoots (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ipv4Address> roots;
 //
 // Walk the list of nodes in the system.
 //
-  NS_LOG_INFO ("About to start SPF calculation");
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -724,10 +885,349 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (rtr->GetRouterId ());
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  return roots;
+}
+
+//
+// The routines adding the routes write them to the node of the root of the
+// SPF tree, which is found by its router ID.  The nodes are looked up once
+// for all the calculations, which also keeps the worker threads away from
+// the node list.
+//
+void
+GlobalRouteManagerImpl::FindRouterNodes (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routerNodes.clear ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr != 0)
+        {
+          // The first node having a router ID is the one the routes go to
+          m_routerNodes.insert (std::make_pair (rtr->GetRouterId (), node));
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::SaveTableGenerations (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tableGenerations.clear ();
+  for (std::map<Ipv4Address, Ptr<Node> >::const_iterator i = m_routerNodes.begin (); i != m_routerNodes.end (); i++)
+    {
+      Ptr<GlobalRouter> rtr = i->second->GetObject<GlobalRouter> ();
+      m_tableGenerations[i->second->GetId ()] = rtr->GetRoutingProtocol ()->GetRoutingTableGeneration ();
+    }
+}
+
+//
+// Each root is independent from the others: a calculation only reads the
+// LSDB and writes the routes of the node of its root.  The roots can thus be
+// split among several workers, each having its own candidate queue and SPF
+// status of the LSAs.  The routes of a node are added by a single worker, in
+// the same order as a serial calculation would add them.
+//
+// The reference counts of ns-3 objects are not atomic, so the workers must
+// not touch any refcounted object shared with another worker, such as the
+// NodeList: what they need from it is read here, before they start.  The
+// only objects they touch are those of the nodes of their own roots.
+//
+void
+GlobalRouteManagerImpl::SPFCalculateAll (std::vector<Ipv4Address> const &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  m_hasNodes = NodeList::GetNNodes () > 0;
+  UintegerValue value;
+  g_globalRoutingThreads.GetValue (value);
+  uint32_t nThreads = value.Get ();
+#ifdef HAVE_PTHREAD_H
+  if (nThreads == 0)
+    {
+      long nProcessors = sysconf (_SC_NPROCESSORS_ONLN);
+      nThreads = nProcessors > 0 ? nProcessors : 1;
+    }
+#else
+  nThreads = 1;
+#endif /* HAVE_PTHREAD_H */
+  nThreads = std::min<uint32_t> (nThreads, roots.size ());
+
+  if (nThreads <= 1)
+    {
+      for (std::vector<Ipv4Address>::const_iterator i = roots.begin (); i != roots.end (); i++)
+        {
+          SPFCalculate (*i);
+        }
+      return;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  NS_LOG_LOGIC ("Calculating the routes of " << roots.size () << " routers with " << nThreads << " threads");
+  // Build the LSDB index before it is shared
+  m_lsdb->GetNumLSAs ();
+  std::vector<GlobalRouteManagerImpl *> workers;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 0; t < nThreads; t++)
+    {
+      GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl (this);
+      for (uint32_t i = t; i < roots.size (); i += nThreads)
+        {
+          worker->m_roots.push_back (roots[i]);
+        }
+      workers.push_back (worker);
+      threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFCalculateRoots, worker)));
+    }
+  for (uint32_t t = 0; t < nThreads; t++)
+    {
+      threads[t]->Start ();
+    }
+  for (uint32_t t = 0; t < nThreads; t++)
+    {
+      threads[t]->Join ();
+      delete workers[t];
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateRoots (void)
+{
+  for (std::vector<Ipv4Address>::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
+    {
+      SPFCalculate (*i);
+    }
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutingTables ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_lsdbOwner);
+  GlobalRouteManagerLSDB *oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  FindRouterNodes ();
+
+  std::vector<Ipv4Address> roots;
+  if (m_tableGenerations.empty () || !FindChangedRoots (oldLsdb, roots))
+    {
+      NS_LOG_LOGIC ("Computing the routes of all the routers");
+      NodeList::Iterator listEnd = NodeList::End ();
+      for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+        {
+          Ptr<GlobalRouter> router = (*i)->GetObject<GlobalRouter> ();
+          if (router != 0)
+            {
+              ClearRoutes (router->GetRoutingProtocol ());
+            }
+        }
+      InitializeRoutes ();
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Computing the routes of " << roots.size () << " routers");
+      for (std::vector<Ipv4Address>::const_iterator i = roots.begin (); i != roots.end (); i++)
+        {
+          ClearRoutes (m_routerNodes[*i]->GetObject<GlobalRouter> ()->GetRoutingProtocol ());
+        }
+      SPFCalculateAll (roots);
+      SaveTableGenerations ();
+      m_routerNodes.clear ();
+    }
+  delete oldLsdb;
+}
+
+//
+// The routes of a router only depend on the shortest paths from it, which
+// are unchanged when the database only differs by the metrics of some
+// links and none of these links can be on a shortest path with either
+// its old or its new metric.  Link <u, w> can be on a shortest path from
+// r if d(r, u) + metric <= d(r, w), so the distances to the ends of the
+// changed links are computed once on the old database instead of
+// computing a SPF tree for every router.
+//
+bool
+GlobalRouteManagerImpl::FindChangedRoots (GlobalRouteManagerLSDB* oldLsdb, std::vector<Ipv4Address> &roots)
+{
+  NS_LOG_FUNCTION (this << oldLsdb);
+  // Beyond this number of changed vertices, computing all the routes again
+  // is cheaper than finding the routers which must be updated
+  const uint32_t maxChangedVertices = 32;
+
+  if (oldLsdb->GetNumExtLSAs () != m_lsdb->GetNumExtLSAs ()
+      || oldLsdb->GetNumLSAs () != m_lsdb->GetNumLSAs ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *oldLsa = oldLsdb->GetExtLSA (i);
+      GlobalRoutingLSA *lsa = m_lsdb->GetExtLSA (i);
+      if (oldLsa->GetLinkStateId () != lsa->GetLinkStateId ()
+          || oldLsa->GetAdvertisingRouter () != lsa->GetAdvertisingRouter ()
+          || oldLsa->GetNetworkLSANetworkMask () != lsa->GetNetworkLSANetworkMask ())
+        {
+          return false;
+        }
+    }
+
+  /// A link whose metric changed
+  struct ChangedLink
+  {
+    uint32_t from;      //!< number of the LSA of the link
+    uint32_t to;        //!< number of the LSA the link leads to
+    uint32_t metric;    //!< the lowest of the old and new metrics
+  };
+  std::vector<ChangedLink> changedLinks;
+  std::map<uint32_t, std::vector<uint32_t> > distances;
+  for (uint32_t i = 0; i < m_lsdb->GetNumLSAs (); i++)
+    {
+      GlobalRoutingLSA *oldLsa = oldLsdb->GetLSAByIndex (i);
+      GlobalRoutingLSA *lsa = m_lsdb->GetLSAByIndex (i);
+      if (oldLsa->GetLinkStateId () != lsa->GetLinkStateId ()
+          || oldLsa->GetLSType () != lsa->GetLSType ()
+          || oldLsa->GetAdvertisingRouter () != lsa->GetAdvertisingRouter ()
+          || oldLsa->GetNetworkLSANetworkMask () != lsa->GetNetworkLSANetworkMask ()
+          || oldLsa->GetNLinkRecords () != lsa->GetNLinkRecords ()
+          || oldLsa->GetNAttachedRouters () != lsa->GetNAttachedRouters ())
+        {
+          return false;
+        }
+      for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+        {
+          if (oldLsa->GetAttachedRouter (j) != lsa->GetAttachedRouter (j))
+            {
+              return false;
+            }
+        }
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *oldLink = oldLsa->GetLinkRecord (j);
+          GlobalRoutingLinkRecord *link = lsa->GetLinkRecord (j);
+          if (oldLink->GetLinkType () != link->GetLinkType ()
+              || oldLink->GetLinkId () != link->GetLinkId ()
+              || oldLink->GetLinkData () != link->GetLinkData ())
+            {
+              return false;
+            }
+          // The metrics of the stub networks are not used
+          if (oldLink->GetMetric () == link->GetMetric ()
+              || link->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              continue;
+            }
+          ChangedLink changed;
+          changed.from = i;
+          changed.to = oldLsdb->GetNeighborIndex (i, j);
+          changed.metric = std::min (oldLink->GetMetric (), link->GetMetric ());
+          NS_ASSERT (changed.to != GlobalRouteManagerLSDB::NO_LSA);
+          changedLinks.push_back (changed);
+          distances[changed.from];
+          distances[changed.to];
+          if (distances.size () > maxChangedVertices)
+            {
+              NS_LOG_LOGIC ("Too many changed links");
+              return false;
+            }
+        }
+    }
+  NS_LOG_LOGIC (changedLinks.size () << " links changed");
+
+  for (std::map<uint32_t, std::vector<uint32_t> >::iterator i = distances.begin (); i != distances.end (); i++)
+    {
+      i->second = DistancesTo (oldLsdb, i->first);
+    }
+  std::vector<Ipv4Address> allRoots = GetRoots ();
+  for (std::vector<Ipv4Address>::const_iterator i = allRoots.begin (); i != allRoots.end (); i++)
+    {
+      Ptr<Node> node = m_routerNodes[*i];
+      Ptr<Ipv4GlobalRouting> gr = node->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::map<uint32_t, uint64_t>::const_iterator generation = m_tableGenerations.find (node->GetId ());
+      if (generation == m_tableGenerations.end () || generation->second != gr->GetRoutingTableGeneration ())
+        {
+          // The routes were changed since they were computed
+          roots.push_back (*i);
+          continue;
+        }
+      GlobalRoutingLinkRecord *transitLink;
+      GlobalRoutingLinkRecord *peerLink;
+      if (IsStubNode (*i, transitLink, peerLink))
+        {
+          // The default route of a stub does not depend on the metrics
+          continue;
+        }
+      uint32_t root = m_lsdb->GetLSAIndex (*i);
+      for (std::vector<ChangedLink>::const_iterator l = changedLinks.begin (); l != changedLinks.end (); l++)
+        {
+          uint64_t from = distances[l->from][root];
+          uint64_t to = distances[l->to][root];
+          if (from != SPF_INFINITY && from + l->metric <= to)
+            {
+              roots.push_back (*i);
+              break;
+            }
+        }
+    }
+  return true;
+}
+
+std::vector<uint32_t>
+GlobalRouteManagerImpl::DistancesTo (GlobalRouteManagerLSDB* lsdb, uint32_t index)
+{
+  NS_LOG_FUNCTION (lsdb << index);
+  uint32_t nLSAs = lsdb->GetNumLSAs ();
+  // Reverse the links of the SPF graph: a router link costs its metric,
+  // and going from a network to the routers attached to it is free.
+  std::vector<std::vector<std::pair<uint32_t, uint32_t> > > incoming (nLSAs);
+  for (uint32_t i = 0; i < nLSAs; i++)
+    {
+      GlobalRoutingLSA *lsa = lsdb->GetLSAByIndex (i);
+      bool router = lsa->GetLSType () == GlobalRoutingLSA::RouterLSA;
+      uint32_t nLinks = router ? lsa->GetNLinkRecords () : lsa->GetNAttachedRouters ();
+      for (uint32_t j = 0; j < nLinks; j++)
+        {
+          uint32_t neighbor = lsdb->GetNeighborIndex (i, j);
+          if (neighbor != GlobalRouteManagerLSDB::NO_LSA)
+            {
+              uint32_t metric = router ? lsa->GetLinkRecord (j)->GetMetric () : 0;
+              incoming[neighbor].push_back (std::make_pair (i, metric));
+            }
+        }
+    }
+
+  std::vector<uint32_t> distances (nLSAs, SPF_INFINITY);
+  std::priority_queue<std::pair<uint32_t, uint32_t>,
+                      std::vector<std::pair<uint32_t, uint32_t> >,
+                      std::greater<std::pair<uint32_t, uint32_t> > > queue;
+  distances[index] = 0;
+  queue.push (std::make_pair (0, index));
+  while (!queue.empty ())
+    {
+      uint32_t distance = queue.top ().first;
+      uint32_t v = queue.top ().second;
+      queue.pop ();
+      if (distance != distances[v])
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < incoming[v].size (); j++)
+        {
+          uint32_t u = incoming[v][j].first;
+          uint32_t d = distance + incoming[v][j].second;
+          if (d < distances[u])
+            {
+              distances[u] = d;
+              queue.push (std::make_pair (d, u));
+            }
+        }
+    }
+  return distances;
 }
 
 //
@@ -753,6 +1253,8 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
   GlobalRoutingLinkRecord *l = 0;
   uint32_t distance = 0;
   uint32_t numRecordsInVertex = 0;
+  uint32_t vIndex = m_lsdb->GetLSAIndex (v->GetVertexId ());
+  uint32_t wIndex = GlobalRouteManagerLSDB::NO_LSA;
 //
 // V points to a Router-LSA or Network-LSA
 // Loop over the links in router LSA or attached routers in Network LSA
@@ -769,6 +1271,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
   for (uint32_t i = 0; i < numRecordsInVertex; i++)
     {
 // Get w_lsa:  In case of V is Router-LSA
+      wIndex = m_lsdb->GetNeighborIndex (vIndex, i);
       if (v->GetVertexType () == SPFVertex::VertexRouter) 
         {
           NS_LOG_LOGIC ("Examining link " << i << " of " << 
@@ -797,16 +1300,16 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // Lookup the link state advertisement of the new link -- we call it <w> in
 // the link state database.
 //
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
+              NS_ASSERT (wIndex != GlobalRouteManagerLSDB::NO_LSA);
+              w_lsa = m_lsdb->GetLSAByIndex (wIndex);
               NS_LOG_LOGIC ("Found a P2P record from " << 
                             v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
             }
           else if (l->GetLinkType () == 
                    GlobalRoutingLinkRecord::TransitNetwork)
             {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
+              NS_ASSERT (wIndex != GlobalRouteManagerLSDB::NO_LSA);
+              w_lsa = m_lsdb->GetLSAByIndex (wIndex);
               NS_LOG_LOGIC ("Found a Transit record from " << 
                             v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
             }
@@ -818,12 +1321,11 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // Get w_lsa:  In case of V is Network-LSA
       if (v->GetVertexType () == SPFVertex::VertexNetwork) 
         {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
+          if (wIndex == GlobalRouteManagerLSDB::NO_LSA)
             {
               continue;
             }
+          w_lsa = m_lsdb->GetLSAByIndex (wIndex);
           NS_LOG_LOGIC ("Found a Network LSA from " << 
                         v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
         }
@@ -836,7 +1338,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (m_lsaStatus[wIndex] == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1363,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (m_lsaStatus[wIndex] == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -873,7 +1375,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
           w = new SPFVertex (w_lsa);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              m_lsaStatus[wIndex] = GlobalRoutingLSA::LSA_SPF_CANDIDATE;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1390,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (m_lsaStatus[wIndex] == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -960,7 +1462,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Reorder (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1247,7 +1749,10 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  FindRouterNodes ();
+  m_hasNodes = NodeList::GetNNodes () > 0;
   SPFCalculate (root);
+  m_routerNodes.clear ();
 }
 
 //
@@ -1258,12 +1763,49 @@ GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 //
 bool
 GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
+{
+  NS_LOG_FUNCTION (this << root);
+  GlobalRoutingLinkRecord *transitLink = 0;
+  GlobalRoutingLinkRecord *peerLink = 0;
+  if (!IsStubNode (root, transitLink, peerLink))
+    {
+      return false;
+    }
+  if (transitLink == 0)
+    {
+      // This router is not connected to any router.  Probably, global
+      // routing should not be called for this node, but we can just raise
+      // a warning here and return true.
+      NS_LOG_WARN ("all nodes should have at least one transit link:" << root );
+      return true;
+    }
+  // Install default route to next hop
+  // The link record LinkID is the router ID of the peer.
+  // The Link Data is the local IP interface address
+  // Next hop is stored in the LinkID field of peerLink
+  NS_ASSERT (m_spfrootNode);
+  Ptr<GlobalRouter> router = m_spfrootNode->GetObject<GlobalRouter> ();
+  NS_ASSERT (router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), peerLink->GetLinkData (), 
+                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+  NS_LOG_LOGIC ("Inserting default route for node " << root << " to next hop " << 
+                peerLink->GetLinkData () << " via interface " << 
+                FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+  return true;
+}
+
+bool
+GlobalRouteManagerImpl::IsStubNode (Ipv4Address root, GlobalRoutingLinkRecord *&transitLink,
+                                    GlobalRoutingLinkRecord *&peerLink) const
 {
   NS_LOG_FUNCTION (this << root);
   GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (root);
   Ipv4Address myRouterId = rlsa->GetLinkStateId ();
   int transits = 0;
-  GlobalRoutingLinkRecord *transitLink = 0;
+  transitLink = 0;
+  peerLink = 0;
   for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
     {
       GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (i);
@@ -1280,10 +1822,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
     }
   if (transits == 0)
     {
-      // This router is not connected to any router.  Probably, global
-      // routing should not be called for this node, but we can just raise
-      // a warning here and return true.
-      NS_LOG_WARN ("all nodes should have at least one transit link:" << root );
+      transitLink = 0;
       return true;
     }
   if (transits == 1)
@@ -1301,9 +1840,6 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
         }
       else if (transitLink->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
         {
-          // Install default route to next hop
-          // The link record LinkID is the router ID of the peer.
-          // The Link Data is the local IP interface address
           GlobalRoutingLSA *w_lsa = m_lsdb->GetLSA (transitLink->GetLinkId ());
           uint32_t nLinkRecords = w_lsa->GetNLinkRecords ();
           for (uint32_t j = 0; j < nLinkRecords; ++j)
@@ -1319,16 +1855,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               // Find the link record that corresponds to our routerId
               if (lr->GetLinkId () == myRouterId)
                 {
-                  // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
-                  NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
-                                lr->GetLinkData () << " via interface " << 
-                                FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  peerLink = lr;
                   return true;
                 }
             }
@@ -1345,9 +1872,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the SPF status of the LSAs and find the node we are going to
+// write the routes to.
 //
-  m_lsdb->Initialize ();
+  m_lsaStatus.assign (m_lsdb->GetNumLSAs (), GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+  std::map<Ipv4Address, Ptr<Node> >::const_iterator rootNode = m_routerNodes.find (root);
+  m_spfrootNode = rootNode != m_routerNodes.end () ? rootNode->second : 0;
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1367,7 +1897,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  m_lsaStatus[m_lsdb->GetLSAIndex (root)] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,10 +1907,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_hasNodes && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootNode = 0;
       return;
     }
 
@@ -1428,7 +1960,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      m_lsaStatus[m_lsdb->GetLSAIndex (v->GetVertexId ())] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1502,6 +2034,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootNode = 0;
 }
 
 void
@@ -1560,58 +2093,36 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root of the SPF tree was found before the calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +2137,36 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1729,60 +2237,36 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root of the SPF tree was found before the calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1797,39 +2281,36 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // which the packets should be send for forwarding.
 //
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1853,61 +2334,39 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 //
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// The node of the root of the SPF tree was found before the calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return -1;
+    }
 //
 // This is the node we're building the routing table for.  We're going to need
 // the Ipv4 interface to look for the ipv4 interface index.  Since this node
 // is participating in routing IP version 4 packets, it certainly must have 
 // an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1944,60 +2403,36 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root of the SPF tree was found before the calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2441,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << node->GetId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,45 +2466,42 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
+    }
 //
 // Done adding the routes for the selected node.
 //
-          return;
-        }
-    }
 }
 void
 GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
@@ -2089,95 +2521,69 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root of the SPF tree was found before the calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -2203,6 +2609,302 @@ GlobalRouteManagerImpl::SPFVertexAddParent (SPFVertex* v)
     }
 }
 
+//
+// A routing tables file holds a RoutingTablesHeader followed, for each
+// global router, by a NodeRoutesHeader and its host, network and external
+// routes.  The records are written in the layout of the host, as the files
+// are only meant to skip the route computation of repeated runs.
+//
+namespace {
+
+const char ROUTING_TABLES_MAGIC[8] = { 'n', 's', '3', 'g', 'r', 't', 'b', 'l' }; //!< Magic string of a routing tables file
+const uint32_t ROUTING_TABLES_VERSION = 1; //!< Version of the routing tables file format
+
+/**
+ * \brief Routing tables file header
+ */
+struct RoutingTablesHeader
+{
+  char     m_magic[8];      //!< ROUTING_TABLES_MAGIC
+  uint32_t m_version;       //!< ROUTING_TABLES_VERSION
+  uint32_t m_nNodes;        //!< number of NodeRoutesHeader in the file
+  uint64_t m_topologyHash;  //!< GlobalRouteManagerImpl::GetTopologyHash
+};
+
+/**
+ * \brief Header of the routes of a node
+ */
+struct NodeRoutesHeader
+{
+  uint32_t m_nodeId;        //!< node ID
+  uint32_t m_nRoutes[3];    //!< number of host, network and external routes
+};
+
+/**
+ * \brief A route
+ */
+struct RouteRecord
+{
+  uint32_t m_dest;          //!< destination address or network
+  uint32_t m_mask;          //!< destination network mask
+  uint32_t m_gateway;       //!< next hop, or 0.0.0.0
+  uint32_t m_interface;     //!< output interface
+};
+
+/**
+ * \brief Add the fields of an LSA which the routes depend on to a hash input.
+ * \param words the hash input
+ * \param lsa the LSA
+ */
+void
+HashLSA (std::vector<uint32_t> &words, GlobalRoutingLSA *lsa)
+{
+  words.push_back (lsa->GetLSType ());
+  words.push_back (lsa->GetLinkStateId ().Get ());
+  words.push_back (lsa->GetAdvertisingRouter ().Get ());
+  words.push_back (lsa->GetNetworkLSANetworkMask ().Get ());
+  words.push_back (lsa->GetNAttachedRouters ());
+  for (uint32_t i = 0; i < lsa->GetNAttachedRouters (); i++)
+    {
+      words.push_back (lsa->GetAttachedRouter (i).Get ());
+    }
+  words.push_back (lsa->GetNLinkRecords ());
+  for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *link = lsa->GetLinkRecord (i);
+      words.push_back (link->GetLinkType ());
+      words.push_back (link->GetLinkId ().Get ());
+      words.push_back (link->GetLinkData ().Get ());
+      words.push_back (link->GetMetric ());
+    }
+}
+
+} // unnamed namespace
+
+uint64_t
+GlobalRouteManagerImpl::GetTopologyHash (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<uint32_t> words;
+  words.push_back (m_lsdb->GetNumLSAs ());
+  for (uint32_t i = 0; i < m_lsdb->GetNumLSAs (); i++)
+    {
+      HashLSA (words, m_lsdb->GetLSAByIndex (i));
+    }
+  words.push_back (m_lsdb->GetNumExtLSAs ());
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      HashLSA (words, m_lsdb->GetExtLSA (i));
+    }
+//
+// The routes also depend on the interface numbers of the routers, which the
+// LSAs do not tell.
+//
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr == 0)
+        {
+          continue;
+        }
+      words.push_back (node->GetId ());
+      words.push_back (node->GetSystemId ());
+      words.push_back (rtr->GetRouterId ().Get ());
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      words.push_back (ipv4->GetNInterfaces ());
+      for (uint32_t j = 0; j < ipv4->GetNInterfaces (); j++)
+        {
+          words.push_back (ipv4->IsUp (j));
+          words.push_back (ipv4->GetNAddresses (j));
+          for (uint32_t k = 0; k < ipv4->GetNAddresses (j); k++)
+            {
+              words.push_back (ipv4->GetAddress (j, k).GetLocal ().Get ());
+              words.push_back (ipv4->GetAddress (j, k).GetMask ().Get ());
+            }
+        }
+    }
+  return Hash64 ((const char *)&words[0], words.size () * sizeof (uint32_t));
+}
+
+bool
+GlobalRouteManagerImpl::SaveRoutingTables (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream file (filename.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_LOG_WARN ("Unable to open " << filename);
+      return false;
+    }
+
+  std::vector<Ptr<Node> > nodes;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      if ((*i)->GetObject<GlobalRouter> () != 0)
+        {
+          nodes.push_back (*i);
+        }
+    }
+
+  RoutingTablesHeader header;
+  std::memcpy (header.m_magic, ROUTING_TABLES_MAGIC, sizeof (ROUTING_TABLES_MAGIC));
+  header.m_version = ROUTING_TABLES_VERSION;
+  header.m_nNodes = nodes.size ();
+  header.m_topologyHash = GetTopologyHash ();
+  file.write ((const char *)&header, sizeof (header));
+
+  std::vector<Ipv4RoutingTableEntry> routes[3];
+  std::vector<RouteRecord> records;
+  for (uint32_t i = 0; i < nodes.size (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = nodes[i]->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      gr->GetRoutes (routes[0], routes[1], routes[2]);
+      NodeRoutesHeader nodeHeader;
+      nodeHeader.m_nodeId = nodes[i]->GetId ();
+      records.clear ();
+      for (uint32_t kind = 0; kind < 3; kind++)
+        {
+          nodeHeader.m_nRoutes[kind] = routes[kind].size ();
+          for (uint32_t j = 0; j < routes[kind].size (); j++)
+            {
+              RouteRecord record;
+              record.m_dest = routes[kind][j].GetDest ().Get ();
+              record.m_mask = routes[kind][j].GetDestNetworkMask ().Get ();
+              record.m_gateway = routes[kind][j].GetGateway ().Get ();
+              record.m_interface = routes[kind][j].GetInterface ();
+              records.push_back (record);
+            }
+        }
+      file.write ((const char *)&nodeHeader, sizeof (nodeHeader));
+      if (!records.empty ())
+        {
+          file.write ((const char *)&records[0], records.size () * sizeof (RouteRecord));
+        }
+    }
+  file.close ();
+  if (file.fail ())
+    {
+      NS_LOG_WARN ("Unable to write " << filename);
+      return false;
+    }
+  NS_LOG_INFO ("Saved the routes of " << nodes.size () << " routers to " << filename);
+  return true;
+}
+
+bool
+GlobalRouteManagerImpl::LoadRoutingTables (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_LOG_LOGIC ("Unable to open " << filename);
+      return false;
+    }
+  file.seekg (0, std::ios::end);
+  std::streamoff size = file.tellg ();
+  file.seekg (0, std::ios::beg);
+  if (size < (std::streamoff) sizeof (RoutingTablesHeader))
+    {
+      NS_LOG_WARN (filename << " is not a routing tables file");
+      return false;
+    }
+  std::vector<char> data (size);
+  file.read (&data[0], size);
+  if (file.fail ())
+    {
+      NS_LOG_WARN ("Unable to read " << filename);
+      return false;
+    }
+
+  RoutingTablesHeader header;
+  std::memcpy (&header, &data[0], sizeof (header));
+  if (std::memcmp (header.m_magic, ROUTING_TABLES_MAGIC, sizeof (ROUTING_TABLES_MAGIC)) != 0
+      || header.m_version != ROUTING_TABLES_VERSION)
+    {
+      NS_LOG_WARN (filename << " is not a routing tables file");
+      return false;
+    }
+  if (header.m_topologyHash != GetTopologyHash ())
+    {
+      NS_LOG_INFO (filename << " holds the routes of another topology");
+      return false;
+    }
+
+//
+// Check the whole file before changing any route.
+//
+  std::vector<std::pair<Ptr<Ipv4GlobalRouting>, std::size_t> > tables;
+  std::size_t offset = sizeof (header);
+  for (uint32_t i = 0; i < header.m_nNodes; i++)
+    {
+      NodeRoutesHeader nodeHeader;
+      if (offset + sizeof (nodeHeader) > data.size ())
+        {
+          NS_LOG_WARN (filename << " is truncated");
+          return false;
+        }
+      std::memcpy (&nodeHeader, &data[offset], sizeof (nodeHeader));
+      if (nodeHeader.m_nodeId >= NodeList::GetNNodes ()
+          || NodeList::GetNode (nodeHeader.m_nodeId)->GetObject<GlobalRouter> () == 0)
+        {
+          NS_LOG_WARN (filename << " holds the routes of an unknown node");
+          return false;
+        }
+      tables.push_back (std::make_pair (NodeList::GetNode (nodeHeader.m_nodeId)->GetObject<GlobalRouter> ()->GetRoutingProtocol (),
+                                        offset));
+      offset += sizeof (nodeHeader);
+      offset += (uint64_t)(nodeHeader.m_nRoutes[0]) * sizeof (RouteRecord);
+      offset += (uint64_t)(nodeHeader.m_nRoutes[1]) * sizeof (RouteRecord);
+      offset += (uint64_t)(nodeHeader.m_nRoutes[2]) * sizeof (RouteRecord);
+      if (offset > data.size ())
+        {
+          NS_LOG_WARN (filename << " is truncated");
+          return false;
+        }
+    }
+
+  for (uint32_t i = 0; i < tables.size (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = tables[i].first;
+      NodeRoutesHeader nodeHeader;
+      std::memcpy (&nodeHeader, &data[tables[i].second], sizeof (nodeHeader));
+      const char *p = &data[tables[i].second + sizeof (nodeHeader)];
+      ClearRoutes (gr);
+      for (uint32_t kind = 0; kind < 3; kind++)
+        {
+          for (uint32_t j = 0; j < nodeHeader.m_nRoutes[kind]; j++, p += sizeof (RouteRecord))
+            {
+              RouteRecord record;
+              std::memcpy (&record, p, sizeof (record));
+              if (kind == 0)
+                {
+                  gr->AddHostRouteTo (Ipv4Address (record.m_dest), Ipv4Address (record.m_gateway),
+                                      record.m_interface);
+                }
+              else if (kind == 1)
+                {
+                  gr->AddNetworkRouteTo (Ipv4Address (record.m_dest), Ipv4Mask (record.m_mask),
+                                         Ipv4Address (record.m_gateway), record.m_interface);
+                }
+              else
+                {
+                  gr->AddASExternalRouteTo (Ipv4Address (record.m_dest), Ipv4Mask (record.m_mask),
+                                            Ipv4Address (record.m_gateway), record.m_interface);
+                }
+            }
+        }
+    }
+  FindRouterNodes ();
+  SaveTableGenerations ();
+  m_routerNodes.clear ();
+  NS_LOG_INFO ("Loaded the routes of " << tables.size () << " routers from " << filename);
+  return true;
+}
+
 } // namespace ns3
 
 
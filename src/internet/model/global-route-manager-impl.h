@@ -27,6 +27,7 @@
 #include <queue>
 #include <map>
 #include <vector>
+#include <string>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
@@ -576,10 +577,18 @@ private:
  *
  * This class implements a searchable database of LSAs gathered from every
  * router in the simulation.
+ *
+ * The router and network LSAs are also numbered, in the order of their link
+ * state IDs, and the LSAs each of their links leads to are resolved once, so
+ * that the SPF computations can follow the links and keep their state in
+ * arrays indexed by LSA number.  This index is built on first use after
+ * the last Insert.
  */
 class GlobalRouteManagerLSDB
 {
 public:
+  static const uint32_t NO_LSA = 0xffffffff; //!< LSA number meaning "no LSA"
+
 /**
  * @brief Construct an empty Global Router Manager Link State Database.
  *
@@ -674,14 +683,66 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Get the number of router and network Link State Advertisements.
+ *
+ * @returns the number of router and network Link State Advertisements.
+ */
+  uint32_t GetNumLSAs () const;
+
+/**
+ * @brief Look up the router or network Link State Advertisement with the
+ * given number.
+ *
+ * @param index the number of the LSA, less than GetNumLSAs ().
+ * @returns A pointer to the Link State Advertisement.
+ */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+
+/**
+ * @brief Get the number of the Link State Advertisement associated with the
+ * given link state ID (address).
+ *
+ * @see GetLSA
+ * @param addr The IP address associated with the LSA.
+ * @returns The number of the LSA, or NO_LSA if there is none.
+ */
+  uint32_t GetLSAIndex (Ipv4Address addr) const;
+
+/**
+ * @brief Get the number of the Link State Advertisement a link of another
+ * one leads to.
+ *
+ * For a router LSA, the link is the link record n, and the LSA returned is
+ * the one GetLSA () finds for the link ID of a point-to-point or transit
+ * network record.  For a network LSA, the link is the attached router n,
+ * and the LSA returned is the one GetLSAByLinkData () finds for it.
+ *
+ * @param index the number of the LSA
+ * @param n the number of the link record or attached router
+ * @returns The number of the LSA the link leads to, or NO_LSA if there is
+ * none (e.g., for a stub network record).
+ */
+  uint32_t GetNeighborIndex (uint32_t index, uint32_t n) const;
 
 private:
+/**
+ * @brief Number the router and network LSAs and resolve their links.
+ */
+  void BuildIndex (void) const;
+
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
+  mutable bool m_indexed; //!< whether the index below is up to date
+  mutable std::vector<Ipv4Address> m_keys; //!< addresses of the router and network LSAs, by number
+  mutable std::vector<GlobalRoutingLSA*> m_lsas; //!< router and network LSAs, by number
+  mutable std::map<Ipv4Address, uint32_t> m_linkDataIndexes; //!< number of the first LSA with a transit network record of each link data
+  mutable std::vector<std::vector<uint32_t> > m_neighbors; //!< numbers of the LSAs the links of each LSA lead to
+
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
  * need for it and a compiler provided shallow copy would be wrong.
@@ -732,9 +793,62 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The routers are split among the number of threads given by the
+ * "GlobalRoutingThreads" global value.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the forwarding tables
+ * which depend on its changes.
+ *
+ * This has the same result as DeleteGlobalRoutes (), 
+ * BuildGlobalRoutingDatabase () and InitializeRoutes (), but when the
+ * only changes of the database since the last computation are changes of
+ * link metrics, the routes are only computed again for the routers whose
+ * shortest paths may use these links.  The other forwarding tables are
+ * kept as they are, unless they were modified since they were computed.
+ */
+  virtual void RecomputeRoutingTables ();
+
+/**
+ * @brief Compute a hash of the routing database and of the interfaces of
+ * the global routers.
+ *
+ * The routes computed by InitializeRoutes () only depend on them, so
+ * topologies having the same hash get the same routes.  The routing
+ * database must have been built by BuildGlobalRoutingDatabase ().
+ *
+ * @returns the topology hash
+ */
+  uint64_t GetTopologyHash (void);
+
+/**
+ * @brief Save the routes of all the global routers to a file.
+ *
+ * The file is tagged with GetTopologyHash () and is meant to be read back
+ * by LoadRoutingTables () on the same host.
+ *
+ * @param filename the name of the file
+ * @returns true if the file was written
+ */
+  bool SaveRoutingTables (std::string filename);
+
+/**
+ * @brief Replace the routes of all the global routers by routes saved by
+ * SaveRoutingTables ().
+ *
+ * This replaces InitializeRoutes () after BuildGlobalRoutingDatabase ().
+ * The file is only used if it was saved for the same topology, as told by
+ * GetTopologyHash ().
+ *
+ * @param filename the name of the file
+ * @returns false, leaving the routes unchanged, if the file cannot be read
+ * or holds the routes of another topology
+ */
+  bool LoadRoutingTables (std::string filename);
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +880,100 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+/**
+ * @brief Create a worker computing the routes of some routers on the
+ * Link State DataBase of another Global Route Manager.
+ *
+ * @param manager the Global Route Manager owning the Link State DataBase
+ */
+  GlobalRouteManagerImpl (const GlobalRouteManagerImpl *manager);
+
+  /// Container of SPF status, indexed by LSA number
+  typedef std::vector<GlobalRoutingLSA::SPFStatus> SPFStatusList_t;
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_lsdbOwner; //!< whether m_lsdb is deleted with this object
+  Ptr<Node> m_spfrootNode; //!< the node of the root router, if any
+  SPFStatusList_t m_lsaStatus; //!< the SPF status of each LSA, by LSA number
+  std::map<Ipv4Address, Ptr<Node> > m_routerNodes; //!< the node of each router ID
+  std::vector<Ipv4Address> m_roots; //!< the routers whose routes a worker computes
+  bool m_hasNodes; //!< whether NodeList had nodes when the SPF calculations started
+  std::map<uint32_t, uint64_t> m_tableGenerations; //!< the routing table generation of each node after the last computation
+
+  /**
+   * \brief Find the node of every router.
+   */
+  void FindRouterNodes (void);
+
+  /**
+   * \brief Get the routers whose routes are computed by InitializeRoutes.
+   * \returns the router IDs
+   */
+  std::vector<Ipv4Address> GetRoots (void) const;
+
+  /**
+   * \brief Delete the routes of a global router.
+   * \param gr the global routing protocol of the router
+   */
+  void ClearRoutes (Ptr<Ipv4GlobalRouting> gr);
+
+  /**
+   * \brief Calculate the SPF trees of several routers, possibly in
+   * parallel
+   * \param roots the router IDs
+   */
+  void SPFCalculateAll (std::vector<Ipv4Address> const &roots);
+
+  /**
+   * \brief Calculate the SPF trees of the routers of a worker.
+   *
+   * This is the entry point of the worker threads.
+   */
+  void SPFCalculateRoots (void);
+
+  /**
+   * \brief Remember the routing table generation of every global router.
+   */
+  void SaveTableGenerations (void);
+
+  /**
+   * \brief Find the routers whose routes may change between two routing
+   * databases.
+   *
+   * \param oldLsdb the routing database the routes were computed from
+   * \param roots filled with the router IDs of the routers whose routes may
+   * change
+   * \returns false if the changes of the routing database are not
+   * supported, in which case the routes of all the routers must be
+   * computed again
+   */
+  bool FindChangedRoots (GlobalRouteManagerLSDB* oldLsdb, std::vector<Ipv4Address> &roots);
+
+  /**
+   * \brief Compute the distance to a vertex from every vertex of a routing
+   * database
+   *
+   * \param lsdb the routing database
+   * \param index the number of the LSA of the vertex
+   * \returns the distance from each vertex, by LSA number, SPF_INFINITY if
+   * the vertex cannot be reached
+   */
+  static std::vector<uint32_t> DistancesTo (GlobalRouteManagerLSDB* lsdb, uint32_t index);
+
+  /**
+   * \brief Test if a router is a stub, from an OSPF sense, without
+   * changing its routes
+   *
+   * \param root the router ID
+   * \param transitLink set to the link to the only neighbor of the stub, if
+   * any
+   * \param peerLink set to the link from this neighbor back to the stub, if
+   * any
+   * \returns true if the router is a stub
+   */
+  bool IsStubNode (Ipv4Address root, GlobalRoutingLinkRecord* &transitLink,
+                   GlobalRoutingLinkRecord* &peerLink) const;
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -58,6 +58,30 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::RecomputeRoutingTables (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  RecomputeRoutingTables ();
+}
+
+bool
+GlobalRouteManager::SaveRoutingTables (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  return SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+         SaveRoutingTables (filename);
+}
+
+bool
+GlobalRouteManager::LoadRoutingTables (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  return SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+         LoadRoutingTables (filename);
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
@@ -22,6 +22,8 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include <string>
+
 namespace ns3 {
 
 /**
@@ -65,6 +67,37 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and compute the routes again.
+ *
+ * This is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes (), but only the routes which may change are
+ * computed again when the link metrics are the only changes of the
+ * routing database.
+ */
+  static void RecomputeRoutingTables ();
+
+/**
+ * @brief Save the routes of all the global routers to a file, tagged with
+ * a hash of the routing database.
+ *
+ * @param filename the name of the file
+ * @returns true if the file was written
+ */
+  static bool SaveRoutingTables (std::string filename);
+
+/**
+ * @brief Install the routes saved by SaveRoutingTables () instead of
+ * calling InitializeRoutes ().
+ *
+ * BuildGlobalRoutingDatabase () must be called first: the routes are only
+ * loaded if they were saved for the same routing database and interfaces.
+ *
+ * @param filename the name of the file
+ * @returns true if the routes were loaded
+ */
+  static bool LoadRoutingTables (std::string filename);
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -37,6 +38,21 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4GlobalRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4GlobalRouting);
 
+namespace {
+
+/**
+ * \param a a route
+ * \param b another route
+ * \returns true if a was added to the routing table before b
+ */
+bool
+EntryOrderLess (Ipv4RouteTrie::Entry const &a, Ipv4RouteTrie::Entry const &b)
+{
+  return a.order < b.order;
+}
+
+} // unnamed namespace
+
 TypeId 
 Ipv4GlobalRouting::GetTypeId (void)
 { 
@@ -80,6 +96,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_hostRouteTrie.Insert (route);
+  NotifyRoutingTableChanged ();
 }
 
 void 
@@ -90,6 +108,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_hostRouteTrie.Insert (route);
+  NotifyRoutingTableChanged ();
 }
 
 void 
@@ -105,6 +125,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkRouteTrie.Insert (route);
+  NotifyRoutingTableChanged ();
 }
 
 void 
@@ -118,6 +140,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkRouteTrie.Insert (route);
+  NotifyRoutingTableChanged ();
 }
 
 void 
@@ -133,6 +157,8 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_ASexternalRouteTrie.Insert (route);
+  NotifyRoutingTableChanged ();
 }
 
 
@@ -146,73 +172,109 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
+  Ipv4RouteTrie::Entries const *matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t nMatches;
+
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  nMatches = m_hostRouteTrie.Lookup (dest, matches);
+  for (uint32_t m = 0; m < nMatches; m++)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      for (Ipv4RouteTrie::Entries::const_iterator i = matches[m]->begin ();
+           i != matches[m]->end ();
+           i++)
         {
-          if (oif != 0)
+          NS_ASSERT (i->route->IsHost ());
+          if (i->route->GetDest ().IsEqual (dest))
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != 0)
                 {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
+                  if (oif != m_ipv4->GetNetDevice (i->route->GetInterface ()))
+                    {
+                      NS_LOG_LOGIC ("Not on requested interface, skipping");
+                      continue;
+                    }
                 }
+              allRoutes.push_back (i->route);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << i->route);
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
+      // All the matching network routes are candidates, whatever their
+      // prefix length, in the order of the routing table.
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      std::vector<Ipv4RouteTrie::Entry> found;
+      nMatches = m_networkRouteTrie.Lookup (dest, matches);
+      for (uint32_t m = 0; m < nMatches; m++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          for (Ipv4RouteTrie::Entries::const_iterator j = matches[m]->begin ();
+               j != matches[m]->end ();
+               j++)
             {
-              if (oif != 0)
+              Ipv4Mask mask = j->route->GetDestNetworkMask ();
+              Ipv4Address entry = j->route->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != 0)
                     {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
+                      if (oif != m_ipv4->GetNetDevice (j->route->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
                     }
+                  found.push_back (*j);
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
         }
+      if (nMatches > 1)
+        {
+          std::sort (found.begin (), found.end (), EntryOrderLess);
+        }
+      for (std::vector<Ipv4RouteTrie::Entry>::const_iterator j = found.begin (); j != found.end (); j++)
+        {
+          allRoutes.push_back (j->route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << j->route);
+        }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      // Only the first matching external route in the table is used
+      Ipv4RouteTrie::Entry const *first = 0;
+      nMatches = m_ASexternalRouteTrie.Lookup (dest, matches);
+      for (uint32_t m = 0; m < nMatches; m++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          for (Ipv4RouteTrie::Entries::const_iterator k = matches[m]->begin ();
+               k != matches[m]->end ();
+               k++)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (first != 0 && first->order < k->order)
+                {
+                  break;
+                }
+              Ipv4Mask mask = k->route->GetDestNetworkMask ();
+              Ipv4Address entry = k->route->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  NS_LOG_LOGIC ("Found external route" << k->route);
+                  if (oif != 0)
                     {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
+                      if (oif != m_ipv4->GetNetDevice (k->route->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
                     }
+                  first = &*k;
+                  break;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
         }
+      if (first != 0)
+        {
+          allRoutes.push_back (first->route);
+        }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
@@ -256,6 +318,29 @@ Ipv4GlobalRouting::GetNRoutes (void) const
   return n;
 }
 
+void
+Ipv4GlobalRouting::GetRoutes (std::vector<Ipv4RoutingTableEntry> &hostRoutes,
+                              std::vector<Ipv4RoutingTableEntry> &networkRoutes,
+                              std::vector<Ipv4RoutingTableEntry> &externalRoutes) const
+{
+  NS_LOG_FUNCTION (this);
+  hostRoutes.clear ();
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      hostRoutes.push_back (**i);
+    }
+  networkRoutes.clear ();
+  for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      networkRoutes.push_back (**j);
+    }
+  externalRoutes.clear ();
+  for (ASExternalRoutesCI k = m_ASexternalRoutes.begin (); k != m_ASexternalRoutes.end (); k++)
+    {
+      externalRoutes.push_back (**k);
+    }
+}
+
 Ipv4RoutingTableEntry *
 Ipv4GlobalRouting::GetRoute (uint32_t index) const
 {
@@ -319,6 +404,8 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              m_hostRouteTrie.Remove (*i);
+              NotifyRoutingTableChanged ();
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +423,8 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          m_networkRouteTrie.Remove (*j);
+          NotifyRoutingTableChanged ();
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +441,8 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          m_ASexternalRouteTrie.Remove (*k);
+          NotifyRoutingTableChanged ();
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +483,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteTrie.Clear ();
+  m_networkRouteTrie.Clear ();
+  m_ASexternalRouteTrie.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -537,9 +631,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -549,9 +641,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -561,9 +651,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -573,9 +661,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -218,6 +220,21 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Copy all the routes of the global unicast routing table.
+   *
+   * Unlike GetRoute, this tells the host, network and external routes apart
+   * and copies the whole table in linear time.
+   *
+   * \param hostRoutes filled with the routes added by AddHostRouteTo
+   * \param networkRoutes filled with the routes added by AddNetworkRouteTo
+   * \param externalRoutes filled with the routes added by
+   * AddASExternalRouteTo
+   */
+  void GetRoutes (std::vector<Ipv4RoutingTableEntry> &hostRoutes,
+                  std::vector<Ipv4RoutingTableEntry> &networkRoutes,
+                  std::vector<Ipv4RoutingTableEntry> &externalRoutes) const;
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -271,6 +288,9 @@ private:
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  Ipv4RouteTrie m_hostRouteTrie;       //!< Longest prefix match index of m_hostRoutes
+  Ipv4RouteTrie m_networkRouteTrie;    //!< Longest prefix match index of m_networkRoutes
+  Ipv4RouteTrie m_ASexternalRouteTrie; //!< Longest prefix match index of m_ASexternalRoutes
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
@@ -18,6 +18,9 @@
 // Author: George F. Riley<riley@ece.gatech.edu>
 //
 
+#include <algorithm>
+#include <iterator>
+
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "ns3/callback.h"
@@ -33,6 +36,7 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/tso-tag.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -41,6 +45,7 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-l4-protocol.h"
 
 namespace ns3 {
 
@@ -69,6 +74,17 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("RouteCacheSize",
+                   "Number of entries of the cache of the routes used to "
+                   "forward packets, indexed by destination and input interface; "
+                   "zero disables the cache.  The cache may only be enabled with "
+                   "routing protocols which choose the route of a forwarded packet "
+                   "from its destination and input interface alone and report their "
+                   "route changes, such as static, global, RIP and OLSR routing.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::SetRouteCacheSize,
+                                         &Ipv4L3Protocol::GetRouteCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("Tx",
                      "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace),
@@ -108,6 +124,7 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_routeCacheGeneration (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -271,6 +288,9 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv4 (this);
+  // The routing table generations of the new protocol are unrelated to
+  // those of the previous one, so its routes cannot be told apart
+  std::fill (m_routeCache.begin (), m_routeCache.end (), RouteCacheEntry ());
 }
 
 
@@ -297,6 +317,7 @@ Ipv4L3Protocol::DoDispose (void)
     }
   m_interfaces.clear ();
   m_reverseInterfacesContainer.clear ();
+  m_routeCache.clear ();
 
   m_sockets.clear ();
   m_node = 0;
@@ -307,16 +328,9 @@ Ipv4L3Protocol::DoDispose (void)
       it->second = 0;
     }
 
-  for (MapFragmentsTimers_t::iterator it = m_fragmentsTimers.begin (); it != m_fragmentsTimers.end (); it++)
-    {
-      if (it->second.IsRunning ())
-        {
-          it->second.Cancel ();
-        }
-    }
-
   m_fragments.clear ();
-  m_fragmentsTimers.clear ();
+  m_fragmentsTimeouts.clear ();
+  m_fragmentsTimeoutEvent.Cancel ();
 
   Object::DoDispose ();
 }
@@ -631,8 +645,19 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
+  Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Ipv4L3Protocol::IpForward, this);
+  if (!m_routeCache.empty ())
+    {
+      Ptr<Ipv4Route> route = LookupRouteCache (ipHeader.GetDestination (), interface);
+      if (route != 0)
+        {
+          NS_LOG_LOGIC ("Forwarding with cached route to " << ipHeader.GetDestination ());
+          IpForward (route, packet, ipHeader);
+          return;
+        }
+      ucb = MakeCallback (&Ipv4L3Protocol::CacheRouteAndForward, this).Bind (static_cast<uint32_t> (interface));
+    }
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device, ucb,
                                       MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
                                       MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
@@ -925,12 +950,36 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // TCP super-segments are segmented by the devices supporting it, never
+  // fragmented.  They are split into their segments before the other devices.
+  TsoTag tsoTag;
+  if (packet->PeekPacketTag (tsoTag) && !outDev->SupportsTso ())
+    {
+      if (ipHeader.GetProtocol () == TcpL4Protocol::PROT_NUMBER)
+        {
+          NS_LOG_LOGIC ("Splitting super-segment of " << tsoTag.GetNSegments () << " segments");
+          std::list<Ptr<Packet> > segments;
+          TcpL4Protocol::SplitSuperSegment (packet, ipHeader.GetSource (), ipHeader.GetDestination (), segments);
+          Ipv4Header segmentHeader = ipHeader;
+          for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); it++)
+            {
+              segmentHeader.SetPayloadSize ((*it)->GetSize ());
+              SendRealOut (route, *it, segmentHeader);
+              segmentHeader.SetIdentification (segmentHeader.GetIdentification () + 1);
+            }
+          return;
+        }
+      packet->RemovePacketTag (tsoTag);
+    }
+  bool fragment = packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ()
+    && !packet->PeekPacketTag (tsoTag);
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (fragment)
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -957,7 +1006,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (fragment)
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -1126,6 +1175,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  InvalidateRouteCache ();
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -1157,6 +1207,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
   if (address != Ipv4InterfaceAddress ())
     {
+      InvalidateRouteCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -1180,6 +1231,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, Ipv4Address address)
   Ipv4InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv4InterfaceAddress ())
     {
+      InvalidateRouteCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -1314,6 +1366,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 68)
     {
       interface->SetUp ();
+      InvalidateRouteCache ();
 
       if (m_routingProtocol != 0)
         {
@@ -1332,6 +1385,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
   NS_LOG_FUNCTION (this << ifaceIndex);
   Ptr<Ipv4Interface> interface = GetInterface (ifaceIndex);
   interface->SetDown ();
+  InvalidateRouteCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -1354,6 +1408,7 @@ Ipv4L3Protocol::SetForwarding (uint32_t i, bool val)
   NS_LOG_FUNCTION (this << i);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   interface->SetForwarding (val);
+  InvalidateRouteCache ();
 }
 
 Ptr<NetDevice>
@@ -1372,6 +1427,7 @@ Ipv4L3Protocol::SetIpForward (bool forward)
     {
       (*i)->SetForwarding (forward);
     }
+  InvalidateRouteCache ();
 }
 
 bool 
@@ -1386,6 +1442,7 @@ Ipv4L3Protocol::SetWeakEsModel (bool model)
 {
   NS_LOG_FUNCTION (this << model);
   m_weakEsModel = model;
+  InvalidateRouteCache ();
 }
 
 bool 
@@ -1395,6 +1452,65 @@ Ipv4L3Protocol::GetWeakEsModel (void) const
   return m_weakEsModel;
 }
 
+void
+Ipv4L3Protocol::SetRouteCacheSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_routeCache.clear ();
+  m_routeCache.resize (size);
+}
+
+uint32_t
+Ipv4L3Protocol::GetRouteCacheSize (void) const
+{
+  return m_routeCache.size ();
+}
+
+void
+Ipv4L3Protocol::InvalidateRouteCache (void)
+{
+  m_routeCacheGeneration++;
+}
+
+uint64_t
+Ipv4L3Protocol::GetRouteCacheGeneration (void) const
+{
+  return m_routeCacheGeneration + m_routingProtocol->GetRoutingTableGeneration ();
+}
+
+Ipv4L3Protocol::RouteCacheEntry &
+Ipv4L3Protocol::GetRouteCacheEntry (Ipv4Address destination, uint32_t interface)
+{
+  uint32_t hash = (destination.Get () * 2654435761U) ^ (interface * 0x9e3779b9U);
+  return m_routeCache[hash % m_routeCache.size ()];
+}
+
+Ptr<Ipv4Route>
+Ipv4L3Protocol::LookupRouteCache (Ipv4Address destination, uint32_t interface)
+{
+  RouteCacheEntry &entry = GetRouteCacheEntry (destination, interface);
+  if (entry.route != 0
+      && entry.destination == destination
+      && entry.interface == interface
+      && entry.generation == GetRouteCacheGeneration ())
+    {
+      return entry.route;
+    }
+  return 0;
+}
+
+void
+Ipv4L3Protocol::CacheRouteAndForward (uint32_t iif, Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << iif << rtentry << p << header);
+  RouteCacheEntry &entry = GetRouteCacheEntry (header.GetDestination (), iif);
+  entry.destination = header.GetDestination ();
+  entry.interface = iif;
+  entry.generation = GetRouteCacheGeneration ();
+  entry.route = rtentry;
+  IpForward (rtentry, p, header);
+}
+
 void
 Ipv4L3Protocol::RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeader, Socket::SocketErrno sockErrno)
 {
@@ -1496,9 +1612,8 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
 
   uint64_t addressCombination = uint64_t (ipHeader.GetSource ().Get ()) << 32 | uint64_t (ipHeader.GetDestination ().Get ());
   uint32_t idProto = uint32_t (ipHeader.GetIdentification ()) << 16 | uint32_t (ipHeader.GetProtocol ());
-  std::pair<uint64_t, uint32_t> key;
+  FragmentKey_t key;
   bool ret = false;
-  Ptr<Packet> p = packet->Copy ();
 
   key.first = addressCombination;
   key.second = idProto;
@@ -1510,9 +1625,28 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
     {
       fragments = Create<Fragments> ();
       m_fragments.insert (std::make_pair (key, fragments));
-      m_fragmentsTimers[key] = Simulator::Schedule (m_fragmentExpirationTimeout,
-                                                    &Ipv4L3Protocol::HandleFragmentsTimeout, this,
-                                                    key, ipHeader, iif);
+
+      // The list of timeouts is sorted by expiration, and only its first
+      // entry has an event.  Unless the FragmentExpirationTimeout attribute
+      // was lowered, the new entry expires last.
+      FragmentTimeout timeout;
+      timeout.expiration = Simulator::Now () + m_fragmentExpirationTimeout;
+      timeout.key = key;
+      timeout.ipHeader = ipHeader;
+      timeout.iif = iif;
+      std::list<FragmentTimeout>::iterator next = m_fragmentsTimeouts.end ();
+      while (next != m_fragmentsTimeouts.begin () && std::prev (next)->expiration > timeout.expiration)
+        {
+          next--;
+        }
+      std::list<FragmentTimeout>::iterator timeoutIter = m_fragmentsTimeouts.insert (next, timeout);
+      fragments->SetTimeoutIter (timeoutIter);
+      if (timeoutIter == m_fragmentsTimeouts.begin ())
+        {
+          m_fragmentsTimeoutEvent.Cancel ();
+          m_fragmentsTimeoutEvent = Simulator::Schedule (m_fragmentExpirationTimeout,
+                                                         &Ipv4L3Protocol::HandleTimeout, this);
+        }
     }
   else
     {
@@ -1521,19 +1655,16 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
 
   NS_LOG_LOGIC ("Adding fragment - Size: " << packet->GetSize ( ) << " - Offset: " << (ipHeader.GetFragmentOffset ()) );
 
-  fragments->AddFragment (p, ipHeader.GetFragmentOffset (), !ipHeader.IsLastFragment () );
+  // The packet is a copy owned by the caller, it can be kept as it is.
+  fragments->AddFragment (packet, ipHeader.GetFragmentOffset (), !ipHeader.IsLastFragment () );
 
   if ( fragments->IsEntire () )
     {
       packet = fragments->GetPacket ();
+      NS_LOG_LOGIC ("Removing the timeout of the packet at " << Simulator::Now ().GetSeconds () << " due to complete packet");
+      m_fragmentsTimeouts.erase (fragments->GetTimeoutIter ());
       fragments = 0;
       m_fragments.erase (key);
-      if (m_fragmentsTimers[key].IsRunning ())
-        {
-          NS_LOG_LOGIC ("Stopping WaitFragmentsTimer at " << Simulator::Now ().GetSeconds () << " due to complete packet");
-          m_fragmentsTimers[key].Cancel ();
-        }
-      m_fragmentsTimers.erase (key);
       ret = true;
     }
 
@@ -1556,14 +1687,17 @@ Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentO
 {
   NS_LOG_FUNCTION (this << fragment << fragmentOffset << moreFragment);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
-
-  for (it = m_fragments.begin (); it != m_fragments.end (); it++)
+  // Fragments mostly arrive in order: look for their place from the end.
+  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it = m_fragments.end ();
+  while (it != m_fragments.begin ())
     {
-      if (it->second > fragmentOffset)
+      std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator previous = it;
+      previous--;
+      if (previous->second <= fragmentOffset)
         {
           break;
         }
+      it = previous;
     }
 
   if (it == m_fragments.end ())
@@ -1572,6 +1706,29 @@ Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentO
     }
 
   m_fragments.insert (it, std::pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
+
+  // Merge the bytes of the fragment into the ranges received.  Overlapping
+  // fragments do exist, and might overlap in strange ways.
+  uint32_t start = fragmentOffset;
+  uint32_t end = start + fragment->GetSize ();
+  std::vector<std::pair<uint32_t, uint32_t> >::iterator range = m_received.begin ();
+  while (range != m_received.end () && range->second < start)
+    {
+      range++;
+    }
+  if (range == m_received.end () || range->first > end)
+    {
+      m_received.insert (range, std::make_pair (start, end));
+      return;
+    }
+  range->first = std::min (range->first, start);
+  range->second = std::max (range->second, end);
+  std::vector<std::pair<uint32_t, uint32_t> >::iterator next = range + 1;
+  while (next != m_received.end () && next->first <= range->second)
+    {
+      range->second = std::max (range->second, next->second);
+      next = m_received.erase (next);
+    }
 }
 
 bool
@@ -1579,39 +1736,18 @@ Ipv4L3Protocol::Fragments::IsEntire () const
 {
   NS_LOG_FUNCTION (this);
 
-  bool ret = !m_moreFragment && m_fragments.size () > 0;
-
-  if (ret)
-    {
-      uint16_t lastEndOffset = 0;
-
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
-        {
-          // overlapping fragments do exist
-          NS_LOG_LOGIC ("Checking overlaps " << lastEndOffset << " - " << it->second );
-
-          if (lastEndOffset < it->second)
-            {
-              ret = false;
-              break;
-            }
-          // fragments might overlap in strange ways
-          uint16_t fragmentEnd = it->first->GetSize () + it->second;
-          lastEndOffset = std::max ( lastEndOffset, fragmentEnd );
-        }
-    }
-
-  return ret;
+  // Entire if the last fragment is there and no bytes are missing before it
+  return !m_moreFragment && m_received.size () == 1 && m_received.front ().first == 0;
 }
 
 Ptr<Packet>
-Ipv4L3Protocol::Fragments::GetPacket () const
+Ipv4L3Protocol::Fragments::GetPacket ()
 {
   NS_LOG_FUNCTION (this);
 
   std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
 
-  Ptr<Packet> p = it->first->Copy ();
+  Ptr<Packet> p = it->first;
   uint16_t lastEndOffset = p->GetSize ();
   it++;
 
@@ -1678,7 +1814,46 @@ Ipv4L3Protocol::Fragments::GetPartialPacket () const
 }
 
 void
-Ipv4L3Protocol::HandleFragmentsTimeout (std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif)
+Ipv4L3Protocol::Fragments::SetTimeoutIter (std::list<Ipv4L3Protocol::FragmentTimeout>::iterator iter)
+{
+  m_timeoutIter = iter;
+}
+
+std::list<Ipv4L3Protocol::FragmentTimeout>::iterator
+Ipv4L3Protocol::Fragments::GetTimeoutIter (void) const
+{
+  return m_timeoutIter;
+}
+
+size_t
+Ipv4L3Protocol::FragmentKeyHash::operator () (FragmentKey_t const &key) const
+{
+  uint64_t hash = key.first * 0x9e3779b97f4a7c15ULL ^ key.second;
+  return hash ^ (hash >> 32);
+}
+
+void
+Ipv4L3Protocol::HandleTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+  while (!m_fragmentsTimeouts.empty () && m_fragmentsTimeouts.front ().expiration <= now)
+    {
+      FragmentTimeout timeout = m_fragmentsTimeouts.front ();
+      m_fragmentsTimeouts.pop_front ();
+      HandleFragmentsTimeout (timeout.key, timeout.ipHeader, timeout.iif);
+    }
+
+  if (!m_fragmentsTimeouts.empty ())
+    {
+      m_fragmentsTimeoutEvent = Simulator::Schedule (m_fragmentsTimeouts.front ().expiration - now,
+                                                     &Ipv4L3Protocol::HandleTimeout, this);
+    }
+}
+
+void
+Ipv4L3Protocol::HandleFragmentsTimeout (FragmentKey_t key, Ipv4Header & ipHeader, uint32_t iif)
 {
   NS_LOG_FUNCTION (this << &key << &ipHeader << iif);
 
@@ -1697,6 +1872,5 @@ Ipv4L3Protocol::HandleFragmentsTimeout (std::pair<uint64_t, uint32_t> key, Ipv4H
   it->second = 0;
 
   m_fragments.erase (key);
-  m_fragmentsTimers.erase (key);
 }
 } // namespace ns3
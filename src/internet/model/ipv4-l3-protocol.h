@@ -34,6 +34,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "ns3/sgi-hashmap.h"
 
 class Ipv4L3ProtocolTestCase;
 
@@ -365,6 +366,69 @@ private:
    */
   void RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeader, Socket::SocketErrno sockErrno);
 
+  /**
+   * \brief Entry of the route cache
+   */
+  struct RouteCacheEntry
+  {
+    RouteCacheEntry () : interface (0), generation (0) {}
+    Ipv4Address destination; //!< destination of the forwarded packets
+    uint32_t interface;      //!< input interface of the forwarded packets
+    uint64_t generation;     //!< route cache generation the route was found in
+    Ptr<Ipv4Route> route;    //!< route of the forwarded packets
+  };
+
+  /**
+   * \brief Resize the route cache, dropping its entries.
+   * \param size the number of entries, zero to disable the cache
+   */
+  void SetRouteCacheSize (uint32_t size);
+
+  /**
+   * \returns the number of entries of the route cache
+   */
+  uint32_t GetRouteCacheSize (void) const;
+
+  /**
+   * \brief Invalidate all the entries of the route cache.
+   *
+   * Called whenever the stack changes in a way which may change the
+   * result of Ipv4RoutingProtocol::RouteInput, e.g. when an address is
+   * added or forwarding is disabled.
+   */
+  void InvalidateRouteCache (void);
+
+  /**
+   * \returns the generation of the valid route cache entries, which
+   * changes with the generation of the routing table
+   */
+  uint64_t GetRouteCacheGeneration (void) const;
+
+  /**
+   * \param destination destination address
+   * \param interface input interface
+   * \returns the route cache entry the route of these packets is stored in
+   */
+  RouteCacheEntry &GetRouteCacheEntry (Ipv4Address destination, uint32_t interface);
+
+  /**
+   * \brief Look up the route cache.
+   * \param destination destination address
+   * \param interface input interface
+   * \returns the cached route, or 0 if there is none
+   */
+  Ptr<Ipv4Route> LookupRouteCache (Ipv4Address destination, uint32_t interface);
+
+  /**
+   * \brief Store the route chosen by the routing protocol in the route
+   * cache and forward the packet.
+   * \param iif input interface
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv4 header to add to the packet
+   */
+  void CacheRouteAndForward (uint32_t iif, Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv4Header &header);
+
   /**
    * \brief Add an IPv4 interface to the stack.
    * \param interface interface to add
@@ -414,13 +478,25 @@ private:
    */
   bool ProcessFragment (Ptr<Packet>& packet, Ipv4Header & ipHeader, uint32_t iif);
 
+  /**
+   * \brief Key identifying a fragmented packet: source and destination
+   * addresses, identification and protocol.
+   */
+  typedef std::pair<uint64_t, uint32_t> FragmentKey_t;
+
   /**
    * \brief Process the timeout for packet fragments
    * \param key representing the packet fragments
    * \param ipHeader the IP header of the original packet
    * \param iif Input Interface
    */
-  void HandleFragmentsTimeout ( std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif);
+  void HandleFragmentsTimeout (FragmentKey_t key, Ipv4Header & ipHeader, uint32_t iif);
+
+  /**
+   * \brief Expire the fragmented packets whose timeout is reached, and
+   * schedule the next expiration.
+   */
+  void HandleTimeout (void);
 
   /**
    * \brief Make a copy of the packet, add the header and invoke the TX trace callback
@@ -490,8 +566,22 @@ private:
 
   Ptr<Ipv4RoutingProtocol> m_routingProtocol; //!< Routing protocol associated with the stack
 
+  std::vector<RouteCacheEntry> m_routeCache; //!< Cache of the routes of forwarded packets
+  uint64_t m_routeCacheGeneration;           //!< Changed when the route cache is invalidated
+
   SocketList m_sockets; //!< List of IPv4 raw sockets.
 
+  /**
+   * \brief Expiration of a fragmented packet
+   */
+  struct FragmentTimeout
+  {
+    Time expiration;       //!< Time the packet expires
+    FragmentKey_t key;     //!< The packet
+    Ipv4Header ipHeader;   //!< IP header of the first fragment received
+    uint32_t iif;          //!< Input interface of the first fragment received
+  };
+
   /**
    * \brief A Set of Fragment belonging to the same packet (src, dst, identification and proto)
    */
@@ -524,9 +614,13 @@ public:
 
     /**
      * \brief Get the entire packet.
+     *
+     * The fragments are joined into the first one: the Fragments object
+     * must be discarded afterwards.
+     *
      * \return the entire packet
      */
-    Ptr<Packet> GetPacket () const;
+    Ptr<Packet> GetPacket ();
 
     /**
      * \brief Get the complete part of the packet.
@@ -534,6 +628,18 @@ public:
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Set the position of the packet in the list of timeouts.
+     * \param iter the position
+     */
+    void SetTimeoutIter (std::list<Ipv4L3Protocol::FragmentTimeout>::iterator iter);
+
+    /**
+     * \brief Get the position of the packet in the list of timeouts.
+     * \return the position
+     */
+    std::list<Ipv4L3Protocol::FragmentTimeout>::iterator GetTimeoutIter (void) const;
+
 private:
     /**
      * \brief True if other fragments will be sent.
@@ -541,20 +647,42 @@ private:
     bool m_moreFragment;
 
     /**
-     * \brief The current fragments.
+     * \brief The current fragments, sorted by offset.
      */
     std::list<std::pair<Ptr<Packet>, uint16_t> > m_fragments;
 
+    /**
+     * \brief The byte ranges received, sorted and coalesced.
+     */
+    std::vector<std::pair<uint32_t, uint32_t> > m_received;
+
+    /**
+     * \brief The position of the packet in the list of timeouts.
+     */
+    std::list<Ipv4L3Protocol::FragmentTimeout>::iterator m_timeoutIter;
+  };
+
+  /**
+   * \brief Hash of a FragmentKey_t
+   */
+  class FragmentKeyHash : public std::unary_function<FragmentKey_t, size_t>
+  {
+public:
+    /**
+     * \brief Hash a key
+     * \param key the key
+     * \return the hash
+     */
+    size_t operator () (FragmentKey_t const &key) const;
   };
 
-  /// Container of fragments, stored as pairs(src+dst addr, src+dst port) / fragment
-  typedef std::map< std::pair<uint64_t, uint32_t>, Ptr<Fragments> > MapFragments_t;
-  /// Container of fragment timeout event, stored as pairs(src+dst addr, src+dst port) / EventId
-  typedef std::map< std::pair<uint64_t, uint32_t>, EventId > MapFragmentsTimers_t;
+  /// Container of fragments, indexed by FragmentKey_t
+  typedef sgi::hash_map<FragmentKey_t, Ptr<Fragments>, FragmentKeyHash> MapFragments_t;
 
   MapFragments_t       m_fragments; //!< Fragmented packets.
   Time                 m_fragmentExpirationTimeout; //!< Expiration timeout
-  MapFragmentsTimers_t m_fragmentsTimers; //!< Expiration events.
+  std::list<FragmentTimeout> m_fragmentsTimeouts; //!< Fragmented packets, in the order they expire
+  EventId              m_fragmentsTimeoutEvent; //!< Expiration of the first fragmented packet
 
 };
 
@@ -255,12 +255,25 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  NotifyRoutingTableChanged ();
   if (m_ipv4 != 0)
     {
       routingProtocol->SetIpv4 (m_ipv4);
     }
 }
 
+uint64_t
+Ipv4ListRouting::GetRoutingTableGeneration (void) const
+{
+  uint64_t generation = Ipv4RoutingProtocol::GetRoutingTableGeneration ();
+  for (Ipv4RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      generation += i->second->GetRoutingTableGeneration ();
+    }
+  return generation;
+}
+
 uint32_t 
 Ipv4ListRouting::GetNRoutingProtocols (void) const
 {
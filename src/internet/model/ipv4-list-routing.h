@@ -91,6 +91,12 @@ public:
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
 
+  /**
+   * \returns the sum of the generations of the routing protocols in the
+   * list and of the list itself, which changes when a protocol is added
+   */
+  virtual uint64_t GetRoutingTableGeneration (void) const;
+
 protected:
   virtual void DoDispose (void);
   virtual void DoInitialize (void);
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ipv4-route-trie.h"
+#include "ipv4-routing-table-entry.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+namespace {
+
+/**
+ * \param length a prefix length, at most 32
+ * \returns the mask of the first length bits of an address
+ */
+inline uint32_t
+PrefixMask (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffffU << (32 - length);
+}
+
+/**
+ * \param address an address
+ * \param i a bit index, less than 32, the most significant bit being 0
+ * \returns bit i of the address
+ */
+inline uint32_t
+Bit (uint32_t address, uint32_t i)
+{
+  return (address >> (31 - i)) & 1;
+}
+
+} // unnamed namespace
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_order (0),
+    m_nRoutes (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_root.prefix = 0;
+  m_root.length = 0;
+  m_root.child[0] = 0;
+  m_root.child[1] = 0;
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+Ipv4RouteTrie::DeleteSubTrie (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteSubTrie (node->child[0]);
+      DeleteSubTrie (node->child[1]);
+      delete node;
+    }
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  DeleteSubTrie (m_root.child[0]);
+  DeleteSubTrie (m_root.child[1]);
+  m_root.child[0] = 0;
+  m_root.child[1] = 0;
+  m_root.entries.clear ();
+  m_nRoutes = 0;
+}
+
+uint32_t
+Ipv4RouteTrie::GetNRoutes (void) const
+{
+  return m_nRoutes;
+}
+
+void
+Ipv4RouteTrie::GetKey (Ipv4RoutingTableEntry *route, uint32_t &prefix, uint32_t &length)
+{
+  length = route->GetDestNetworkMask ().GetPrefixLength ();
+  prefix = route->GetDestNetwork ().Get () & PrefixMask (length);
+}
+
+void
+Ipv4RouteTrie::Insert (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  uint32_t prefix, length;
+  GetKey (route, prefix, length);
+
+  // The prefix of node always matches the key and is not longer than it
+  Node *node = &m_root;
+  while (node->length < length)
+    {
+      uint32_t bit = Bit (prefix, node->length);
+      Node *child = node->child[bit];
+      if (child == 0)
+        {
+          child = new Node;
+          child->prefix = prefix;
+          child->length = length;
+          child->child[0] = 0;
+          child->child[1] = 0;
+          node->child[bit] = child;
+          node = child;
+          break;
+        }
+      uint32_t diff = child->prefix ^ prefix;
+      uint32_t common = std::min (child->length, length);
+      if (diff != 0)
+        {
+          common = std::min<uint32_t> (common, __builtin_clz (diff));
+        }
+      if (common == child->length)
+        {
+          node = child;
+          continue;
+        }
+      // The key leaves the path compressed into child: split it
+      Node *split = new Node;
+      split->prefix = prefix & PrefixMask (common);
+      split->length = common;
+      split->child[0] = 0;
+      split->child[1] = 0;
+      split->child[Bit (child->prefix, common)] = child;
+      node->child[bit] = split;
+      node = split;
+    }
+  NS_ASSERT (node->length == length && node->prefix == prefix);
+
+  Entry entry;
+  entry.route = route;
+  entry.metric = metric;
+  entry.order = m_order++;
+  node->entries.push_back (entry);
+  m_nRoutes++;
+}
+
+bool
+Ipv4RouteTrie::Remove (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint32_t prefix, length;
+  GetKey (route, prefix, length);
+
+  Node *path[MAX_MATCHES];
+  uint32_t depth = 0;
+  Node *node = &m_root;
+  path[depth++] = node;
+  while (node->length < length)
+    {
+      node = node->child[Bit (prefix, node->length)];
+      if (node == 0 || node->length > length
+          || (prefix & PrefixMask (node->length)) != node->prefix)
+        {
+          return false;
+        }
+      path[depth++] = node;
+    }
+
+  Entries::iterator i;
+  for (i = node->entries.begin (); i != node->entries.end (); i++)
+    {
+      if (i->route == route)
+        {
+          break;
+        }
+    }
+  if (i == node->entries.end ())
+    {
+      return false;
+    }
+  node->entries.erase (i);
+  m_nRoutes--;
+
+  // Remove the nodes which neither hold routes nor join two branches
+  for (uint32_t j = depth - 1; j > 0; j--)
+    {
+      Node *n = path[j];
+      if (!n->entries.empty () || (n->child[0] != 0 && n->child[1] != 0))
+        {
+          break;
+        }
+      Node *only = n->child[0] != 0 ? n->child[0] : n->child[1];
+      Node *parent = path[j - 1];
+      parent->child[Bit (n->prefix, parent->length)] = only;
+      delete n;
+      if (only != 0)
+        {
+          break;
+        }
+    }
+  return true;
+}
+
+uint32_t
+Ipv4RouteTrie::Lookup (Ipv4Address dest, Entries const *matches[MAX_MATCHES]) const
+{
+  uint32_t address = dest.Get ();
+  uint32_t n = 0;
+  Node const *node = &m_root;
+  while (node != 0 && (address & PrefixMask (node->length)) == node->prefix)
+    {
+      if (!node->entries.empty ())
+        {
+          matches[n++] = &node->entries;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[Bit (address, node->length)];
+    }
+  std::reverse (matches, matches + n);
+  return n;
+}
+
+} // namespace ns3
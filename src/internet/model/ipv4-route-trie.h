@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <vector>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Longest prefix match index over Ipv4RoutingTableEntry objects
+ *
+ * Routes are stored in a path-compressed binary trie (Patricia trie)
+ * keyed by their destination prefix: a node exists only for a prefix
+ * holding routes or where two branches of the trie meet, so a lookup
+ * visits at most 33 nodes whatever the number of routes.
+ *
+ * The trie does not decide which route is used: Lookup returns the
+ * routes of every prefix matching a destination, from the longest to the
+ * shortest prefix, and the routing protocols apply their own selection
+ * rules to them.  To allow this, the routes of a prefix are kept in
+ * insertion order and every route carries a sequence number giving its
+ * position in the whole table, together with an opaque metric.
+ *
+ * The trie does not own the routing table entries.
+ */
+class Ipv4RouteTrie
+{
+public:
+  /// A route stored in the trie
+  struct Entry
+  {
+    Ipv4RoutingTableEntry *route;  //!< the route
+    uint32_t metric;               //!< metric given at insertion
+    uint64_t order;                //!< insertion sequence number
+  };
+  /// Routes of a prefix, in insertion order
+  typedef std::vector<Entry> Entries;
+
+  static const uint32_t MAX_MATCHES = 33; //!< Maximum number of prefixes matching an address
+
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \brief Add a route after all the routes already in the trie
+   * \param route the route, indexed by its destination network and mask
+   * \param metric metric of the route
+   */
+  void Insert (Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+
+  /**
+   * \brief Remove a route
+   * \param route the route, as given to Insert
+   * \returns true if the route was found and removed
+   */
+  bool Remove (Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Remove all the routes
+   */
+  void Clear (void);
+
+  /**
+   * \returns the number of routes in the trie
+   */
+  uint32_t GetNRoutes (void) const;
+
+  /**
+   * \brief Find the prefixes matching an address
+   *
+   * Routes whose mask is not contiguous are stored under the prefix made
+   * of the leading ones of their mask, so callers must still check
+   * Ipv4Mask::IsMatch on the returned routes.
+   *
+   * \param dest the address to look up
+   * \param matches filled with the routes of each matching prefix, longest
+   * prefix first
+   * \returns the number of matching prefixes stored in matches
+   */
+  uint32_t Lookup (Ipv4Address dest, Entries const *matches[MAX_MATCHES]) const;
+
+private:
+  /// A node of the trie
+  struct Node
+  {
+    uint32_t prefix;     //!< prefix bits, the others being zero
+    uint32_t length;     //!< prefix length
+    Node *child[2];      //!< sub-tries for the next bit being 0 or 1
+    Entries entries;     //!< routes to this prefix
+  };
+
+  /**
+   * \brief Copy constructor, not implemented
+   * \param o object to copy
+   */
+  Ipv4RouteTrie (Ipv4RouteTrie const &o);
+  /**
+   * \brief Assignment operator, not implemented
+   * \param o object to copy
+   * \returns the object
+   */
+  Ipv4RouteTrie &operator = (Ipv4RouteTrie const &o);
+
+  /**
+   * \brief Delete a node and all its sub-tries
+   * \param node the node
+   */
+  static void DeleteSubTrie (Node *node);
+
+  /**
+   * \param route a route
+   * \param prefix filled with the masked destination of the route
+   * \param length filled with the prefix length of the route
+   */
+  static void GetKey (Ipv4RoutingTableEntry *route, uint32_t &prefix, uint32_t &length);
+
+  Node m_root;         //!< node of the empty prefix, always present
+  uint64_t m_order;    //!< sequence number of the next route
+  uint32_t m_nRoutes;  //!< number of routes in the trie
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
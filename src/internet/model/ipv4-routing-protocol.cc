@@ -36,4 +36,21 @@ TypeId Ipv4RoutingProtocol::GetTypeId (void)
   return tid;
 }
 
+Ipv4RoutingProtocol::Ipv4RoutingProtocol ()
+  : m_routingTableGeneration (0)
+{
+}
+
+uint64_t
+Ipv4RoutingProtocol::GetRoutingTableGeneration (void) const
+{
+  return m_routingTableGeneration;
+}
+
+void
+Ipv4RoutingProtocol::NotifyRoutingTableChanged (void)
+{
+  m_routingTableGeneration++;
+}
+
 } // namespace ns3
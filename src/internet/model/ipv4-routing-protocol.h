@@ -62,6 +62,8 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  Ipv4RoutingProtocol ();
+
   /// Callback for unicast packets to be forwarded
   typedef Callback<void, Ptr<Ipv4Route>, Ptr<const Packet>, const Ipv4Header &> UnicastForwardCallback;
 
@@ -171,6 +173,27 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const = 0;
 
+  /**
+   * \brief Get the generation of the routing table
+   *
+   * The generation changes whenever the routing protocol changes the
+   * routes it uses to forward packets.  Ipv4L3Protocol uses it to
+   * invalidate its route cache (see the RouteCacheSize attribute), so
+   * protocols which support the cache must call NotifyRoutingTableChanged
+   * on every route change.
+   *
+   * \returns the generation of the routing table
+   */
+  virtual uint64_t GetRoutingTableGeneration (void) const;
+
+protected:
+  /**
+   * \brief Start a new routing table generation
+   */
+  void NotifyRoutingTableChanged (void);
+
+private:
+  uint64_t m_routingTableGeneration; //!< generation of the routing table
 };
 
 } // namespace ns3
@@ -73,6 +73,8 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkRouteTrie.Insert (route, metric);
+  NotifyRoutingTableChanged ();
 }
 
 void 
@@ -87,6 +89,8 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkRouteTrie.Insert (route, metric);
+  NotifyRoutingTableChanged ();
 }
 
 void 
@@ -144,6 +148,8 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_networkRouteTrie.Insert (route, 0);
+  NotifyRoutingTableChanged ();
 }
 
 uint32_t 
@@ -224,7 +230,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
   uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
@@ -240,18 +245,27 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // Among the routes with the longest matching prefix, a host route is
+  // the first one in the table and a network route the one with the lowest
+  // metric, the last one in the table on ties.
+  Ipv4RouteTrie::Entries const *matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t nMatches = m_networkRouteTrie.Lookup (dest, matches);
+  for (uint32_t m = 0; m < nMatches && rtentry == 0; m++)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      Ipv4RoutingTableEntry *route = 0;
+      for (Ipv4RouteTrie::Entries::const_iterator i = matches[m]->begin ();
+           i != matches[m]->end ();
+           i++)
         {
+          Ipv4RoutingTableEntry *j = i->route;
+          uint32_t metric = i->metric;
+          Ipv4Mask mask = j->GetDestNetworkMask ();
+          uint16_t masklen = mask.GetPrefixLength ();
+          NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << j->GetDestNetwork () << "/" << masklen);
+          if (!mask.IsMatch (dest, j->GetDestNetwork ()))
+            {
+              continue;
+            }
           NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
           if (oif != 0)
             {
@@ -261,33 +275,26 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
                   continue;
                 }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
           if (metric > shortest_metric)
             {
               NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
               continue;
             }
           shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
+          route = j;
+          if (masklen == 32)
+            {
+              break;
+            }
+        }
+      if (route != 0)
+        {
           uint32_t interfaceIdx = route->GetInterface ();
           rtentry = Create<Ipv4Route> ();
           rtentry->SetDestination (route->GetDest ());
           rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
           rtentry->SetGateway (route->GetGateway ());
           rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
-            }
         }
     }
   if (rtentry != 0)
@@ -447,6 +454,8 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          m_networkRouteTrie.Remove (j->first);
+          NotifyRoutingTableChanged ();
           delete j->first;
           m_networkRoutes.erase (j);
           return;
@@ -575,6 +584,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRouteTrie.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,6 +623,8 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
+          m_networkRouteTrie.Remove (it->first);
+          NotifyRoutingTableChanged ();
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -660,6 +672,8 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
+          m_networkRouteTrie.Remove (it->first);
+          NotifyRoutingTableChanged ();
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
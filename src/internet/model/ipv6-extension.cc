@@ -18,6 +18,7 @@
  * Author: David Gross <gdavid.devel@gmail.com>
  */
 
+#include <iterator>
 #include <list>
 #include <ctime>
 
@@ -339,6 +340,8 @@ void Ipv6ExtensionFragment::DoDispose ()
     }
 
   m_fragments.clear ();
+  m_fragmentsTimeouts.clear ();
+  m_fragmentsTimeoutEvent.Cancel ();
   Ipv6Extension::DoDispose ();
 }
 
@@ -376,7 +379,7 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
   uint32_t identification = fragmentHeader.GetIdentification ();
   Ipv6Address src = ipv6Header.GetSourceAddress ();
 
-  std::pair<Ipv6Address, uint32_t> fragmentsId = std::pair<Ipv6Address, uint32_t> (src, identification);
+  FragmentKey_t fragmentsId = FragmentKey_t (src, identification);
   Ptr<Fragments> fragments;
 
   Ipv6Header ipHeader = ipv6Header;
@@ -387,10 +390,27 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
     {
       fragments = Create<Fragments> ();
       m_fragments.insert (std::make_pair (fragmentsId, fragments));
-      EventId timeout = Simulator::Schedule (Seconds (60),
-                                             &Ipv6ExtensionFragment::HandleFragmentsTimeout, this,
-                                             fragmentsId, ipHeader);
-      fragments->SetTimeoutEventId (timeout);
+
+      // The list of timeouts is sorted by expiration, and only its first
+      // entry has an event.  As the expiration timeout is the same for
+      // every packet, the new entry expires last.
+      FragmentTimeout timeout;
+      timeout.expiration = Simulator::Now () + Seconds (60);
+      timeout.key = fragmentsId;
+      timeout.ipHeader = ipHeader;
+      std::list<FragmentTimeout>::iterator next = m_fragmentsTimeouts.end ();
+      while (next != m_fragmentsTimeouts.begin () && std::prev (next)->expiration > timeout.expiration)
+        {
+          next--;
+        }
+      std::list<FragmentTimeout>::iterator timeoutIter = m_fragmentsTimeouts.insert (next, timeout);
+      fragments->SetTimeoutIter (timeoutIter);
+      if (timeoutIter == m_fragmentsTimeouts.begin ())
+        {
+          m_fragmentsTimeoutEvent.Cancel ();
+          m_fragmentsTimeoutEvent = Simulator::Schedule (Seconds (60),
+                                                         &Ipv6ExtensionFragment::HandleTimeout, this);
+        }
     }
   else
     {
@@ -409,7 +429,7 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
   if (fragments->IsEntire ())
     {
       packet = fragments->GetPacket ();
-      fragments->CancelTimeout ();
+      m_fragmentsTimeouts.erase (fragments->GetTimeoutIter ());
       m_fragments.erase (fragmentsId);
       stopProcessing = false;
     }
@@ -594,7 +614,31 @@ void Ipv6ExtensionFragment::GetFragments (Ptr<Packet> packet, Ipv6Header ipv6Hea
 }
 
 
-void Ipv6ExtensionFragment::HandleFragmentsTimeout (std::pair<Ipv6Address, uint32_t> fragmentsId,
+void Ipv6ExtensionFragment::HandleTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+  while (!m_fragmentsTimeouts.empty () && m_fragmentsTimeouts.front ().expiration <= now)
+    {
+      FragmentTimeout timeout = m_fragmentsTimeouts.front ();
+      m_fragmentsTimeouts.pop_front ();
+      HandleFragmentsTimeout (timeout.key, timeout.ipHeader);
+    }
+
+  if (!m_fragmentsTimeouts.empty ())
+    {
+      m_fragmentsTimeoutEvent = Simulator::Schedule (m_fragmentsTimeouts.front ().expiration - now,
+                                                     &Ipv6ExtensionFragment::HandleTimeout, this);
+    }
+}
+
+size_t Ipv6ExtensionFragment::FragmentKeyHash::operator () (FragmentKey_t const &key) const
+{
+  return Ipv6AddressHash () (key.first) ^ (key.second * 0x9e3779b9U);
+}
+
+void Ipv6ExtensionFragment::HandleFragmentsTimeout (FragmentKey_t fragmentsId,
                                                     Ipv6Header ipHeader)
 {
   Ptr<Fragments> fragments;
@@ -605,6 +649,12 @@ void Ipv6ExtensionFragment::HandleFragmentsTimeout (std::pair<Ipv6Address, uint3
 
   Ptr<Packet> packet = fragments->GetPartialPacket ();
 
+  // without the first fragment, nothing was received that can be reported
+  if (packet == 0)
+    {
+      packet = Create<Packet> ();
+    }
+
   // if we have at least 8 bytes, we can send an ICMP.
   if ( packet->GetSize () > 8 )
     {
@@ -622,7 +672,8 @@ void Ipv6ExtensionFragment::HandleFragmentsTimeout (std::pair<Ipv6Address, uint3
 }
 
 Ipv6ExtensionFragment::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_moreFragment (0),
+    m_overlap (false)
 {
 }
 
@@ -632,14 +683,17 @@ Ipv6ExtensionFragment::Fragments::~Fragments ()
 
 void Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
 {
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
-
-  for (it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  // Fragments mostly arrive in order: look for their place from the end.
+  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it = m_packetFragments.end ();
+  while (it != m_packetFragments.begin ())
     {
-      if (it->second > fragmentOffset)
+      std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator previous = it;
+      previous--;
+      if (previous->second <= fragmentOffset)
         {
           break;
         }
+      it = previous;
     }
 
   if (it == m_packetFragments.end ())
@@ -648,6 +702,37 @@ void Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16
     }
 
   m_packetFragments.insert (it, std::pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
+
+  // Merge the bytes of the fragment into the ranges received, noting
+  // overlapping fragments.
+  uint32_t start = fragmentOffset;
+  uint32_t end = start + fragment->GetSize ();
+  std::vector<std::pair<uint32_t, uint32_t> >::iterator range = m_received.begin ();
+  while (range != m_received.end () && range->second < start)
+    {
+      range++;
+    }
+  if (range == m_received.end () || range->first > end)
+    {
+      m_received.insert (range, std::make_pair (start, end));
+      return;
+    }
+  if (range->second > start && range->first < end)
+    {
+      m_overlap = true;
+    }
+  range->first = std::min (range->first, start);
+  range->second = std::max (range->second, end);
+  std::vector<std::pair<uint32_t, uint32_t> >::iterator next = range + 1;
+  while (next != m_received.end () && next->first <= range->second)
+    {
+      if (next->first < range->second)
+        {
+          m_overlap = true;
+        }
+      range->second = std::max (range->second, next->second);
+      next = m_received.erase (next);
+    }
 }
 
 void Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart (Ptr<Packet> unfragmentablePart)
@@ -657,30 +742,14 @@ void Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart (Ptr<Packet> unfrag
 
 bool Ipv6ExtensionFragment::Fragments::IsEntire () const
 {
-  bool ret = !m_moreFragment && m_packetFragments.size () > 0;
-
-  if (ret)
-    {
-      uint16_t lastEndOffset = 0;
-
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
-        {
-          if (lastEndOffset != it->second)
-            {
-              ret = false;
-              break;
-            }
-
-          lastEndOffset += it->first->GetSize ();
-        }
-    }
-
-  return ret;
+  // Entire if the last fragment is there, no bytes are missing before it
+  // and no fragments overlap
+  return !m_moreFragment && !m_overlap && m_received.size () == 1 && m_received.front ().first == 0;
 }
 
-Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPacket () const
+Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPacket ()
 {
-  Ptr<Packet> p =  m_unfragmentable->Copy ();
+  Ptr<Packet> p = m_unfragmentable;
 
   for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
@@ -718,16 +787,14 @@ Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPartialPacket () const
   return p;
 }
 
-void Ipv6ExtensionFragment::Fragments::SetTimeoutEventId (EventId event)
+void Ipv6ExtensionFragment::Fragments::SetTimeoutIter (std::list<FragmentTimeout>::iterator iter)
 {
-  m_timeoutEventId = event;
-  return;
+  m_timeoutIter = iter;
 }
 
-void Ipv6ExtensionFragment::Fragments::CancelTimeout ()
+std::list<Ipv6ExtensionFragment::FragmentTimeout>::iterator Ipv6ExtensionFragment::Fragments::GetTimeoutIter (void) const
 {
-  m_timeoutEventId.Cancel ();
-  return;
+  return m_timeoutIter;
 }
 
 
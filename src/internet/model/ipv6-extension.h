@@ -23,6 +23,7 @@
 
 #include <map>
 #include <list>
+#include <vector>
 
 #include "ns3/object.h"
 #include "ns3/node.h"
@@ -35,6 +36,7 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/traced-callback.h"
+#include "ns3/sgi-hashmap.h"
 
 
 namespace ns3 {
@@ -316,6 +318,21 @@ protected:
   virtual void DoDispose ();
 
 private:
+  /**
+   * \brief Key identifying a fragmented packet: source address and identification.
+   */
+  typedef std::pair<Ipv6Address, uint32_t> FragmentKey_t;
+
+  /**
+   * \brief Expiration of a fragmented packet
+   */
+  struct FragmentTimeout
+  {
+    Time expiration;       //!< Time the packet expires
+    FragmentKey_t key;     //!< The packet
+    Ipv6Header ipHeader;   //!< IPv6 header of the first fragment received
+  };
+
   /**
    * \ingroup ipv6HeaderExt
    *
@@ -356,9 +373,13 @@ public:
 
     /**
      * \brief Get the entire packet.
+     *
+     * The fragments are joined into the unfragmentable part: the Fragments
+     * object must be discarded afterwards.
+     *
      * \return the entire packet
      */
-    Ptr<Packet> GetPacket () const;
+    Ptr<Packet> GetPacket ();
 
     /**
      * \brief Get the packet parts so far received.
@@ -367,15 +388,16 @@ public:
     Ptr<Packet> GetPartialPacket () const;
 
     /**
-     * \brief Set the Timeout EventId.
-     * \param event The event.
+     * \brief Set the position of the packet in the list of timeouts.
+     * \param iter the position
      */
-    void SetTimeoutEventId (EventId event);
+    void SetTimeoutIter (std::list<FragmentTimeout>::iterator iter);
 
     /**
-     * \brief Cancel the timeout event
+     * \brief Get the position of the packet in the list of timeouts.
+     * \return the position
      */
-    void CancelTimeout ();
+    std::list<FragmentTimeout>::iterator GetTimeoutIter (void) const;
 
 private:
     /**
@@ -384,19 +406,29 @@ private:
     bool m_moreFragment;
 
     /**
-     * \brief The current fragments.
+     * \brief If fragments overlap, in which case the packet is never entire.
+     */
+    bool m_overlap;
+
+    /**
+     * \brief The current fragments, sorted by offset.
      */
     std::list<std::pair<Ptr<Packet>, uint16_t> > m_packetFragments;
 
+    /**
+     * \brief The byte ranges received, sorted and coalesced.
+     */
+    std::vector<std::pair<uint32_t, uint32_t> > m_received;
+
     /**
      * \brief The unfragmentable part.
      */
     Ptr<Packet> m_unfragmentable;
 
     /**
-     * \brief Timeout handler event
+     * \brief The position of the packet in the list of timeouts.
      */
-    EventId m_timeoutEventId;
+    std::list<FragmentTimeout>::iterator m_timeoutIter;
   };
 
   /**
@@ -404,34 +436,53 @@ private:
    * \param key representing the packet fragments
    * \param ipHeader the IP header of the original packet
    */
-  void HandleFragmentsTimeout (std::pair<Ipv6Address, uint32_t> key, Ipv6Header ipHeader);
+  void HandleFragmentsTimeout (FragmentKey_t key, Ipv6Header ipHeader);
 
   /**
-   * \brief Get the packet parts so far received.
-   * \return the partial packet
+   * \brief Expire the fragmented packets whose timeout is reached, and
+   * schedule the next expiration.
    */
-  Ptr<Packet> GetPartialPacket () const;
+  void HandleTimeout (void);
 
   /**
-   * \brief Set the Timeout EventId.
-   * \param event The event.
+   * \brief Get the packet parts so far received.
+   * \return the partial packet
    */
-  void SetTimeoutEventId (EventId event);
+  Ptr<Packet> GetPartialPacket () const;
 
   /**
-   * \brief Cancel the timeout event
+   * \brief Hash of a FragmentKey_t
    */
-  void CancelTimeout ();
+  class FragmentKeyHash : public std::unary_function<FragmentKey_t, size_t>
+  {
+public:
+    /**
+     * \brief Hash a key
+     * \param key the key
+     * \return the hash
+     */
+    size_t operator () (FragmentKey_t const &key) const;
+  };
 
   /**
    * \brief Container for the packet fragments.
    */
-  typedef std::map<std::pair<Ipv6Address, uint32_t>, Ptr<Fragments> > MapFragments_t;
+  typedef sgi::hash_map<FragmentKey_t, Ptr<Fragments>, FragmentKeyHash> MapFragments_t;
 
   /**
    * \brief The hash of fragmented packets.
    */
   MapFragments_t m_fragments;
+
+  /**
+   * \brief The fragmented packets, in the order they expire.
+   */
+  std::list<FragmentTimeout> m_fragmentsTimeouts;
+
+  /**
+   * \brief Expiration of the first fragmented packet.
+   */
+  EventId m_fragmentsTimeoutEvent;
 };
 
 /**
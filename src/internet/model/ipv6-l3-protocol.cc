@@ -18,6 +18,8 @@
  * Author: Sebastien Vincent <vincent@clarinet.u-strasbg.fr>
  */
 
+#include <algorithm>
+
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/uinteger.h"
@@ -31,6 +33,7 @@
 #include "ns3/mac16-address.h"
 #include "ns3/mac64-address.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/tso-tag.h"
 
 #include "loopback-net-device.h"
 #include "ipv6-l3-protocol.h"
@@ -44,6 +47,7 @@
 #include "ipv6-option.h"
 #include "icmpv6-l4-protocol.h"
 #include "ndisc-cache.h"
+#include "tcp-l4-protocol.h"
 
 /// Minimum IPv6 MTU, as defined by \RFC{2460}
 #define IPV6_MIN_MTU 1280
@@ -90,6 +94,17 @@ TypeId Ipv6L3Protocol::GetTypeId ()
                    BooleanValue (true),
                    MakeBooleanAccessor (&Ipv6L3Protocol::m_strongEndSystemModel),
                    MakeBooleanChecker ())
+    .AddAttribute ("RouteCacheSize",
+                   "Number of entries of the cache of the routes used to "
+                   "forward packets, indexed by destination and input interface; "
+                   "zero disables the cache.  The cache may only be enabled with "
+                   "routing protocols which choose the route of a forwarded packet "
+                   "from its destination and input interface alone and report their "
+                   "route changes, such as static and RIPng routing.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv6L3Protocol::SetRouteCacheSize,
+                                         &Ipv6L3Protocol::GetRouteCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("Tx",
                      "Send IPv6 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv6L3Protocol::m_txTrace),
@@ -123,7 +138,8 @@ TypeId Ipv6L3Protocol::GetTypeId ()
 }
 
 Ipv6L3Protocol::Ipv6L3Protocol ()
-  : m_nInterfaces (0)
+  : m_nInterfaces (0),
+    m_routeCacheGeneration (1)
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_pmtuCache = CreateObject<Ipv6PmtuCache> ();
@@ -152,6 +168,7 @@ void Ipv6L3Protocol::DoDispose ()
     }
   m_interfaces.clear ();
   m_reverseInterfacesContainer.clear ();
+  m_routeCache.clear ();
 
   /* remove raw sockets */
   for (SocketList::iterator it = m_sockets.begin (); it != m_sockets.end (); ++it)
@@ -180,6 +197,9 @@ void Ipv6L3Protocol::SetRoutingProtocol (Ptr<Ipv6RoutingProtocol> routingProtoco
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv6 (this);
+  // The routing table generations of the new protocol are unrelated to
+  // those of the previous one, so its routes cannot be told apart
+  std::fill (m_routeCache.begin (), m_routeCache.end (), RouteCacheEntry ());
 }
 
 Ptr<Ipv6RoutingProtocol> Ipv6L3Protocol::GetRoutingProtocol () const
@@ -414,6 +434,7 @@ bool Ipv6L3Protocol::AddAddress (uint32_t i, Ipv6InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv6Interface> interface = GetInterface (i);
   bool ret = interface->AddAddress (address);
+  InvalidateRouteCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -444,6 +465,7 @@ bool Ipv6L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
 
   if (address != Ipv6InterfaceAddress ())
     {
+      InvalidateRouteCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -467,6 +489,7 @@ Ipv6L3Protocol::RemoveAddress (uint32_t i, Ipv6Address address)
   Ipv6InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv6InterfaceAddress ())
   {
+    InvalidateRouteCache ();
     if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -531,6 +554,7 @@ void Ipv6L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 1280)
     {
       interface->SetUp ();
+      InvalidateRouteCache ();
 
       if (m_routingProtocol != 0)
         {
@@ -549,6 +573,7 @@ void Ipv6L3Protocol::SetDown (uint32_t i)
   Ptr<Ipv6Interface> interface = GetInterface (i);
 
   interface->SetDown ();
+  InvalidateRouteCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -607,6 +632,7 @@ void Ipv6L3Protocol::SetForwarding (uint32_t i, bool val)
   NS_LOG_FUNCTION (this << i << val);
   Ptr<Ipv6Interface> interface = GetInterface (i);
   interface->SetForwarding (val);
+  InvalidateRouteCache ();
 }
 
 Ipv6Address Ipv6L3Protocol::SourceAddressSelection (uint32_t interface, Ipv6Address dest)
@@ -657,6 +683,7 @@ void Ipv6L3Protocol::SetIpForward (bool forward)
     {
       (*it)->SetForwarding (forward);
     }
+  InvalidateRouteCache ();
 }
 
 bool Ipv6L3Protocol::GetIpForward () const
@@ -1079,8 +1106,19 @@ void Ipv6L3Protocol::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16
         }
     }
 
-  if (!m_routingProtocol->RouteInput (packet, hdr, device,
-                                      MakeCallback (&Ipv6L3Protocol::IpForward, this),
+  Ipv6RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Ipv6L3Protocol::IpForward, this);
+  if (!m_routeCache.empty ())
+    {
+      Ptr<Ipv6Route> route = LookupRouteCache (hdr.GetDestinationAddress (), interface);
+      if (route != 0)
+        {
+          NS_LOG_LOGIC ("Forwarding with cached route to " << hdr.GetDestinationAddress ());
+          IpForward (device, route, packet, hdr);
+          return;
+        }
+      ucb = MakeCallback (&Ipv6L3Protocol::CacheRouteAndForward, this).Bind (interface);
+    }
+  if (!m_routingProtocol->RouteInput (packet, hdr, device, ucb,
                                       MakeCallback (&Ipv6L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv6L3Protocol::LocalDeliver, this),
                                       MakeCallback (&Ipv6L3Protocol::RouteInputError, this)))
@@ -1116,6 +1154,27 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
   Ptr<Ipv6Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << dev->GetIfIndex () << " Ipv6InterfaceIndex " << interface);
 
+  // TCP super-segments are segmented by the devices supporting it, never
+  // fragmented.  They are split into their segments before the other devices.
+  TsoTag tsoTag;
+  if (packet->PeekPacketTag (tsoTag) && !dev->SupportsTso ())
+    {
+      if (ipHeader.GetNextHeader () == TcpL4Protocol::PROT_NUMBER)
+        {
+          NS_LOG_LOGIC ("Splitting super-segment of " << tsoTag.GetNSegments () << " segments");
+          std::list<Ptr<Packet> > segments;
+          TcpL4Protocol::SplitSuperSegment (packet, ipHeader.GetSourceAddress (), ipHeader.GetDestinationAddress (), segments);
+          Ipv6Header segmentHeader = ipHeader;
+          for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); it++)
+            {
+              segmentHeader.SetPayloadLength ((*it)->GetSize ());
+              SendRealOut (route, *it, segmentHeader);
+            }
+          return;
+        }
+      packet->RemovePacketTag (tsoTag);
+    }
+
   // Check packet size
   std::list<Ipv6ExtensionFragment::Ipv6PayloadHeaderPair> fragments;
 
@@ -1126,7 +1185,8 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
       targetMtu = dev->GetMtu ();
     }
 
-  if (packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
+  if (packet->GetSize () > targetMtu + 40 /* 40 => size of IPv6 header */
+      && !packet->PeekPacketTag (tsoTag))
     {
       // Router => drop
 
@@ -1447,6 +1507,58 @@ void Ipv6L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv6Header const& i
   while (ipv6Extension);
 }
 
+void Ipv6L3Protocol::SetRouteCacheSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_routeCache.clear ();
+  m_routeCache.resize (size);
+}
+
+uint32_t Ipv6L3Protocol::GetRouteCacheSize () const
+{
+  return m_routeCache.size ();
+}
+
+void Ipv6L3Protocol::InvalidateRouteCache ()
+{
+  m_routeCacheGeneration++;
+}
+
+uint64_t Ipv6L3Protocol::GetRouteCacheGeneration () const
+{
+  return m_routeCacheGeneration + m_routingProtocol->GetRoutingTableGeneration ();
+}
+
+Ipv6L3Protocol::RouteCacheEntry & Ipv6L3Protocol::GetRouteCacheEntry (Ipv6Address destination, uint32_t interface)
+{
+  uint32_t hash = Ipv6AddressHash () (destination) ^ (interface * 0x9e3779b9U);
+  return m_routeCache[hash % m_routeCache.size ()];
+}
+
+Ptr<Ipv6Route> Ipv6L3Protocol::LookupRouteCache (Ipv6Address destination, uint32_t interface)
+{
+  RouteCacheEntry &entry = GetRouteCacheEntry (destination, interface);
+  if (entry.route != 0
+      && entry.destination == destination
+      && entry.interface == interface
+      && entry.generation == GetRouteCacheGeneration ())
+    {
+      return entry.route;
+    }
+  return 0;
+}
+
+void Ipv6L3Protocol::CacheRouteAndForward (uint32_t iif, Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentry, Ptr<const Packet> p, const Ipv6Header& header)
+{
+  NS_LOG_FUNCTION (this << iif << idev << rtentry << p << header);
+  RouteCacheEntry &entry = GetRouteCacheEntry (header.GetDestinationAddress (), iif);
+  entry.destination = header.GetDestinationAddress ();
+  entry.interface = iif;
+  entry.generation = GetRouteCacheGeneration ();
+  entry.route = rtentry;
+  IpForward (idev, rtentry, p, header);
+}
+
 void Ipv6L3Protocol::RouteInputError (Ptr<const Packet> p, const Ipv6Header& ipHeader, Socket::SocketErrno sockErrno)
 {
   NS_LOG_FUNCTION (this << p << ipHeader << sockErrno);
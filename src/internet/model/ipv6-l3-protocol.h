@@ -22,6 +22,7 @@
 #define IPV6_L3_PROTOCOL_H
 
 #include <list>
+#include <vector>
 
 #include "ns3/traced-callback.h"
 #include "ns3/net-device.h"
@@ -29,6 +30,7 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-pmtu-cache.h"
+#include "ns3/ipv6-route.h"
 
 class Ipv6L3ProtocolTestCase;
 
@@ -618,6 +620,73 @@ private:
    */
   void RouteInputError (Ptr<const Packet> p, const Ipv6Header& ipHeader, Socket::SocketErrno sockErrno);
 
+  /**
+   * \brief Entry of the route cache
+   */
+  struct RouteCacheEntry
+  {
+    RouteCacheEntry () : interface (0), generation (0) {}
+    Ipv6Address destination; //!< destination of the forwarded packets
+    uint32_t interface;      //!< input interface of the forwarded packets
+    uint64_t generation;     //!< route cache generation the route was found in
+    Ptr<Ipv6Route> route;    //!< route of the forwarded packets
+  };
+
+  /**
+   * \brief Resize the route cache, dropping its entries.
+   * \param size the number of entries, zero to disable the cache
+   */
+  void SetRouteCacheSize (uint32_t size);
+
+  /**
+   * \brief Get the number of entries of the route cache.
+   * \returns the number of entries of the route cache
+   */
+  uint32_t GetRouteCacheSize () const;
+
+  /**
+   * \brief Invalidate all the entries of the route cache.
+   *
+   * Called whenever the stack changes in a way which may change the
+   * result of Ipv6RoutingProtocol::RouteInput, e.g. when an address is
+   * added or forwarding is disabled.
+   */
+  void InvalidateRouteCache ();
+
+  /**
+   * \brief Get the generation of the valid route cache entries.
+   * \returns the generation, which changes with the generation of the
+   * routing table
+   */
+  uint64_t GetRouteCacheGeneration () const;
+
+  /**
+   * \brief Get the route cache entry of some forwarded packets.
+   * \param destination destination address
+   * \param interface input interface
+   * \returns the route cache entry the route of these packets is stored in
+   */
+  RouteCacheEntry & GetRouteCacheEntry (Ipv6Address destination, uint32_t interface);
+
+  /**
+   * \brief Look up the route cache.
+   * \param destination destination address
+   * \param interface input interface
+   * \returns the cached route, or 0 if there is none
+   */
+  Ptr<Ipv6Route> LookupRouteCache (Ipv6Address destination, uint32_t interface);
+
+  /**
+   * \brief Store the route chosen by the routing protocol in the route
+   * cache and forward the packet.
+   * \param iif input interface
+   * \param idev input NetDevice
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv6 header to add to the packet
+   */
+  void CacheRouteAndForward (uint32_t iif, Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentry, Ptr<const Packet> p, const Ipv6Header& header);
+
   /**
    * \brief Add an IPv6 interface to the stack.
    * \param interface interface to add
@@ -726,6 +795,16 @@ private:
    */
   Ptr<Ipv6RoutingProtocol> m_routingProtocol;
 
+  /**
+   * \brief Cache of the routes of forwarded packets.
+   */
+  std::vector<RouteCacheEntry> m_routeCache;
+
+  /**
+   * \brief Changed when the route cache is invalidated.
+   */
+  uint64_t m_routeCacheGeneration;
+
   /**
    * \brief List of IPv6 raw sockets.
    */
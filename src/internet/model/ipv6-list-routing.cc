@@ -247,12 +247,25 @@ Ipv6ListRouting::AddRoutingProtocol (Ptr<Ipv6RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  NotifyRoutingTableChanged ();
   if (m_ipv6 != 0)
     {
       routingProtocol->SetIpv6 (m_ipv6);
     }
 }
 
+uint64_t
+Ipv6ListRouting::GetRoutingTableGeneration (void) const
+{
+  uint64_t generation = Ipv6RoutingProtocol::GetRoutingTableGeneration ();
+  for (Ipv6RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      generation += i->second->GetRoutingTableGeneration ();
+    }
+  return generation;
+}
+
 uint32_t
 Ipv6ListRouting::GetNRoutingProtocols (void) const
 {
@@ -100,6 +100,12 @@ public:
   virtual void SetIpv6 (Ptr<Ipv6> ipv6);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
 
+  /**
+   * \returns the sum of the generations of the routing protocols in the
+   * list and of the list itself, which changes when a protocol is added
+   */
+  virtual uint64_t GetRoutingTableGeneration (void) const;
+
 protected:
   /**
    * \brief Dispose this object.
@@ -37,5 +37,22 @@ TypeId Ipv6RoutingProtocol::GetTypeId ()
   return tid;
 }
 
+Ipv6RoutingProtocol::Ipv6RoutingProtocol ()
+  : m_routingTableGeneration (0)
+{
+}
+
+uint64_t
+Ipv6RoutingProtocol::GetRoutingTableGeneration (void) const
+{
+  return m_routingTableGeneration;
+}
+
+void
+Ipv6RoutingProtocol::NotifyRoutingTableChanged (void)
+{
+  m_routingTableGeneration++;
+}
+
 } /* namespace ns3 */
 
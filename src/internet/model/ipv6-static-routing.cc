@@ -152,6 +152,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  NotifyRoutingTableChanged ();
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -165,6 +166,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  NotifyRoutingTableChanged ();
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
@@ -173,6 +175,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  NotifyRoutingTableChanged ();
 }
 
 void Ipv6StaticRouting::SetDefaultRoute (Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -197,6 +200,7 @@ void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   Ipv6Prefix networkMask = Ipv6Prefix (8);
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
   m_networkRoutes.push_back (std::make_pair (route, 0));
+  NotifyRoutingTableChanged ();
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -380,6 +384,7 @@ void Ipv6StaticRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  NotifyRoutingTableChanged ();
 
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
@@ -530,6 +535,7 @@ void Ipv6StaticRouting::RemoveRoute (uint32_t index)
         {
           delete it->first;
           m_networkRoutes.erase (it);
+          NotifyRoutingTableChanged ();
           return;
         }
       tmp++;
@@ -549,6 +555,7 @@ void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uin
         {
           delete it->first;
           m_networkRoutes.erase (it);
+          NotifyRoutingTableChanged ();
           return;
         }
     }
@@ -674,6 +681,7 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          NotifyRoutingTableChanged ();
         }
       else
         {
@@ -719,6 +727,7 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          NotifyRoutingTableChanged ();
         }
       else
         {
@@ -763,6 +772,7 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
             {
               delete j->first;
               j = m_networkRoutes.erase (j);
+              NotifyRoutingTableChanged ();
             }
           else
             {
@@ -549,6 +549,7 @@ void Rip::DoDispose ()
       delete j->first;
     }
   m_routes.clear ();
+  NotifyRoutingTableChanged ();
 
   m_nextTriggeredUpdate.Cancel ();
   m_nextUnsolicitedUpdate.Cancel ();
@@ -652,6 +653,7 @@ void Rip::AddNetworkRouteTo (Ipv4Address network, Ipv4Mask networkPrefix, Ipv4Ad
   route->SetRouteMetric (1);
   route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
   route->SetRouteChanged (true);
+  NotifyRoutingTableChanged ();
 
   m_routes.push_back (std::make_pair (route, EventId ()));
 }
@@ -664,6 +666,7 @@ void Rip::AddNetworkRouteTo (Ipv4Address network, Ipv4Mask networkPrefix, uint32
   route->SetRouteMetric (1);
   route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
   route->SetRouteChanged (true);
+  NotifyRoutingTableChanged ();
 
   m_routes.push_back (std::make_pair (route, EventId ()));
 }
@@ -679,6 +682,7 @@ void Rip::InvalidateRoute (RipRoutingTableEntry *route)
           route->SetRouteStatus (RipRoutingTableEntry::RIP_INVALID);
           route->SetRouteMetric (m_linkDown);
           route->SetRouteChanged (true);
+          NotifyRoutingTableChanged ();
           if (it->second.IsRunning ())
             {
               it->second.Cancel ();
@@ -700,6 +704,7 @@ void Rip::DeleteRoute (RipRoutingTableEntry *route)
         {
           delete route;
           m_routes.erase (it);
+          NotifyRoutingTableChanged ();
           return;
         }
     }
@@ -994,6 +999,7 @@ void Rip::HandleResponses (RipHeader hdr, Ipv4Address senderAddress, uint32_t in
                   it->first->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
                   it->first->SetRouteTag (iter->GetRouteTag ());
                   it->first->SetRouteChanged (true);
+                  NotifyRoutingTableChanged ();
                   it->second.Cancel ();
                   it->second = Simulator::Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it->first);
                   changed = true;
@@ -1014,6 +1020,7 @@ void Rip::HandleResponses (RipHeader hdr, Ipv4Address senderAddress, uint32_t in
                           route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
                           route->SetRouteTag (iter->GetRouteTag ());
                           route->SetRouteChanged (true);
+                          NotifyRoutingTableChanged ();
                           delete it->first;
                           it->first = route;
                           it->second.Cancel ();
@@ -1031,6 +1038,7 @@ void Rip::HandleResponses (RipHeader hdr, Ipv4Address senderAddress, uint32_t in
                       it->first->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
                       it->first->SetRouteTag (iter->GetRouteTag ());
                       it->first->SetRouteChanged (true);
+                      NotifyRoutingTableChanged ();
                       it->second.Cancel ();
                       it->second = Simulator::Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, it->first);
                     }
@@ -1050,6 +1058,7 @@ void Rip::HandleResponses (RipHeader hdr, Ipv4Address senderAddress, uint32_t in
           route->SetRouteMetric (rteMetric);
           route->SetRouteStatus (RipRoutingTableEntry::RIP_VALID);
           route->SetRouteChanged (true);
+          NotifyRoutingTableChanged ();
           m_routes.push_front (std::make_pair (route, EventId ()));
           EventId invalidateEvent = Simulator::Schedule (m_timeoutDelay, &Rip::InvalidateRoute, this, route);
           (m_routes.begin ())->second = invalidateEvent;
@@ -532,6 +532,7 @@ void RipNg::DoDispose ()
       delete j->first;
     }
   m_routes.clear ();
+  NotifyRoutingTableChanged ();
 
   m_nextTriggeredUpdate.Cancel ();
   m_nextUnsolicitedUpdate.Cancel ();
@@ -644,6 +645,7 @@ void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ip
   route->SetRouteMetric (1);
   route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
   route->SetRouteChanged (true);
+  NotifyRoutingTableChanged ();
 
   m_routes.push_back (std::make_pair (route, EventId ()));
 }
@@ -656,6 +658,7 @@ void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, ui
   route->SetRouteMetric (1);
   route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
   route->SetRouteChanged (true);
+  NotifyRoutingTableChanged ();
 
   m_routes.push_back (std::make_pair (route, EventId ()));
 }
@@ -671,6 +674,7 @@ void RipNg::InvalidateRoute (RipNgRoutingTableEntry *route)
           route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_INVALID);
           route->SetRouteMetric (m_linkDown);
           route->SetRouteChanged (true);
+          NotifyRoutingTableChanged ();
           if (it->second.IsRunning ())
             {
               it->second.Cancel ();
@@ -692,6 +696,7 @@ void RipNg::DeleteRoute (RipNgRoutingTableEntry *route)
         {
           delete route;
           m_routes.erase (it);
+          NotifyRoutingTableChanged ();
           return;
         }
     }
@@ -1005,6 +1010,7 @@ void RipNg::HandleResponses (RipNgHeader hdr, Ipv6Address senderAddress, uint32_
                   it->first->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
                   it->first->SetRouteTag (iter->GetRouteTag ());
                   it->first->SetRouteChanged (true);
+                  NotifyRoutingTableChanged ();
                   it->second.Cancel ();
                   it->second = Simulator::Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it->first);
                   changed = true;
@@ -1025,6 +1031,7 @@ void RipNg::HandleResponses (RipNgHeader hdr, Ipv6Address senderAddress, uint32_
                           route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
                           route->SetRouteTag (iter->GetRouteTag ());
                           route->SetRouteChanged (true);
+                          NotifyRoutingTableChanged ();
                           delete it->first;
                           it->first = route;
                           it->second.Cancel ();
@@ -1042,6 +1049,7 @@ void RipNg::HandleResponses (RipNgHeader hdr, Ipv6Address senderAddress, uint32_
                       it->first->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
                       it->first->SetRouteTag (iter->GetRouteTag ());
                       it->first->SetRouteChanged (true);
+                      NotifyRoutingTableChanged ();
                       it->second.Cancel ();
                       it->second = Simulator::Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, it->first);
                     }
@@ -1061,6 +1069,7 @@ void RipNg::HandleResponses (RipNgHeader hdr, Ipv6Address senderAddress, uint32_
           route->SetRouteMetric (rteMetric);
           route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_VALID);
           route->SetRouteChanged (true);
+          NotifyRoutingTableChanged ();
           m_routes.push_front (std::make_pair (route, EventId ()));
           EventId invalidateEvent = Simulator::Schedule (m_timeoutDelay, &RipNg::InvalidateRoute, this, route);
           (m_routes.begin ())->second = invalidateEvent;
@@ -23,6 +23,8 @@
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
 #include "ns3/object-vector.h"
+#include "ns3/timer-wheel.h"
+#include "ns3/tso-tag.h"
 
 #include "ns3/packet.h"
 #include "ns3/node.h"
@@ -47,6 +49,7 @@
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -84,6 +87,13 @@ TcpL4Protocol::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
                    MakeObjectVectorChecker<TcpSocketBase> ())
+    .AddAttribute ("TimerGranularity",
+                   "Granularity of the timer wheel shared by the retransmission "
+                   "and delayed ACK timers of the sockets; zero (the default) "
+                   "gives every timer its own simulator events.",
+                   TimeValue (Time (0)),
+                   MakeTimeAccessor (&TcpL4Protocol::m_timerGranularity),
+                   MakeTimeChecker (Time (0)))
   ;
   return tid;
 }
@@ -155,6 +165,7 @@ TcpL4Protocol::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_sockets.clear ();
+  m_timerWheel = 0;
 
   if (m_endPoints != 0)
     {
@@ -202,6 +213,16 @@ TcpL4Protocol::CreateSocket (void)
   return CreateSocket (m_congestionTypeId);
 }
 
+Ptr<TimerWheel>
+TcpL4Protocol::GetTimerWheel (void)
+{
+  if (m_timerWheel == 0 && m_timerGranularity.IsStrictlyPositive ())
+    {
+      m_timerWheel = Create<TimerWheel> (m_timerGranularity);
+    }
+  return m_timerWheel;
+}
+
 Ipv4EndPoint *
 TcpL4Protocol::Allocate (void)
 {
@@ -640,6 +661,43 @@ TcpL4Protocol::SendPacketV6 (Ptr<Packet> packet, const TcpHeader &outgoing,
     }
 }
 
+void
+TcpL4Protocol::SplitSuperSegment (Ptr<const Packet> packet,
+                                  const Address &saddr, const Address &daddr,
+                                  std::list<Ptr<Packet> > &segments)
+{
+  Ptr<Packet> payload = packet->Copy ();
+  TsoTag tsoTag;
+  bool found = payload->RemovePacketTag (tsoTag);
+  NS_ASSERT_MSG (found, "TcpL4Protocol::SplitSuperSegment(): not a super-segment");
+  TcpHeader header;
+  payload->RemoveHeader (header);
+
+  uint32_t payloadSize = payload->GetSize ();
+  uint32_t offset = 0;
+  while (offset < payloadSize)
+    {
+      uint32_t size = std::min (tsoTag.GetSegmentSize (), payloadSize - offset);
+      Ptr<Packet> segment = payload->CreateFragment (offset, size);
+
+      TcpHeader segmentHeader = header;
+      segmentHeader.SetSequenceNumber (header.GetSequenceNumber () + offset);
+      if (offset + size < payloadSize)
+        {
+          segmentHeader.SetFlags (header.GetFlags () & ~(TcpHeader::FIN | TcpHeader::PSH));
+        }
+      if (Node::ChecksumEnabled ())
+        {
+          segmentHeader.EnableChecksums ();
+        }
+      segmentHeader.InitializeChecksum (saddr, daddr, PROT_NUMBER);
+      segment->AddHeader (segmentHeader);
+
+      segments.push_back (segment);
+      offset += size;
+    }
+}
+
 void
 TcpL4Protocol::SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
                            const Address &saddr, const Address &daddr,
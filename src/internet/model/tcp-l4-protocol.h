@@ -22,10 +22,12 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <list>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/sequence-number.h"
+#include "ns3/nstime.h"
 #include "ip-l4-protocol.h"
 
 
@@ -41,6 +43,7 @@ class TcpSocketBase;
 class Ipv4EndPoint;
 class Ipv6EndPoint;
 class NetDevice;
+class TimerWheel;
 
 
 /**
@@ -115,6 +118,16 @@ public:
    */
   Ptr<Socket> CreateSocket (TypeId congestionTypeId);
 
+  /**
+   * \brief Get the timer wheel shared by the timers of the sockets
+   *
+   * The wheel is created on first use, with the granularity set by the
+   * TimerGranularity attribute.
+   *
+   * \return the timer wheel, or 0 if the TimerGranularity attribute is zero
+   */
+  Ptr<TimerWheel> GetTimerWheel (void);
+
   /**
    * \brief Allocate an IPv4 Endpoint
    * \return the Endpoint
@@ -205,6 +218,23 @@ public:
                    const Address &saddr, const Address &daddr,
                    Ptr<NetDevice> oif = 0) const;
 
+  /**
+   * \brief Split a super-segment into the segments it stands for
+   *
+   * Used by the IP layer before a device which does not support
+   * segmentation offload (see NetDevice::SupportsTso). Every segment gets
+   * a copy of the TCP header with its own sequence number and checksum;
+   * only the last one keeps the FIN and PSH flags.
+   *
+   * \param packet The super-segment, with its TCP header and TsoTag
+   * \param saddr The source address, for the checksum
+   * \param daddr The destination address, for the checksum
+   * \param segments The list the segments are appended to
+   */
+  static void SplitSuperSegment (Ptr<const Packet> packet,
+                                 const Address &saddr, const Address &daddr,
+                                 std::list<Ptr<Packet> > &segments);
+
   /**
    * \brief Make a socket fully operational
    *
@@ -309,6 +339,8 @@ private:
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
+  Time m_timerGranularity;         //!< Granularity of the timer wheel, zero if disabled
+  Ptr<TimerWheel> m_timerWheel;    //!< Timer wheel shared by the sockets
 
   /**
    * \brief Copy constructor
@@ -18,6 +18,7 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <algorithm>
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
@@ -113,9 +114,9 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size () && m_nextRxSeq > m_data.begin ()->first)
+  else if (m_data.size () && m_nextRxSeq > m_data.front ().head)
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return m_data.front ().head + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -136,6 +137,12 @@ TcpRxBuffer::Finished (void)
   return (m_gotFin && m_finSeq < m_nextRxSeq);
 }
 
+bool
+TcpRxBuffer::BlockEndsBefore (Block const &block, const SequenceNumber32 &seq)
+{
+  return block.tail < seq;
+}
+
 bool
 TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 {
@@ -151,72 +158,82 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
   if (m_data.size ())
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 maxSeq = m_data.front ().head + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
+  if (headSeq >= tailSeq)
+    {
+      NS_LOG_LOGIC ("Nothing to buffer");
+      return false; // Nothing to buffer anyway
+    }
+
+  // The blocks in [first, last) overlap the packet or are adjacent to it:
+  // they are coalesced with the packet into a single block, the packet
+  // filling the holes between them.
+  BufIterator first = std::lower_bound (m_data.begin (), m_data.end (), headSeq, BlockEndsBefore);
+  BufIterator last = first;
+  std::list<Ptr<Packet> > packets;
+  SequenceNumber32 seq = headSeq;
+  uint32_t stored = 0;
+  while (last != m_data.end () && last->head <= tailSeq)
     {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      if (lastByteSeq > headSeq)
+      if (last->head > seq)
         {
-          if (i->first > headSeq && lastByteSeq < tailSeq)
-            { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
-              m_data.erase (i++);
-              continue;
-            }
-          if (i->first <= headSeq)
-            { // Incoming head is overlapped
-              headSeq = lastByteSeq;
-            }
-          if (lastByteSeq >= tailSeq)
-            { // Incoming tail is overlapped
-              tailSeq = i->first;
-            }
+          uint32_t length = static_cast<uint32_t> (last->head - seq);
+          packets.push_back (p->CreateFragment (static_cast<uint32_t> (seq - tcph.GetSequenceNumber ()), length));
+          stored += length;
         }
-      ++i;
+      packets.splice (packets.end (), last->packets);
+      seq = std::max (seq, last->tail);
+      ++last;
     }
-  // We now know how much we are going to store, trim the packet
-  if (headSeq >= tailSeq)
+  if (seq < tailSeq)
+    {
+      uint32_t length = static_cast<uint32_t> (tailSeq - seq);
+      packets.push_back (p->CreateFragment (static_cast<uint32_t> (seq - tcph.GetSequenceNumber ()), length));
+      stored += length;
+    }
+  if (stored == 0)
     {
+      // Every byte is already there: give back the segments taken away
+      NS_ASSERT (first != last && last - first == 1);
+      first->packets.swap (packets);
       NS_LOG_LOGIC ("Nothing to buffer");
-      return false; // Nothing to buffer anyway
+      return false;
+    }
+
+  SequenceNumber32 blockHead = headSeq;
+  SequenceNumber32 blockTail = tailSeq;
+  if (first == last)
+    {
+      first = m_data.insert (first, Block ());
     }
   else
     {
-      uint32_t start = static_cast<uint32_t> (headSeq - tcph.GetSequenceNumber ());
-      uint32_t length = static_cast<uint32_t> (tailSeq - headSeq);
-      p = p->CreateFragment (start, length);
-      NS_ASSERT (length == p->GetSize ());
+      blockHead = std::min (blockHead, first->head);
+      blockTail = std::max (blockTail, (last - 1)->tail);
+      m_data.erase (first + 1, last);
     }
-  // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
+  first->head = blockHead;
+  first->tail = blockTail;
+  first->packets.swap (packets);
 
   if (headSeq > m_nextRxSeq)
     {
       // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      UpdateSackList (blockHead, blockTail);
     }
 
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
+  NS_LOG_LOGIC ("Buffered " << stored << " bytes from seqno=" << headSeq << " in block "
+                            << blockHead << "-" << blockTail);
   // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  m_size += stored;      // Occupancy
+  Block const &front = m_data.front ();
+  if (front.head <= m_nextRxSeq && front.tail > m_nextRxSeq)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+      m_availBytes += static_cast<uint32_t> (front.tail - m_nextRxSeq);
+      m_nextRxSeq = front.tail;
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -271,53 +288,22 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   //     following SACK blocks in the SACK option may be listed in
   //     arbitrary order.
 
-  m_sackList.push_front (current);
-
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
-  TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
-  while (it != m_sackList.end ())
+  // The block given is the whole contiguous block holding the segment, so
+  // every block previously reported that it touches is a subset of it.
+  TcpOptionSack::SackList::iterator it;
+  for (it = m_sackList.begin (); it != m_sackList.end (); )
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
-        {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
+      if (it->first >= head && it->second <= tail)
         {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          NS_ASSERT (it->second < head || it->first > tail);
+          it++;
         }
-
-      ++it;
     }
+  m_sackList.push_front (current);
 
   // Since the maximum blocks that fits into a TCP header are 4, there's no
   // point on maintaining the others.
@@ -325,11 +311,6 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
     {
       m_sackList.pop_back ();
     }
-
-  // Please note that, if a block b is discarded and then a block contiguos
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
 }
 
 void
@@ -370,38 +351,43 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   if (extractSize == 0) return nullptr;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
+  Block &block = m_data.front ();
+  NS_ASSERT (block.head <= m_nextRxSeq); // in-sequence data expected
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      Ptr<Packet> p = block.packets.front ();
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      uint32_t pktSize = p->GetSize ();
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
+          outPkt->AddAtEnd (p);
+          block.packets.pop_front ();
+          block.head += pktSize;
           m_size -= pktSize;
           m_availBytes -= pktSize;
           extractSize -= pktSize;
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
+          outPkt->AddAtEnd (p->CreateFragment (0, extractSize));
+          block.packets.front () = p->CreateFragment (extractSize, pktSize - extractSize);
+          block.head += extractSize;
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
         }
     }
+  if (block.packets.empty ())
+    {
+      m_data.erase (m_data.begin ());
+    }
   if (outPkt->GetSize () == 0)
     {
       NS_LOG_LOGIC ("Nothing extracted.");
       return nullptr;
     }
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
-                             << ", num pkts in buffer=" << m_data.size ());
+                             << ", num blocks in buffer=" << m_data.size ());
   return outPkt;
 }
 
@@ -21,7 +21,8 @@
 #ifndef TCP_RX_BUFFER_H
 #define TCP_RX_BUFFER_H
 
-#include <map>
+#include <list>
+#include <vector>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -67,6 +68,18 @@ class Packet;
  * For more information about the SACK list, please check the documentation of
  * the method GetSackList.
  *
+ * Storage
+ * -------
+ *
+ * The buffered data is kept as a vector of blocks sorted by sequence number.
+ * Each block is a maximal run of contiguous bytes, stored as the list of
+ * segments received for it: a segment adjacent to or overlapping existing
+ * blocks is coalesced with them, so the number of blocks is the number of
+ * holes in the received sequence space plus one, whatever the number of
+ * segments buffered.  Finding where a segment goes is a binary search, and
+ * the block holding a new segment is exactly the first SACK block that
+ * RFC 2018 asks to report.
+ *
  * \see GetSackList
  * \see UpdateSackList
  */
@@ -199,6 +212,9 @@ private:
    *
    * \param head sequence number of the block at the beginning
    * \param tail sequence number of the block at the end
+   *
+   * The block must be the whole contiguous block of buffered data holding
+   * the segment just received.
    */
   void UpdateSackList (const SequenceNumber32 &head, const SequenceNumber32 &tail);
 
@@ -217,15 +233,35 @@ private:
 
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
+  /**
+   * \brief A run of contiguous bytes held by the buffer
+   */
+  struct Block
+  {
+    SequenceNumber32 head;             //!< Seqnum of the first byte of the block
+    SequenceNumber32 tail;             //!< Seqnum following the last byte of the block
+    std::list<Ptr<Packet> > packets;   //!< Segments making the block, in sequence order
+  };
   /// container for data stored in the buffer
-  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  typedef std::vector<Block> BlockList;
+  /// iterator over the blocks stored in the buffer
+  typedef BlockList::iterator BufIterator;
+
+  /**
+   * \brief Order the blocks by their tail, for binary searches
+   * \param block a block
+   * \param seq a sequence number
+   * \returns true if the block ends before seq
+   */
+  static bool BlockEndsBefore (Block const &block, const SequenceNumber32 &seq);
+
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  BlockList m_data;                          //!< Buffered data, sorted and coalesced into disjoint blocks
 };
 
 } //namepsace ns3
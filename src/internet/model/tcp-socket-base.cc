@@ -43,6 +43,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
 #include "ns3/object.h"
+#include "ns3/tso-tag.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
 #include "ipv4-end-point.h"
@@ -64,6 +65,13 @@ NS_LOG_COMPONENT_DEFINE ("TcpSocketBase");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpSocketBase);
 
+namespace {
+
+/// Largest TCP payload whose length fits in the IP headers, with 20 bytes of IPv4 header and 60 bytes of TCP header
+const uint32_t TSO_MAX_PAYLOAD = 65535 - 20 - 60;
+
+} // unnamed namespace
+
 TypeId
 TcpSocketBase::GetTypeId (void)
 {
@@ -105,6 +113,14 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_timestampEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("TsoMaxSegments",
+                   "Maximum number of segments of new data handed to the IP layer "
+                   "as a single super-segment, emulating TCP segmentation offload. "
+                   "The devices modeling serialization time account for each "
+                   "segment of a super-segment; 1 disables the emulation.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsoMaxSegments),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("MinRto",
                    "Minimum retransmit timeout value",
                    TimeValue (Seconds (1.0)), // RFC 6298 says min RTO=1 sec, but Linux uses 200ms.
@@ -288,6 +304,7 @@ TcpSocketBase::TcpSocketBase (void)
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
+  m_delAckTimer.SetFunction (&TcpSocketBase::DelAckTimeout, this);
 
   bool ok;
 
@@ -354,6 +371,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_sndWindShift (sock.m_sndWindShift),
     m_timestampEnabled (sock.m_timestampEnabled),
     m_timestampToEcho (sock.m_timestampToEcho),
+    m_tsoMaxSegments (sock.m_tsoMaxSegments),
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
@@ -380,9 +398,15 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   m_txBuffer = CopyObject (sock.m_txBuffer);
   m_rxBuffer = CopyObject (sock.m_rxBuffer);
   m_tcb = CopyObject (sock.m_tcb);
+  if (m_tcp)
+    {
+      m_retxTimer.SetWheel (m_tcp->GetTimerWheel ());
+      m_delAckTimer.SetWheel (m_tcp->GetTimerWheel ());
+    }
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
+  m_delAckTimer.SetFunction (&TcpSocketBase::DelAckTimeout, this);
 
   if (sock.m_congestionControl)
     {
@@ -453,6 +477,13 @@ void
 TcpSocketBase::SetTcp (Ptr<TcpL4Protocol> tcp)
 {
   m_tcp = tcp;
+  // Retransmission and delayed ACK timers are pushed back or cancelled on
+  // nearly every segment: keep them on the wheel of the protocol.
+  Ptr<TimerWheel> wheel = tcp ? tcp->GetTimerWheel () : 0;
+  m_retxTimer.Cancel ();
+  m_retxTimer.SetWheel (wheel);
+  m_delAckTimer.Cancel ();
+  m_delAckTimer.SetWheel (wheel);
 }
 
 /* Set an RTT estimator with this socket */
@@ -1265,8 +1296,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
     { // Zero window: Enter persist state to send 1 byte to probe
       NS_LOG_LOGIC (this << " Enter zerowindow persist state");
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+                    (Simulator::Now () + GetReTxDelayLeft ()).GetSeconds ());
+      CancelReTxTimer ();
       NS_LOG_LOGIC ("Schedule persist timeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_persistTimeout).GetSeconds ());
@@ -1938,7 +1969,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      CancelReTxTimer ();
       m_delAckCount = m_delAckMaxCount;
       ReceivedData (packet, tcpHeader);
       Simulator::ScheduleNow (&TcpSocketBase::ConnectionSucceeded, this);
@@ -1961,7 +1992,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      CancelReTxTimer ();
       m_rxBuffer->SetNextRxSequence (tcpHeader.GetSequenceNumber () + SequenceNumber32 (1));
       m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
       m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
@@ -2005,7 +2036,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
       m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      CancelReTxTimer ();
       m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
       m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
       if (m_endPoint)
@@ -2039,7 +2070,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
       if (tcpHeader.GetSequenceNumber () == m_rxBuffer->NextRxSequence ())
         { // In-sequence FIN before connection complete. Set up connection and close.
           m_connected = true;
-          m_retxEvent.Cancel ();
+          CancelReTxTimer ();
           m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
           m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
           if (m_endPoint)
@@ -2306,7 +2337,7 @@ TcpSocketBase::Destroy (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + GetReTxDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2322,7 +2353,7 @@ TcpSocketBase::Destroy6 (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + GetReTxDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2416,7 +2447,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
   if (flags & TcpHeader::ACK)
     { // If sending an ACK, cancel the delay ACK as well
-      m_delAckEvent.Cancel ();
+      CancelDelAckTimer ();
       m_delAckCount = 0;
       if (m_highTxAck < header.GetAckNumber ())
         {
@@ -2443,12 +2474,21 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     }
 
 
-  if (m_retxEvent.IsExpired () && (hasSyn || hasFin) && !isAck )
+  if (IsReTxTimerExpired () && (hasSyn || hasFin) && !isAck )
     { // Retransmit SYN / SYN+ACK / FIN / FIN+ACK to guard against lost
       NS_LOG_LOGIC ("Schedule retransmission timeout at time "
                     << Simulator::Now ().GetSeconds () << " to expire at time "
                     << (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
+      if (m_retxTimer.GetWheel ())
+        {
+          m_retxTimer.SetFunction (&TcpSocketBase::SendEmptyPacket, this);
+          m_retxTimer.SetArguments (flags);
+          m_retxTimer.Schedule (m_rto);
+        }
+      else
+        {
+          m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
+        }
     }
 }
 
@@ -2545,6 +2585,43 @@ TcpSocketBase::SetupEndpoint6 ()
   return 0;
 }
 
+bool
+TcpSocketBase::OutputDeviceSupportsTso (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Socket::SocketErrno errno_;
+  Ptr<NetDevice> oif = m_boundnetdevice;
+  if (m_endPoint != nullptr)
+    {
+      Ptr<Ipv4> ipv4 = m_node->GetObject<Ipv4> ();
+      if (ipv4 == nullptr || ipv4->GetRoutingProtocol () == nullptr)
+        {
+          return false;
+        }
+      Ipv4Header header;
+      header.SetSource (m_endPoint->GetLocalAddress ());
+      header.SetDestination (m_endPoint->GetPeerAddress ());
+      header.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+      Ptr<Ipv4Route> route = ipv4->GetRoutingProtocol ()->RouteOutput (Ptr<Packet> (), header, oif, errno_);
+      return route != nullptr && route->GetOutputDevice ()->SupportsTso ();
+    }
+  if (m_endPoint6 != nullptr)
+    {
+      Ptr<Ipv6L3Protocol> ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
+      if (ipv6 == nullptr || ipv6->GetRoutingProtocol () == nullptr)
+        {
+          return false;
+        }
+      Ipv6Header header;
+      header.SetSourceAddress (m_endPoint6->GetLocalAddress ());
+      header.SetDestinationAddress (m_endPoint6->GetPeerAddress ());
+      header.SetNextHeader (TcpL4Protocol::PROT_NUMBER);
+      Ptr<Ipv6Route> route = ipv6->GetRoutingProtocol ()->RouteOutput (Ptr<Packet> (), header, oif, errno_);
+      return route != nullptr && route->GetOutputDevice ()->SupportsTso ();
+    }
+  return false;
+}
+
 /* This function is called only if a SYN received in LISTEN state. After
    TcpSocketBase cloned, allocate a new end point to handle the incoming
    connection and send a SYN+ACK to complete the handshake. */
@@ -2680,11 +2757,15 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   if (withAck)
     {
-      m_delAckEvent.Cancel ();
+      CancelDelAckTimer ();
       m_delAckCount = 0;
     }
 
   AddSocketTags (p);
+  if (sz > m_tcb->m_segmentSize)
+    {
+      p->AddPacketTag (TsoTag (sz, m_tcb->m_segmentSize));
+    }
 
   if (m_closeOnEmpty && (remainingData == 0))
     {
@@ -2717,14 +2798,22 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
-  if (m_retxEvent.IsExpired ())
+  if (IsReTxTimerExpired ())
     {
       // Schedules retransmit timeout. m_rto should be already doubled.
 
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      if (m_retxTimer.GetWheel ())
+        {
+          m_retxTimer.SetFunction (&TcpSocketBase::ReTxTimeout, this);
+          m_retxTimer.Schedule (m_rto);
+        }
+      else
+        {
+          m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+        }
     }
 
   m_txTrace (p, header, this);
@@ -2801,6 +2890,7 @@ TcpSocketBase::SendPendingData (bool withAck)
 
   uint32_t nPacketsSent = 0;
   uint32_t availableWindow = AvailableWindow ();
+  bool tso = m_tsoMaxSegments > 1 && OutputDeviceSupportsTso ();
 
   // RFC 6675, Section (C)
   // If cwnd - pipe >= 1 SMSS, the sender SHOULD transmit one or more
@@ -2869,6 +2959,17 @@ TcpSocketBase::SendPendingData (bool withAck)
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
 
+          // Segmentation offload: new data goes out as super-segments of
+          // whole segments, which must fit in the IP length field.
+          // Retransmissions keep the segment granularity.
+          if (tso && next == m_tcb->m_highTxMark
+              && availableWindow >= 2 * m_tcb->m_segmentSize)
+            {
+              uint32_t nSegments = std::min (availableWindow / m_tcb->m_segmentSize, m_tsoMaxSegments);
+              nSegments = std::min (nSegments, TSO_MAX_PAYLOAD / m_tcb->m_segmentSize);
+              s = std::max (nSegments, 1U) * m_tcb->m_segmentSize;
+            }
+
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
           //       retransmitted segment unless NextSeg () rule (4) was
@@ -3022,6 +3123,9 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   NS_LOG_DEBUG ("Data segment, seq=" << tcpHeader.GetSequenceNumber () <<
                 " pkt size=" << p->GetSize () );
 
+  TsoTag tsoTag;
+  uint32_t nSegments = p->PeekPacketTag (tsoTag) ? tsoTag.GetNSegments () : 1;
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_rxBuffer->NextRxSequence ();
   if (!m_rxBuffer->Add (p, tcpHeader))
@@ -3056,20 +3160,30 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
       SendEmptyPacket (TcpHeader::ACK);
     }
   else
-    { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+    { // In-sequence packet: ACK if delayed ack count allows. A
+      // super-segment counts as the segments it was made of, as if they had
+      // been coalesced by the receiver.
+      m_delAckCount += nSegments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
-          m_delAckEvent.Cancel ();
+          CancelDelAckTimer ();
           m_delAckCount = 0;
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
           SendEmptyPacket (TcpHeader::ACK);
         }
-      else if (m_delAckEvent.IsExpired ())
+      else if (m_delAckEvent.IsExpired () && m_delAckTimer.IsExpired ())
         {
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
+          if (m_delAckTimer.GetWheel ())
+            {
+              m_delAckTimer.Schedule (m_delAckTimeout);
+            }
+          else
+            {
+              m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
+                                                   &TcpSocketBase::DelAckTimeout, this);
+            }
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
-                        (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
+                        (Simulator::Now () + m_delAckTimeout).GetSeconds ());
         }
     }
 }
@@ -3144,8 +3258,8 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_state != SYN_RCVD && resetRTO)
     { // Set RTO unless the ACK is received in SYN_RCVD state
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+                    (Simulator::Now () + GetReTxDelayLeft ()).GetSeconds ());
+      CancelReTxTimer ();
       // On receiving a "New" ack we restart retransmission timer .. RFC 6298
       // RFC 6298, clause 2.4
       m_rto = Max (m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4), m_minRto);
@@ -3153,7 +3267,15 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
       NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      if (m_retxTimer.GetWheel ())
+        {
+          m_retxTimer.SetFunction (&TcpSocketBase::ReTxTimeout, this);
+          m_retxTimer.Schedule (m_rto);
+        }
+      else
+        {
+          m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+        }
     }
 
   // Note the highest ACK and tell app to send more
@@ -3171,8 +3293,8 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_txBuffer->Size () == 0 && m_state != FIN_WAIT_1 && m_state != CLOSING)
     { // No retransmit timer if no data to retransmit
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+                    (Simulator::Now () + GetReTxDelayLeft ()).GetSeconds ());
+      CancelReTxTimer ();
     }
 }
 
@@ -3403,15 +3525,57 @@ TcpSocketBase::DoRetransmit ()
 void
 TcpSocketBase::CancelAllTimers ()
 {
-  m_retxEvent.Cancel ();
+  CancelReTxTimer ();
   m_persistEvent.Cancel ();
-  m_delAckEvent.Cancel ();
+  CancelDelAckTimer ();
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
   m_pacingTimer.Cancel ();
 }
 
+WheelTimer &
+TcpSocketBase::GetReTxTimer (void)
+{
+  return m_retxTimer;
+}
+
+WheelTimer &
+TcpSocketBase::GetDelAckTimer (void)
+{
+  return m_delAckTimer;
+}
+
+void
+TcpSocketBase::CancelReTxTimer (void)
+{
+  m_retxEvent.Cancel ();
+  m_retxTimer.Cancel ();
+}
+
+bool
+TcpSocketBase::IsReTxTimerExpired (void) const
+{
+  return m_retxEvent.IsExpired () && m_retxTimer.IsExpired ();
+}
+
+Time
+TcpSocketBase::GetReTxDelayLeft (void) const
+{
+  if (m_retxTimer.IsRunning ())
+    {
+      return m_retxTimer.GetDelayLeft ();
+    }
+  return Simulator::GetDelayLeft (m_retxEvent);
+}
+
+void
+TcpSocketBase::CancelDelAckTimer (void)
+{
+  m_delAckEvent.Cancel ();
+  m_delAckTimer.Cancel ();
+}
+
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
 void
 TcpSocketBase::TimeWait ()
@@ -28,6 +28,7 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/timer.h"
+#include "ns3/timer-wheel.h"
 #include "ns3/sequence-number.h"
 #include "ns3/data-rate.h"
 #include "ns3/node.h"
@@ -619,6 +620,14 @@ protected:
    */
   int SetupEndpoint6 (void);
 
+  /**
+   * \brief Check whether the route to the peer goes through a device
+   * supporting segmentation offload (see NetDevice::SupportsTso)
+   *
+   * \returns true if super-segments can be sent to the peer
+   */
+  bool OutputDeviceSupportsTso (void) const;
+
   /**
    * \brief Complete a connection by forking the socket
    *
@@ -791,6 +800,27 @@ protected:
    */
   void CancelAllTimers (void);
 
+  /**
+   * \brief Get the retransmission timer kept on the timer wheel
+   *
+   * Retransmission timeouts are scheduled on this timer when the
+   * TcpL4Protocol has a timer wheel (see its TimerGranularity attribute),
+   * and in m_retxEvent otherwise.
+   *
+   * \return the retransmission timer
+   */
+  WheelTimer & GetReTxTimer (void);
+
+  /**
+   * \brief Get the delayed ACK timer kept on the timer wheel
+   *
+   * Delayed ACK timeouts are scheduled on this timer when the TcpL4Protocol
+   * has a timer wheel, and in m_delAckEvent otherwise.
+   *
+   * \return the delayed ACK timer
+   */
+  WheelTimer & GetDelAckTimer (void);
+
   /**
    * \brief Move from CLOSING or FIN_WAIT_2 to TIME_WAIT state
    */
@@ -1216,6 +1246,7 @@ protected:
   uint8_t m_sndWindShift      {0};    //!< Window shift to apply to incoming segments
   bool     m_timestampEnabled {true}; //!< Timestamp option enabled
   uint32_t m_timestampToEcho  {0};    //!< Timestamp to echo
+  uint32_t m_tsoMaxSegments   {1};    //!< Maximum number of segments sent as one super-segment
 
   EventId m_sendPendingDataEvent {}; //!< micro-delay event to send pending data
 
@@ -1245,6 +1276,32 @@ protected:
    * \brief Inflated congestion window trace (not used in the real code, deprecated)
    */
   TracedValue<uint32_t> m_cWndInfl {0};
+
+private:
+  /**
+   * \brief Cancel the retransmission event or timer
+   */
+  void CancelReTxTimer (void);
+
+  /**
+   * \brief Check whether a retransmission timeout is pending
+   * \return true if neither the retransmission event nor the timer is running
+   */
+  bool IsReTxTimerExpired (void) const;
+
+  /**
+   * \brief Get the time left before the retransmission timeout
+   * \return the time left, or zero if no timeout is pending
+   */
+  Time GetReTxDelayLeft (void) const;
+
+  /**
+   * \brief Cancel the delayed ACK event or timer
+   */
+  void CancelDelAckTimer (void);
+
+  WheelTimer m_retxTimer;   //!< Retransmission timer, on the timer wheel of m_tcp
+  WheelTimer m_delAckTimer; //!< Delayed ACK timer, on the timer wheel of m_tcp
 };
 
 /**
@@ -96,7 +96,7 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n), m_lostMark (n)
 {
 }
 
@@ -169,6 +169,7 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostMark = seq;
 }
 
 bool
@@ -294,7 +295,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  IndexItem (m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -308,36 +309,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  auto found = m_sentIndex.find (seq);
+  if (found != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = found->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -347,6 +345,7 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
     {
       m_retrans += item->m_packet->GetSize ();
       item->m_retrans = true;
+      ReindexFlags (item);
     }
 
   return item;
@@ -398,7 +397,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -434,12 +433,25 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   TcpTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool isSentList = (&list == &m_sentList);
+
+  if (isSentList)
+    {
+      // Start from the sent item holding seq
+      auto found = m_sentIndex.upper_bound (seq);
+      if (found != m_sentIndex.begin ())
+        {
+          --found;
+          it = found->second;
+          beginOfCurrentPacket = found->first;
+        }
+    }
 
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!isSentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -466,10 +478,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                            " and now we recurse because packet ends at "
                                         << beginOfCurrentPacket + currentPacket->GetSize ());
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (isSentList)
+                {
+                  UnindexItem (currentItem);
+                }
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstIt = list.insert (it, firstPart);
+              if (isSentList)
+                {
+                  IndexItem (firstIt);
+                  IndexItem (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -513,11 +534,22 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                   // current > outPacket in the list. Merge current with the
                   // previous, and recurse.
                   NS_ASSERT (it != list.begin ());
-                  TcpTxItem *previous = *(--it);
+                  PacketList::iterator currentIt = it;
+                  PacketList::iterator previousIt = --it;
+                  TcpTxItem *previous = *previousIt;
 
-                  list.erase (it);
+                  if (isSentList)
+                    {
+                      UnindexItem (previous);
+                      UnindexItem (currentItem);
+                    }
+                  list.erase (currentIt);
 
                   MergeItems (previous, currentItem);
+                  if (isSentList)
+                    {
+                      IndexItem (previousIt);
+                    }
                   delete currentItem;
                   if (listEdited)
                     {
@@ -532,10 +564,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               // the end is inside the current packet, but it isn't exactly
               // the packet end. Just fragment, fix the list, and return.
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (isSentList)
+                {
+                  UnindexItem (currentItem);
+                }
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstIt = list.insert (it, firstPart);
+              if (isSentList)
+                {
+                  IndexItem (firstIt);
+                  IndexItem (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -562,9 +603,20 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
           // with the packet that follows, and recurse
           TcpTxItem *next = (*it); // Please remember we have incremented it
                                    // in the previous if
+          PacketList::iterator currentIt = it;
+          --currentIt;
 
+          if (isSentList)
+            {
+              UnindexItem (currentItem);
+              UnindexItem (next);
+            }
           MergeItems (currentItem, next);
           list.erase (it);
+          if (isSentList)
+            {
+              IndexItem (currentIt);
+            }
 
           delete next;
 
@@ -693,6 +745,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
           RemoveFromCounts (item, pktSize);
 
+          UnindexItem (item);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -703,9 +756,11 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
         { // Part of the packet is behind the seqnum. Fragment
           pktSize -= offset;
           NS_LOG_INFO (*item);
+          UnindexItem (item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
+          IndexItem (i);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -735,6 +790,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // when adding Reno dupacks in the count.
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          ReindexFlags (head);
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -749,6 +805,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
     {
       m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
+  if (m_lostMark < m_firstByteSeq)
+    {
+      m_lostMark = m_firstByteSeq;
+    }
 
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
                 " retrans: " << m_retrans << " sacked: " << m_sackedOut);
@@ -768,15 +828,21 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // Only the items starting inside the block can be sacked
+      auto found = m_sentIndex.lower_bound ((*option_it).first);
+      if (found == m_sentIndex.end ())
+        {
+          continue;
+        }
+      PacketList::iterator item_it = found->second;
+      SequenceNumber32 beginOfCurrentPacket = found->first;
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
@@ -806,6 +872,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
                   (*item_it)->m_sacked = true;
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
+                  ReindexFlags (*item_it);
 
                   if (m_highestSack.first == m_sentList.end()
                       || m_highestSack.second <= beginOfCurrentPacket + pktSize)
@@ -853,7 +920,6 @@ TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
   if (m_highestSack.first == m_sentList.end ())
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
@@ -865,32 +931,43 @@ TcpTxBuffer::UpdateLostCount ()
                    ", will start from item " << *(*m_highestSack.first));
     }
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  // Find the item below which every segment is lost, unless sacked: it is
+  // the m_dupAckThresh-th sacked item counting down from the highest sacked
+  // one, the head excluded
+  PacketList::const_iterator it = m_highestSack.first;
+  SeqSet::iterator sackedIt = m_sackedIndex.upper_bound ((*it)->m_startSeq);
+  while (sacked < m_dupAckThresh && sackedIt != m_sackedIndex.begin ()
+         && *(--sackedIt) != m_firstByteSeq)
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          sacked++;
-        }
+      sacked++;
+      it = m_sentIndex[*sackedIt];
+    }
 
-      if (sacked >= m_dupAckThresh)
+  if (sacked >= m_dupAckThresh)
+    {
+      SequenceNumber32 lostMark = (*it)->m_startSeq;
+      // The items before m_lostMark are already lost or sacked
+      for (; it != m_sentList.begin () && (*it)->m_startSeq >= m_lostMark; --it)
         {
+          TcpTxItem *item = *it;
           if (!item->m_sacked && !item->m_lost)
             {
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
+              ReindexFlags (item);
             }
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
-    }
 
-  if (sacked >= m_dupAckThresh)
-    {
       TcpTxItem *item = *m_sentList.begin ();
       if (!item->m_lost)
         {
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          ReindexFlags (item);
+        }
+      if (m_lostMark < lostMark)
+        {
+          m_lostMark = lostMark;
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -902,38 +979,26 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first item starting at or after seq which is lost or sacked decides
+  SeqSet::const_iterator lost = m_lostIndex.lower_bound (seq);
+  if (lost == m_lostIndex.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
-        }
-
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      return false;
+    }
+  SeqSet::const_iterator sacked = m_sackedIndex.lower_bound (seq);
+  if (sacked != m_sackedIndex.end () && *sacked < *lost)
+    {
+      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+      return false;
     }
 
-  return false;
+  NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+  return true;
 }
 
 bool
@@ -954,35 +1019,11 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (!m_pendingLostIndex.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      NS_LOG_INFO("IsLost, returning" << *m_pendingLostIndex.begin ());
+      *seq = *m_pendingLostIndex.begin ();
+      return true;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,10 +1049,10 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery && !m_pendingIndex.empty ())
     {
-      NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
-      *seq = seqPerRule3;
+      NS_LOG_INFO ("Rule3 valid. " << *m_pendingIndex.begin ());
+      *seq = *m_pendingIndex.begin ();
       return true;
     }
 
@@ -1180,12 +1221,15 @@ TcpTxBuffer::ResetRenoSack ()
   NS_LOG_FUNCTION (this);
 
   m_sackedOut = 0;
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  while (!m_sackedIndex.empty ())
     {
-      (*it)->m_sacked = false;
+      TcpTxItem *item = *m_sentIndex[*m_sackedIndex.begin ()];
+      item->m_sacked = false;
+      ReindexFlags (item);
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostMark = m_firstByteSeq;
 }
 
 void
@@ -1203,6 +1247,9 @@ TcpTxBuffer::ResetSentList ()
       m_sentList.pop_back ();
     }
 
+  m_sentIndex.clear ();
+  ClearFlagIndexes ();
+
   m_sentSize = 0;
   m_lostOut = 0;
   m_retrans = 0;
@@ -1218,6 +1265,7 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      UnindexItem (item);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1271,6 +1319,12 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       (*it)->m_retrans = false;
     }
 
+  ClearFlagIndexes ();
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      IndexFlags (*it);
+    }
+
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   ConsistencyCheck ();
@@ -1303,6 +1357,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      ReindexFlags (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1332,6 +1387,7 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+      ReindexFlags (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1358,6 +1414,7 @@ TcpTxBuffer::AddRenoSack (void)
     {
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
+      ReindexFlags (*it);
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
@@ -1406,6 +1463,95 @@ TcpTxBuffer::ConsistencyCheck () const
                  " stored lost: " << m_lostOut);
   NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
                  " stored retrans: " << m_retrans);
+
+  uint32_t nLost = 0, nSacked = 0, nPending = 0, nPendingLost = 0;
+  NS_ASSERT (m_sentIndex.size () == m_sentList.size ());
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      const TcpTxItem *item = *it;
+      auto found = m_sentIndex.find (item->m_startSeq);
+      NS_ASSERT_MSG (found != m_sentIndex.end () && found->second == it,
+                     "Item " << *item << " not indexed");
+      bool pending = !item->m_sacked && !item->m_retrans;
+      NS_ASSERT (m_lostIndex.count (item->m_startSeq) == (item->m_lost ? 1 : 0));
+      NS_ASSERT (m_sackedIndex.count (item->m_startSeq) == (item->m_sacked ? 1 : 0));
+      NS_ASSERT (m_pendingIndex.count (item->m_startSeq) == (pending ? 1 : 0));
+      NS_ASSERT (m_pendingLostIndex.count (item->m_startSeq) == (pending && item->m_lost ? 1 : 0));
+      NS_ASSERT_MSG (item->m_startSeq >= m_lostMark || item == m_sentList.front ()
+                     || item->m_lost || item->m_sacked,
+                     "Item " << *item << " below the lost mark " << m_lostMark);
+      nLost += item->m_lost ? 1 : 0;
+      nSacked += item->m_sacked ? 1 : 0;
+      nPending += pending ? 1 : 0;
+      nPendingLost += pending && item->m_lost ? 1 : 0;
+    }
+  NS_ASSERT (m_lostIndex.size () == nLost);
+  NS_ASSERT (m_sackedIndex.size () == nSacked);
+  NS_ASSERT (m_pendingIndex.size () == nPending);
+  NS_ASSERT (m_pendingLostIndex.size () == nPendingLost);
+}
+
+void
+TcpTxBuffer::IndexItem (PacketList::iterator it)
+{
+  const TcpTxItem *item = *it;
+  NS_ASSERT (m_sentIndex.find (item->m_startSeq) == m_sentIndex.end ());
+  m_sentIndex[item->m_startSeq] = it;
+  IndexFlags (item);
+}
+
+void
+TcpTxBuffer::UnindexItem (const TcpTxItem *item)
+{
+  m_sentIndex.erase (item->m_startSeq);
+  UnindexFlags (item);
+}
+
+void
+TcpTxBuffer::ReindexFlags (const TcpTxItem *item)
+{
+  UnindexFlags (item);
+  IndexFlags (item);
+}
+
+void
+TcpTxBuffer::IndexFlags (const TcpTxItem *item)
+{
+  if (item->m_lost)
+    {
+      m_lostIndex.insert (item->m_startSeq);
+    }
+  if (item->m_sacked)
+    {
+      m_sackedIndex.insert (item->m_startSeq);
+    }
+  else if (!item->m_retrans)
+    {
+      m_pendingIndex.insert (item->m_startSeq);
+      if (item->m_lost)
+        {
+          m_pendingLostIndex.insert (item->m_startSeq);
+        }
+    }
+}
+
+void
+TcpTxBuffer::UnindexFlags (const TcpTxItem *item)
+{
+  m_lostIndex.erase (item->m_startSeq);
+  m_sackedIndex.erase (item->m_startSeq);
+  m_pendingIndex.erase (item->m_startSeq);
+  m_pendingLostIndex.erase (item->m_startSeq);
+}
+
+void
+TcpTxBuffer::ClearFlagIndexes ()
+{
+  m_lostIndex.clear ();
+  m_sackedIndex.clear ();
+  m_pendingIndex.clear ();
+  m_pendingLostIndex.clear ();
+  m_lostMark = m_firstByteSeq;
 }
 
 std::ostream &
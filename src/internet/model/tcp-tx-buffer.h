@@ -22,6 +22,9 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <list>
+#include <map>
+#include <set>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -102,8 +105,19 @@ public:
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of finding the
+ * segments covered by a SACK block and setting the SACK flag on them.
+ *
+ * To avoid walking the list of sent segments from its head for each SACK
+ * block and each query, the sent items are indexed by their starting
+ * sequence number, and the sequence numbers of the items with a given
+ * combination of flags (lost, sacked, neither sacked nor retransmitted...)
+ * are kept in ordered sets. Applying a SACK block, asking if a sequence is
+ * lost, or choosing the next segment to retransmit are then logarithmic in
+ * the number of segments in flight, and marking segments as lost only visits
+ * the segments which were not already lost. The flags of an item of the sent
+ * list must therefore be changed only through methods which update the
+ * indexes as well.
  *
  * Item properties
  * ---------------
@@ -426,8 +440,8 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. Since a segment marked lost stays lost, the
+   * walk stops at m_lostMark, below which every segment is lost or sacked.
    *
    */
   void UpdateLostCount ();
@@ -560,7 +574,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -592,6 +606,47 @@ private:
    */
   void ConsistencyCheck () const;
 
+  /**
+   * \brief Add an item of the sent list to the indexes
+   * \param it iterator to the item in m_sentList
+   */
+  void IndexItem (PacketList::iterator it);
+
+  /**
+   * \brief Remove an item of the sent list from the indexes
+   *
+   * Must be called before the starting sequence of the item is changed, or
+   * before the item is removed from the sent list.
+   *
+   * \param item the item
+   */
+  void UnindexItem (const TcpTxItem *item);
+
+  /**
+   * \brief Update the flag indexes after a change of the flags of an item
+   * of the sent list
+   * \param item the item
+   */
+  void ReindexFlags (const TcpTxItem *item);
+
+  /**
+   * \brief Add an item of the sent list to the flag indexes
+   * \param item the item
+   */
+  void IndexFlags (const TcpTxItem *item);
+
+  /**
+   * \brief Remove an item of the sent list from the flag indexes
+   * \param item the item
+   */
+  void UnindexFlags (const TcpTxItem *item);
+
+  /**
+   * \brief Forget all the items of the sent list in the flag indexes, and
+   * the items known to be lost or sacked
+   */
+  void ClearFlagIndexes ();
+
   /**
    * \brief Find the highest SACK byte
    * \return a pair with the highest byte and an iterator inside m_sentList
@@ -599,13 +654,22 @@ private:
   std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
   FindHighestSacked () const;
 
+  /// Ordered set of starting sequences of items in the sent list
+  typedef std::set<SequenceNumber32> SeqSet;
+
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  std::map<SequenceNumber32, PacketList::iterator> m_sentIndex; //!< Items of m_sentList by starting sequence
+  SeqSet m_lostIndex;         //!< Items marked lost
+  SeqSet m_sackedIndex;       //!< Items marked sacked
+  SeqSet m_pendingIndex;      //!< Items neither sacked nor retransmitted
+  SeqSet m_pendingLostIndex;  //!< Items lost, and neither sacked nor retransmitted
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
+  SequenceNumber32 m_lostMark; //!< Every item of the sent list starting before this sequence is lost or sacked
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
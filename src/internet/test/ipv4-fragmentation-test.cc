@@ -46,6 +46,8 @@
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/error-channel.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/udp-header.h"
 
 #include <string>
 #include <limits>
@@ -512,6 +514,252 @@ Ipv4FragmentationTest::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 reassembly of fragments received out of order
+ *
+ * Several datagrams are fragmented by hand and their fragments handed to
+ * Ipv4L3Protocol interleaved, out of order, duplicated and overlapping.
+ * Each datagram must be delivered once, intact, as soon as its last
+ * missing fragment arrives, and a datagram left incomplete must be dropped
+ * when its expiration timeout is reached, even if the timeout was lowered
+ * after other datagrams started to be reassembled.
+ */
+class Ipv4ReassemblyTest : public TestCase
+{
+public:
+  Ipv4ReassemblyTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Build a fragment of a datagram
+   * \param id identification of the datagram
+   * \param datagram the UDP datagram
+   * \param offset offset of the fragment
+   * \param size size of the fragment
+   * \return the fragment, with its IPv4 header
+   */
+  Ptr<Packet> MakeFragment (uint16_t id, Ptr<Packet> datagram, uint32_t offset, uint32_t size);
+
+  /**
+   * \brief Hand a fragment to the IPv4 protocol
+   * \param fragment the fragment
+   */
+  void Deliver (Ptr<Packet> fragment);
+
+  /**
+   * \brief Change the expiration timeout of the IPv4 protocol
+   * \param timeout the new timeout
+   */
+  void SetExpirationTimeout (Time timeout);
+
+  /**
+   * \brief Receive the datagrams
+   * \param socket the receiving socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+
+  /**
+   * \brief Drop trace sink
+   * \param header the IPv4 header
+   * \param packet the packet
+   * \param reason the drop reason
+   * \param ipv4 the IPv4 protocol
+   * \param interface the interface
+   */
+  void Drop (const Ipv4Header &header, Ptr<const Packet> packet, Ipv4L3Protocol::DropReason reason,
+             Ptr<Ipv4> ipv4, uint32_t interface);
+
+  static const uint32_t DATAGRAM_SIZE = 5008; //!< Size of the UDP datagrams, header included
+
+  Ptr<Ipv4L3Protocol> m_ipv4;       //!< The IPv4 protocol receiving the fragments
+  Ptr<NetDevice> m_device;          //!< The device receiving the fragments
+  std::vector<Time> m_received;     //!< Time each datagram was received
+  std::vector<Time> m_dropped;      //!< Time each datagram was dropped
+  bool m_corrupted;                 //!< A datagram was not received intact
+};
+
+Ipv4ReassemblyTest::Ipv4ReassemblyTest ()
+  : TestCase ("Verify the reassembly of IPv4 fragments received out of order")
+{
+}
+
+Ptr<Packet>
+Ipv4ReassemblyTest::MakeFragment (uint16_t id, Ptr<Packet> datagram, uint32_t offset, uint32_t size)
+{
+  Ptr<Packet> fragment = datagram->CreateFragment (offset, size);
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.0.2"));
+  header.SetDestination (Ipv4Address ("10.0.0.1"));
+  header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  header.SetIdentification (id);
+  header.SetTtl (64);
+  header.SetPayloadSize (size);
+  header.SetFragmentOffset (offset);
+  if (offset + size < datagram->GetSize ())
+    {
+      header.SetMoreFragments ();
+    }
+  else
+    {
+      header.SetLastFragment ();
+    }
+  fragment->AddHeader (header);
+  return fragment;
+}
+
+void
+Ipv4ReassemblyTest::Deliver (Ptr<Packet> fragment)
+{
+  m_ipv4->Receive (m_device, fragment, Ipv4L3Protocol::PROT_NUMBER,
+                   m_device->GetBroadcast (), m_device->GetAddress (), NetDevice::PACKET_HOST);
+}
+
+void
+Ipv4ReassemblyTest::SetExpirationTimeout (Time timeout)
+{
+  m_ipv4->SetAttribute ("FragmentExpirationTimeout", TimeValue (timeout));
+}
+
+void
+Ipv4ReassemblyTest::HandleRead (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      uint8_t buffer[DATAGRAM_SIZE];
+      uint32_t size = packet->CopyData (buffer, sizeof (buffer));
+      uint8_t id = buffer[0];
+      if (size != DATAGRAM_SIZE - 8 || id >= m_received.size () || !m_received[id].IsNegative ())
+        {
+          m_corrupted = true;
+          continue;
+        }
+      for (uint32_t i = 1; i < size; i++)
+        {
+          if (buffer[i] != uint8_t (i * 7 + id))
+            {
+              m_corrupted = true;
+            }
+        }
+      m_received[id] = Simulator::Now ();
+    }
+}
+
+void
+Ipv4ReassemblyTest::Drop (const Ipv4Header &header, Ptr<const Packet> packet, Ipv4L3Protocol::DropReason reason,
+                          Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (reason == Ipv4L3Protocol::DROP_FRAGMENT_TIMEOUT && header.GetIdentification () < m_dropped.size ())
+    {
+      m_dropped[header.GetIdentification ()] = Simulator::Now ();
+    }
+}
+
+void
+Ipv4ReassemblyTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices = devHelper.Install (node);
+  InternetStackHelper stack;
+  stack.Install (node);
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.0");
+  address.Assign (devices);
+  m_ipv4 = node->GetObject<Ipv4L3Protocol> ();
+  m_device = devices.Get (0);
+  m_ipv4->TraceConnectWithoutContext ("Drop", MakeCallback (&Ipv4ReassemblyTest::Drop, this));
+
+  Ptr<Socket> socket = Socket::CreateSocket (node, UdpSocketFactory::GetTypeId ());
+  socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  socket->SetRecvCallback (MakeCallback (&Ipv4ReassemblyTest::HandleRead, this));
+
+  // Six datagrams, cut in fragments of 1000 bytes
+  const uint32_t nDatagrams = 6;
+  std::vector<std::vector<Ptr<Packet> > > fragments (nDatagrams);
+  for (uint32_t id = 0; id < nDatagrams; id++)
+    {
+      uint8_t payload[DATAGRAM_SIZE - 8];
+      payload[0] = id;
+      for (uint32_t i = 1; i < sizeof (payload); i++)
+        {
+          payload[i] = uint8_t (i * 7 + id);
+        }
+      Ptr<Packet> datagram = Create<Packet> (payload, sizeof (payload));
+      UdpHeader udp;
+      udp.SetSourcePort (9);
+      udp.SetDestinationPort (9);
+      datagram->AddHeader (udp);
+      for (uint32_t offset = 0; offset < DATAGRAM_SIZE; offset += 1000)
+        {
+          fragments[id].push_back (MakeFragment (id, datagram, offset, std::min<uint32_t> (1000, DATAGRAM_SIZE - offset)));
+        }
+      // A fragment overlapping two others
+      fragments[id].push_back (MakeFragment (id, datagram, 504, 1000));
+    }
+  m_received.assign (nDatagrams, Seconds (-1));
+  m_dropped.assign (nDatagrams, Seconds (-1));
+  m_corrupted = false;
+
+  // Datagram 0 in order, 1 in reverse order, 2 with the first fragment
+  // last, 3 interleaved with 4 and duplicated, 4 never complete.
+  uint32_t order0[] = { 0, 1, 2, 3, 4, 5 };
+  uint32_t order1[] = { 6, 5, 4, 3, 2, 1, 0 };
+  uint32_t order2[] = { 2, 6, 5, 3, 4, 1, 0 };
+  uint32_t order3[] = { 3, 3, 0, 5, 0, 4, 1, 2 };
+  uint32_t order4[] = { 0, 6, 1, 5, 2, 4 };
+  Time t = Seconds (1);
+  for (uint32_t i = 0; i < sizeof (order0) / sizeof (order0[0]); i++, t += MilliSeconds (1))
+    {
+      Simulator::Schedule (t, &Ipv4ReassemblyTest::Deliver, this, fragments[0][order0[i]]);
+    }
+  for (uint32_t i = 0; i < sizeof (order1) / sizeof (order1[0]); i++, t += MilliSeconds (1))
+    {
+      Simulator::Schedule (t, &Ipv4ReassemblyTest::Deliver, this, fragments[1][order1[i]]);
+    }
+  for (uint32_t i = 0; i < sizeof (order2) / sizeof (order2[0]); i++, t += MilliSeconds (1))
+    {
+      Simulator::Schedule (t, &Ipv4ReassemblyTest::Deliver, this, fragments[2][order2[i]]);
+    }
+  for (uint32_t i = 0; i < sizeof (order3) / sizeof (order3[0]); i++, t += MilliSeconds (1))
+    {
+      Simulator::Schedule (t, &Ipv4ReassemblyTest::Deliver, this, fragments[3][order3[i]]);
+      if (i < sizeof (order4) / sizeof (order4[0]))
+        {
+          Simulator::Schedule (t, &Ipv4ReassemblyTest::Deliver, this, fragments[4][order4[i]]);
+        }
+    }
+  // Datagram 5 never complete, started after the timeout is lowered, so
+  // that it expires before datagram 4
+  Simulator::Schedule (Seconds (2), &Ipv4ReassemblyTest::SetExpirationTimeout, this, Seconds (5));
+  Simulator::Schedule (Seconds (3), &Ipv4ReassemblyTest::Deliver, this, fragments[5][0]);
+  Time lastFragment0 = Seconds (1) + MilliSeconds (5);
+  Time lastFragment3 = t - MilliSeconds (1);
+  Time firstFragment4 = Seconds (1) + MilliSeconds (20);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_corrupted, false, "datagram corrupted or received twice");
+  NS_TEST_EXPECT_MSG_EQ (m_received[0], lastFragment0, "datagram sent in order not received");
+  for (uint32_t id = 1; id < 3; id++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[id].IsStrictlyPositive (), true, "datagram " << id << " not received");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_received[3], lastFragment3, "duplicated datagram not received");
+  NS_TEST_EXPECT_MSG_EQ (m_received[4].IsNegative (), true, "incomplete datagram received");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped[4], firstFragment4 + Seconds (30), "incomplete datagram not dropped on time");
+  NS_TEST_EXPECT_MSG_EQ (m_received[5].IsNegative (), true, "incomplete datagram received");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped[5], Seconds (8), "datagram not dropped on time after the timeout was lowered");
+  for (uint32_t id = 0; id < 4; id++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_dropped[id].IsNegative (), true, "complete datagram " << id << " dropped");
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -528,6 +776,7 @@ Ipv4FragmentationTestSuite::Ipv4FragmentationTestSuite ()
   : TestSuite ("ipv4-fragmentation", UNIT)
 {
   AddTestCase (new Ipv4FragmentationTest, TestCase::QUICK);
+  AddTestCase (new Ipv4ReassemblyTest, TestCase::QUICK);
 }
 
 static Ipv4FragmentationTestSuite g_ipv4fragmentationTestSuite; //!< Static variable for test initialization
@@ -42,6 +42,12 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/global-value.h"
+#include <sstream>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -1244,6 +1250,260 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes computed incrementally after metric changes
+ * and the routes computed with several threads are the routes of a full
+ * serial computation.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the global routes of every node.
+   * \param nodes the nodes
+   * \returns the sorted routes of each node
+   */
+  static std::vector<std::string> GetRoutes (NodeContainer nodes);
+
+  /**
+   * \brief Compute all the routes again, from scratch.
+   * \param threads the number of threads computing the routes
+   */
+  static void ComputeRoutes (uint32_t threads);
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Incremental and parallel global route computation")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::vector<std::string> tables;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<GlobalRouter> router = nodes.Get (i)->GetObject<GlobalRouter> ();
+      Ptr<Ipv4GlobalRouting> routing = router->GetRoutingProtocol ();
+      std::vector<std::string> routes;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          std::ostringstream oss;
+          oss << *routing->GetRoute (j);
+          routes.push_back (oss.str ());
+        }
+      std::sort (routes.begin (), routes.end ());
+      std::ostringstream table;
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          table << routes[j] << "\n";
+        }
+      tables.push_back (table.str ());
+    }
+  return tables;
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::ComputeRoutes (uint32_t threads)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (threads));
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (3);
+
+  // A ring of routers with random chords, a LAN and a few stub hosts
+  const uint32_t nRouters = 16;
+  NodeContainer routers;
+  routers.Create (nRouters);
+  NodeContainer hosts;
+  hosts.Create (3);
+  NodeContainer nodes (routers, hosts);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<Ptr<Ipv4> > linkIpv4;
+  std::vector<uint32_t> linkInterfaces;
+  for (uint32_t i = 0; i < nRouters + 8; i++)
+    {
+      uint32_t a = i < nRouters ? i : rng->GetInteger (0, nRouters - 1);
+      uint32_t b = i < nRouters ? (i + 1) % nRouters : (a + rng->GetInteger (2, nRouters - 2)) % nRouters;
+      // The ring is made of transit networks, the chords of point to point
+      // links
+      devHelper.SetNetDevicePointToPointMode (i >= nRouters);
+      NetDeviceContainer devices = devHelper.Install (NodeContainer (routers.Get (a), routers.Get (b)));
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      address.NewNetwork ();
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          linkIpv4.push_back (interfaces.Get (j).first);
+          linkInterfaces.push_back (interfaces.Get (j).second);
+        }
+    }
+  for (uint32_t i = 0; i < hosts.GetN (); i++)
+    {
+      NetDeviceContainer devices = devHelper.Install (NodeContainer (hosts.Get (i), routers.Get (i * 5)));
+      address.Assign (devices);
+      address.NewNetwork ();
+    }
+  devHelper.SetNetDevicePointToPointMode (false);
+  NetDeviceContainer lan = devHelper.Install (NodeContainer (routers.Get (2), routers.Get (9), routers.Get (13)));
+  address.SetBase ("10.2.0.0", "255.255.255.0");
+  address.Assign (lan);
+
+  // The metrics are drawn from a wide range: SPFVertex does not support
+  // several equal cost paths to the networks of a LAN
+  for (uint32_t link = 0; link < linkIpv4.size (); link++)
+    {
+      linkIpv4[link]->SetMetric (linkInterfaces[link], rng->GetInteger (1, 10000));
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> routes = GetRoutes (nodes);
+  ComputeRoutes (4);
+  NS_TEST_ASSERT_MSG_EQ ((GetRoutes (nodes) == routes), true, "routes computed in parallel differ");
+
+  for (uint32_t step = 0; step < 20; step++)
+    {
+      uint32_t nChanges = rng->GetInteger (1, 3);
+      for (uint32_t i = 0; i < nChanges; i++)
+        {
+          uint32_t link = rng->GetInteger (0, linkIpv4.size () - 1);
+          linkIpv4[link]->SetMetric (linkInterfaces[link], rng->GetInteger (1, 10000));
+        }
+      if (step == 10)
+        {
+          // Routes changed by hand are computed again
+          Ptr<Ipv4GlobalRouting> routing = routers.Get (7)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+          routing->RemoveRoute (0);
+        }
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      routes = GetRoutes (nodes);
+      ComputeRoutes (1);
+      NS_TEST_ASSERT_MSG_EQ ((GetRoutes (nodes) == routes), true, "incremental routes differ at step " << step);
+      ComputeRoutes (3);
+      NS_TEST_ASSERT_MSG_EQ ((GetRoutes (nodes) == routes), true, "routes computed in parallel differ at step " << step);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routing tables saved to a file are reloaded as
+ * they were computed, and only for the same topology.
+ */
+class Ipv4GlobalRoutingSaveLoadTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingSaveLoadTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the global routes of every node.
+   * \param nodes the nodes
+   * \returns the routes of all the nodes, in routing table order
+   */
+  static std::string GetRoutes (NodeContainer nodes);
+};
+
+Ipv4GlobalRoutingSaveLoadTestCase::Ipv4GlobalRoutingSaveLoadTestCase ()
+  : TestCase ("Save and load the global routing tables")
+{
+}
+
+std::string
+Ipv4GlobalRoutingSaveLoadTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      oss << "node " << i << "\n";
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << *routing->GetRoute (j) << "\n";
+        }
+    }
+  return oss.str ();
+}
+
+void
+Ipv4GlobalRoutingSaveLoadTestCase::DoRun (void)
+{
+  // n0 -- n1 -- n2 -- n3, n1 -- n3, and a LAN between n2, n3 and n4
+  NodeContainer nodes;
+  nodes.Create (5);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.252");
+  uint32_t links[4][2] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 1, 3 } };
+  Ipv4InterfaceContainer interfaces;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NetDeviceContainer devices = devHelper.Install (NodeContainer (nodes.Get (links[i][0]), nodes.Get (links[i][1])));
+      interfaces.Add (address.Assign (devices));
+      address.NewNetwork ();
+    }
+  devHelper.SetNetDevicePointToPointMode (false);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  address.Assign (devHelper.Install (NodeContainer (nodes.Get (2), nodes.Get (3), nodes.Get (4))));
+
+  // Avoid equal cost paths to the LAN, which SPFVertex does not support
+  interfaces.Get (6).first->SetMetric (interfaces.Get (6).second, 3);
+  interfaces.Get (7).first->SetMetric (interfaces.Get (7).second, 3);
+
+  std::string filename = CreateTempDirFilename ("global-routing-tables.bin");
+  Ipv4GlobalRoutingHelper::PopulateRoutingTablesFromFile (filename);
+  std::string routes = GetRoutes (nodes);
+  NS_TEST_ASSERT_MSG_NE (routes.find ("10.1.2.0"), std::string::npos, "routes not computed");
+
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  NS_TEST_ASSERT_MSG_EQ (GlobalRouteManager::LoadRoutingTables (filename), true, "routing tables not loaded");
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (nodes), routes, "loaded routes differ");
+
+  // The routing tables do not match another topology
+  interfaces.Get (2).first->SetMetric (interfaces.Get (2).second, 5);
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  NS_TEST_ASSERT_MSG_EQ (GlobalRouteManager::LoadRoutingTables (filename), false, "routing tables of another topology loaded");
+  Ipv4GlobalRoutingHelper::PopulateRoutingTablesFromFile (filename);
+  std::string newRoutes = GetRoutes (nodes);
+  NS_TEST_ASSERT_MSG_NE (newRoutes, routes, "routes not computed again");
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  NS_TEST_ASSERT_MSG_EQ (GlobalRouteManager::LoadRoutingTables (filename), true, "routing tables not saved again");
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (nodes), newRoutes, "loaded routes differ");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1527,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingSaveLoadTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
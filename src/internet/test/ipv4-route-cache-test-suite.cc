@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/internet-stack-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets forwarded by a router follow the changes
+ * of its routing table, with and without the route cache.
+ *
+ * The router forwards the packets sent to 10.9.0.1 to one of two
+ * receivers; its route is changed, and then the interface of the route
+ * is brought down, between the packets.  The route is changed either in
+ * the routing table, or by replacing the routing protocol by one whose
+ * routing table generation is one lower, which leaves the sum of the
+ * generations of the route cache unchanged.
+ */
+class Ipv4RouteCacheTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param cacheSize size of the route cache of the router
+   * \param replaceProtocol whether the route is changed by replacing the
+   * routing protocol of the router
+   */
+  Ipv4RouteCacheTestCase (uint32_t cacheSize, bool replaceProtocol);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Add a node with a single interface on a channel.
+   * \param channel the channel
+   * \param address the address of the interface
+   * \returns the node
+   */
+  Ptr<Node> AddNode (Ptr<SimpleChannel> channel, Ipv4Address address);
+
+  /**
+   * \brief Add an interface to a node.
+   * \param node the node
+   * \param channel the channel of the interface
+   * \param address the address of the interface
+   * \returns the interface index
+   */
+  uint32_t AddInterface (Ptr<Node> node, Ptr<SimpleChannel> channel, Ipv4Address address);
+
+  /**
+   * \brief Replace the last route of the router by a route to 10.9.0.0/16
+   * through the receiver of an interface.
+   * \param routing the routing protocol of the router
+   * \param interface the interface
+   */
+  static void ChangeRoute (Ptr<Ipv4StaticRouting> routing, uint32_t interface);
+
+  /**
+   * \brief Replace the routing protocol of the router by a static routing
+   * protocol with a route to 10.9.0.0/16 through the receiver of an
+   * interface, and a routing table generation one lower.
+   * \param ipv4 the IPv4 stack of the router
+   * \param interface the interface
+   */
+  void ReplaceProtocol (Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /**
+   * \brief Send a packet to 10.9.0.1.
+   * \param socket the sending socket
+   */
+  void SendPacket (Ptr<Socket> socket);
+
+  /**
+   * \brief Count the packets received by a node.
+   * \param receiver index of the receiver
+   * \param packet the packet
+   * \param ipv4 the IPv4 stack of the receiver
+   * \param interface the interface of the receiver
+   */
+  void Receive (uint32_t receiver, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  uint32_t m_cacheSize;    //!< size of the route cache of the router
+  bool m_replaceProtocol;  //!< whether the routing protocol is replaced
+  uint32_t m_received[2];  //!< number of packets received by each receiver
+};
+
+Ipv4RouteCacheTestCase::Ipv4RouteCacheTestCase (uint32_t cacheSize, bool replaceProtocol)
+  : TestCase (std::string (cacheSize == 0 ? "Check forwarding after routing changes without route cache"
+                                          : "Check forwarding after routing changes with a route cache")
+              + (replaceProtocol ? ", replacing the routing protocol" : "")),
+    m_cacheSize (cacheSize),
+    m_replaceProtocol (replaceProtocol)
+{
+}
+
+uint32_t
+Ipv4RouteCacheTestCase::AddInterface (Ptr<Node> node, Ptr<SimpleChannel> channel, Ipv4Address address)
+{
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  device->SetChannel (channel);
+  node->AddDevice (device);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t interface = ipv4->AddInterface (device);
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (address, Ipv4Mask ("255.255.0.0")));
+  ipv4->SetUp (interface);
+  return interface;
+}
+
+Ptr<Node>
+Ipv4RouteCacheTestCase::AddNode (Ptr<SimpleChannel> channel, Ipv4Address address)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (node);
+  AddInterface (node, channel, address);
+  return node;
+}
+
+void
+Ipv4RouteCacheTestCase::ChangeRoute (Ptr<Ipv4StaticRouting> routing, uint32_t interface)
+{
+  routing->RemoveRoute (routing->GetNRoutes () - 1);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.9.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.3.0.2"), interface);
+}
+
+void
+Ipv4RouteCacheTestCase::ReplaceProtocol (Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  uint64_t generation = ipv4->GetRoutingProtocol ()->GetRoutingTableGeneration ();
+  Ptr<Ipv4StaticRouting> routing = CreateObject<Ipv4StaticRouting> ();
+  ipv4->SetRoutingProtocol (routing);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.9.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.3.0.2"), interface);
+  NS_TEST_ASSERT_MSG_LT (routing->GetRoutingTableGeneration () + 1, generation, "generation of the new protocol too high");
+  while (routing->GetRoutingTableGeneration () + 1 < generation)
+    {
+      routing->AddHostRouteTo (Ipv4Address ("10.8.0.1"), Ipv4Address ("10.3.0.2"), interface);
+    }
+}
+
+void
+Ipv4RouteCacheTestCase::SendPacket (Ptr<Socket> socket)
+{
+  Address to = InetSocketAddress (Ipv4Address ("10.9.0.1"), 1234);
+  NS_TEST_EXPECT_MSG_EQ (socket->SendTo (Create<Packet> (100), 0, to), 100, "packet not sent");
+}
+
+void
+Ipv4RouteCacheTestCase::Receive (uint32_t receiver, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_received[receiver]++;
+}
+
+void
+Ipv4RouteCacheTestCase::DoRun (void)
+{
+  m_received[0] = 0;
+  m_received[1] = 0;
+
+  Ptr<SimpleChannel> txChannel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> rxChannel[2];
+  rxChannel[0] = CreateObject<SimpleChannel> ();
+  rxChannel[1] = CreateObject<SimpleChannel> ();
+
+  Ptr<Node> router = AddNode (txChannel, Ipv4Address ("10.1.0.1"));
+  uint32_t routerInterface[2];
+  routerInterface[0] = AddInterface (router, rxChannel[0], Ipv4Address ("10.2.0.1"));
+  routerInterface[1] = AddInterface (router, rxChannel[1], Ipv4Address ("10.3.0.1"));
+  router->GetObject<Ipv4L3Protocol> ()->SetAttribute ("RouteCacheSize", UintegerValue (m_cacheSize));
+  Ptr<Ipv4StaticRouting> routing = Ipv4RoutingHelper::GetRouting<Ipv4StaticRouting> (router->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  routing->AddNetworkRouteTo (Ipv4Address ("10.9.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.2.0.2"), routerInterface[0]);
+  if (m_replaceProtocol)
+    {
+      // Leave room for the routes the new protocol adds for the interfaces
+      for (uint32_t i = 0; i < 20; i++)
+        {
+          routing->AddHostRouteTo (Ipv4Address ("10.8.0.1"), Ipv4Address ("10.2.0.2"), routerInterface[0]);
+        }
+    }
+
+  Ptr<Node> receiver[2];
+  receiver[0] = AddNode (rxChannel[0], Ipv4Address ("10.2.0.2"));
+  receiver[1] = AddNode (rxChannel[1], Ipv4Address ("10.3.0.2"));
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      receiver[i]->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Rx", MakeCallback (&Ipv4RouteCacheTestCase::Receive, this).Bind (i));
+    }
+
+  Ptr<Node> sender = AddNode (txChannel, Ipv4Address ("10.1.0.2"));
+  Ipv4RoutingHelper::GetRouting<Ipv4StaticRouting> (sender->GetObject<Ipv4> ()->GetRoutingProtocol ())
+    ->SetDefaultRoute (Ipv4Address ("10.1.0.1"), 1);
+  Ptr<Socket> socket = sender->GetObject<UdpSocketFactory> ()->CreateSocket ();
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (1 + i * 0.1), &Ipv4RouteCacheTestCase::SendPacket, this, socket);
+    }
+  if (m_replaceProtocol)
+    {
+      Simulator::Schedule (Seconds (2), &Ipv4RouteCacheTestCase::ReplaceProtocol, this, router->GetObject<Ipv4> (), routerInterface[1]);
+    }
+  else
+    {
+      Simulator::Schedule (Seconds (2), &Ipv4RouteCacheTestCase::ChangeRoute, routing, routerInterface[1]);
+    }
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (3 + i * 0.1), &Ipv4RouteCacheTestCase::SendPacket, this, socket);
+    }
+  Simulator::Schedule (Seconds (4), &Ipv4::SetDown, router->GetObject<Ipv4> (), routerInterface[1]);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (5 + i * 0.1), &Ipv4RouteCacheTestCase::SendPacket, this, socket);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received[0], 3, "wrong number of packets forwarded on the first route");
+  NS_TEST_ASSERT_MSG_EQ (m_received[1], 3, "wrong number of packets forwarded on the second route");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 route cache TestSuite
+ */
+class Ipv4RouteCacheTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteCacheTestSuite ();
+};
+
+Ipv4RouteCacheTestSuite::Ipv4RouteCacheTestSuite ()
+  : TestSuite ("ipv4-route-cache", UNIT)
+{
+  AddTestCase (new Ipv4RouteCacheTestCase (0, false), TestCase::QUICK);
+  AddTestCase (new Ipv4RouteCacheTestCase (64, false), TestCase::QUICK);
+  AddTestCase (new Ipv4RouteCacheTestCase (0, true), TestCase::QUICK);
+  AddTestCase (new Ipv4RouteCacheTestCase (64, true), TestCase::QUICK);
+}
+
+static Ipv4RouteCacheTestSuite g_ipv4RouteCacheTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,308 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/ipv4-route-trie.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \param rng random number generator
+ * \returns a random address among a small set of addresses, so that the
+ * prefixes built on them often overlap
+ */
+Ipv4Address
+RandomAddress (Ptr<UniformRandomVariable> rng)
+{
+  uint32_t address = 0x0a000000;
+  address |= rng->GetInteger (0, 3) << 22;
+  address |= rng->GetInteger (0, 3) << 14;
+  address |= rng->GetInteger (0, 3) << 6;
+  address |= rng->GetInteger (0, 1);
+  return Ipv4Address (address);
+}
+
+/**
+ * \param rng random number generator
+ * \returns a random network mask
+ */
+Ipv4Mask
+RandomMask (Ptr<UniformRandomVariable> rng)
+{
+  uint32_t length = rng->GetInteger (0, 32);
+  return Ipv4Mask (length == 0 ? 0 : 0xffffffffU << (32 - length));
+}
+
+} // unnamed namespace
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check Ipv4RouteTrie::Lookup against a linear scan of the routes
+ * while routes are randomly added and removed.
+ */
+class Ipv4RouteTrieLookupTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4RouteTrieLookupTestCase::Ipv4RouteTrieLookupTestCase ()
+  : TestCase ("Check Ipv4RouteTrie lookups against a linear scan")
+{
+}
+
+void
+Ipv4RouteTrieLookupTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  Ipv4RouteTrie trie;
+  std::vector<Ipv4RoutingTableEntry *> routes;
+
+  for (uint32_t step = 0; step < 2000; step++)
+    {
+      if (routes.empty () || rng->GetValue () < 0.6)
+        {
+          Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+          *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (RandomAddress (rng), RandomMask (rng), 1);
+          routes.push_back (route);
+          trie.Insert (route, step);
+        }
+      else
+        {
+          uint32_t index = rng->GetInteger (0, routes.size () - 1);
+          NS_TEST_ASSERT_MSG_EQ (trie.Remove (routes[index]), true, "route not found");
+          NS_TEST_ASSERT_MSG_EQ (trie.Remove (routes[index]), false, "route removed twice");
+          delete routes[index];
+          routes.erase (routes.begin () + index);
+        }
+      NS_TEST_ASSERT_MSG_EQ (trie.GetNRoutes (), routes.size (), "wrong number of routes");
+
+      Ipv4Address dest = RandomAddress (rng);
+      std::vector<Ipv4RoutingTableEntry *> expected;
+      for (int32_t length = 32; length >= 0; length--)
+        {
+          for (uint32_t i = 0; i < routes.size (); i++)
+            {
+              Ipv4Mask mask = routes[i]->GetDestNetworkMask ();
+              if (mask.GetPrefixLength () == length && mask.IsMatch (dest, routes[i]->GetDestNetwork ()))
+                {
+                  expected.push_back (routes[i]);
+                }
+            }
+        }
+
+      std::vector<Ipv4RoutingTableEntry *> got;
+      Ipv4RouteTrie::Entries const *matches[Ipv4RouteTrie::MAX_MATCHES];
+      uint32_t nMatches = trie.Lookup (dest, matches);
+      uint16_t previousLength = 33;
+      for (uint32_t m = 0; m < nMatches; m++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (matches[m]->empty (), false, "empty prefix returned");
+          uint16_t length = matches[m]->front ().route->GetDestNetworkMask ().GetPrefixLength ();
+          NS_TEST_ASSERT_MSG_LT (length, previousLength, "prefixes not sorted by length");
+          previousLength = length;
+          for (uint32_t i = 0; i < matches[m]->size (); i++)
+            {
+              got.push_back ((*matches[m])[i].route);
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (got.size (), expected.size (), "wrong number of matching routes for " << dest);
+      for (uint32_t i = 0; i < got.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (got[i], expected[i], "wrong matching route for " << dest);
+        }
+    }
+
+  trie.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (trie.GetNRoutes (), 0, "routes left after Clear");
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      delete routes[i];
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that Ipv4StaticRouting selects the route a linear scan of
+ * its routing table selects: longest prefix, then lowest metric, the last
+ * such network route and the first such host route.
+ */
+class Ipv4StaticRoutingTrieTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Reference route selection
+   * \param routing the routing protocol
+   * \param dest the destination
+   * \returns the index of the selected route, or -1 if no route matches
+   */
+  static int32_t Select (Ptr<Ipv4StaticRouting> routing, Ipv4Address dest);
+};
+
+Ipv4StaticRoutingTrieTestCase::Ipv4StaticRoutingTrieTestCase ()
+  : TestCase ("Check Ipv4StaticRouting route selection")
+{
+}
+
+int32_t
+Ipv4StaticRoutingTrieTestCase::Select (Ptr<Ipv4StaticRouting> routing, Ipv4Address dest)
+{
+  int32_t selected = -1;
+  int32_t longest = -1;
+  uint32_t lowest = 0xffffffff;
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      Ipv4RoutingTableEntry route = routing->GetRoute (i);
+      Ipv4Mask mask = route.GetDestNetworkMask ();
+      int32_t length = mask.GetPrefixLength ();
+      uint32_t metric = routing->GetMetric (i);
+      if (!mask.IsMatch (dest, route.GetDestNetwork ()) || length < longest)
+        {
+          continue;
+        }
+      if (length > longest)
+        {
+          lowest = 0xffffffff;
+        }
+      longest = length;
+      if (metric > lowest)
+        {
+          continue;
+        }
+      lowest = metric;
+      selected = i;
+      if (length == 32)
+        {
+          break;
+        }
+    }
+  return selected;
+}
+
+void
+Ipv4StaticRoutingTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (2);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      devices.Add (devHelper.Install (node));
+    }
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (Ipv4StaticRoutingHelper ());
+  stack.Install (node);
+  Ipv4AddressHelper address;
+  address.SetBase ("192.168.1.0", "255.255.255.0");
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      address.Assign (NetDeviceContainer (devices.Get (i)));
+      address.NewNetwork ();
+    }
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ptr<Ipv4StaticRouting> routing = Ipv4StaticRoutingHelper ().GetStaticRouting (ipv4);
+
+  // Every route has its own gateway, so that the selected route can be
+  // told from the route returned by RouteOutput
+  uint32_t gateway = 0;
+  uint32_t nFound = 0;
+  for (uint32_t step = 0; step < 600; step++)
+    {
+      if (routing->GetNRoutes () == 0 || rng->GetValue () < 0.7)
+        {
+          uint32_t interface = rng->GetInteger (1, 3);
+          Ipv4Address nextHop = Ipv4Address (0xc0a80000 | (interface << 8) | (2 + gateway++ % 250));
+          routing->AddNetworkRouteTo (RandomAddress (rng), RandomMask (rng), nextHop, interface, rng->GetInteger (0, 3));
+        }
+      else
+        {
+          routing->RemoveRoute (rng->GetInteger (0, routing->GetNRoutes () - 1));
+        }
+
+      Ipv4Address dest = RandomAddress (rng);
+      int32_t expected = Select (routing, dest);
+      Ipv4Header header;
+      header.SetDestination (dest);
+      Socket::SocketErrno err;
+      Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, 0, err);
+      if (expected < 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (route, 0, "unexpected route to " << dest);
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_NE (route, 0, "no route to " << dest);
+          nFound++;
+          Ipv4RoutingTableEntry entry = routing->GetRoute (expected);
+          NS_TEST_ASSERT_MSG_EQ (route->GetGateway (), entry.GetGateway (), "wrong route to " << dest);
+          NS_TEST_ASSERT_MSG_EQ (route->GetOutputDevice (), ipv4->GetNetDevice (entry.GetInterface ()),
+                                 "wrong device to " << dest);
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (nFound, 300, "too few destinations with a route");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RouteTrie TestSuite
+ */
+class Ipv4RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteTrieTestSuite ();
+};
+
+Ipv4RouteTrieTestSuite::Ipv4RouteTrieTestSuite ()
+  : TestSuite ("ipv4-route-trie", UNIT)
+{
+  AddTestCase (new Ipv4RouteTrieLookupTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingTrieTestCase, TestCase::QUICK);
+}
+
+static Ipv4RouteTrieTestSuite g_ipv4RouteTrieTestSuite; //!< Static variable for test initialization
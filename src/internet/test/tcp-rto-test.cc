@@ -20,6 +20,7 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/tcp-westwood.h"
+#include "ns3/tcp-l4-protocol.h"
 #include "ns3/simple-channel.h"
 #include "tcp-general-test.h"
 #include "tcp-error-model.h"
@@ -317,7 +318,9 @@ TcpSsThreshRtoTest::AfterRTOExpired (const Ptr<const TcpSocketState> tcb, Socket
  *
  * \brief Testing the timing of RTO
  *
- * Checking if RTO is doubled ONLY after a retransmission.
+ * Checking if RTO is doubled ONLY after a retransmission, and that the
+ * retransmissions happen exactly one RTO apart, with the TCP timers
+ * scheduled as simulator events or kept on a timer wheel.
  */
 class TcpTimeRtoTest : public TcpGeneralTest
 {
@@ -325,12 +328,14 @@ public:
   /**
    * \brief Constructor.
    * \param congControl Congestion control type.
+   * \param timerGranularity TcpL4Protocol::TimerGranularity, zero for simulator events.
    * \param msg Test description.
    */
-  TcpTimeRtoTest (TypeId &congControl, const std::string &msg);
+  TcpTimeRtoTest (TypeId &congControl, Time timerGranularity, const std::string &msg);
 
 protected:
   virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
   virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
   virtual void ErrorClose  (SocketWho who);
   virtual void AfterRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
@@ -350,13 +355,18 @@ protected:
 private:
   uint32_t m_senderSentSegments;  //!< Number of segments sent.
   Time m_previousRTO;             //!< Previous RTO.
+  Time m_timerGranularity;        //!< Granularity of the TCP timer wheel.
+  Time m_retxTime;                //!< Expected time of the next retransmission.
   bool m_closed;                  //!< True if the connection is closed.
 };
 
 
-TcpTimeRtoTest::TcpTimeRtoTest (TypeId &congControl, const std::string &desc)
+TcpTimeRtoTest::TcpTimeRtoTest (TypeId &congControl, Time timerGranularity,
+                                const std::string &desc)
   :   TcpGeneralTest (desc),
     m_senderSentSegments (0),
+    m_timerGranularity (timerGranularity),
+    m_retxTime (Seconds (0)),
     m_closed (false)
 {
   m_congControlTypeId = congControl;
@@ -373,12 +383,22 @@ TcpTimeRtoTest::ConfigureEnvironment ()
 Ptr<TcpSocketMsgBase>
 TcpTimeRtoTest::CreateSenderSocket (Ptr<Node> node)
 {
+  node->GetObject<TcpL4Protocol> ()->SetAttribute ("TimerGranularity",
+                                                   TimeValue (m_timerGranularity));
   Ptr<TcpSocketMsgBase> s = TcpGeneralTest::CreateSenderSocket (node);
   s->SetAttribute ("DataRetries", UintegerValue (6));
 
   return s;
 }
 
+Ptr<TcpSocketMsgBase>
+TcpTimeRtoTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  node->GetObject<TcpL4Protocol> ()->SetAttribute ("TimerGranularity",
+                                                   TimeValue (m_timerGranularity));
+  return TcpGeneralTest::CreateReceiverSocket (node);
+}
+
 Ptr<ErrorModel>
 TcpTimeRtoTest::CreateReceiverErrorModel ()
 {
@@ -454,6 +474,16 @@ TcpTimeRtoTest::Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who)
                                          "RTO value has changed unexpectedly");
 
             }
+
+          if (m_senderSentSegments >= 3)
+            { // Data packet: it is sent again one RTO later
+              if (m_senderSentSegments > 3)
+                {
+                  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), m_retxTime,
+                                         "Retransmission not sent one RTO after the previous one");
+                }
+              m_retxTime = Simulator::Now () + GetRto (SENDER);
+            }
         }
     }
   else if (who == RECEIVER)
@@ -528,7 +558,8 @@ public:
         // With RTO of 0.005 seconds, FlightSize/2 > 2*SMSS 
         minRto = Seconds (0.005);
         AddTestCase (new TcpSsThreshRtoTest ((*it), seqToDrop, minRto, (*it).GetName () + " RTO ssthresh testing, set to half of BytesInFlight"), TestCase::QUICK);
-        AddTestCase (new TcpTimeRtoTest ((*it), (*it).GetName () + " RTO timing testing"), TestCase::QUICK);
+        AddTestCase (new TcpTimeRtoTest ((*it), Time (0), (*it).GetName () + " RTO timing testing"), TestCase::QUICK);
+        AddTestCase (new TcpTimeRtoTest ((*it), MilliSeconds (1), (*it).GetName () + " RTO timing testing, timer wheel"), TestCase::QUICK);
       }
   }
 };
@@ -15,9 +15,11 @@
  *
  */
 
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
 
 #include "ns3/tcp-rx-buffer.h"
 
@@ -344,6 +346,141 @@ TcpRxBufferTestCase::DoTeardown ()
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check TcpRxBuffer against a byte map of the received data while
+ * overlapping segments arrive out of order and data is read in random
+ * amounts.
+ */
+class TcpRxBufferReorderTestCase : public TestCase
+{
+public:
+  TcpRxBufferReorderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpRxBufferReorderTestCase::TcpRxBufferReorderTestCase ()
+  : TestCase ("TcpRxBuffer reordering and coalescing against a byte map")
+{
+}
+
+void
+TcpRxBufferReorderTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // The stream starts close to the wrap around of the sequence numbers
+  const uint32_t isn = 0xffff0000;
+  const uint32_t streamSize = 100000;
+  const uint32_t window = 20000;
+  std::vector<uint8_t> stream (streamSize);
+  for (uint32_t i = 0; i < streamSize; i++)
+    {
+      stream[i] = static_cast<uint8_t> (rng->GetInteger (0, 255));
+    }
+
+  TcpRxBuffer rxBuf;
+  rxBuf.SetMaxBufferSize (window);
+  rxBuf.SetNextRxSequence (SequenceNumber32 (isn));
+  std::vector<bool> received (streamSize, false);
+  uint32_t nextRx = 0;   // first byte not received, as an offset in the stream
+  uint32_t read = 0;     // first byte not read
+  uint32_t size = 0;     // bytes held by the buffer
+  while (read < streamSize)
+    {
+      uint32_t offset = nextRx + rng->GetInteger (0, window / 2);
+      if (offset > 0 && rng->GetValue () < 0.1)
+        {
+          offset -= std::min<uint32_t> (offset, rng->GetInteger (0, 2000));
+        }
+      offset = std::min (offset, streamSize - 1);
+      uint32_t length = std::min (rng->GetInteger (1, 1500), streamSize - offset);
+      TcpHeader h;
+      h.SetSequenceNumber (SequenceNumber32 (isn + offset));
+      Ptr<Packet> p = Create<Packet> (&stream[offset], length);
+
+      uint32_t end = std::min (offset + length, read + window);
+      uint32_t added = 0;
+      for (uint32_t i = std::max (offset, nextRx); i < end; i++)
+        {
+          if (!received[i])
+            {
+              received[i] = true;
+              added++;
+            }
+        }
+      size += added;
+      bool advances = nextRx < end && offset <= nextRx;
+      while (nextRx < streamSize && received[nextRx])
+        {
+          nextRx++;
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (p, h), (added > 0), "wrong Add result for " << offset << "+" << length);
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (isn + nextRx), "wrong RCV.NXT");
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), size, "wrong occupancy");
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), nextRx - read, "wrong available bytes");
+
+      // The first SACK block is the contiguous block holding the segment
+      TcpOptionSack::SackList sackList = rxBuf.GetSackList ();
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (sackList.size (), 4, "too many SACK blocks");
+      if (added > 0 && !advances)
+        {
+          uint32_t head = std::max (offset, nextRx);
+          while (!received[head])
+            {
+              head++;
+            }
+          uint32_t tail = head;
+          while (head > 0 && received[head - 1])
+            {
+              head--;
+            }
+          while (tail < streamSize && received[tail])
+            {
+              tail++;
+            }
+          NS_TEST_ASSERT_MSG_EQ (sackList.empty (), false, "no SACK block");
+          NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (isn + head), "wrong first SACK block");
+          NS_TEST_ASSERT_MSG_EQ (sackList.front ().second, SequenceNumber32 (isn + tail), "wrong first SACK block");
+        }
+      for (TcpOptionSack::SackList::const_iterator it = sackList.begin (); it != sackList.end (); ++it)
+        {
+          NS_TEST_ASSERT_MSG_GT (it->first, SequenceNumber32 (isn + nextRx), "SACK block below RCV.NXT");
+          for (SequenceNumber32 seq = it->first; seq < it->second; seq++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (received[seq - SequenceNumber32 (isn)], true, "SACK of missing data");
+            }
+        }
+
+      if (rng->GetValue () < 0.3)
+        {
+          Ptr<Packet> out = rxBuf.Extract (rng->GetInteger (1, 6000));
+          if (nextRx == read)
+            {
+              NS_TEST_ASSERT_MSG_EQ (out, 0, "data extracted from an empty buffer");
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_NE (out, 0, "no data extracted");
+          std::vector<uint8_t> data (out->GetSize ());
+          out->CopyData (&data[0], data.size ());
+          for (uint32_t i = 0; i < data.size (); i++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (data[i]), static_cast<uint32_t> (stream[read + i]),
+                                     "wrong byte " << read + i);
+            }
+          read += data.size ();
+          size -= data.size ();
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "data left in the buffer");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -357,6 +494,7 @@ public:
     : TestSuite ("tcp-rx-buffer", UNIT)
   {
     AddTestCase (new TcpRxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpRxBufferReorderTestCase, TestCase::QUICK);
   }
 };
 static TcpRxBufferTestSuite  g_tcpRxBufferTestSuite;
@@ -0,0 +1,455 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/error-model.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tso-tag.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpTsoTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief SimpleNetDevice without segmentation offload
+ */
+class TcpTsoTestNetDevice : public SimpleNetDevice
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual bool SupportsTso (void) const;
+};
+
+TypeId
+TcpTsoTestNetDevice::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpTsoTestNetDevice")
+    .SetParent<SimpleNetDevice> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpTsoTestNetDevice> ()
+  ;
+  return tid;
+}
+
+bool
+TcpTsoTestNetDevice::SupportsTso (void) const
+{
+  return false;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Bulk transfer with and without TCP segmentation offload emulation
+ *
+ * The same amount of data is sent with TsoMaxSegments set to 1 and to 16.
+ * With super-segments, the data must arrive intact, in far fewer packets,
+ * and in about the same time, the device accounting for the transmission
+ * time of every segment.
+ *
+ * The data is then sent through a router whose second link does not
+ * support segmentation offload, and over such a link only: the receiver
+ * must get single segments.
+ */
+class TcpTsoTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param ipv6 use IPv6 rather than IPv4
+   */
+  TcpTsoTestCase (bool ipv6);
+
+private:
+  /// Links between the sender and the receiver
+  enum Topology
+  {
+    DIRECT,         //!< A single link, supporting segmentation offload
+    NON_TSO_HOP,    //!< Through a router, the second link not supporting segmentation offload
+    NON_TSO_SENDER  //!< A single link, not supporting segmentation offload
+  };
+
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run a bulk transfer
+   * \param tsoMaxSegments value of the TsoMaxSegments attribute of the sender
+   * \param topology links between the sender and the receiver
+   */
+  void RunTransfer (uint32_t tsoMaxSegments, Topology topology);
+
+  /**
+   * \brief Link two nodes with devices not supporting segmentation offload
+   * \param first the first node
+   * \param second the second node
+   * \returns the devices
+   */
+  NetDeviceContainer InstallNonTso (Ptr<Node> first, Ptr<Node> second);
+
+  /**
+   * \brief Fill the send buffer of the sender
+   * \param socket the sender socket
+   * \param available space in the send buffer
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+
+  /**
+   * \brief Read and check the received data
+   * \param socket the receiver socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  /**
+   * \brief Accept a connection
+   * \param socket the new socket
+   * \param from the peer address
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief Count the data packets sent
+   * \param p the packet
+   * \param header the TCP header
+   * \param socket the sender socket
+   */
+  void Tx (Ptr<const Packet> p, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+
+  /**
+   * \brief Count the super-segments received over IPv4
+   * \param p the packet, with its IPv4 header
+   * \param ipv4 the IPv4 stack of the receiver
+   * \param interface the receiving interface
+   */
+  void Rx4 (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /**
+   * \brief Count the super-segments received over IPv6
+   * \param p the packet, with its IPv6 header
+   * \param ipv6 the IPv6 stack of the receiver
+   * \param interface the receiving interface
+   */
+  void Rx6 (Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface);
+
+  static const uint32_t TOTAL_BYTES = 1000000; //!< Amount of data sent
+
+  bool m_ipv6;              //!< Use IPv6
+  uint32_t m_sent;          //!< Bytes given to the sender
+  uint32_t m_received;      //!< Bytes received
+  bool m_corrupted;         //!< Received data differs from the sent data
+  uint32_t m_nPackets;      //!< Data packets sent
+  uint32_t m_nSuperSegments; //!< Data packets sent as super-segments
+  uint32_t m_nRxSuperSegments; //!< Packets received larger than a segment
+  Time m_completion;        //!< Time the last byte was received
+};
+
+TcpTsoTestCase::TcpTsoTestCase (bool ipv6)
+  : TestCase (std::string ("Check TCP segmentation offload emulation over ") + (ipv6 ? "IPv6" : "IPv4")),
+    m_ipv6 (ipv6)
+{
+}
+
+void
+TcpTsoTestCase::Send (Ptr<Socket> socket, uint32_t available)
+{
+  uint8_t buffer[1024];
+  while (m_sent < TOTAL_BYTES && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min<uint32_t> (std::min<uint32_t> (sizeof (buffer), TOTAL_BYTES - m_sent),
+                                          socket->GetTxAvailable ());
+      for (uint32_t i = 0; i < size; i++)
+        {
+          buffer[i] = (m_sent + i) % 251;
+        }
+      int sent = socket->Send (buffer, size, 0);
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+}
+
+void
+TcpTsoTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()) != 0)
+    {
+      uint32_t size = p->GetSize ();
+      uint8_t *buffer = new uint8_t[size];
+      p->CopyData (buffer, size);
+      for (uint32_t i = 0; i < size; i++)
+        {
+          if (buffer[i] != (m_received + i) % 251)
+            {
+              m_corrupted = true;
+            }
+        }
+      delete [] buffer;
+      m_received += size;
+    }
+  if (m_received == TOTAL_BYTES)
+    {
+      m_completion = Simulator::Now ();
+    }
+}
+
+void
+TcpTsoTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpTsoTestCase::Receive, this));
+}
+
+void
+TcpTsoTestCase::Tx (Ptr<const Packet> p, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  if (p->GetSize () == 0)
+    {
+      return;
+    }
+  m_nPackets++;
+  TsoTag tag;
+  if (p->PeekPacketTag (tag))
+    {
+      NS_TEST_EXPECT_MSG_EQ (tag.GetPayloadSize (), p->GetSize (), "wrong super-segment payload");
+      NS_TEST_EXPECT_MSG_EQ (tag.GetSegmentSize (), 1000, "wrong super-segment segment size");
+      m_nSuperSegments++;
+    }
+}
+
+void
+TcpTsoTestCase::Rx4 (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > 1500)
+    {
+      m_nRxSuperSegments++;
+    }
+}
+
+void
+TcpTsoTestCase::Rx6 (Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  if (p->GetSize () > 1500)
+    {
+      m_nRxSuperSegments++;
+    }
+}
+
+NetDeviceContainer
+TcpTsoTestCase::InstallNonTso (Ptr<Node> first, Ptr<Node> second)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (5)));
+  NodeContainer nodes (first, second);
+  NetDeviceContainer devices;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+    {
+      Ptr<TcpTsoTestNetDevice> device = CreateObject<TcpTsoTestNetDevice> ();
+      device->SetAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+      device->SetAddress (Mac48Address::Allocate ());
+      (*i)->AddDevice (device);
+      device->SetChannel (channel);
+      device->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+      devices.Add (device);
+    }
+  return devices;
+}
+
+void
+TcpTsoTestCase::RunTransfer (uint32_t tsoMaxSegments, Topology topology)
+{
+  m_sent = 0;
+  m_received = 0;
+  m_corrupted = false;
+  m_nPackets = 0;
+  m_nSuperSegments = 0;
+  m_nRxSuperSegments = 0;
+  m_completion = Time (0);
+
+  NodeContainer nodes;
+  nodes.Create (topology == NON_TSO_HOP ? 3 : 2);
+  Ptr<Node> receiver = nodes.Get (nodes.GetN () - 1);
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  devHelper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (5)));
+  NetDeviceContainer firstDevices;
+  NetDeviceContainer lastDevices;
+  if (topology == NON_TSO_SENDER)
+    {
+      firstDevices = InstallNonTso (nodes.Get (0), nodes.Get (1));
+    }
+  else
+    {
+      firstDevices = devHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+    }
+  if (topology == NON_TSO_HOP)
+    {
+      lastDevices = InstallNonTso (nodes.Get (1), nodes.Get (2));
+    }
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  Address serverLocal;
+  Address serverRemote;
+  if (m_ipv6)
+    {
+      Ipv6AddressHelper address;
+      address.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = address.Assign (firstDevices);
+      if (topology == NON_TSO_HOP)
+        {
+          interfaces.SetForwarding (1, true);
+          interfaces.SetDefaultRouteInAllNodes (1);
+          address.SetBase (Ipv6Address ("2001:2::"), Ipv6Prefix (64));
+          interfaces = address.Assign (lastDevices);
+          interfaces.SetForwarding (0, true);
+          interfaces.SetDefaultRouteInAllNodes (0);
+        }
+      serverLocal = Inet6SocketAddress (Ipv6Address::GetAny (), 50000);
+      serverRemote = Inet6SocketAddress (interfaces.GetAddress (1, 1), 50000);
+      receiver->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Rx", MakeCallback (&TcpTsoTestCase::Rx6, this));
+    }
+  else
+    {
+      Ipv4AddressHelper address;
+      address.SetBase ("10.1.1.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (firstDevices);
+      if (topology == NON_TSO_HOP)
+        {
+          address.SetBase ("10.1.2.0", "255.255.255.0");
+          interfaces = address.Assign (lastDevices);
+          Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+        }
+      serverLocal = InetSocketAddress (Ipv4Address::GetAny (), 50000);
+      serverRemote = InetSocketAddress (interfaces.GetAddress (1), 50000);
+      receiver->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Rx", MakeCallback (&TcpTsoTestCase::Rx4, this));
+    }
+
+  Ptr<Socket> server = Socket::CreateSocket (receiver, TcpSocketFactory::GetTypeId ());
+  server->SetAttribute ("SegmentSize", UintegerValue (1000));
+  server->SetAttribute ("RcvBufSize", UintegerValue (65536));
+  server->Bind (serverLocal);
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpTsoTestCase::Accept, this));
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  source->SetAttribute ("SegmentSize", UintegerValue (1000));
+  source->SetAttribute ("SndBufSize", UintegerValue (131072));
+  source->SetAttribute ("TsoMaxSegments", UintegerValue (tsoMaxSegments));
+  source->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpTsoTestCase::Tx, this));
+  source->SetSendCallback (MakeCallback (&TcpTsoTestCase::Send, this));
+  source->Bind (m_ipv6 ? Address (Inet6SocketAddress (Ipv6Address::GetAny (), 0))
+                : Address (InetSocketAddress (Ipv4Address::GetAny (), 0)));
+  source->Connect (serverRemote);
+  Simulator::ScheduleNow (&TcpTsoTestCase::Send, this, source, 0);
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+TcpTsoTestCase::DoRun (void)
+{
+  RunTransfer (1, DIRECT);
+  NS_TEST_ASSERT_MSG_EQ (m_received, TOTAL_BYTES, "transfer not completed without TSO");
+  NS_TEST_ASSERT_MSG_EQ (m_corrupted, false, "data corrupted without TSO");
+  NS_TEST_ASSERT_MSG_EQ (m_nSuperSegments, 0, "super-segments sent without TSO");
+  uint32_t plainPackets = m_nPackets;
+  Time plainCompletion = m_completion;
+
+  RunTransfer (16, DIRECT);
+  NS_TEST_ASSERT_MSG_EQ (m_received, TOTAL_BYTES, "transfer not completed with TSO");
+  NS_TEST_ASSERT_MSG_EQ (m_corrupted, false, "data corrupted with TSO");
+  NS_TEST_ASSERT_MSG_GT (m_nSuperSegments, 0, "no super-segments sent");
+  NS_TEST_ASSERT_MSG_GT (m_nRxSuperSegments, 0, "no super-segments received");
+  NS_TEST_ASSERT_MSG_LT (m_nPackets * 8, plainPackets, "too many packets sent with TSO");
+
+  // Every 1000 bytes segment carries at least 40 bytes of TCP/IP headers,
+  // so the transfer cannot take less than 1040000 bytes at 10 Mbps even if
+  // it is sent as super-segments.
+  Time lineRate = DataRate ("10Mbps").CalculateBytesTxTime (TOTAL_BYTES / 1000 * 1040);
+  NS_TEST_ASSERT_MSG_GT (plainCompletion, lineRate, "transfer too fast without TSO");
+  NS_TEST_ASSERT_MSG_GT (m_completion, lineRate, "transfer too fast with TSO");
+  NS_TEST_ASSERT_MSG_LT (m_completion.GetSeconds (), plainCompletion.GetSeconds () * 1.1, "transfer too slow with TSO");
+
+  // The router splits the super-segments before the link without
+  // segmentation offload
+  RunTransfer (16, NON_TSO_HOP);
+  NS_TEST_ASSERT_MSG_EQ (m_received, TOTAL_BYTES, "transfer not completed through a router");
+  NS_TEST_ASSERT_MSG_EQ (m_corrupted, false, "data corrupted through a router");
+  NS_TEST_ASSERT_MSG_GT (m_nSuperSegments, 0, "no super-segments sent to the router");
+  NS_TEST_ASSERT_MSG_EQ (m_nRxSuperSegments, 0, "super-segments sent over a link without TSO");
+
+  // The sender does not build super-segments for a link without
+  // segmentation offload
+  RunTransfer (16, NON_TSO_SENDER);
+  NS_TEST_ASSERT_MSG_EQ (m_received, TOTAL_BYTES, "transfer not completed without a TSO device");
+  NS_TEST_ASSERT_MSG_EQ (m_corrupted, false, "data corrupted without a TSO device");
+  NS_TEST_ASSERT_MSG_EQ (m_nSuperSegments, 0, "super-segments sent without a TSO device");
+  NS_TEST_ASSERT_MSG_EQ (m_nRxSuperSegments, 0, "super-segments received without a TSO device");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP segmentation offload emulation TestSuite
+ */
+class TcpTsoTestSuite : public TestSuite
+{
+public:
+  TcpTsoTestSuite ()
+    : TestSuite ("tcp-tso", UNIT)
+  {
+    AddTestCase (new TcpTsoTestCase (false), TestCase::QUICK);
+    AddTestCase (new TcpTsoTestCase (true), TestCase::QUICK);
+  }
+};
+
+static TcpTsoTestSuite g_tcpTsoTestSuite; //!< Static variable for test initialization
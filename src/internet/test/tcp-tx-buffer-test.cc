@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard with a large window and many SACK holes */
+  void TestManyHoles ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestManyHoles, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -267,6 +271,73 @@ TcpTxBufferTestCase::TestNextSeg ()
                          "Data inside the buffer");
 }
 
+void
+TcpTxBufferTestCase::TestManyHoles ()
+{
+  const uint32_t segmentSize = 1000;
+  const uint32_t nSegments = 2000;
+  const uint32_t dupThresh = 3;
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetMaxBufferSize (segmentSize * nSegments);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (dupThresh);
+
+  txBuf.Add (Create<Packet> (segmentSize * nSegments));
+  for (uint32_t i = 0; i < nSegments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // Every odd segment arrives: after the k-th SACK, the holes with at least
+  // dupThresh sacked segments above them are lost
+  uint32_t nSacked = nSegments / 2;
+  for (uint32_t k = 1; k <= nSacked; ++k)
+    {
+      SequenceNumber32 begin = head + (segmentSize * (2 * k - 1));
+      TcpOptionSack::SackList list;
+      list.push_back (TcpOptionSack::SackBlock (begin, begin + segmentSize));
+      NS_TEST_ASSERT_MSG_EQ (txBuf.Update (list), true, "SACK block not applied");
+
+      uint32_t nLost = k >= dupThresh ? k - dupThresh + 1 : 0;
+      NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), k * segmentSize, "Wrong sacked count");
+      NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), nLost * segmentSize, "Wrong lost count");
+      if (nLost > 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 2 * (nLost - 1))), true,
+                                 "Highest lost hole not lost");
+        }
+      NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 2 * nLost)), false,
+                             "Hole lost with less than dupThresh sacked segments above");
+    }
+
+  // The lost holes are retransmitted in order, and nothing else
+  for (uint32_t m = 0; m <= nSacked - dupThresh; ++m)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, false), true, "No hole to retransmit");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 2 * m), "Wrong hole retransmitted");
+      txBuf.CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, false), false, "Retransmission of a hole not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), (nSegments - nSacked) * segmentSize,
+                         "Wrong bytes in flight after the retransmissions");
+
+  // In recovery, rule 3 returns the first hole not retransmitted
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true, "No hole per rule 3");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 2 * (nSacked - dupThresh + 1)),
+                         "Wrong hole per rule 3");
+
+  // A cumulative ACK of the first half leaves the scoreboard consistent
+  txBuf.DiscardUpTo (head + (segmentSize * nSegments / 2));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), nSacked / 2 * segmentSize, "Wrong sacked count after ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), (nSacked / 2 - dupThresh + 1) * segmentSize,
+                         "Wrong lost count after ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * nSegments / 2)), true,
+                         "New head not lost");
+}
+
 void
 TcpTxBufferTestCase::TestNewBlock ()
 {
@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "mobility-grid.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MobilityGrid");
+
+size_t
+MobilityGrid::CellHash::operator () (uint64_t key) const
+{
+  return static_cast<size_t> (key ^ (key >> 29));
+}
+
+MobilityGrid::MobilityGrid (double cellSize)
+  : m_cellSize (cellSize),
+    m_maxSpeed (0)
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT_MSG (cellSize > 0, "The cells of a MobilityGrid must not be empty");
+}
+
+MobilityGrid::~MobilityGrid ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_items.size (); i++)
+    {
+      if (m_models.erase (PeekPointer (m_items[i].mobility)) > 0)
+        {
+          m_items[i].mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                              MakeCallback (&MobilityGrid::CourseChanged, this));
+        }
+    }
+}
+
+double
+MobilityGrid::GetCellSize (void) const
+{
+  return m_cellSize;
+}
+
+uint32_t
+MobilityGrid::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  NS_ASSERT (mobility != 0);
+
+  uint32_t i = m_items.size ();
+  Item item;
+  item.mobility = mobility;
+  item.cell = GetCellKey (mobility->GetPosition ());
+  item.moving = false;
+  m_items.push_back (item);
+  m_cells[item.cell].push_back (i);
+
+  std::vector<uint32_t> &items = m_models[PeekPointer (mobility)];
+  if (items.empty ())
+    {
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MobilityGrid::CourseChanged, this));
+    }
+  items.push_back (i);
+  // Follow the item if it already moves
+  m_changed.push_back (i);
+  return i;
+}
+
+uint32_t
+MobilityGrid::GetNItems (void) const
+{
+  return m_items.size ();
+}
+
+uint64_t
+MobilityGrid::GetCellKey (int64_t x, int64_t y)
+{
+  return (static_cast<uint64_t> (static_cast<uint32_t> (x)) << 32) | static_cast<uint32_t> (y);
+}
+
+uint64_t
+MobilityGrid::GetCellKey (const Vector &position) const
+{
+  return GetCellKey (static_cast<int64_t> (std::floor (position.x / m_cellSize)),
+                     static_cast<int64_t> (std::floor (position.y / m_cellSize)));
+}
+
+void
+MobilityGrid::Update (uint32_t i)
+{
+  Item &item = m_items[i];
+  uint64_t cell = GetCellKey (item.mobility->GetPosition ());
+  if (cell != item.cell)
+    {
+      std::vector<uint32_t> &items = m_cells[item.cell];
+      std::vector<uint32_t>::iterator it = std::find (items.begin (), items.end (), i);
+      NS_ASSERT (it != items.end ());
+      *it = items.back ();
+      items.pop_back ();
+      if (items.empty ())
+        {
+          m_cells.erase (item.cell);
+        }
+      m_cells[cell].push_back (i);
+      item.cell = cell;
+    }
+  double speed = item.mobility->GetVelocity ().GetLength ();
+  if (speed > 0)
+    {
+      m_maxSpeed = std::max (m_maxSpeed, speed);
+      if (!item.moving)
+        {
+          item.moving = true;
+          m_moving.push_back (i);
+        }
+    }
+}
+
+double
+MobilityGrid::Refresh (void)
+{
+  // Items whose course changed are exactly in their cells, the others
+  // may have moved from their cells since the last refresh
+  if (!m_changed.empty ())
+    {
+      std::vector<uint32_t> changed;
+      changed.swap (m_changed);
+      for (std::vector<uint32_t>::const_iterator it = changed.begin (); it != changed.end (); it++)
+        {
+          Update (*it);
+        }
+    }
+  if (m_moving.empty ())
+    {
+      return 0;
+    }
+
+  Time now = Simulator::Now ();
+  double drift = m_maxSpeed * (now - m_lastRefresh).GetSeconds ();
+  if (drift <= m_cellSize / 2)
+    {
+      return drift;
+    }
+
+  NS_LOG_LOGIC ("Moving " << m_moving.size () << " items to their cells");
+  std::vector<uint32_t> moving;
+  moving.swap (m_moving);
+  m_maxSpeed = 0;
+  for (std::vector<uint32_t>::const_iterator it = moving.begin (); it != moving.end (); it++)
+    {
+      m_items[*it].moving = false;
+      Update (*it);
+    }
+  m_lastRefresh = now;
+  return 0;
+}
+
+void
+MobilityGrid::GetItemsInRange (const Vector &position, double range, std::vector<uint32_t> &items)
+{
+  NS_LOG_FUNCTION (this << position << range);
+
+  items.clear ();
+  double radius = range + Refresh ();
+  double x0 = std::floor ((position.x - radius) / m_cellSize);
+  double x1 = std::floor ((position.x + radius) / m_cellSize);
+  double y0 = std::floor ((position.y - radius) / m_cellSize);
+  double y1 = std::floor ((position.y + radius) / m_cellSize);
+  if ((x1 - x0 + 1) * (y1 - y0 + 1) > m_cells.size ())
+    {
+      // Fewer cells hold items than the query would visit
+      for (Cells::const_iterator it = m_cells.begin (); it != m_cells.end (); it++)
+        {
+          items.insert (items.end (), it->second.begin (), it->second.end ());
+        }
+    }
+  else
+    {
+      for (int64_t x = static_cast<int64_t> (x0); x <= static_cast<int64_t> (x1); x++)
+        {
+          for (int64_t y = static_cast<int64_t> (y0); y <= static_cast<int64_t> (y1); y++)
+            {
+              Cells::const_iterator it = m_cells.find (GetCellKey (x, y));
+              if (it != m_cells.end ())
+                {
+                  items.insert (items.end (), it->second.begin (), it->second.end ());
+                }
+            }
+        }
+    }
+
+  std::vector<uint32_t>::iterator last = items.begin ();
+  for (std::vector<uint32_t>::const_iterator it = items.begin (); it != items.end (); it++)
+    {
+      if (CalculateDistance (position, m_items[*it].mobility->GetPosition ()) <= range)
+        {
+          *last++ = *it;
+        }
+    }
+  items.erase (last, items.end ());
+  std::sort (items.begin (), items.end ());
+  NS_LOG_LOGIC (items.size () << " items in range");
+}
+
+void
+MobilityGrid::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  // The mobility model may be in the middle of an update: the cells are
+  // updated at the next query
+  std::map<const MobilityModel *, std::vector<uint32_t> >::const_iterator it = m_models.find (PeekPointer (mobility));
+  NS_ASSERT (it != m_models.end ());
+  m_changed.insert (m_changed.end (), it->second.begin (), it->second.end ());
+}
+
+} // namespace ns3
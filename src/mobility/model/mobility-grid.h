@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MOBILITY_GRID_H
+#define MOBILITY_GRID_H
+
+#include <map>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/sgi-hashmap.h"
+#include "mobility-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ * \brief Spatial index of the positions of a set of mobility models.
+ *
+ * The items, each followed by a MobilityModel, are kept in the square
+ * cells of a grid of the x-y plane, so that the items within a range of a
+ * position are found by visiting the few cells around the position.
+ *
+ * The cell of an item is updated when its mobility model notifies a course
+ * change.  Items moving at a constant velocity between course changes are
+ * not moved to their new cell at every query: they are all updated when
+ * the fastest of them may have moved by half a cell, and the cells visited
+ * by a query are widened by the distance they may have moved since.
+ */
+class MobilityGrid : public SimpleRefCount<MobilityGrid>
+{
+public:
+  /**
+   * \param cellSize the side of the cells of the grid, in meters
+   */
+  MobilityGrid (double cellSize);
+  ~MobilityGrid ();
+
+  /**
+   * \return the side of the cells of the grid, in meters
+   */
+  double GetCellSize (void) const;
+
+  /**
+   * \brief Add an item to the grid.
+   *
+   * Several items can follow the same mobility model.
+   *
+   * \param mobility the mobility model of the item
+   * \return the index of the item, in the order items were added
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+
+  /**
+   * \return the number of items in the grid
+   */
+  uint32_t GetNItems (void) const;
+
+  /**
+   * \brief Find the items within a range of a position.
+   *
+   * \param position the position
+   * \param range the range, in meters
+   * \param items the indexes of the items at a distance from the position
+   * lower or equal to the range, in increasing order
+   */
+  void GetItemsInRange (const Vector &position, double range, std::vector<uint32_t> &items);
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  MobilityGrid (const MobilityGrid &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  MobilityGrid & operator = (const MobilityGrid &);
+
+  /**
+   * \brief An item of the grid
+   */
+  struct Item
+  {
+    Ptr<MobilityModel> mobility; //!< Mobility model of the item
+    uint64_t cell;               //!< Cell the item is in
+    bool moving;                 //!< Item in m_moving
+  };
+
+  /**
+   * \brief Hash of a cell key
+   */
+  class CellHash : public std::unary_function<uint64_t, size_t>
+  {
+public:
+    /**
+     * \brief Hash a cell key
+     * \param key the key
+     * \return the hash
+     */
+    size_t operator () (uint64_t key) const;
+  };
+
+  /// Items in each cell, indexed by cell key
+  typedef sgi::hash_map<uint64_t, std::vector<uint32_t>, CellHash> Cells;
+
+  /**
+   * \param x the x coordinate of a cell
+   * \param y the y coordinate of a cell
+   * \return the key of the cell
+   */
+  static uint64_t GetCellKey (int64_t x, int64_t y);
+  /**
+   * \param position a position
+   * \return the key of the cell holding the position
+   */
+  uint64_t GetCellKey (const Vector &position) const;
+  /**
+   * \brief Move an item to the cell of its current position, and follow
+   * it if it moves.
+   * \param i index of the item
+   */
+  void Update (uint32_t i);
+  /**
+   * \brief Take the course changes of the items into account, and move the
+   * moving items to their cells if they may have moved too far.
+   * \return the distance the items may have moved from their cells, in meters
+   */
+  double Refresh (void);
+  /**
+   * \brief Record that a mobility model changed course.
+   * \param mobility the mobility model
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
+  double m_cellSize;                   //!< Side of the cells
+  std::vector<Item> m_items;           //!< Items
+  Cells m_cells;                       //!< Items in each cell
+  std::map<const MobilityModel *, std::vector<uint32_t> > m_models; //!< Items following each mobility model
+  std::vector<uint32_t> m_changed;     //!< Items whose course changed since the last query
+  std::vector<uint32_t> m_moving;      //!< Items which may be moving
+  double m_maxSpeed;                   //!< Highest speed of the moving items, in m/s
+  Time m_lastRefresh;                  //!< Last time all the moving items were updated
+};
+
+} // namespace ns3
+
+#endif /* MOBILITY_GRID_H */
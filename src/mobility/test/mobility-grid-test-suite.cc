@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/mobility-grid.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Check the items a MobilityGrid finds in range of random positions
+ * against all the items, while some items stand still, others move at a
+ * constant velocity and others are moved or change velocity.
+ */
+class MobilityGridTestCase : public TestCase
+{
+public:
+  MobilityGridTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Query the grid from a random position, and change the course of an item
+  void Step (void);
+
+  Ptr<UniformRandomVariable> m_rng;                  //!< Random number generator
+  Ptr<MobilityGrid> m_grid;                          //!< The grid
+  std::vector<Ptr<MobilityModel> > m_items;          //!< Mobility model of each item
+  uint32_t m_nQueries;                               //!< Queries done
+  uint32_t m_nFound;                                 //!< Items found by the queries
+  uint32_t m_nErrors;                                //!< Queries which found the wrong items
+};
+
+MobilityGridTestCase::MobilityGridTestCase ()
+  : TestCase ("Check the items in range found by a MobilityGrid")
+{
+}
+
+void
+MobilityGridTestCase::Step (void)
+{
+  Vector position (m_rng->GetValue (-100, 1100), m_rng->GetValue (-100, 1100), 0);
+  double range = m_rng->GetValue (0, 400);
+  std::vector<uint32_t> found;
+  m_grid->GetItemsInRange (position, range, found);
+
+  std::vector<uint32_t> expected;
+  for (uint32_t i = 0; i < m_items.size (); i++)
+    {
+      if (CalculateDistance (position, m_items[i]->GetPosition ()) <= range)
+        {
+          expected.push_back (i);
+        }
+    }
+  if (found != expected)
+    {
+      m_nErrors++;
+    }
+  m_nQueries++;
+  m_nFound += found.size ();
+
+  // Change the course of an item
+  Ptr<MobilityModel> mobility = m_items[m_rng->GetInteger (0, m_items.size () - 1)];
+  Ptr<ConstantVelocityMobilityModel> moving = DynamicCast<ConstantVelocityMobilityModel> (mobility);
+  if (moving && m_rng->GetValue () < 0.5)
+    {
+      moving->SetVelocity (Vector (m_rng->GetValue (-30, 30), m_rng->GetValue (-30, 30), 0));
+    }
+  else
+    {
+      mobility->SetPosition (Vector (m_rng->GetValue (0, 1000), m_rng->GetValue (0, 1000), 0));
+    }
+
+  Simulator::Schedule (MilliSeconds (m_rng->GetInteger (1, 200)), &MobilityGridTestCase::Step, this);
+}
+
+void
+MobilityGridTestCase::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+  m_grid = Create<MobilityGrid> (100);
+  m_nQueries = 0;
+  m_nFound = 0;
+  m_nErrors = 0;
+
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      Ptr<MobilityModel> mobility;
+      if (i % 3 == 0)
+        {
+          Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+          moving->SetVelocity (Vector (m_rng->GetValue (-30, 30), m_rng->GetValue (-30, 30), 0));
+          mobility = moving;
+        }
+      else if (i % 3 == 1 || i == 2)
+        {
+          mobility = CreateObject<ConstantPositionMobilityModel> ();
+        }
+      else
+        {
+          // Several items may follow the same mobility model
+          mobility = m_items[i - 1];
+        }
+      mobility->SetPosition (Vector (m_rng->GetValue (0, 1000), m_rng->GetValue (0, 1000), m_rng->GetValue (0, 10)));
+      NS_TEST_ASSERT_MSG_EQ (m_grid->Add (mobility), i, "wrong item index");
+      m_items.push_back (mobility);
+    }
+
+  Simulator::Schedule (Seconds (1), &MobilityGridTestCase::Step, this);
+  Simulator::Stop (Seconds (100));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_GT (m_nQueries, 900, "too few queries");
+  NS_TEST_EXPECT_MSG_GT (m_nFound, m_nQueries * 10, "too few items found");
+  NS_TEST_EXPECT_MSG_EQ (m_nErrors, 0, "wrong items found");
+
+  m_grid = 0;
+  m_items.clear ();
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief MobilityGrid TestSuite
+ */
+class MobilityGridTestSuite : public TestSuite
+{
+public:
+  MobilityGridTestSuite ()
+    : TestSuite ("mobility-grid", UNIT)
+  {
+    AddTestCase (new MobilityGridTestCase, TestCase::QUICK);
+  }
+};
+
+static MobilityGridTestSuite g_mobilityGridTestSuite; //!< Static variable for test initialization
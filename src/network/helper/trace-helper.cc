@@ -159,6 +159,92 @@ PcapHelper::GetFilenameFromInterfacePair (std::string prefix, Ptr<Object> object
   return oss.str ();
 }
 
+std::string
+PcapHelper::GetPcapNgFilenameFromNode (std::string prefix, Ptr<Node> node, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (prefix << node << useObjectNames);
+  NS_ABORT_MSG_UNLESS (prefix.size (), "Empty prefix string");
+
+  std::ostringstream oss;
+  oss << prefix << "-";
+
+  std::string nodename;
+  if (useObjectNames)
+    {
+      nodename = Names::FindName (node);
+    }
+
+  if (nodename.size ())
+    {
+      oss << nodename;
+    }
+  else
+    {
+      oss << node->GetId ();
+    }
+
+  oss << ".pcapng";
+
+  return oss.str ();
+}
+
+std::string
+PcapHelper::GetInterfaceNameFromDevice (Ptr<NetDevice> device, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (device << useObjectNames);
+
+  std::ostringstream oss;
+  std::string nodename;
+  std::string devicename;
+
+  Ptr<Node> node = device->GetNode ();
+
+  if (useObjectNames)
+    {
+      nodename = Names::FindName (node);
+      devicename = Names::FindName (device);
+    }
+
+  if (nodename.size ())
+    {
+      oss << nodename;
+    }
+  else
+    {
+      oss << node->GetId ();
+    }
+
+  oss << "-";
+
+  if (devicename.size ())
+    {
+      oss << devicename;
+    }
+  else
+    {
+      oss << device->GetIfIndex ();
+    }
+
+  return oss.str ();
+}
+
+Ptr<PcapNgFileWrapper>
+PcapHelper::CreatePcapNgFile (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+
+  Ptr<PcapNgFileWrapper> file = CreateObject<PcapNgFileWrapper> ();
+  file->Open (filename);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename);
+
+  //
+  // As for CreateFile, ownership is implicitly transferred to the trace
+  // callbacks hooked to the file; the file is flushed and closed when the
+  // last of them goes away.
+  //
+  return file;
+}
+
 //
 // The basic default trace sink.  This one just writes the packet to the pcap
 // file which is good enough for most kinds of captures.
@@ -177,6 +263,13 @@ PcapHelper::SinkWithHeader (Ptr<PcapFileWrapper> file, const Header &header, Ptr
   file->Write (Simulator::Now (), header, p);
 }
 
+void
+PcapHelper::DefaultPcapNgSink (Ptr<PcapNgFileWrapper> file, uint32_t interfaceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << interfaceId << p);
+  file->Write (Simulator::Now (), interfaceId, p);
+}
+
 AsciiTraceHelper::AsciiTraceHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -397,6 +490,41 @@ AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
+Ptr<BinaryTraceFile>
+AsciiTraceHelper::CreateBinaryFile (std::string filename, uint32_t digestSize)
+{
+  NS_LOG_FUNCTION (filename << digestSize);
+  return Create<BinaryTraceFile> (filename, digestSize);
+}
+
+void
+AsciiTraceHelper::BinaryEnqueueSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << nodeId << deviceId << p);
+  file->Write (Simulator::Now (), BinaryTraceFile::ENQUEUE, nodeId, deviceId, p);
+}
+
+void
+AsciiTraceHelper::BinaryDropSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << nodeId << deviceId << p);
+  file->Write (Simulator::Now (), BinaryTraceFile::DROP, nodeId, deviceId, p);
+}
+
+void
+AsciiTraceHelper::BinaryDequeueSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << nodeId << deviceId << p);
+  file->Write (Simulator::Now (), BinaryTraceFile::DEQUEUE, nodeId, deviceId, p);
+}
+
+void
+AsciiTraceHelper::BinaryReceiveSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << nodeId << deviceId << p);
+  file->Write (Simulator::Now (), BinaryTraceFile::RECEIVE, nodeId, deviceId, p);
+}
+
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
@@ -462,6 +590,61 @@ PcapHelperForDevice::EnablePcap (std::string prefix, uint32_t nodeid, uint32_t d
     }
 }
 
+void
+PcapHelperForDevice::EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+  NS_FATAL_ERROR ("PcapHelperForDevice::EnablePcapNgInternal(): pcapng output is not supported by this helper");
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+  EnablePcapNgInternal (file, nd, promiscuous);
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (Ptr<PcapNgFileWrapper> file, NetDeviceContainer d, bool promiscuous)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      Ptr<NetDevice> dev = *i;
+      EnablePcapNg (file, dev, promiscuous);
+    }
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (Ptr<PcapNgFileWrapper> file, NodeContainer n, bool promiscuous)
+{
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          EnablePcapNg (file, node->GetDevice (j), promiscuous);
+        }
+    }
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (std::string prefix, NodeContainer n, bool promiscuous)
+{
+  PcapHelper pcapHelper;
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      Ptr<PcapNgFileWrapper> file = pcapHelper.CreatePcapNgFile (pcapHelper.GetPcapNgFilenameFromNode (prefix, node));
+      EnablePcapNg (file, NodeContainer (node), promiscuous);
+    }
+}
+
+void
+PcapHelperForDevice::EnablePcapNgAll (std::string filename, bool promiscuous)
+{
+  PcapHelper pcapHelper;
+  Ptr<PcapNgFileWrapper> file = pcapHelper.CreatePcapNgFile (filename);
+  EnablePcapNg (file, NodeContainer::GetGlobal (), promiscuous);
+}
+
 //
 // Public API
 //
@@ -650,5 +833,45 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
     }
 }
 
+void
+AsciiTraceHelperForDevice::EnableBinaryInternal (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd)
+{
+  NS_FATAL_ERROR ("AsciiTraceHelperForDevice::EnableBinaryInternal(): binary traces are not supported by this helper");
+}
+
+void
+AsciiTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd)
+{
+  EnableBinaryInternal (file, nd);
+}
+
+void
+AsciiTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, NetDeviceContainer d)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      EnableBinaryInternal (file, *i);
+    }
+}
+
+void
+AsciiTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, NodeContainer n)
+{
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          EnableBinaryInternal (file, node->GetDevice (j));
+        }
+    }
+}
+
+void
+AsciiTraceHelperForDevice::EnableBinaryAll (Ptr<BinaryTraceFile> file)
+{
+  EnableBinary (file, NodeContainer::GetGlobal ());
+}
+
 } // namespace ns3
 
@@ -24,7 +24,9 @@
 #include "ns3/node-container.h"
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/binary-trace-file.h"
 
 namespace ns3 {
 
@@ -94,6 +96,27 @@ public:
   std::string GetFilenameFromInterfacePair (std::string prefix, Ptr<Object> object, 
                                             uint32_t interface, bool useObjectNames = true);
 
+  /**
+   * @brief Let the pcap helper figure out a reasonable filename to use for the
+   * pcapng file collecting all the devices of a node.
+   *
+   * @param prefix prefix string
+   * @param node Node
+   * @param useObjectNames use node names instead of indexes
+   * @returns file name
+   */
+  std::string GetPcapNgFilenameFromNode (std::string prefix, Ptr<Node> node, bool useObjectNames = true);
+
+  /**
+   * @brief Let the pcap helper figure out a reasonable interface name to
+   * store in the Interface Description Block of a device.
+   *
+   * @param device NetDevice
+   * @param useObjectNames use node and device names instead of indexes
+   * @returns interface name
+   */
+  std::string GetInterfaceNameFromDevice (Ptr<NetDevice> device, bool useObjectNames = true);
+
   /**
    * @brief Create and initialize a pcap file.
    * 
@@ -118,6 +141,28 @@ public:
    */
   template <typename T> void HookDefaultSink (Ptr<T> object, std::string traceName, Ptr<PcapFileWrapper> file);
 
+  /**
+   * @brief Create a pcapng file and write its section header.
+   *
+   * Interfaces are declared afterwards with PcapNgFileWrapper::AddInterface,
+   * typically by the device helpers as devices are hooked to the file.
+   *
+   * @param filename file name
+   * @returns a smart pointer to the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> CreatePcapNgFile (std::string filename);
+
+  /**
+   * @brief Hook a trace source to the default pcapng trace sink
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param file file wrapper
+   * @param interfaceId interface identifier returned by PcapNgFileWrapper::AddInterface
+   */
+  template <typename T> void HookDefaultSink (Ptr<T> object, std::string traceName,
+                                              Ptr<PcapNgFileWrapper> file, uint32_t interfaceId);
+
 private:
   /**
    * The basic default trace sink.
@@ -141,6 +186,16 @@ private:
    * @see DefaultSink
    */
   static void SinkWithHeader (Ptr<PcapFileWrapper> file, const Header& header, Ptr<const Packet> p);
+
+  /**
+   * The default pcapng trace sink: writes the packet in an Enhanced Packet
+   * Block tagged with the interface of the device it was captured on.
+   *
+   * @param file the file to write to
+   * @param interfaceId the interface the packet was captured on
+   * @param p the packet to write
+   */
+  static void DefaultPcapNgSink (Ptr<PcapNgFileWrapper> file, uint32_t interfaceId, Ptr<const Packet> p);
 };
 
 template <typename T> void
@@ -151,6 +206,14 @@ PcapHelper::HookDefaultSink (Ptr<T> object, std::string tracename, Ptr<PcapFileW
   NS_ASSERT_MSG (result == true, "PcapHelper::HookDefaultSink():  Unable to hook \"" << tracename << "\"");
 }
 
+template <typename T> void
+PcapHelper::HookDefaultSink (Ptr<T> object, std::string tracename, Ptr<PcapNgFileWrapper> file, uint32_t interfaceId)
+{
+  bool result =
+    object->TraceConnectWithoutContext (tracename.c_str (), MakeBoundCallback (&DefaultPcapNgSink, file, interfaceId));
+  NS_ASSERT_MSG (result == true, "PcapHelper::HookDefaultSink():  Unable to hook \"" << tracename << "\"");
+}
+
 /**
  * \brief Manage ASCII trace files for device models
  *
@@ -222,6 +285,35 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create a compact binary trace file.
+   *
+   * Binary traces record a fixed-size entry per event instead of a printed
+   * packet, so they do not need packet printing to be enabled.  They can be
+   * turned into text after the run with BinaryTraceFile::ConvertToAscii.
+   *
+   * @param filename file name
+   * @param digestSize number of leading packet bytes hashed into each
+   * record, zero to disable the digest
+   * @returns a smart pointer to the binary trace file
+   */
+  Ptr<BinaryTraceFile> CreateBinaryFile (std::string filename, uint32_t digestSize = 0);
+
+  /**
+   * @brief Hook a trace source to the default binary trace sink for the
+   * given kind of event.
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param file binary trace file
+   * @param event kind of event recorded when the trace source fires
+   * @param nodeId node id recorded with the event
+   * @param deviceId device index recorded with the event
+   */
+  template <typename T>
+  void HookBinarySink (Ptr<T> object, std::string traceName, Ptr<BinaryTraceFile> file,
+                       BinaryTraceFile::EventType event, uint32_t nodeId, uint32_t deviceId);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -455,8 +547,84 @@ public:
    * @param p the packet
    */
   static void DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> file, std::string context, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Enqueue binary trace sink, the binary counterpart of
+   * DefaultEnqueueSinkWithContext.
+   *
+   * @param file the binary trace file
+   * @param nodeId the node id
+   * @param deviceId the device index
+   * @param p the packet
+   */
+  static void BinaryEnqueueSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Drop binary trace sink, the binary counterpart of
+   * DefaultDropSinkWithContext.
+   *
+   * @param file the binary trace file
+   * @param nodeId the node id
+   * @param deviceId the device index
+   * @param p the packet
+   */
+  static void BinaryDropSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Dequeue binary trace sink, the binary counterpart of
+   * DefaultDequeueSinkWithContext.
+   *
+   * @param file the binary trace file
+   * @param nodeId the node id
+   * @param deviceId the device index
+   * @param p the packet
+   */
+  static void BinaryDequeueSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Receive binary trace sink, the binary counterpart of
+   * DefaultReceiveSinkWithContext.
+   *
+   * @param file the binary trace file
+   * @param nodeId the node id
+   * @param deviceId the device index
+   * @param p the packet
+   */
+  static void BinaryReceiveSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p);
 };
 
+template <typename T> void
+AsciiTraceHelper::HookBinarySink (
+  Ptr<T> object,
+  std::string tracename,
+  Ptr<BinaryTraceFile> file,
+  BinaryTraceFile::EventType event,
+  uint32_t nodeId,
+  uint32_t deviceId)
+{
+  void (*sink)(Ptr<BinaryTraceFile>, uint32_t, uint32_t, Ptr<const Packet>) = 0;
+  switch (event)
+    {
+    case BinaryTraceFile::ENQUEUE:
+      sink = &BinaryEnqueueSink;
+      break;
+    case BinaryTraceFile::DEQUEUE:
+      sink = &BinaryDequeueSink;
+      break;
+    case BinaryTraceFile::DROP:
+      sink = &BinaryDropSink;
+      break;
+    case BinaryTraceFile::RECEIVE:
+      sink = &BinaryReceiveSink;
+      break;
+    }
+  NS_ASSERT (sink != 0);
+  bool result =
+    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (sink, file, nodeId, deviceId));
+  NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookBinarySink():  Unable to hook \""
+                 << tracename << "\"");
+}
+
 template <typename T> void
 AsciiTraceHelper::HookDefaultEnqueueSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file)
 {
@@ -572,6 +740,20 @@ public:
    */
   virtual void EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename) = 0;
 
+  /**
+   * @brief Enable pcapng output on the indicated net device.
+   *
+   * The implementation is expected to declare a new interface in the
+   * provided file for the device and hook its sniffer trace source to the
+   * file.  Helpers that do not override this method do not support pcapng
+   * output; calling it on them is a fatal error.
+   *
+   * @param file pcapng file shared by all the devices being traced
+   * @param nd Net device for which you want to enable tracing.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  virtual void EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous);
+
   /**
    * @brief Enable pcap output the indicated net device.
    *
@@ -632,6 +814,57 @@ public:
    * @param promiscuous If true capture all possible packets available at the device.
    */
   void EnablePcapAll (std::string prefix, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on the indicated net device, writing to a
+   * file that may be shared with other devices.
+   *
+   * @param file pcapng file, as returned by PcapHelper::CreatePcapNgFile
+   * @param nd Net device for which you want to enable tracing.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device in the container which is of
+   * the appropriate type, all of them writing to the same file.
+   *
+   * @param file pcapng file, as returned by PcapHelper::CreatePcapNgFile
+   * @param d container of devices
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (Ptr<PcapNgFileWrapper> file, NetDeviceContainer d, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device (which is of the appropriate
+   * type) in the nodes provided in the container, all of them writing to the
+   * same file.
+   *
+   * @param file pcapng file, as returned by PcapHelper::CreatePcapNgFile
+   * @param n container of nodes.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (Ptr<PcapNgFileWrapper> file, NodeContainer n, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output with one file per node, each file holding
+   * one interface for every device (of the appropriate type) of the node.
+   *
+   * \param prefix Filename prefix to use for pcapng files.
+   * \param n container of nodes.
+   * \param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (std::string prefix, NodeContainer n, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device (which is of the appropriate
+   * type) in the set of all nodes created in the simulation, writing them all
+   * to a single file.
+   *
+   * @param filename name of the pcapng file.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNgAll (std::string filename, bool promiscuous = false);
 };
 
 /**
@@ -798,6 +1031,54 @@ public:
    */
   void EnableAscii (Ptr<OutputStreamWrapper> stream, uint32_t nodeid, uint32_t deviceid);
 
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * @param file binary trace file, as returned by AsciiTraceHelper::CreateBinaryFile
+   * @param nd Net device for which you want to enable tracing.
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd);
+
+  /**
+   * @brief Enable binary trace output on each device in the container which
+   * is of the appropriate type.
+   *
+   * @param file binary trace file, as returned by AsciiTraceHelper::CreateBinaryFile
+   * @param d container of devices
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, NetDeviceContainer d);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the nodes provided in the container.
+   *
+   * @param file binary trace file, as returned by AsciiTraceHelper::CreateBinaryFile
+   * @param n container of nodes.
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, NodeContainer n);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the set of all nodes created in the simulation.
+   *
+   * @param file binary trace file, as returned by AsciiTraceHelper::CreateBinaryFile
+   */
+  void EnableBinaryAll (Ptr<BinaryTraceFile> file);
+
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * The implementation is expected to hook the same trace sources as
+   * EnableAsciiInternal to the binary sinks of AsciiTraceHelper, using the
+   * node id and device index of the device.  Helpers that do not override
+   * this method do not support binary traces; calling it on them is a
+   * fatal error.
+   *
+   * @param file binary trace file
+   * @param nd Net device for which you want to enable tracing
+   */
+  virtual void EnableBinaryInternal (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd);
+
 private:
   /**
    * @brief Enable ascii trace output on the device specified by a global
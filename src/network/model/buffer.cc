@@ -21,6 +21,11 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#if defined (__GNUC__) && defined (__x86_64__)
+#define BUFFER_HAVE_SIMD_CHECKSUM 1
+#include <immintrin.h>
+#endif
+
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
                 ", zero end="<<m_zeroAreaEnd<<", count="<<m_data->m_count<<", size="<<m_data->m_size<<   \
@@ -1139,18 +1144,193 @@ Buffer::Iterator::CalculateIpChecksum (uint16_t size)
   return CalculateIpChecksum (size, 0);
 }
 
+namespace {
+
+/*
+ * The checksum kernels below return the sum of the 16-bit words of a
+ * memory area read in little-endian order, as Buffer::Iterator::ReadU16
+ * does, a trailing odd byte being the low byte of a last word.  The sum
+ * is not folded: RFC 1071 allows the words to be added in any order and
+ * with any width as long as the carries are folded back at the end.
+ * Since a checksummed area is at most 64 KiB long, none of the
+ * accumulators can overflow.
+ */
+
+/**
+ * \brief Portable checksum kernel
+ * \param data start of the area
+ * \param len length of the area in bytes
+ * \returns the unfolded sum of the 16-bit words of the area
+ */
+uint64_t
+ChecksumScalar (const uint8_t *data, uint32_t len)
+{
+  uint64_t sum = 0;
+  while (len >= 4)
+    {
+      // A 32-bit word is the sum of two 16-bit words modulo 0xffff
+      sum += data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+      data += 4;
+      len -= 4;
+    }
+  if (len >= 2)
+    {
+      sum += data[0] | (data[1] << 8);
+      data += 2;
+      len -= 2;
+    }
+  if (len)
+    {
+      sum += data[0];
+    }
+  return sum;
+}
+
+#ifdef BUFFER_HAVE_SIMD_CHECKSUM
+
+/**
+ * \brief SSE2 checksum kernel, always available on x86_64
+ * \param data start of the area
+ * \param len length of the area in bytes
+ * \returns the unfolded sum of the 16-bit words of the area
+ */
+uint64_t
+ChecksumSse2 (const uint8_t *data, uint32_t len)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i acc = zero;
+  while (len >= 16)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *)data);
+      acc = _mm_add_epi32 (acc, _mm_unpacklo_epi16 (v, zero));
+      acc = _mm_add_epi32 (acc, _mm_unpackhi_epi16 (v, zero));
+      data += 16;
+      len -= 16;
+    }
+  uint32_t lanes[4];
+  _mm_storeu_si128 ((__m128i *)lanes, acc);
+  return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] + ChecksumScalar (data, len);
+}
+
+/**
+ * \brief AVX2 checksum kernel
+ * \param data start of the area
+ * \param len length of the area in bytes
+ * \returns the unfolded sum of the 16-bit words of the area
+ */
+__attribute__ ((target ("avx2")))
+uint64_t
+ChecksumAvx2 (const uint8_t *data, uint32_t len)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  __m256i acc = zero;
+  while (len >= 32)
+    {
+      __m256i v = _mm256_loadu_si256 ((const __m256i *)data);
+      acc = _mm256_add_epi32 (acc, _mm256_unpacklo_epi16 (v, zero));
+      acc = _mm256_add_epi32 (acc, _mm256_unpackhi_epi16 (v, zero));
+      data += 32;
+      len -= 32;
+    }
+  uint32_t lanes[8];
+  _mm256_storeu_si256 ((__m256i *)lanes, acc);
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      sum += lanes[i];
+    }
+  return sum + ChecksumSse2 (data, len);
+}
+
+#endif /* BUFFER_HAVE_SIMD_CHECKSUM */
+
+/// Signature of the checksum kernels
+typedef uint64_t (*ChecksumKernel)(const uint8_t *, uint32_t);
+
+/**
+ * \returns the fastest checksum kernel supported by the CPU
+ */
+ChecksumKernel
+SelectChecksumKernel (void)
+{
+#ifdef BUFFER_HAVE_SIMD_CHECKSUM
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    {
+      return &ChecksumAvx2;
+    }
+  return &ChecksumSse2;
+#else
+  return &ChecksumScalar;
+#endif
+}
+
+/**
+ * The kernel is selected on first use rather than by a static initializer,
+ * which may run after those of other files computing checksums.
+ *
+ * \returns the kernel used by Buffer::Iterator::CalculateIpChecksum
+ */
+ChecksumKernel
+GetChecksumKernel (void)
+{
+  static const ChecksumKernel kernel = SelectChecksumKernel ();
+  return kernel;
+}
+
+/**
+ * \brief Add the checksum of a memory area to a running sum
+ * \param sum running sum
+ * \param data start of the area
+ * \param len length of the area in bytes
+ * \param odd whether the area starts at an odd offset from the start of
+ * the checksummed data
+ * \returns the updated running sum
+ */
+uint64_t
+AddChecksumArea (uint64_t sum, const uint8_t *data, uint32_t len, bool odd)
+{
+  uint64_t area = GetChecksumKernel () (data, len);
+  if (odd)
+    {
+      // The bytes of the area are in the other half of the words of the
+      // checksummed data: swap the bytes of its folded sum.
+      while (area >> 16)
+        {
+          area = (area & 0xffff) + (area >> 16);
+        }
+      area = ((area & 0xff) << 8) | (area >> 8);
+    }
+  return sum + area;
+}
+
+} // unnamed namespace
+
 uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
+  NS_ASSERT_MSG (m_current + size <= m_dataEnd, GetReadErrorMessage ());
   /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  uint64_t sum = initialChecksum;
+  uint32_t start = m_current;
+  uint32_t end = m_current + size;
+
+  // Data before the zero area is at the same offset in m_data, data after
+  // it is shifted by the size of the zero area, and the zero area itself
+  // adds nothing to the sum.
+  if (start < m_zeroStart)
+    {
+      uint32_t areaEnd = std::min (end, m_zeroStart);
+      sum = AddChecksumArea (sum, m_data + start, areaEnd - start, false);
+    }
+  uint32_t afterZero = std::max (start, m_zeroEnd);
+  if (afterZero < end)
+    {
+      sum = AddChecksumArea (sum, m_data + afterZero - (m_zeroEnd - m_zeroStart),
+                             end - afterZero, (afterZero - start) & 1);
+    }
+  m_current = end;
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
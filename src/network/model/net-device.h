@@ -359,6 +359,18 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \brief Check whether the device transmits TCP super-segments
+   *
+   * A device supporting segmentation offload sends a packet carrying a
+   * TsoTag as the train of segments it stands for.  The IP layer splits
+   * the super-segments into single segments before the other devices.
+   * The default implementation returns false.
+   *
+   * \return true if this interface supports segmentation offload, false otherwise.
+   */
+  virtual bool SupportsTso (void) const;
+
 };
 
 } // namespace ns3
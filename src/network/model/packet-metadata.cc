@@ -37,6 +37,9 @@ bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+PacketMetadata::DecodeCache PacketMetadata::m_decodeCache;
+bool PacketMetadata::m_decodeCacheBusy = false;
+uint64_t PacketMetadata::m_lastVersion = 0;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -48,6 +51,58 @@ PacketMetadata::DataFreeList::~DataFreeList ()
   PacketMetadata::m_enable = false;
 }
 
+PacketMetadata::DecodeCacheEntry::DecodeCacheEntry ()
+  : data (0),
+    version (0),
+    head (0xffff),
+    tail (0xffff),
+    size (0)
+{
+}
+
+void
+PacketMetadata::DecodeCacheEntry::Clear (void)
+{
+  for (std::vector<DecodedItem>::iterator i = items.begin (); i != items.end (); i++)
+    {
+      delete i->chunk;
+    }
+  items.clear ();
+  data = 0;
+}
+
+PacketMetadata::DecodeCache::DecodeCache ()
+  : std::vector<DecodeCacheEntry> (PacketMetadata::DECODE_CACHE_SIZE_DEFAULT)
+{
+}
+
+PacketMetadata::DecodeCache::~DecodeCache ()
+{
+  NS_LOG_FUNCTION (this);
+  for (iterator i = begin (); i != end (); i++)
+    {
+      i->Clear ();
+    }
+}
+
+void
+PacketMetadata::SetDecodeCacheSize (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  NS_ASSERT_MSG (!m_decodeCacheBusy, "Cannot resize the decode cache while it is in use");
+  for (DecodeCache::iterator i = m_decodeCache.begin (); i != m_decodeCache.end (); i++)
+    {
+      i->Clear ();
+    }
+  m_decodeCache.resize (n);
+}
+
+void
+PacketMetadata::Touch (struct PacketMetadata::Data *data)
+{
+  data->m_version = ++m_lastVersion;
+}
+
 void 
 PacketMetadata::Enable (void)
 {
@@ -341,6 +396,7 @@ PacketMetadata::UpdateTail (uint16_t written)
   NS_ASSERT (written >= 8);
   m_used += written;
   m_data->m_dirtyEnd = m_used;
+  Touch (m_data);
 }
 
 
@@ -368,6 +424,7 @@ PacketMetadata::UpdateHead (uint16_t written)
   NS_ASSERT (written >= 8);
   m_used += written;
   m_data->m_dirtyEnd = m_used;
+  Touch (m_data);
 }
 
 uint16_t
@@ -496,6 +553,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
       Append32 (extraItem->packetUid, buffer);
       m_used = std::max (m_used, (uint16_t)(buffer - &m_data->m_data[0]));
       m_data->m_dirtyEnd = m_used;
+      Touch (m_data);
       return;
     }
 
@@ -583,6 +641,7 @@ PacketMetadata::Create (uint32_t size)
         {
           NS_LOG_LOGIC ("create found size="<<data->m_size);
           data->m_count = 1;
+          Touch (data);
           return data;
         }
       NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
@@ -629,6 +688,7 @@ PacketMetadata::Allocate (uint32_t n)
   data->m_size = n;
   data->m_count = 1;
   data->m_dirtyEnd = 0;
+  Touch (data);
   return data;
 }
 void 
@@ -1129,6 +1189,151 @@ PacketMetadata::ItemIterator::Next (void)
   return item;
 }
 
+void
+PacketMetadata::Decode (Buffer buffer, DecodeCacheEntry *entry) const
+{
+  NS_LOG_FUNCTION (this << &buffer << entry);
+  entry->data = m_data;
+  entry->version = m_data->m_version;
+  entry->head = m_head;
+  entry->tail = m_tail;
+  entry->size = buffer.GetSize ();
+  uint32_t offset = 0;
+  ItemIterator i = BeginItem (buffer);
+  while (i.HasNext ())
+    {
+      Item item = i.Next ();
+      DecodedItem decoded;
+      decoded.info.type = item.type;
+      decoded.info.isFragment = item.isFragment;
+      decoded.info.tid = item.tid;
+      decoded.info.offset = offset;
+      decoded.info.currentSize = item.currentSize;
+      decoded.info.currentTrimedFromStart = item.currentTrimedFromStart;
+      decoded.info.currentTrimedFromEnd = item.currentTrimedFromEnd;
+      decoded.chunk = 0;
+      entry->items.push_back (decoded);
+      offset += item.currentSize;
+    }
+}
+
+PacketMetadata::DecodeCacheEntry *
+PacketMetadata::LookupDecoded (Buffer buffer, DecodeCacheEntry *scratch) const
+{
+  NS_LOG_FUNCTION (this << &buffer << scratch);
+  if (m_decodeCache.empty () || m_decodeCacheBusy)
+    {
+      Decode (buffer, scratch);
+      return scratch;
+    }
+  uintptr_t key = reinterpret_cast<uintptr_t> (m_data) / sizeof (struct Data);
+  key = key * 31 + m_head;
+  key = key * 31 + m_tail;
+  DecodeCacheEntry *entry = &m_decodeCache[key % m_decodeCache.size ()];
+  if (entry->data == m_data &&
+      entry->version == m_data->m_version &&
+      entry->head == m_head &&
+      entry->tail == m_tail &&
+      entry->size == buffer.GetSize ())
+    {
+      NS_LOG_LOGIC ("decode cache hit");
+      return entry;
+    }
+  NS_LOG_LOGIC ("decode cache miss");
+  entry->Clear ();
+  Decode (buffer, entry);
+  return entry;
+}
+
+void
+PacketMetadata::VisitItems (Buffer buffer, ItemVisitor visitor) const
+{
+  NS_LOG_FUNCTION (this << &buffer);
+  if (m_head == 0xffff)
+    {
+      return;
+    }
+  DecodeCacheEntry scratch;
+  DecodeCacheEntry *entry = LookupDecoded (buffer, &scratch);
+  bool wasBusy = m_decodeCacheBusy;
+  m_decodeCacheBusy = true;
+  for (std::vector<DecodedItem>::const_iterator i = entry->items.begin (); i != entry->items.end (); i++)
+    {
+      if (!visitor (i->info))
+        {
+          break;
+        }
+    }
+  m_decodeCacheBusy = wasBusy;
+  scratch.Clear ();
+}
+
+void
+PacketMetadata::Print (std::ostream &os, Buffer buffer) const
+{
+  NS_LOG_FUNCTION (this << &os << &buffer);
+  if (m_head == 0xffff)
+    {
+      return;
+    }
+  DecodeCacheEntry scratch;
+  DecodeCacheEntry *entry = LookupDecoded (buffer, &scratch);
+  bool wasBusy = m_decodeCacheBusy;
+  m_decodeCacheBusy = true;
+  for (std::vector<DecodedItem>::iterator i = entry->items.begin (); i != entry->items.end (); i++)
+    {
+      ItemInfo const &info = i->info;
+      if (i != entry->items.begin ())
+        {
+          os << " ";
+        }
+      if (info.isFragment)
+        {
+          switch (info.type) {
+            case PacketMetadata::Item::PAYLOAD:
+              os << "Payload";
+              break;
+            case PacketMetadata::Item::HEADER:
+            case PacketMetadata::Item::TRAILER:
+              os << info.tid.GetName ();
+              break;
+            }
+          os << " Fragment [" << info.currentTrimedFromStart<<":"
+             << (info.currentTrimedFromStart + info.currentSize) << "]";
+          continue;
+        }
+      switch (info.type) {
+        case PacketMetadata::Item::PAYLOAD:
+          os << "Payload (size=" << info.currentSize << ")";
+          break;
+        case PacketMetadata::Item::HEADER:
+        case PacketMetadata::Item::TRAILER:
+          os << info.tid.GetName () << " (";
+          if (i->chunk == 0)
+            {
+              NS_ASSERT (info.tid.HasConstructor ());
+              Callback<ObjectBase *> constructor = info.tid.GetConstructor ();
+              NS_ASSERT (!constructor.IsNull ());
+              ObjectBase *instance = constructor ();
+              NS_ASSERT (instance != 0);
+              Chunk *chunk = dynamic_cast<Chunk *> (instance);
+              NS_ASSERT (chunk != 0);
+              Buffer::Iterator start = buffer.Begin ();
+              start.Next (info.offset);
+              Buffer::Iterator end = start;
+              end.Next (info.currentSize);
+              chunk->Deserialize (start, end);
+              i->chunk = chunk;
+            }
+          i->chunk->Print (os);
+          os << ")";
+          break;
+        }
+    }
+  m_decodeCacheBusy = wasBusy;
+  scratch.Clear ();
+}
+
 uint32_t 
 PacketMetadata::GetSerializedSize (void) const
 {
@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include <vector>
+#include <ostream>
 #include <limits>
 #include "ns3/callback.h"
 #include "ns3/assert.h"
@@ -74,6 +75,17 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * Walking this list and instantiating every header and trailer it
+ * refers to is expensive, and ASCII tracing does it several times for
+ * each packet.  A small decode cache keeps the decoded item list, and
+ * the headers and trailers deserialized by Print, of the most recently
+ * printed packets.  It is keyed by the data block, its version and the
+ * head and tail of the list, so that copies of a packet which have not
+ * been modified since share the same entry.  The version of a data block
+ * changes whenever its content is modified in place or when the block is
+ * recycled, which invalidates any stale entry.  VisitItems gives access
+ * to the decoded items without printing anything.
  */
 class PacketMetadata 
 {
@@ -152,6 +164,50 @@ private:
     bool m_hasReadTail; //!< true if the metadata tail has been read
   };
 
+  /**
+   * \brief structure describing a packet metadata item, as passed
+   * to an ItemVisitor
+   *
+   * Unlike Item, this structure does not refer to the packet buffer.
+   */
+  struct ItemInfo
+  {
+    Item::ItemType type; //!< metadata type
+    /**
+     * true: this is a fragmented header, trailer, or, payload.
+     * false: this is a whole header, trailer, or, payload.
+     */
+    bool isFragment;
+    /**
+     * TypeId of Header or Trailer. Valid only if type is
+     * header or trailer.
+     */
+    TypeId tid;
+    /**
+     * offset (in bytes) of the item from the start of the packet
+     */
+    uint32_t offset;
+    /**
+     * size of item. If fragment, size of fragment. Otherwise,
+     * size of original item.
+     */
+    uint32_t currentSize;
+    /**
+     * how many bytes were trimed from the start of a fragment.
+     */
+    uint32_t currentTrimedFromStart;
+    /**
+     * how many bytes were trimed from the end of a fragment.
+     */
+    uint32_t currentTrimedFromEnd;
+  };
+
+  /**
+   * Callback invoked by VisitItems for each item of a packet, in order.
+   * Returning false stops the walk.
+   */
+  typedef Callback<bool, ItemInfo const &> ItemVisitor;
+
   /**
    * \brief Enable the packet metadata
    */
@@ -160,6 +216,17 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Set the number of entries of the decode cache
+   *
+   * The cache is enabled by default, with DECODE_CACHE_SIZE_DEFAULT
+   * entries. All the current entries are dropped.
+   *
+   * \param n number of entries, zero disables the cache
+   */
+  static void SetDecodeCacheSize (uint32_t n);
+
+  static const uint32_t DECODE_CACHE_SIZE_DEFAULT = 64; //!< Default number of decode cache entries
 
   /**
    * \brief Constructor
@@ -258,6 +325,27 @@ private:
    */
   ItemIterator BeginItem (Buffer buffer) const;
 
+  /**
+   * \brief Invoke a visitor on each item of the packet, in order
+   *
+   * No header or trailer is instantiated, and the item list is taken
+   * from the decode cache when possible.
+   *
+   * \param buffer the buffer the metadata refers to
+   * \param visitor the callback to invoke
+   */
+  void VisitItems (Buffer buffer, ItemVisitor visitor) const;
+
+  /**
+   * \brief Print the content of the packet
+   *
+   * This is the implementation of Packet::Print.
+   *
+   * \param os output stream
+   * \param buffer the buffer the metadata refers to
+   */
+  void Print (std::ostream &os, Buffer buffer) const;
+
   /**
    *  \brief Serialization to raw uint8_t*
    *  \param buffer the buffer to serialize to
@@ -404,7 +492,7 @@ private:
 
   /**
    * the size of PacketMetadata::Data::m_data such that the total size
-   * of PacketMetadata::Data is 16 bytes
+   * of PacketMetadata::Data is 24 bytes
    */ 
 #define PACKET_METADATA_DATA_M_DATA_SIZE 8
   
@@ -419,6 +507,9 @@ private:
     /** max of the m_used field over all objects which
      * reference this struct Data instance */
     uint16_t m_dirtyEnd;
+    /** changed whenever the content of m_data is modified in place,
+     * to invalidate the decode cache entries built from it */
+    uint64_t m_version;
     /** variable-sized buffer of bytes */
     uint8_t m_data[PACKET_METADATA_DATA_M_DATA_SIZE]; 
   };
@@ -504,6 +595,44 @@ public:
   };
 
   friend DataFreeList::~DataFreeList ();
+
+  /**
+   * \brief A decoded item, as stored in the decode cache
+   */
+  struct DecodedItem
+  {
+    ItemInfo info; //!< item description
+    Chunk *chunk;  //!< deserialized header or trailer, 0 until first printed
+  };
+
+  /**
+   * \brief Decode cache entry
+   */
+  struct DecodeCacheEntry
+  {
+    const struct Data *data; //!< data block the items were decoded from, 0 if unused
+    uint64_t version;        //!< version of the data block
+    uint16_t head;           //!< list head
+    uint16_t tail;           //!< list tail
+    uint32_t size;           //!< size of the buffer
+    std::vector<DecodedItem> items; //!< decoded items
+
+    DecodeCacheEntry ();
+    /**
+     * Delete the deserialized chunks and mark the entry as unused
+     */
+    void Clear (void);
+  };
+
+  /**
+   * \brief Decode cache storage
+   */
+  class DecodeCache : public std::vector<DecodeCacheEntry>
+  {
+public:
+    DecodeCache ();
+    ~DecodeCache ();
+  };
   /// Friend class
   friend class ItemIterator;
 
@@ -604,6 +733,33 @@ public:
    */
   uint32_t GetTotalSize (void) const;
 
+  /**
+   * \brief Find the decode cache entry of this packet, decoding the
+   * item list on a miss
+   *
+   * The entry is only valid until the next lookup.  If the cache is
+   * disabled or already in use higher up the stack (for example by
+   * a header printing another packet), the items are decoded into
+   * the entry provided by the caller, which must then be cleared.
+   *
+   * \param buffer the buffer the metadata refers to
+   * \param scratch entry to use when the cache cannot be used
+   * \returns the entry holding the decoded items
+   */
+  DecodeCacheEntry *LookupDecoded (Buffer buffer, DecodeCacheEntry *scratch) const;
+  /**
+   * \brief Decode the item list into a cache entry
+   * \param buffer the buffer the metadata refers to
+   * \param entry the entry to fill
+   */
+  void Decode (Buffer buffer, DecodeCacheEntry *entry) const;
+  /**
+   * \brief Give a data block a new version, invalidating the decode
+   * cache entries built from it
+   * \param data the data block
+   */
+  static inline void Touch (struct Data *data);
+
   /**
    * \brief Read items
    * \param current the offset we should start reading the data from
@@ -662,6 +818,9 @@ public:
   static void Deallocate (struct PacketMetadata::Data *data);
 
   static DataFreeList m_freeList; //!< the metadata data storage
+  static DecodeCache m_decodeCache; //!< the decode cache
+  static bool m_decodeCacheBusy; //!< true while a decode cache entry is being used
+  static uint64_t m_lastVersion; //!< last version given to a data block
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
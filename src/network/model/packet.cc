@@ -433,69 +433,7 @@ Packet::ToString() const
 void 
 Packet::Print (std::ostream &os) const
 {
-  PacketMetadata::ItemIterator i = m_metadata.BeginItem (m_buffer);
-  while (i.HasNext ())
-    {
-      PacketMetadata::Item item = i.Next ();
-      if (item.isFragment)
-        {
-          switch (item.type) {
-            case PacketMetadata::Item::PAYLOAD:
-              os << "Payload";
-              break;
-            case PacketMetadata::Item::HEADER:
-            case PacketMetadata::Item::TRAILER:
-              os << item.tid.GetName ();
-              break;
-            }
-          os << " Fragment [" << item.currentTrimedFromStart<<":"
-             << (item.currentTrimedFromStart + item.currentSize) << "]";
-        }
-      else
-        {
-          switch (item.type) {
-            case PacketMetadata::Item::PAYLOAD:
-              os << "Payload (size=" << item.currentSize << ")";
-              break;
-            case PacketMetadata::Item::HEADER:
-            case PacketMetadata::Item::TRAILER:
-              os << item.tid.GetName () << " (";
-              {
-                NS_ASSERT (item.tid.HasConstructor ());
-                Callback<ObjectBase *> constructor = item.tid.GetConstructor ();
-                NS_ASSERT (!constructor.IsNull ());
-                ObjectBase *instance = constructor ();
-                NS_ASSERT (instance != 0);
-                Chunk *chunk = dynamic_cast<Chunk *> (instance);
-                NS_ASSERT (chunk != 0);
-                if (item.type == PacketMetadata::Item::HEADER)
-                  {
-                    Buffer::Iterator end = item.current;
-                    end.Next (item.currentSize); // move from start 
-                    chunk->Deserialize (item.current, end);
-                  }
-                else if (item.type == PacketMetadata::Item::TRAILER)
-                  {
-                    Buffer::Iterator start = item.current;
-                    start.Prev (item.currentSize); // move from end
-                    chunk->Deserialize (start, item.current);
-                  }
-                else
-                  {
-                    chunk->Deserialize (item.current);
-                  }    
-                chunk->Print (os);
-                delete chunk;
-              }
-              os << ")";
-              break;
-            }
-        }
-      if (i.HasNext ())
-        {
-          os << " ";
-        }
-    }
+  m_metadata.Print (os, m_buffer);
 #if 0
   // The code below will work only if headers and trailers
   // define the right attributes which is not the case for
@@ -568,6 +506,12 @@ Packet::BeginItem (void) const
   return m_metadata.BeginItem (m_buffer);
 }
 
+void
+Packet::VisitItems (PacketMetadata::ItemVisitor visitor) const
+{
+  m_metadata.VisitItems (m_buffer, visitor);
+}
+
 void
 Packet::EnablePrinting (void)
 {
@@ -509,6 +509,39 @@ public:
    */
   PacketMetadata::ItemIterator BeginItem (void) const;
 
+  /**
+   * \brief Invoke a visitor on each 'item' stored in this buffer
+   *
+   * This gives the type, offset and size of the headers, trailers and
+   * payload of the packet without instantiating the headers and
+   * trailers, and without formatting any output.  For example, to find
+   * the offset of the first header of a given type:
+   *
+   * \code
+   *   bool FindTcp (uint32_t *offset, PacketMetadata::ItemInfo const &item)
+   *   {
+   *     if (item.type == PacketMetadata::Item::HEADER
+   *         && item.tid == TcpHeader::GetTypeId ())
+   *       {
+   *         *offset = item.offset;
+   *         return false;  // stop here
+   *       }
+   *     return true;
+   *   }
+   *   ...
+   *   p->VisitItems (MakeBoundCallback (&FindTcp, &offset));
+   * \endcode
+   *
+   * Like BeginItem, this visits nothing if you don't call
+   * EnablePrinting or EnableChecking before.
+   *
+   * \param visitor callback invoked for each item, in order; the walk
+   * stops when it returns false
+   *
+   * \sa EnablePrinting EnableChecking
+   */
+  void VisitItems (PacketMetadata::ItemVisitor visitor) const;
+
   /**
    * \brief Enable printing packets metadata.
    *
@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/hash.h"
+#include "ns3/binary-trace-file.h"
+#include "ns3/packet.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceTestSuite");
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that records written to a BinaryTraceFile are converted
+ * back to the expected ASCII lines.
+ */
+class BinaryTraceConvertTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param digestSize number of packet bytes hashed into the digest
+   * \param bufferSize size of the write buffer
+   */
+  BinaryTraceConvertTestCase (uint32_t digestSize, uint32_t bufferSize);
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename; //!< File name
+  uint32_t m_digestSize;      //!< digest size to test
+  uint32_t m_bufferSize;      //!< buffer size to test
+};
+
+BinaryTraceConvertTestCase::BinaryTraceConvertTestCase (uint32_t digestSize, uint32_t bufferSize)
+  : TestCase ("Check that binary trace records convert to ASCII trace lines"),
+    m_digestSize (digestSize),
+    m_bufferSize (bufferSize)
+{
+}
+
+void
+BinaryTraceConvertTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".bin");
+}
+
+void
+BinaryTraceConvertTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceConvertTestCase::DoRun (void)
+{
+  const uint32_t nPackets = 100;
+  std::ostringstream expected;
+
+  {
+    Ptr<BinaryTraceFile> file = Create<BinaryTraceFile> (m_testFilename, m_digestSize, m_bufferSize);
+    NS_TEST_ASSERT_MSG_EQ (file->GetDigestSize (), m_digestSize, "Unexpected digest size");
+
+    const char events[] = { BinaryTraceFile::ENQUEUE, BinaryTraceFile::DEQUEUE,
+                            BinaryTraceFile::DROP, BinaryTraceFile::RECEIVE };
+    for (uint32_t i = 0; i < nPackets; ++i)
+      {
+        uint8_t data[64];
+        for (uint32_t j = 0; j < sizeof (data); ++j)
+          {
+            data[j] = i + j;
+          }
+        uint32_t size = 10 + (i % 50);
+        Ptr<Packet> p = Create<Packet> (data, size);
+        Time t = MicroSeconds (1500 * i);
+        char event = events[i % 4];
+        file->Write (t, BinaryTraceFile::EventType (event), i % 3, i % 2, p);
+
+        expected << event << " " << t.GetSeconds ()
+                 << " /NodeList/" << i % 3 << "/DeviceList/" << i % 2
+                 << " ns3::Packet(uid=" << p->GetUid () << " size=" << size;
+        if (m_digestSize > 0)
+          {
+            uint32_t n = std::min (m_digestSize, size);
+            expected << " digest=0x" << std::hex << Hash32 ((const char *)data, n) << std::dec;
+          }
+        expected << ")\n";
+      }
+    // The file is flushed and closed when the last reference goes away
+  }
+
+  std::ostringstream converted;
+  bool ok = BinaryTraceFile::ConvertToAscii (m_testFilename, converted);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Unable to convert " << m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (converted.str (), expected.str (), "Converted trace differs from the written records");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that ConvertToAscii rejects files that are not binary traces.
+ */
+class BinaryTraceBadFileTestCase : public TestCase
+{
+public:
+  BinaryTraceBadFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceBadFileTestCase::BinaryTraceBadFileTestCase ()
+  : TestCase ("Check that ConvertToAscii rejects unknown files")
+{
+}
+
+void
+BinaryTraceBadFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("not-a-binary-trace.bin");
+  FILE *f = std::fopen (filename.c_str (), "wb");
+  NS_TEST_ASSERT_MSG_NE (f, 0, "Unable to create " << filename);
+  std::fputs ("+ 1.0 /NodeList/0/DeviceList/0 ns3::Packet\n", f);
+  std::fclose (f);
+
+  std::ostringstream os;
+  bool ok = BinaryTraceFile::ConvertToAscii (filename, os);
+  NS_TEST_EXPECT_MSG_EQ (ok, false, "Text file accepted as a binary trace");
+  ok = BinaryTraceFile::ConvertToAscii (filename + ".missing", os);
+  NS_TEST_EXPECT_MSG_EQ (ok, false, "Missing file accepted as a binary trace");
+  NS_TEST_EXPECT_MSG_EQ (os.str ().empty (), true, "Unexpected output");
+  remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace file TestSuite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite ()
+  : TestSuite ("binary-trace", UNIT)
+{
+  AddTestCase (new BinaryTraceConvertTestCase (0, BinaryTraceFile::BUFFER_SIZE_DEFAULT), TestCase::QUICK);
+  // A buffer holding fewer records than written exercises the flush path
+  AddTestCase (new BinaryTraceConvertTestCase (32, 7 * sizeof (BinaryTraceFile::Record)), TestCase::QUICK);
+  AddTestCase (new BinaryTraceBadFileTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceTestSuite binaryTraceTestSuite; //!< Static variable for test initialization
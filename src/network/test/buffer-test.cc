@@ -378,6 +378,109 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check Buffer::Iterator::CalculateIpChecksum against a byte by
+ * byte computation, over buffers holding a zero area and for checksummed
+ * ranges starting at even and odd offsets.
+ */
+class BufferChecksumTest : public TestCase
+{
+public:
+  BufferChecksumTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Compute the checksum of a byte range with ReadU8
+   * \param i iterator to the start of the range
+   * \param size number of bytes
+   * \param initial initial checksum value
+   * \returns the checksum of the range
+   */
+  static uint16_t Reference (Buffer::Iterator i, uint16_t size, uint32_t initial);
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer checksum")
+{
+}
+
+uint16_t
+BufferChecksumTest::Reference (Buffer::Iterator i, uint16_t size, uint32_t initial)
+{
+  uint64_t sum = initial;
+  for (uint32_t j = 0; j < size; j++)
+    {
+      uint32_t byte = i.ReadU8 ();
+      sum += (j & 1) ? (byte << 8) : byte;
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  for (uint32_t headerSize = 0; headerSize < 70; headerSize += 23)
+    {
+      for (uint32_t trailerSize = 0; trailerSize < 200; trailerSize += 67)
+        {
+          // Header bytes, then a zero area of 101 bytes, then trailer bytes
+          Buffer buffer (101);
+          buffer.AddAtStart (headerSize);
+          buffer.AddAtEnd (trailerSize);
+          Buffer::Iterator w = buffer.Begin ();
+          for (uint32_t j = 0; j < headerSize; j++)
+            {
+              w.WriteU8 (rng->GetInteger (0, 255));
+            }
+          w = buffer.End ();
+          w.Prev (trailerSize);
+          for (uint32_t j = 0; j < trailerSize; j++)
+            {
+              w.WriteU8 (rng->GetInteger (0, 255));
+            }
+
+          for (uint32_t start = 0; start < buffer.GetSize (); start += 7)
+            {
+              for (uint32_t size = 0; start + size <= buffer.GetSize (); size += 13)
+                {
+                  Buffer::Iterator i = buffer.Begin ();
+                  i.Next (start);
+                  Buffer::Iterator j = i;
+                  uint16_t got = i.CalculateIpChecksum (size, 0x1234);
+                  NS_TEST_ASSERT_MSG_EQ (got, Reference (j, size, 0x1234),
+                                         "wrong checksum for header " << headerSize << " trailer " << trailerSize
+                                                                      << " start " << start << " size " << size);
+                  NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), start + size,
+                                         "iterator not moved past the checksummed range");
+                }
+            }
+        }
+    }
+
+  // A large range in real memory, as checksummed for big TCP segments
+  Buffer big;
+  big.AddAtStart (65535);
+  Buffer::Iterator w = big.Begin ();
+  for (uint32_t j = 0; j < 65535; j++)
+    {
+      w.WriteU8 (0xff);
+    }
+  NS_TEST_ASSERT_MSG_EQ (big.Begin ().CalculateIpChecksum (65535, 0xffffffff),
+                         Reference (big.Begin (), 65535, 0xffffffff), "wrong checksum of a large range");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +497,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -308,6 +308,198 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
   return N;
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Header carrying a value, used to check the printed packets
+ *
+ * \note Class internal to packet-metadata-test.cc
+ */
+class ValueHeader : public Header
+{
+public:
+  /**
+   * Constructor
+   * \param value header value
+   */
+  ValueHeader (uint16_t value = 0);
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+private:
+  uint16_t m_value; //!< header value
+};
+
+ValueHeader::ValueHeader (uint16_t value)
+  : m_value (value)
+{
+}
+
+TypeId
+ValueHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ValueHeader")
+    .SetParent<Header> ()
+    .AddConstructor<ValueHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+ValueHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+ValueHeader::Print (std::ostream &os) const
+{
+  os << "value=" << m_value;
+}
+
+uint32_t
+ValueHeader::GetSerializedSize (void) const
+{
+  return 2;
+}
+
+void
+ValueHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU16 (m_value);
+}
+
+uint32_t
+ValueHeader::Deserialize (Buffer::Iterator start)
+{
+  m_value = start.ReadNtohU16 ();
+  return 2;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Trailer carrying a value, used to check the printed packets
+ *
+ * \note Class internal to packet-metadata-test.cc
+ */
+class ValueTrailer : public Trailer
+{
+public:
+  /**
+   * Constructor
+   * \param value trailer value
+   */
+  ValueTrailer (uint32_t value = 0);
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+private:
+  uint32_t m_value; //!< trailer value
+};
+
+ValueTrailer::ValueTrailer (uint32_t value)
+  : m_value (value)
+{
+}
+
+TypeId
+ValueTrailer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ValueTrailer")
+    .SetParent<Trailer> ()
+    .AddConstructor<ValueTrailer> ()
+  ;
+  return tid;
+}
+
+TypeId
+ValueTrailer::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+ValueTrailer::Print (std::ostream &os) const
+{
+  os << "value=" << m_value;
+}
+
+uint32_t
+ValueTrailer::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+ValueTrailer::Serialize (Buffer::Iterator start) const
+{
+  start.Prev (4);
+  start.WriteHtonU32 (m_value);
+}
+
+uint32_t
+ValueTrailer::Deserialize (Buffer::Iterator start)
+{
+  start.Prev (4);
+  m_value = start.ReadNtohU32 ();
+  return 4;
+}
+
+/**
+ * Item visitor appending a short description of each item to a string
+ * \param os stream to append to
+ * \param item the visited item
+ * \returns true, to visit all the items
+ */
+bool
+DescribeItem (std::ostringstream *os, PacketMetadata::ItemInfo const &item)
+{
+  switch (item.type)
+    {
+    case PacketMetadata::Item::PAYLOAD:
+      *os << "P";
+      break;
+    case PacketMetadata::Item::HEADER:
+      *os << "H";
+      break;
+    case PacketMetadata::Item::TRAILER:
+      *os << "T";
+      break;
+    }
+  *os << (item.isFragment ? "f" : "") << "@" << item.offset << ":" << item.currentSize << " ";
+  return true;
+}
+
+/**
+ * Item visitor counting the items up to the first trailer
+ * \param count counter to increment
+ * \param item the visited item
+ * \returns false on the first trailer, to stop the walk
+ */
+bool
+CountUntilTrailer (uint32_t *count, PacketMetadata::ItemInfo const &item)
+{
+  (*count)++;
+  return item.type != PacketMetadata::Item::TRAILER;
+}
+
 }
 
 /**
@@ -903,6 +1095,129 @@ PacketMetadataTest::DoRun (void)
 }
 
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that Packet::Print and Packet::VisitItems, which share the
+ * decode cache, follow the changes made to packets and their copies.
+ */
+class PacketMetadataDecodeCacheTest : public TestCase {
+public:
+  PacketMetadataDecodeCacheTest ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Print a packet twice through the decode cache and once without it
+   * \param p the packet
+   * \param file The file name
+   * \param line The line number
+   * \returns the printed packet
+   */
+  std::string CheckPrint (Ptr<const Packet> p, const char *file, int line);
+  /**
+   * Describe the items of a packet with DescribeItem
+   * \param p the packet
+   * \returns the description
+   */
+  std::string Describe (Ptr<const Packet> p);
+};
+
+PacketMetadataDecodeCacheTest::PacketMetadataDecodeCacheTest ()
+  : TestCase ("Packet metadata decode cache and item visitor")
+{
+}
+
+std::string
+PacketMetadataDecodeCacheTest::CheckPrint (Ptr<const Packet> p, const char *file, int line)
+{
+  std::ostringstream first;
+  std::ostringstream second;
+  std::ostringstream uncached;
+  p->Print (first);
+  p->Print (second);
+  PacketMetadata::SetDecodeCacheSize (0);
+  p->Print (uncached);
+  PacketMetadata::SetDecodeCacheSize (PacketMetadata::DECODE_CACHE_SIZE_DEFAULT);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (second.str (), first.str (), "Cached print differs", file, line);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (uncached.str (), first.str (), "Uncached print differs", file, line);
+  return first.str ();
+}
+
+std::string
+PacketMetadataDecodeCacheTest::Describe (Ptr<const Packet> p)
+{
+  std::ostringstream os;
+  p->VisitItems (MakeBoundCallback (&DescribeItem, &os));
+  return os.str ();
+}
+
+#define CHECK_PRINT(p, expected)                                               \
+  NS_TEST_EXPECT_MSG_EQ (CheckPrint (p, __FILE__, __LINE__), std::string (expected), \
+                         "Unexpected printed packet")
+
+void
+PacketMetadataDecodeCacheTest::DoRun (void)
+{
+  PacketMetadata::Enable ();
+
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddHeader (ValueHeader (1));
+  CHECK_PRINT (p, "ns3::ValueHeader (value=1) Payload (size=10)");
+
+  // A copy shares the cache entry until one of them is modified.
+  Ptr<Packet> q = p->Copy ();
+  CHECK_PRINT (q, "ns3::ValueHeader (value=1) Payload (size=10)");
+  ValueHeader header;
+  q->RemoveHeader (header);
+  q->AddHeader (ValueHeader (2));
+  CHECK_PRINT (q, "ns3::ValueHeader (value=2) Payload (size=10)");
+  CHECK_PRINT (p, "ns3::ValueHeader (value=1) Payload (size=10)");
+  p->RemoveHeader (header);
+  p->AddHeader (ValueHeader (3));
+  CHECK_PRINT (p, "ns3::ValueHeader (value=3) Payload (size=10)");
+  CHECK_PRINT (q, "ns3::ValueHeader (value=2) Payload (size=10)");
+
+  // Trailers and in-place replacement of the tail item.
+  p->AddTrailer (ValueTrailer (7));
+  CHECK_PRINT (p, "ns3::ValueHeader (value=3) Payload (size=10) ns3::ValueTrailer (value=7)");
+  NS_TEST_EXPECT_MSG_EQ (Describe (p), "H@0:2 P@2:10 T@12:4 ", "Unexpected items");
+  p->RemoveAtEnd (3);
+  CHECK_PRINT (p, "ns3::ValueHeader (value=3) Payload (size=10) ns3::ValueTrailer Fragment [0:1]");
+  p->RemoveAtEnd (1);
+  CHECK_PRINT (p, "ns3::ValueHeader (value=3) Payload (size=10)");
+
+  // Fragments and concatenation.
+  Ptr<Packet> f = p->CreateFragment (1, 6);
+  CHECK_PRINT (f, "ns3::ValueHeader Fragment [1:2] Payload Fragment [0:5]");
+  NS_TEST_EXPECT_MSG_EQ (Describe (f), "Hf@0:1 Pf@1:5 ", "Unexpected items");
+  f->AddAtEnd (q);
+  CHECK_PRINT (f, "ns3::ValueHeader Fragment [1:2] Payload Fragment [0:5] "
+               "ns3::ValueHeader (value=2) Payload (size=10)");
+  NS_TEST_EXPECT_MSG_EQ (Describe (f), "Hf@0:1 Pf@1:5 H@6:2 P@8:10 ", "Unexpected items");
+
+  // The visitor stops when asked to.
+  q->AddTrailer (ValueTrailer (8));
+  q->AddTrailer (ValueTrailer (9));
+  uint32_t count = 0;
+  q->VisitItems (MakeBoundCallback (&CountUntilTrailer, &count));
+  NS_TEST_EXPECT_MSG_EQ (count, 3, "Visitor did not stop at the first trailer");
+
+  // Packets recycled through the metadata free list must not reuse stale entries.
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<Packet> r = Create<Packet> (i);
+      r->AddHeader (ValueHeader (i));
+      std::ostringstream expected;
+      expected << "ns3::ValueHeader (value=" << i << ")";
+      if (i > 0)
+        {
+          expected << " Payload (size=" << i << ")";
+        }
+      CHECK_PRINT (r, expected.str ());
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -919,6 +1234,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataDecodeCacheTest, TestCase::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
@@ -21,10 +21,14 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <unistd.h>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/mapped-pcap-file.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -1144,6 +1148,281 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that PcapNgFile multiplexes several
+ * interfaces into one file and honours the per-interface snap length.
+ */
+class PcapNgWriteTestCase : public TestCase
+{
+public:
+  PcapNgWriteTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Read a 32-bit word from the test file
+   * \param f file
+   * \returns the word read
+   */
+  uint32_t Read32 (FILE *f);
+
+  std::string m_testFilename; //!< File name
+};
+
+PcapNgWriteTestCase::PcapNgWriteTestCase ()
+  : TestCase ("Check to see that PcapNgFile writes interface and packet blocks correctly")
+{
+}
+
+void
+PcapNgWriteTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcapng");
+}
+
+void
+PcapNgWriteTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+uint32_t
+PcapNgWriteTestCase::Read32 (FILE *f)
+{
+  uint32_t val = 0;
+  size_t result = std::fread (&val, sizeof (val), 1, f);
+  NS_TEST_EXPECT_MSG_EQ (result, 1, "Unable to read a word from " << m_testFilename);
+  return val;
+}
+
+void
+PcapNgWriteTestCase::DoRun (void)
+{
+  //
+  // Use a small buffer so that both the flush on buffer full and the flush
+  // on close are exercised.
+  //
+  PcapNgFile f;
+  f.Open (m_testFilename, 4096);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ") returns error");
+
+  uint32_t if0 = f.AddInterface (1, 0, "eth0");
+  uint32_t if1 = f.AddInterface (9, 10);
+  NS_TEST_ASSERT_MSG_EQ (if0, 0, "First interface must have identifier 0");
+  NS_TEST_ASSERT_MSG_EQ (if1, 1, "Second interface must have identifier 1");
+  NS_TEST_ASSERT_MSG_EQ (f.GetNInterfaces (), 2, "Two interfaces must have been declared");
+
+  uint8_t data[101];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = i;
+    }
+  const uint32_t nPackets = 100;
+  for (uint32_t i = 0; i < nPackets; ++i)
+    {
+      f.Write (i % 2, 1000000000ULL * 5 + i, Create<Packet> (data, sizeof (data)));
+    }
+  f.Close ();
+
+  FILE *p = std::fopen (m_testFilename.c_str (), "rb");
+  NS_TEST_ASSERT_MSG_NE (p, 0, "fopen(" << m_testFilename << ") should have been able to open a correctly created pcapng file");
+
+  //
+  // Section Header Block
+  //
+  NS_TEST_EXPECT_MSG_EQ (Read32 (p), PcapNgFile::SECTION_HEADER_BLOCK, "Bad SHB block type");
+  NS_TEST_EXPECT_MSG_EQ (Read32 (p), 28, "Bad SHB length");
+  NS_TEST_EXPECT_MSG_EQ (Read32 (p), PcapNgFile::BYTE_ORDER_MAGIC, "Bad byte-order magic");
+  std::fseek (p, 28, SEEK_SET);
+
+  //
+  // Interface Description Blocks: type, length, link type, snap length
+  //
+  NS_TEST_EXPECT_MSG_EQ (Read32 (p), PcapNgFile::INTERFACE_DESCRIPTION_BLOCK, "Bad IDB block type");
+  uint32_t len = Read32 (p);
+  NS_TEST_EXPECT_MSG_EQ (len, 20 + 8 + 8 + 4, "IDB with if_name must carry the name option");
+  uint32_t linkType = Read32 (p) & 0xffff;
+  NS_TEST_EXPECT_MSG_EQ (linkType, 1, "Bad link type for interface 0");
+  NS_TEST_EXPECT_MSG_EQ (Read32 (p), 0, "Bad snap length for interface 0");
+  std::fseek (p, 28 + len, SEEK_SET);
+  long offset = 28 + len;
+
+  NS_TEST_EXPECT_MSG_EQ (Read32 (p), PcapNgFile::INTERFACE_DESCRIPTION_BLOCK, "Bad IDB block type");
+  len = Read32 (p);
+  NS_TEST_EXPECT_MSG_EQ (len, 20 + 8 + 4, "IDB without if_name has only if_tsresol");
+  linkType = Read32 (p) & 0xffff;
+  NS_TEST_EXPECT_MSG_EQ (linkType, 9, "Bad link type for interface 1");
+  NS_TEST_EXPECT_MSG_EQ (Read32 (p), 10, "Bad snap length for interface 1");
+  offset += len;
+  std::fseek (p, offset, SEEK_SET);
+
+  //
+  // Enhanced Packet Blocks, alternating between both interfaces
+  //
+  for (uint32_t i = 0; i < nPackets; ++i)
+    {
+      uint32_t inclLen = (i % 2) ? 10 : sizeof (data);
+      uint32_t blockLen = 32 + ((inclLen + 3) & ~3U);
+      NS_TEST_EXPECT_MSG_EQ (Read32 (p), PcapNgFile::ENHANCED_PACKET_BLOCK, "Bad EPB block type");
+      NS_TEST_EXPECT_MSG_EQ (Read32 (p), blockLen, "Bad EPB length");
+      NS_TEST_EXPECT_MSG_EQ (Read32 (p), i % 2, "Bad interface identifier");
+      uint64_t ts = Read32 (p);
+      ts = (ts << 32) | Read32 (p);
+      NS_TEST_EXPECT_MSG_EQ (ts, 1000000000ULL * 5 + i, "Bad timestamp");
+      NS_TEST_EXPECT_MSG_EQ (Read32 (p), inclLen, "Snap length must be applied");
+      NS_TEST_EXPECT_MSG_EQ (Read32 (p), sizeof (data), "Original length must be preserved");
+      uint8_t readData[sizeof (data)];
+      size_t result = std::fread (readData, 1, inclLen, p);
+      NS_TEST_EXPECT_MSG_EQ (result, inclLen, "Unable to read packet data");
+      NS_TEST_EXPECT_MSG_EQ (std::memcmp (readData, data, inclLen), 0, "Packet data corrupted");
+      offset += blockLen;
+      std::fseek (p, offset - 4, SEEK_SET);
+      NS_TEST_EXPECT_MSG_EQ (Read32 (p), blockLen, "Bad trailing EPB length");
+    }
+
+  std::fgetc (p);
+  bool eof = std::feof (p);
+  NS_TEST_EXPECT_MSG_EQ (eof, true, "Unexpected data after the last block");
+  std::fclose (p);
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Test that MappedPcapFile reads known and freshly written files.
+ */
+class MappedReadTestCase : public TestCase
+{
+public:
+  MappedReadTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename; //!< File name
+};
+
+MappedReadTestCase::MappedReadTestCase ()
+  : TestCase ("Check to see that MappedPcapFile iterates over the records of pcap files")
+{
+}
+
+void
+MappedReadTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcap");
+}
+
+void
+MappedReadTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+MappedReadTestCase::DoRun (void)
+{
+  //
+  // The known good file read by ReadFileTestCase.
+  //
+  MappedPcapFile known;
+  std::string filename = CreateDataDirFilename ("known.pcap");
+  NS_TEST_ASSERT_MSG_EQ (known.Open (filename), true, "Unable to map " << filename);
+  NS_TEST_EXPECT_MSG_EQ (known.GetDataLinkType (), 1, "Unexpected data link type");
+
+  uint32_t n = 0;
+  for (MappedPcapFile::Iterator i = known.Begin (); i != known.End (); ++i, ++n)
+    {
+      NS_TEST_ASSERT_MSG_LT (n, N_KNOWN_PACKETS, "Too many records in " << filename);
+      MappedPcapFile::Record record = *i;
+      PacketEntry const & p = knownPackets[n];
+      uint64_t timestamp = p.tsSec * 1000000000ULL + p.tsUsec * 1000ULL;
+      NS_TEST_EXPECT_MSG_EQ (record.timestamp, timestamp, "Incorrect timestamp of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (record.inclLen, p.inclLen, "Incorrect length of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (record.origLen, p.origLen, "Incorrect original length of record " << n);
+      // knownPackets holds the packets without their 14-byte Ethernet header
+      const uint8_t *data = record.data + 14;
+      for (uint32_t j = 0; j < N_PACKET_BYTES; ++j)
+        {
+          uint16_t word = (data[2 * j] << 8) | data[2 * j + 1];
+          NS_TEST_EXPECT_MSG_EQ (word, p.data[j], "Incorrect data in record " << n << " word " << j);
+        }
+      Ptr<Packet> packet = record.CreatePacket ();
+      NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), p.inclLen, "Incorrect packet size of record " << n);
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, N_KNOWN_PACKETS, "Unexpected number of records in " << filename);
+  known.Close ();
+
+  //
+  // A byte-swapped, nanosecond resolution file with a small snap length,
+  // cut in the middle of its last record.
+  //
+  PcapFile f;
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", \"std::ios::out\") returns error");
+  f.Init (101, 20, PcapFile::ZONE_DEFAULT, true, true);
+  uint8_t data[30];
+  for (uint32_t j = 0; j < sizeof (data); ++j)
+    {
+      data[j] = j;
+    }
+  f.Write (1, 500, data, 10);
+  f.Write (2, 999999999, data, 30);
+  f.Write (3, 0, data, 30);
+  f.Close ();
+  truncate (m_testFilename.c_str (), 24 + 16 + 10 + 16 + 20 + 16 + 5);
+
+  MappedPcapFile mapped;
+  NS_TEST_ASSERT_MSG_EQ (mapped.Open (m_testFilename), true, "Unable to map " << m_testFilename);
+  NS_TEST_EXPECT_MSG_EQ (mapped.GetSwapMode (), true, "Swap mode not detected");
+  NS_TEST_EXPECT_MSG_EQ (mapped.IsNanoSecMode (), true, "Nanosecond mode not detected");
+  NS_TEST_EXPECT_MSG_EQ (mapped.GetSnapLen (), 20, "Incorrect snap length");
+  NS_TEST_EXPECT_MSG_EQ (mapped.GetDataLinkType (), 101, "Incorrect data link type");
+
+  MappedPcapFile::Iterator i = mapped.Begin ();
+  NS_TEST_ASSERT_MSG_EQ ((i != mapped.End ()), true, "Missing first record");
+  MappedPcapFile::Record record = *i;
+  NS_TEST_EXPECT_MSG_EQ (record.timestamp, 1000000500ULL, "Incorrect timestamp of first record");
+  NS_TEST_EXPECT_MSG_EQ (record.inclLen, 10, "Incorrect length of first record");
+  NS_TEST_EXPECT_MSG_EQ (record.data[9], 9, "Incorrect data in first record");
+
+  ++i;
+  NS_TEST_ASSERT_MSG_EQ ((i != mapped.End ()), true, "Missing second record");
+  record = *i;
+  NS_TEST_EXPECT_MSG_EQ (record.timestamp, 2999999999ULL, "Incorrect timestamp of second record");
+  NS_TEST_EXPECT_MSG_EQ (record.inclLen, 20, "Incorrect length of second record");
+  NS_TEST_EXPECT_MSG_EQ (record.origLen, 30, "Incorrect original length of second record");
+  NS_TEST_EXPECT_MSG_EQ (record.CreatePacket ()->GetSize (), 20, "Incorrect size of truncated packet");
+  NS_TEST_EXPECT_MSG_EQ (record.CreatePacket (true)->GetSize (), 30, "Incorrect size of padded packet");
+
+  ++i;
+  NS_TEST_EXPECT_MSG_EQ ((i == mapped.End ()), true, "Truncated last record not ignored");
+
+  NS_TEST_EXPECT_MSG_EQ (mapped.Open (CreateTempDirFilename ("does-not-exist.pcap")), false,
+                         "Mapped a file which does not exist");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1446,8 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new PcapNgWriteTestCase, TestCase::QUICK);
+  AddTestCase (new MappedReadTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/hash.h"
+#include "ns3/packet.h"
+#include "binary-trace-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+namespace {
+
+const char MAGIC[8] = { 'n', 's', '3', 'b', 't', 'r', 'c', '\0' }; //!< Magic string of a binary trace file
+
+/**
+ * \brief Binary trace file header
+ */
+struct FileHeader
+{
+  char     m_magic[8];      //!< MAGIC
+  uint32_t m_version;       //!< BinaryTraceFile::VERSION
+  uint32_t m_recordSize;    //!< sizeof (BinaryTraceFile::Record)
+  uint32_t m_digestSize;    //!< number of bytes hashed into the digest
+  uint32_t m_reserved;      //!< reserved, always zero
+};
+
+} // unnamed namespace
+
+BinaryTraceFile::BinaryTraceFile (std::string filename, uint32_t digestSize, uint32_t bufferSize)
+  : m_used (0),
+    m_digestSize (digestSize)
+{
+  NS_LOG_FUNCTION (this << filename << digestSize << bufferSize);
+  m_buffer.resize (std::max<uint32_t> (bufferSize, sizeof (Record)));
+  m_file.open (filename.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "BinaryTraceFile::BinaryTraceFile():  " <<
+                       "Unable to Open " << filename);
+  WriteFileHeader ();
+}
+
+BinaryTraceFile::~BinaryTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_file.close ();
+}
+
+void
+BinaryTraceFile::WriteFileHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  FileHeader header;
+  std::memcpy (header.m_magic, MAGIC, sizeof (MAGIC));
+  header.m_version = VERSION;
+  header.m_recordSize = sizeof (Record);
+  header.m_digestSize = m_digestSize;
+  header.m_reserved = 0;
+  m_file.write ((const char *)&header, sizeof (header));
+}
+
+uint32_t
+BinaryTraceFile::GetDigestSize (void) const
+{
+  return m_digestSize;
+}
+
+void
+BinaryTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_used > 0)
+    {
+      m_file.write ((const char *)&m_buffer[0], m_used);
+      m_used = 0;
+    }
+  m_file.flush ();
+}
+
+void
+BinaryTraceFile::Write (Time t, EventType event, uint32_t node, uint32_t device, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << event << node << device << p);
+  if (m_used + sizeof (Record) > m_buffer.size ())
+    {
+      Flush ();
+    }
+
+  Record record;
+  record.m_time = t.GetNanoSeconds ();
+  record.m_uid = p->GetUid ();
+  record.m_node = node;
+  record.m_device = device;
+  record.m_size = p->GetSize ();
+  record.m_digest = 0;
+  record.m_event = event;
+  std::memset (record.m_reserved, 0, sizeof (record.m_reserved));
+
+  if (m_digestSize > 0)
+    {
+      uint8_t bytes[256];
+      uint32_t n = std::min<uint32_t> (std::min<uint32_t> (m_digestSize, sizeof (bytes)), record.m_size);
+      p->CopyData (bytes, n);
+      record.m_digest = Hash32 ((const char *)bytes, n);
+    }
+
+  std::memcpy (&m_buffer[m_used], &record, sizeof (record));
+  m_used += sizeof (record);
+}
+
+bool
+BinaryTraceFile::ConvertToAscii (std::string const &filename, std::ostream &os)
+{
+  NS_LOG_FUNCTION (filename << &os);
+  std::ifstream in (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!in.is_open ())
+    {
+      return false;
+    }
+
+  FileHeader header;
+  in.read ((char *)&header, sizeof (header));
+  if (in.fail ()
+      || std::memcmp (header.m_magic, MAGIC, sizeof (MAGIC)) != 0
+      || header.m_version != VERSION
+      || header.m_recordSize != sizeof (Record))
+    {
+      NS_LOG_WARN ("BinaryTraceFile::ConvertToAscii(): " << filename << " is not a binary trace file");
+      return false;
+    }
+
+  //
+  // Read the records in large chunks; the formatting below is the only
+  // expensive part of the conversion.
+  //
+  const uint32_t recordsPerChunk = 4096;
+  std::vector<Record> records (recordsPerChunk);
+  while (in)
+    {
+      in.read ((char *)&records[0], recordsPerChunk * sizeof (Record));
+      uint32_t n = in.gcount () / sizeof (Record);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          Record const &r = records[i];
+          os << r.m_event << " " << NanoSeconds (r.m_time).GetSeconds ()
+             << " /NodeList/" << r.m_node << "/DeviceList/" << r.m_device
+             << " ns3::Packet(uid=" << r.m_uid << " size=" << r.m_size;
+          if (header.m_digestSize > 0)
+            {
+              os << " digest=0x" << std::hex << r.m_digest << std::dec;
+            }
+          os << ")\n";
+        }
+    }
+  return true;
+}
+
+} // namespace ns3
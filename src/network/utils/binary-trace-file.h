@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \brief A compact binary alternative to ASCII device traces
+ *
+ * The default ASCII trace sinks print every traced packet with
+ * Packet::Print, which requires packet metadata and is by far the most
+ * expensive part of a traced run.  A BinaryTraceFile instead stores one
+ * fixed-size Record per event: the event time, the node and device
+ * identifiers, the kind of event, the packet uid and size and, if
+ * requested, a 32-bit digest of the first bytes of the packet.  Records
+ * are accumulated in a memory buffer and written to disk in large blocks.
+ *
+ * The file can be turned into text after the run with ConvertToAscii (see
+ * also the binary-trace-to-ascii program in utils/), which produces lines
+ * laid out like the ones of the ASCII trace sinks used with a context:
+ *
+ * \verbatim
+ *   + 2.00134 /NodeList/0/DeviceList/1 ns3::Packet(uid=12 size=1054)
+ * \endverbatim
+ *
+ * The file starts with a header holding a magic string, the format
+ * version, the record size and the digest size.  All fields are stored in
+ * host byte order.
+ *
+ * Like OutputStreamWrapper, this class is reference counted so that it can
+ * be bound to trace sink callbacks; the file is flushed and closed when
+ * the last reference goes away.
+ */
+class BinaryTraceFile : public SimpleRefCount<BinaryTraceFile>
+{
+public:
+  static const uint32_t BUFFER_SIZE_DEFAULT = 1 << 20;   /**< Default size of the write buffer, in bytes */
+  static const uint32_t VERSION = 1;                     /**< Version of the file format */
+
+  /// Kind of traced event, using the same letters as the ASCII traces
+  enum EventType
+  {
+    ENQUEUE = '+',   //!< packet enqueued in the device transmit queue
+    DEQUEUE = '-',   //!< packet dequeued from the device transmit queue
+    DROP = 'd',      //!< packet dropped
+    RECEIVE = 'r'    //!< packet received by the device
+  };
+
+  /**
+   * \brief On-disk layout of one traced event
+   *
+   * All the fields are naturally aligned so that the structure has no
+   * implicit padding and can be copied to and from the file as is.
+   */
+  struct Record
+  {
+    int64_t  m_time;        //!< event time, in nanoseconds
+    uint64_t m_uid;         //!< packet uid
+    uint32_t m_node;        //!< node id
+    uint32_t m_device;      //!< device index on the node
+    uint32_t m_size;        //!< packet size, in bytes
+    uint32_t m_digest;      //!< digest of the first packet bytes, zero if disabled
+    uint8_t  m_event;       //!< EventType
+    uint8_t  m_reserved[7]; //!< reserved, always zero
+  };
+
+  /**
+   * \brief Create a binary trace file
+   *
+   * \param filename name of the file to create; any existing file is truncated
+   * \param digestSize number of leading packet bytes to hash into the
+   * record digest; zero disables the digest
+   * \param bufferSize size in bytes of the write buffer
+   */
+  BinaryTraceFile (std::string filename, uint32_t digestSize = 0,
+                   uint32_t bufferSize = BUFFER_SIZE_DEFAULT);
+  ~BinaryTraceFile ();
+
+  /**
+   * \brief Append a record for a traced packet
+   *
+   * \param t event time
+   * \param event kind of event
+   * \param node node id
+   * \param device device index on the node
+   * \param p the traced packet
+   */
+  void Write (Time t, EventType event, uint32_t node, uint32_t device, Ptr<const Packet> p);
+
+  /**
+   * Hand all buffered records over to the underlying file.
+   */
+  void Flush (void);
+
+  /**
+   * \returns the number of leading packet bytes covered by the digest
+   */
+  uint32_t GetDigestSize (void) const;
+
+  /**
+   * \brief Print the records of a binary trace file as ASCII trace lines
+   *
+   * \param filename name of the binary trace file
+   * \param os stream to print to
+   * \returns false if the file could not be opened or is not a binary
+   * trace file, true otherwise
+   */
+  static bool ConvertToAscii (std::string const &filename, std::ostream &os);
+
+private:
+  /**
+   * \brief Write the file header
+   */
+  void WriteFileHeader (void);
+
+  std::ofstream        m_file;        //!< file stream
+  std::vector<uint8_t> m_buffer;      //!< write buffer
+  uint32_t             m_used;        //!< number of bytes used in m_buffer
+  uint32_t             m_digestSize;  //!< number of bytes hashed into the digest
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
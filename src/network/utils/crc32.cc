@@ -27,6 +27,14 @@
  */
 #include <stdint.h>
 
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define CRC32_HAVE_CLMUL 1
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#endif
+
 namespace ns3 {
 
 /**
@@ -67,17 +75,220 @@ static uint32_t crc32table[256] = {
 0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D 
 };
 
+namespace {
+
+/**
+ * Tables of the slice-by-8 algorithm: table[0] is crc32table and
+ * table[k][n] is the CRC of byte n followed by k zero bytes.
+ */
+struct SliceTables
+{
+  /// Fill the tables
+  SliceTables ();
+
+  uint32_t table[8][256]; //!< The tables
+};
+
+SliceTables::SliceTables ()
+{
+  for (uint32_t n = 0; n < 256; n++)
+    {
+      table[0][n] = crc32table[n];
+    }
+  for (uint32_t n = 0; n < 256; n++)
+    {
+      for (uint32_t k = 1; k < 8; k++)
+        {
+          uint32_t prev = table[k - 1][n];
+          table[k][n] = (prev >> 8) ^ crc32table[prev & 0xff];
+        }
+    }
+}
+
+/**
+ * The tables are filled on first use rather than by a static initializer,
+ * which may run after those of other files computing CRCs.
+ *
+ * \returns the tables of the slice-by-8 algorithm
+ */
+const SliceTables &
+GetSliceTables (void)
+{
+  static const SliceTables tables;
+  return tables;
+}
+
+/**
+ * \brief Update a CRC with the slice-by-8 algorithm
+ * \param crc current (non-inverted) CRC value
+ * \param data data to add
+ * \param length number of bytes
+ * \returns the updated CRC value
+ */
+uint32_t
+UpdateSliceBy8 (uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  const uint32_t (*crc32slice)[256] = GetSliceTables ().table;
+  while (length >= 8)
+    {
+      // Assembled byte by byte so that the result does not depend on the
+      // host byte order; compilers turn this into plain loads.
+      uint32_t one = (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24)) ^ crc;
+      uint32_t two = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+      crc = crc32slice[7][one & 0xff] ^ crc32slice[6][(one >> 8) & 0xff] ^
+        crc32slice[5][(one >> 16) & 0xff] ^ crc32slice[4][one >> 24] ^
+        crc32slice[3][two & 0xff] ^ crc32slice[2][(two >> 8) & 0xff] ^
+        crc32slice[1][(two >> 16) & 0xff] ^ crc32slice[0][two >> 24];
+      data += 8;
+      length -= 8;
+    }
+  while (length--)
+    {
+      crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
+    }
+  return crc;
+}
+
+#ifdef CRC32_HAVE_CLMUL
+
+/**
+ * \returns true if the CPU supports the PCLMULQDQ and SSE4.1 instructions
+ */
+bool
+HasClmul (void)
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx))
+    {
+      return false;
+    }
+  return (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1);
+}
+
+/**
+ * \brief Update a CRC by folding 16-byte blocks with carry-less
+ * multiplications
+ *
+ * This is the algorithm of "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction" (Intel, 2009), with the
+ * constants of the bit-reflected CRC-32 polynomial used by Ethernet.
+ *
+ * \param crc current (non-inverted) CRC value
+ * \param data data to add
+ * \param length number of bytes, a multiple of 16, at least 64
+ * \returns the updated CRC value
+ */
+__attribute__ ((target ("pclmul,sse4.1")))
+uint32_t
+UpdateClmul (uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  const __m128i k1k2 = _mm_set_epi64x (0x01c6e41596LL, 0x0154442bd4LL);
+  const __m128i k3k4 = _mm_set_epi64x (0x00ccaa009eLL, 0x01751997d0LL);
+  const __m128i k5k0 = _mm_set_epi64x (0, 0x0163cd6124LL);
+  const __m128i poly = _mm_set_epi64x (0x01f7011641LL, 0x01db710641LL);
+  const __m128i mask32 = _mm_setr_epi32 (~0, 0, ~0, 0);
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+  x1 = _mm_loadu_si128 ((const __m128i *)(data + 0x00));
+  x2 = _mm_loadu_si128 ((const __m128i *)(data + 0x10));
+  x3 = _mm_loadu_si128 ((const __m128i *)(data + 0x20));
+  x4 = _mm_loadu_si128 ((const __m128i *)(data + 0x30));
+  x1 = _mm_xor_si128 (x1, _mm_cvtsi32_si128 (crc));
+  data += 64;
+  length -= 64;
+
+  // Fold four blocks at a time
+  x0 = k1k2;
+  while (length >= 64)
+    {
+      x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+      x6 = _mm_clmulepi64_si128 (x2, x0, 0x00);
+      x7 = _mm_clmulepi64_si128 (x3, x0, 0x00);
+      x8 = _mm_clmulepi64_si128 (x4, x0, 0x00);
+      x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+      x2 = _mm_clmulepi64_si128 (x2, x0, 0x11);
+      x3 = _mm_clmulepi64_si128 (x3, x0, 0x11);
+      x4 = _mm_clmulepi64_si128 (x4, x0, 0x11);
+      x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x5), _mm_loadu_si128 ((const __m128i *)(data + 0x00)));
+      x2 = _mm_xor_si128 (_mm_xor_si128 (x2, x6), _mm_loadu_si128 ((const __m128i *)(data + 0x10)));
+      x3 = _mm_xor_si128 (_mm_xor_si128 (x3, x7), _mm_loadu_si128 ((const __m128i *)(data + 0x20)));
+      x4 = _mm_xor_si128 (_mm_xor_si128 (x4, x8), _mm_loadu_si128 ((const __m128i *)(data + 0x30)));
+      data += 64;
+      length -= 64;
+    }
+
+  // Fold the four blocks into one
+  x0 = k3k4;
+  x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x2), x5);
+  x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x3), x5);
+  x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x4), x5);
+
+  // Fold the remaining blocks one at a time
+  while (length >= 16)
+    {
+      x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+      x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+      x1 = _mm_xor_si128 (_mm_xor_si128 (x1, _mm_loadu_si128 ((const __m128i *)data)), x5);
+      data += 16;
+      length -= 16;
+    }
+
+  // Fold 128 bits to 64 bits
+  x2 = _mm_clmulepi64_si128 (x1, x0, 0x10);
+  x1 = _mm_xor_si128 (_mm_srli_si128 (x1, 8), x2);
+  x0 = k5k0;
+  x2 = _mm_srli_si128 (x1, 4);
+  x1 = _mm_and_si128 (x1, mask32);
+  x1 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+  x1 = _mm_xor_si128 (x1, x2);
+
+  // Barrett reduction to 32 bits
+  x0 = poly;
+  x2 = _mm_and_si128 (x1, mask32);
+  x2 = _mm_clmulepi64_si128 (x2, x0, 0x10);
+  x2 = _mm_and_si128 (x2, mask32);
+  x2 = _mm_clmulepi64_si128 (x2, x0, 0x00);
+  x1 = _mm_xor_si128 (x1, x2);
+  return _mm_extract_epi32 (x1, 1);
+}
+
+/**
+ * \returns true if UpdateClmul can be used on this CPU, checked on first
+ * use rather than by a static initializer
+ */
+bool
+UseClmul (void)
+{
+  static const bool hasClmul = HasClmul ();
+  return hasClmul;
+}
+
+#endif /* CRC32_HAVE_CLMUL */
+
+} // unnamed namespace
+
 uint32_t
 CRC32Calculate (const uint8_t *data, int length)
 {
   uint32_t crc = 0xffffffff;
+  uint32_t remaining = length > 0 ? length : 0;
 
-  while (length--)
+#ifdef CRC32_HAVE_CLMUL
+  if (remaining >= 64 && UseClmul ())
     {
-      crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
+      uint32_t blocks = remaining & ~15U;
+      crc = UpdateClmul (crc, data, blocks);
+      data += blocks;
+      remaining -= blocks;
     }
-  return ~crc;
+#endif
+  return ~UpdateSliceBy8 (crc, data, remaining);
 }
 
 } // namespace ns3
-
@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "mapped-pcap-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MappedPcapFile");
+
+namespace {
+
+const uint32_t MAGIC = 0xa1b2c3d4;            //!< Magic number identifying standard pcap file format
+const uint32_t SWAPPED_MAGIC = 0xd4c3b2a1;    //!< Looks this way if byte swapping is required
+const uint32_t NS_MAGIC = 0xa1b23c4d;         //!< Magic number identifying nanosec resolution pcap file format
+const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; //!< Looks this way if byte swapping is required
+
+const uint32_t FILE_HEADER_SIZE = 24;         //!< Size of the pcap file header
+const uint32_t RECORD_HEADER_SIZE = 16;       //!< Size of a pcap record header
+
+} // unnamed namespace
+
+Ptr<Packet>
+MappedPcapFile::Record::CreatePacket (bool padToOrigLen) const
+{
+  Ptr<Packet> p = Create<Packet> (data, inclLen);
+  if (padToOrigLen && origLen > inclLen)
+    {
+      p->AddPaddingAtEnd (origLen - inclLen);
+    }
+  return p;
+}
+
+MappedPcapFile::Iterator::Iterator ()
+  : m_file (0),
+    m_offset (0)
+{
+}
+
+MappedPcapFile::Iterator::Iterator (const MappedPcapFile *file, uint64_t offset)
+  : m_file (file),
+    m_offset (offset)
+{
+  Check ();
+}
+
+void
+MappedPcapFile::Iterator::Check (void)
+{
+  if (m_offset >= m_file->m_size)
+    {
+      m_offset = m_file->m_size;
+      return;
+    }
+  if (m_offset + RECORD_HEADER_SIZE > m_file->m_size
+      || m_offset + RECORD_HEADER_SIZE + m_file->Read32 (m_offset + 8) > m_file->m_size)
+    {
+      NS_LOG_WARN ("Ignoring truncated record at offset " << m_offset);
+      m_offset = m_file->m_size;
+    }
+}
+
+MappedPcapFile::Record
+MappedPcapFile::Iterator::operator* (void) const
+{
+  NS_ASSERT_MSG (m_file != 0 && m_offset < m_file->m_size, "MappedPcapFile: dereferencing the end iterator");
+  Record record;
+  uint64_t tsSec = m_file->Read32 (m_offset);
+  uint64_t tsFrac = m_file->Read32 (m_offset + 4);
+  record.timestamp = tsSec * 1000000000 + (m_file->m_nanosecMode ? tsFrac : tsFrac * 1000);
+  record.inclLen = m_file->Read32 (m_offset + 8);
+  record.origLen = m_file->Read32 (m_offset + 12);
+  record.data = m_file->m_data + m_offset + RECORD_HEADER_SIZE;
+  return record;
+}
+
+MappedPcapFile::Iterator &
+MappedPcapFile::Iterator::operator++ (void)
+{
+  NS_ASSERT (m_file != 0 && m_offset < m_file->m_size);
+  m_offset += RECORD_HEADER_SIZE + m_file->Read32 (m_offset + 8);
+  Check ();
+  return *this;
+}
+
+bool
+MappedPcapFile::Iterator::operator== (Iterator const &o) const
+{
+  return m_file == o.m_file && m_offset == o.m_offset;
+}
+
+bool
+MappedPcapFile::Iterator::operator!= (Iterator const &o) const
+{
+  return !(*this == o);
+}
+
+MappedPcapFile::MappedPcapFile ()
+  : m_data (0),
+    m_size (0),
+    m_dataLinkType (0),
+    m_snapLen (0),
+    m_swapMode (false),
+    m_nanosecMode (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MappedPcapFile::~MappedPcapFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+MappedPcapFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Unable to open " << filename);
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) < 0 || st.st_size < static_cast<off_t> (FILE_HEADER_SIZE))
+    {
+      NS_LOG_WARN (filename << " is too short to be a pcap file");
+      close (fd);
+      return false;
+    }
+  void *addr = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps a reference to the file
+  close (fd);
+  if (addr == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Unable to map " << filename);
+      return false;
+    }
+  // Records are read once, in order
+  madvise (addr, st.st_size, MADV_SEQUENTIAL);
+  m_data = static_cast<const uint8_t *> (addr);
+  m_size = st.st_size;
+
+  uint32_t magic;
+  std::memcpy (&magic, m_data, sizeof (magic));
+  if (magic != MAGIC && magic != SWAPPED_MAGIC && magic != NS_MAGIC && magic != NS_SWAPPED_MAGIC)
+    {
+      NS_LOG_WARN (filename << " is not a pcap file");
+      Close ();
+      return false;
+    }
+  m_swapMode = (magic == SWAPPED_MAGIC || magic == NS_SWAPPED_MAGIC);
+  m_nanosecMode = (magic == NS_MAGIC || magic == NS_SWAPPED_MAGIC);
+  m_snapLen = Read32 (16);
+  m_dataLinkType = Read32 (20);
+  return true;
+}
+
+void
+MappedPcapFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data != 0)
+    {
+      munmap (const_cast<uint8_t *> (m_data), m_size);
+      m_data = 0;
+      m_size = 0;
+    }
+}
+
+bool
+MappedPcapFile::IsOpen (void) const
+{
+  return m_data != 0;
+}
+
+MappedPcapFile::Iterator
+MappedPcapFile::Begin (void) const
+{
+  NS_ASSERT (IsOpen ());
+  return Iterator (this, FILE_HEADER_SIZE);
+}
+
+MappedPcapFile::Iterator
+MappedPcapFile::End (void) const
+{
+  NS_ASSERT (IsOpen ());
+  return Iterator (this, m_size);
+}
+
+uint32_t
+MappedPcapFile::GetDataLinkType (void) const
+{
+  return m_dataLinkType;
+}
+
+uint32_t
+MappedPcapFile::GetSnapLen (void) const
+{
+  return m_snapLen;
+}
+
+bool
+MappedPcapFile::GetSwapMode (void) const
+{
+  return m_swapMode;
+}
+
+bool
+MappedPcapFile::IsNanoSecMode (void) const
+{
+  return m_nanosecMode;
+}
+
+uint64_t
+MappedPcapFile::GetSize (void) const
+{
+  return m_size;
+}
+
+uint32_t
+MappedPcapFile::Read32 (uint64_t offset) const
+{
+  uint32_t v;
+  std::memcpy (&v, m_data + offset, sizeof (v));
+  if (m_swapMode)
+    {
+      v = ((v >> 24) & 0x000000ff) | ((v >> 8) & 0x0000ff00) | ((v << 8) & 0x00ff0000) | ((v << 24) & 0xff000000);
+    }
+  return v;
+}
+
+} // namespace ns3
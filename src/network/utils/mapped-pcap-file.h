@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MAPPED_PCAP_FILE_H
+#define MAPPED_PCAP_FILE_H
+
+#include <string>
+#include <stdint.h>
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \brief A read-only, memory-mapped pcap file
+ *
+ * PcapFile::Read copies each record through an iostream, which dominates
+ * the cost of trace-driven simulations reading large captures.  This
+ * class maps the whole file in memory instead and iterates over its
+ * records in place: a Record only points into the mapping, and the
+ * packet bytes are copied once, when a Packet is created from them.
+ * The operating system pages the file in and out as needed, so captures
+ * much larger than the available memory can be read sequentially (on
+ * 64-bit systems; a 32-bit address space limits the file size to a few
+ * gigabytes).
+ *
+ * Files written in either byte order and with either microsecond or
+ * nanosecond timestamps are supported.  A truncated record at the end of
+ * the file, as left by an interrupted capture, is ignored.
+ *
+ * \code
+ *   MappedPcapFile file;
+ *   file.Open ("capture.pcap");
+ *   for (MappedPcapFile::Iterator i = file.Begin (); i != file.End (); ++i)
+ *     {
+ *       MappedPcapFile::Record record = *i;
+ *       Ptr<Packet> p = record.CreatePacket ();
+ *       ...
+ *     }
+ * \endcode
+ */
+class MappedPcapFile
+{
+public:
+  /**
+   * \brief A record of the file, pointing into the mapping
+   *
+   * A record is only valid while the file is open.
+   */
+  struct Record
+  {
+    uint64_t timestamp;  //!< record timestamp, in nanoseconds
+    uint32_t inclLen;    //!< number of packet bytes stored in the file
+    uint32_t origLen;    //!< original length of the packet
+    const uint8_t *data; //!< first byte of the packet
+
+    /**
+     * \brief Create a packet holding the bytes of the record
+     * \param padToOrigLen if true and the packet was truncated by the
+     * capture snap length, add zero bytes at the end of the packet so
+     * that its size is origLen
+     * \returns the packet
+     */
+    Ptr<Packet> CreatePacket (bool padToOrigLen = false) const;
+  };
+
+  /**
+   * \brief Forward iterator over the records of the file
+   */
+  class Iterator
+  {
+public:
+    Iterator ();
+    /**
+     * \returns the current record
+     */
+    Record operator* (void) const;
+    /**
+     * \brief Move to the next record
+     * \returns this iterator
+     */
+    Iterator &operator++ (void);
+    /**
+     * \param o other iterator
+     * \returns true if both iterators point to the same record
+     */
+    bool operator== (Iterator const &o) const;
+    /**
+     * \param o other iterator
+     * \returns true if the iterators point to different records
+     */
+    bool operator!= (Iterator const &o) const;
+private:
+    friend class MappedPcapFile;
+    /**
+     * \param file the file
+     * \param offset offset of a record header in the file
+     */
+    Iterator (const MappedPcapFile *file, uint64_t offset);
+    /**
+     * \brief Move to the end of the file if no complete record
+     * starts at the current offset
+     */
+    void Check (void);
+
+    const MappedPcapFile *m_file; //!< the file
+    uint64_t m_offset;            //!< offset of the current record header
+  };
+
+  MappedPcapFile ();
+  ~MappedPcapFile ();
+
+  /**
+   * \brief Map a pcap file in memory
+   *
+   * \param filename name of the file to map
+   * \returns false if the file could not be mapped or is not a pcap file
+   */
+  bool Open (std::string const &filename);
+  /**
+   * \brief Unmap the file
+   *
+   * All the records obtained from the file become invalid.
+   */
+  void Close (void);
+  /**
+   * \returns true if a file is mapped
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \returns an iterator to the first record
+   */
+  Iterator Begin (void) const;
+  /**
+   * \returns an iterator past the last record
+   */
+  Iterator End (void) const;
+
+  /**
+   * \returns the data link type of the file
+   */
+  uint32_t GetDataLinkType (void) const;
+  /**
+   * \returns the snap length of the file
+   */
+  uint32_t GetSnapLen (void) const;
+  /**
+   * \returns true if the file was written in the opposite byte order
+   */
+  bool GetSwapMode (void) const;
+  /**
+   * \returns true if the file has nanosecond resolution timestamps
+   */
+  bool IsNanoSecMode (void) const;
+  /**
+   * \returns the size of the file, in bytes
+   */
+  uint64_t GetSize (void) const;
+
+private:
+  /**
+   * \param offset an offset in the file
+   * \returns the 32-bit word at this offset, in host byte order
+   */
+  uint32_t Read32 (uint64_t offset) const;
+
+  /// Disabled copy constructor
+  MappedPcapFile (MappedPcapFile const &);
+  /// Disabled assignment operator
+  MappedPcapFile &operator = (MappedPcapFile const &);
+
+  const uint8_t *m_data;    //!< first byte of the mapping
+  uint64_t m_size;          //!< size of the file
+  uint32_t m_dataLinkType;  //!< data link type
+  uint32_t m_snapLen;       //!< snap length
+  bool m_swapMode;          //!< true if fields must be byte swapped
+  bool m_nanosecMode;       //!< true if timestamps are in nanoseconds
+};
+
+} // namespace ns3
+
+#endif /* MAPPED_PCAP_FILE_H */
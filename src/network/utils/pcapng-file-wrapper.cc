@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/header.h"
+#include "pcapng-file-wrapper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFileWrapper");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapNgFileWrapper);
+
+TypeId
+PcapNgFileWrapper::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapNgFileWrapper")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PcapNgFileWrapper> ()
+    .AddAttribute ("CaptureSize",
+                   "Default maximum length of captured packets (cf. pcap snaplen) "
+                   "for interfaces added to the file.  Bytes beyond this length "
+                   "are never copied out of the packet.",
+                   UintegerValue (PcapNgFile::SNAPLEN_DEFAULT),
+                   MakeUintegerAccessor (&PcapNgFileWrapper::m_snapLen),
+                   MakeUintegerChecker<uint32_t> (0, PcapNgFile::SNAPLEN_DEFAULT))
+    .AddAttribute ("BufferSize",
+                   "Size in bytes of the buffer blocks are assembled in before "
+                   "being written to the file.",
+                   UintegerValue (PcapNgFile::BUFFER_SIZE_DEFAULT),
+                   MakeUintegerAccessor (&PcapNgFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (4096))
+  ;
+  return tid;
+}
+
+PcapNgFileWrapper::PcapNgFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapNgFileWrapper::~PcapNgFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapNgFileWrapper::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.Fail ();
+}
+
+void
+PcapNgFileWrapper::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.Open (filename, m_bufferSize);
+}
+
+void
+PcapNgFileWrapper::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Close ();
+}
+
+void
+PcapNgFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Flush ();
+}
+
+uint32_t
+PcapNgFileWrapper::AddInterface (uint32_t dataLinkType, std::string const &name, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << name << snapLen);
+  if (snapLen == std::numeric_limits<uint32_t>::max ())
+    {
+      snapLen = m_snapLen;
+    }
+  return m_file.AddInterface (dataLinkType, snapLen, name);
+}
+
+uint32_t
+PcapNgFileWrapper::GetNInterfaces (void) const
+{
+  return m_file.GetNInterfaces ();
+}
+
+void
+PcapNgFileWrapper::Write (Time t, uint32_t interfaceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << interfaceId << p);
+  m_file.Write (interfaceId, t.GetNanoSeconds (), p);
+}
+
+void
+PcapNgFileWrapper::Write (Time t, uint32_t interfaceId, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << interfaceId << &header << p);
+  m_file.Write (interfaceId, t.GetNanoSeconds (), header, p);
+}
+
+} // namespace ns3
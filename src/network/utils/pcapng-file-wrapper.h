@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_WRAPPER_H
+#define PCAPNG_FILE_WRAPPER_H
+
+#include <limits>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+/**
+ * A class that wraps a PcapNgFile as an ns3::Object so that a single
+ * multi-interface capture file can be shared by the trace sinks of many
+ * devices.  The snap length applied to new interfaces and the size of the
+ * write buffer are controlled through attributes.
+ */
+class PcapNgFileWrapper : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapNgFileWrapper ();
+  ~PcapNgFileWrapper ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new pcapng file, using the "BufferSize" attribute as the size
+   * of the write buffer.
+   *
+   * \param filename String containing the name of the file.
+   */
+  void Open (std::string const &filename);
+
+  /**
+   * Flush buffered blocks and close the underlying pcapng file.
+   */
+  void Close (void);
+
+  /**
+   * Hand all buffered blocks over to the underlying file.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Declare a new capture interface in the file.
+   *
+   * \param dataLinkType A data link type as defined in the pcap library.
+   * \param name Interface name stored in the file (may be empty).
+   * \param snapLen An optional maximum size for packets captured on this
+   * interface.  If not provided, the "CaptureSize" attribute is used.
+   * \returns the interface identifier to pass to Write
+   */
+  uint32_t AddInterface (uint32_t dataLinkType,
+                         std::string const &name,
+                         uint32_t snapLen = std::numeric_limits<uint32_t>::max ());
+
+  /**
+   * \returns the number of interfaces declared so far
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write the next packet to file
+   *
+   * \param t Packet timestamp as ns3::Time.
+   * \param interfaceId Interface the packet was captured on.
+   * \param p Packet to write to the pcapng file.
+   */
+  void Write (Time t, uint32_t interfaceId, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the provided header along with the packet to the pcapng file.
+   *
+   * \param t Packet timestamp as ns3::Time.
+   * \param interfaceId Interface the packet was captured on.
+   * \param header The Header to prepend to the packet.
+   * \param p Packet to write to the pcapng file.
+   */
+  void Write (Time t, uint32_t interfaceId, const Header &header, Ptr<const Packet> p);
+
+private:
+  PcapNgFile m_file;       //!< Pcapng file
+  uint32_t   m_snapLen;    //!< default max length of saved packets
+  uint32_t   m_bufferSize; //!< size of the write buffer
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_WRAPPER_H */
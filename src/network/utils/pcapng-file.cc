@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/log.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFile");
+
+namespace {
+
+const uint16_t VERSION_MAJOR = 1;     //!< Major version of the pcapng format
+const uint16_t VERSION_MINOR = 0;     //!< Minor version of the pcapng format
+
+const uint16_t OPT_ENDOFOPT = 0;      //!< End of option list
+const uint16_t OPT_IF_NAME = 2;       //!< if_name option code
+const uint16_t OPT_IF_TSRESOL = 9;    //!< if_tsresol option code
+
+/**
+ * \param len a length in bytes
+ * \returns len rounded up to the next multiple of four
+ */
+inline uint32_t
+Pad4 (uint32_t len)
+{
+  return (len + 3) & ~3U;
+}
+
+/**
+ * \brief Store a value at p in host byte order and advance p
+ * \param p write pointer
+ * \param v value to store
+ */
+template <typename T>
+inline void
+Put (uint8_t *&p, T v)
+{
+  std::memcpy (p, &v, sizeof (v));
+  p += sizeof (v);
+}
+
+} // unnamed namespace
+
+PcapNgFile::PcapNgFile ()
+  : m_file (),
+    m_used (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapNgFile::~PcapNgFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapNgFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.fail ();
+}
+
+void
+PcapNgFile::Open (std::string const &filename, uint32_t bufferSize)
+{
+  NS_LOG_FUNCTION (this << filename << bufferSize);
+  NS_ASSERT (!m_file.is_open ());
+
+  m_filename = filename;
+  m_buffer.resize (std::max<uint32_t> (bufferSize, 4096));
+  m_used = 0;
+  m_snapLen.clear ();
+  m_file.open (filename.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!m_file.fail ())
+    {
+      WriteSectionHeader ();
+    }
+}
+
+void
+PcapNgFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file.is_open ())
+    {
+      Flush ();
+      m_file.close ();
+    }
+}
+
+void
+PcapNgFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_used > 0)
+    {
+      m_file.write ((const char *)&m_buffer[0], m_used);
+      m_used = 0;
+    }
+  m_file.flush ();
+}
+
+uint8_t *
+PcapNgFile::Reserve (uint32_t blockLen)
+{
+  if (m_used + blockLen > m_buffer.size ())
+    {
+      Flush ();
+      if (blockLen > m_buffer.size ())
+        {
+          m_buffer.resize (blockLen);
+        }
+    }
+  uint8_t *p = &m_buffer[m_used];
+  m_used += blockLen;
+  return p;
+}
+
+void
+PcapNgFile::WriteSectionHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  const uint32_t blockLen = 28;
+  uint8_t *p = Reserve (blockLen);
+  Put<uint32_t> (p, SECTION_HEADER_BLOCK);
+  Put<uint32_t> (p, blockLen);
+  Put<uint32_t> (p, BYTE_ORDER_MAGIC);
+  Put<uint16_t> (p, VERSION_MAJOR);
+  Put<uint16_t> (p, VERSION_MINOR);
+  // Section length is not known in advance
+  Put<int64_t> (p, -1);
+  Put<uint32_t> (p, blockLen);
+}
+
+uint32_t
+PcapNgFile::AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name);
+  NS_ASSERT_MSG (dataLinkType <= 0xffff, "PcapNgFile::AddInterface(): link type does not fit in an IDB");
+
+  uint32_t nameLen = name.size ();
+  uint32_t optionsLen = 8 + 4;                 // if_tsresol + opt_endofopt
+  if (nameLen > 0)
+    {
+      optionsLen += 4 + Pad4 (nameLen);
+    }
+  uint32_t blockLen = 20 + optionsLen;
+
+  uint8_t *p = Reserve (blockLen);
+  Put<uint32_t> (p, INTERFACE_DESCRIPTION_BLOCK);
+  Put<uint32_t> (p, blockLen);
+  Put<uint16_t> (p, dataLinkType);
+  Put<uint16_t> (p, 0);
+  Put<uint32_t> (p, snapLen);
+  if (nameLen > 0)
+    {
+      Put<uint16_t> (p, OPT_IF_NAME);
+      Put<uint16_t> (p, nameLen);
+      std::memcpy (p, name.data (), nameLen);
+      std::memset (p + nameLen, 0, Pad4 (nameLen) - nameLen);
+      p += Pad4 (nameLen);
+    }
+  Put<uint16_t> (p, OPT_IF_TSRESOL);
+  Put<uint16_t> (p, 1);
+  Put<uint32_t> (p, 9);                        // 10^-9 s, padding bytes are zero
+  Put<uint16_t> (p, OPT_ENDOFOPT);
+  Put<uint16_t> (p, 0);
+  Put<uint32_t> (p, blockLen);
+
+  m_snapLen.push_back (snapLen);
+  return m_snapLen.size () - 1;
+}
+
+uint32_t
+PcapNgFile::GetNInterfaces (void) const
+{
+  return m_snapLen.size ();
+}
+
+uint32_t
+PcapNgFile::GetSnapLen (uint32_t interfaceId) const
+{
+  NS_ASSERT (interfaceId < m_snapLen.size ());
+  return m_snapLen[interfaceId];
+}
+
+uint8_t *
+PcapNgFile::BeginPacketBlock (uint32_t interfaceId, uint64_t ts, uint32_t totalLen, uint32_t &inclLen)
+{
+  NS_ASSERT_MSG (interfaceId < m_snapLen.size (), "PcapNgFile: unknown interface " << interfaceId);
+  uint32_t snapLen = m_snapLen[interfaceId];
+  inclLen = (snapLen != 0 && totalLen > snapLen) ? snapLen : totalLen;
+
+  uint32_t blockLen = 32 + Pad4 (inclLen);
+  uint8_t *p = Reserve (blockLen);
+  Put<uint32_t> (p, ENHANCED_PACKET_BLOCK);
+  Put<uint32_t> (p, blockLen);
+  Put<uint32_t> (p, interfaceId);
+  Put<uint32_t> (p, static_cast<uint32_t> (ts >> 32));
+  Put<uint32_t> (p, static_cast<uint32_t> (ts));
+  Put<uint32_t> (p, inclLen);
+  Put<uint32_t> (p, totalLen);
+
+  // Zero the padding and store the trailing length now, the caller only
+  // fills in the packet data.
+  uint8_t *trailer = p + Pad4 (inclLen);
+  std::memset (p + inclLen, 0, Pad4 (inclLen) - inclLen);
+  Put<uint32_t> (trailer, blockLen);
+  return p;
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t ts, uint8_t const * const data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interfaceId << ts << &data << totalLen);
+  uint32_t inclLen;
+  uint8_t *p = BeginPacketBlock (interfaceId, ts, totalLen, inclLen);
+  std::memcpy (p, data, inclLen);
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t ts, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interfaceId << ts << p);
+  uint32_t inclLen;
+  uint8_t *data = BeginPacketBlock (interfaceId, ts, p->GetSize (), inclLen);
+  p->CopyData (data, inclLen);
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t ts, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interfaceId << ts << &header << p);
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t inclLen;
+  uint8_t *data = BeginPacketBlock (interfaceId, ts, headerSize + p->GetSize (), inclLen);
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  headerBuffer.Begin ().Read (data, toCopy);
+  p->CopyData (data + toCopy, inclLen - toCopy);
+}
+
+} // namespace ns3
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \brief A class representing a pcapng file
+ *
+ * Unlike a classic pcap file, which is restricted to one data link type
+ * and hence to one capture point, a pcapng file may carry packets from
+ * any number of interfaces.  Each interface is announced once with an
+ * Interface Description Block (IDB) and every packet is stored in an
+ * Enhanced Packet Block (EPB) referring to its interface by index.  This
+ * allows all the devices of a node, or of a whole simulation, to share a
+ * single file.
+ *
+ * Blocks are assembled in an in-memory buffer and handed to the underlying
+ * stream only when the buffer is full or the file is closed, so that the
+ * per-packet cost is a memcpy rather than several small stream writes.
+ * Packets longer than the snap length of their interface are truncated
+ * before any of their bytes are copied.
+ *
+ * All blocks are written in host byte order; readers detect the byte order
+ * from the byte-order magic of the Section Header Block.  Timestamps are
+ * written with nanosecond resolution (if_tsresol = 9).
+ *
+ * See https://github.com/pcapng/pcapng for the format specification.
+ */
+class PcapNgFile
+{
+public:
+  static const uint32_t SNAPLEN_DEFAULT = 65535;         /**< Default value for maximum octets to save per packet */
+  static const uint32_t BUFFER_SIZE_DEFAULT = 1 << 20;   /**< Default size of the write buffer, in bytes */
+
+  static const uint32_t SECTION_HEADER_BLOCK = 0x0a0d0d0a;      /**< Block type of a Section Header Block */
+  static const uint32_t INTERFACE_DESCRIPTION_BLOCK = 0x00000001; /**< Block type of an Interface Description Block */
+  static const uint32_t ENHANCED_PACKET_BLOCK = 0x00000006;     /**< Block type of an Enhanced Packet Block */
+  static const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;          /**< Byte-order magic of a Section Header Block */
+
+  PcapNgFile ();
+  ~PcapNgFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new pcapng file and write its Section Header Block.  Any
+   * existing file with the same name is truncated.
+   *
+   * \param filename String containing the name of the file.
+   * \param bufferSize Size in bytes of the write buffer.
+   */
+  void Open (std::string const &filename, uint32_t bufferSize = BUFFER_SIZE_DEFAULT);
+
+  /**
+   * Flush any buffered blocks and close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * Hand all buffered blocks over to the underlying file.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Declare a new interface by writing an Interface Description Block
+   *
+   * \param dataLinkType A data link type as defined in the pcap library.
+   * \param snapLen Maximum number of octets saved per packet captured on this
+   * interface.  Zero means no limit.
+   * \param name Optional interface name stored in the if_name option.
+   * \returns the interface identifier to pass to Write
+   */
+  uint32_t AddInterface (uint32_t dataLinkType,
+                         uint32_t snapLen = SNAPLEN_DEFAULT,
+                         std::string const &name = "");
+
+  /**
+   * \returns the number of interfaces declared so far
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \param interfaceId interface identifier returned by AddInterface
+   * \returns the snap length of that interface
+   */
+  uint32_t GetSnapLen (uint32_t interfaceId) const;
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param interfaceId interface identifier returned by AddInterface
+   * \param ts          Packet timestamp, nanoseconds
+   * \param data        Data buffer
+   * \param totalLen    Total packet length
+   */
+  void Write (uint32_t interfaceId, uint64_t ts, uint8_t const * const data, uint32_t totalLen);
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param interfaceId interface identifier returned by AddInterface
+   * \param ts          Packet timestamp, nanoseconds
+   * \param p           Packet to write
+   */
+  void Write (uint32_t interfaceId, uint64_t ts, Ptr<const Packet> p);
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param interfaceId interface identifier returned by AddInterface
+   * \param ts          Packet timestamp, nanoseconds
+   * \param header      Header to write, in front of packet
+   * \param p           Packet to write
+   */
+  void Write (uint32_t interfaceId, uint64_t ts, const Header &header, Ptr<const Packet> p);
+
+private:
+  /**
+   * \brief Make room for a block in the write buffer
+   *
+   * \param blockLen total length of the block about to be written
+   * \returns a pointer to the first free byte of the buffer
+   */
+  uint8_t *Reserve (uint32_t blockLen);
+
+  /**
+   * \brief Start an Enhanced Packet Block in the write buffer
+   *
+   * \param interfaceId interface identifier
+   * \param ts timestamp, nanoseconds
+   * \param totalLen total packet length
+   * \param inclLen [out] number of packet octets to store
+   * \returns a pointer to where the packet data must be copied
+   */
+  uint8_t *BeginPacketBlock (uint32_t interfaceId, uint64_t ts, uint32_t totalLen, uint32_t &inclLen);
+
+  /**
+   * \brief Write the Section Header Block
+   */
+  void WriteSectionHeader (void);
+
+  std::string          m_filename;    //!< file name
+  std::ofstream        m_file;        //!< file stream
+  std::vector<uint8_t> m_buffer;      //!< write buffer
+  uint32_t             m_used;        //!< number of bytes used in m_buffer
+  std::vector<uint32_t> m_snapLen;    //!< snap length of each declared interface
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
@@ -28,6 +28,7 @@
 #include "ns3/boolean.h"
 #include "ns3/string.h"
 #include "ns3/tag.h"
+#include "tso-tag.h"
 #include "ns3/simulator.h"
 #include "ns3/net-device-queue-interface.h"
 
@@ -487,7 +488,8 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
           Time txTime = Time (0);
           if (m_bps > DataRate (0))
             {
-              txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+              uint32_t nSegments;
+              txTime = m_bps.CalculateBytesTxTime (TsoTag::GetWireSize (packet, nSegments));
             }
           m_channel->Send (p, protocolNumber, to, from, this);
           TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
@@ -527,7 +529,8 @@ SimpleNetDevice::TransmitComplete ()
       Time txTime = Time (0);
       if (m_bps > DataRate (0))
         {
-          txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+          uint32_t nSegments;
+          txTime = m_bps.CalculateBytesTxTime (TsoTag::GetWireSize (packet, nSegments));
         }
       TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
     }
@@ -595,4 +598,11 @@ SimpleNetDevice::SupportsSendFrom (void) const
   return true;
 }
 
+bool
+SimpleNetDevice::SupportsTso (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
 } // namespace ns3
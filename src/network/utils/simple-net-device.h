@@ -135,6 +135,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsTso (void) const;
 
 protected:
   virtual void DoDispose (void);
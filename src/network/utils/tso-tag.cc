@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tso-tag.h"
+#include "ns3/packet.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TsoTag");
+
+NS_OBJECT_ENSURE_REGISTERED (TsoTag);
+
+TypeId
+TsoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TsoTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<TsoTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+TsoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+TsoTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+TsoTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU32 (m_payloadSize);
+  buf.WriteU32 (m_segmentSize);
+}
+
+void
+TsoTag::Deserialize (TagBuffer buf)
+{
+  m_payloadSize = buf.ReadU32 ();
+  m_segmentSize = buf.ReadU32 ();
+}
+
+void
+TsoTag::Print (std::ostream &os) const
+{
+  os << "TsoPayload=" << m_payloadSize << " TsoSegmentSize=" << m_segmentSize;
+}
+
+TsoTag::TsoTag ()
+  : Tag (),
+    m_payloadSize (0),
+    m_segmentSize (1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TsoTag::TsoTag (uint32_t payloadSize, uint32_t segmentSize)
+  : Tag (),
+    m_payloadSize (payloadSize),
+    m_segmentSize (segmentSize)
+{
+  NS_LOG_FUNCTION (this << payloadSize << segmentSize);
+  NS_ASSERT (segmentSize > 0);
+}
+
+uint32_t
+TsoTag::GetPayloadSize (void) const
+{
+  return m_payloadSize;
+}
+
+uint32_t
+TsoTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+uint32_t
+TsoTag::GetNSegments (void) const
+{
+  return m_payloadSize == 0 ? 1 : (m_payloadSize + m_segmentSize - 1) / m_segmentSize;
+}
+
+uint32_t
+TsoTag::GetWireSize (Ptr<const Packet> p, uint32_t &nSegments)
+{
+  uint32_t size = p->GetSize ();
+  TsoTag tag;
+  if (!p->PeekPacketTag (tag) || size < tag.m_payloadSize)
+    {
+      nSegments = 1;
+      return size;
+    }
+  // Every wire segment carries the headers and trailers of the packet
+  nSegments = tag.GetNSegments ();
+  return size + (nSegments - 1) * (size - tag.m_payloadSize);
+}
+
+} // namespace ns3
@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TSO_TAG_H
+#define TSO_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief Mark a packet as a super-segment built by a transport protocol
+ * emulating segmentation offload (TSO)
+ *
+ * A super-segment carries the payload of several wire segments of at most
+ * GetSegmentSize bytes each under a single copy of the headers. The
+ * protocol layers let it through as a single packet, without fragmenting
+ * it, to the devices supporting segmentation offload (see
+ * NetDevice::SupportsTso), and split it into single segments before the
+ * other devices. The devices modeling serialization time charge it for the
+ * wire segments it stands for: every segment repeats the headers and
+ * framing of the super-segment, and is followed by an interframe gap.
+ *
+ * The receiver gets the whole super-segment when its last segment would
+ * have been received, as if the segments had been coalesced by the
+ * receiver (GRO).
+ */
+class TsoTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+
+  TsoTag ();
+  /**
+   * \brief Constructor
+   * \param payloadSize total payload of the super-segment, in bytes
+   * \param segmentSize maximum payload of a wire segment, in bytes
+   */
+  TsoTag (uint32_t payloadSize, uint32_t segmentSize);
+
+  /**
+   * \returns the total payload of the super-segment, in bytes
+   */
+  uint32_t GetPayloadSize (void) const;
+  /**
+   * \returns the maximum payload of a wire segment, in bytes
+   */
+  uint32_t GetSegmentSize (void) const;
+  /**
+   * \returns the number of wire segments making the super-segment
+   */
+  uint32_t GetNSegments (void) const;
+
+  /**
+   * \brief Get the size on the wire of a packet which may be a super-segment
+   *
+   * \param p the packet, with the headers and trailers of the device
+   * \param nSegments filled with the number of wire segments, 1 if the
+   * packet is not a super-segment
+   * \returns the sum of the sizes of the wire segments
+   */
+  static uint32_t GetWireSize (Ptr<const Packet> p, uint32_t &nSegments);
+
+private:
+  uint32_t m_payloadSize; //!< Total payload
+  uint32_t m_segmentSize; //!< Maximum payload of a wire segment
+};
+
+} // namespace ns3
+
+#endif /* TSO_TAG_H */
@@ -258,6 +258,18 @@ void RoutingProtocol::DoDispose ()
   Ipv4RoutingProtocol::DoDispose ();
 }
 
+uint64_t
+RoutingProtocol::GetRoutingTableGeneration (void) const
+{
+  // HNA routes are looked up in m_hnaRoutingTable
+  uint64_t generation = Ipv4RoutingProtocol::GetRoutingTableGeneration ();
+  if (m_hnaRoutingTable != 0)
+    {
+      generation += m_hnaRoutingTable->GetRoutingTableGeneration ();
+    }
+  return generation;
+}
+
 void
 RoutingProtocol::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
 {
@@ -2819,12 +2831,14 @@ RoutingProtocol::Clear ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_table.clear ();
+  NotifyRoutingTableChanged ();
 }
 
 void
 RoutingProtocol::RemoveEntry (Ipv4Address const &dest)
 {
   m_table.erase (dest);
+  NotifyRoutingTableChanged ();
 }
 
 bool
@@ -3079,6 +3093,7 @@ RoutingProtocol::AddEntry (Ipv4Address const &dest,
   entry.nextAddr = next;
   entry.interface = interface;
   entry.distance = distance;
+  NotifyRoutingTableChanged ();
 }
 
 void
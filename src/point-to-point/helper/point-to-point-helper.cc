@@ -107,6 +107,21 @@ PointToPointHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, b
   pcapHelper.HookDefaultSink<PointToPointNetDevice> (device, "PromiscSniffer", file);
 }
 
+void
+PointToPointHelper::EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+  Ptr<PointToPointNetDevice> device = nd->GetObject<PointToPointNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("PointToPointHelper::EnablePcapNgInternal(): Device " << device << " not of type ns3::PointToPointNetDevice");
+      return;
+    }
+
+  PcapHelper pcapHelper;
+  uint32_t interfaceId = file->AddInterface (PcapHelper::DLT_PPP, pcapHelper.GetInterfaceNameFromDevice (device));
+  pcapHelper.HookDefaultSink<PointToPointNetDevice> (device, "PromiscSniffer", file, interfaceId);
+}
+
 void 
 PointToPointHelper::EnableAsciiInternal (
   Ptr<OutputStreamWrapper> stream, 
@@ -216,6 +231,37 @@ PointToPointHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+
+void
+PointToPointHelper::EnableBinaryInternal (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd)
+{
+  Ptr<PointToPointNetDevice> device = nd->GetObject<PointToPointNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("PointToPointHelper::EnableBinaryInternal(): Device " << device <<
+                   " not of type ns3::PointToPointNetDevice");
+      return;
+    }
+
+  //
+  // Hook the same trace sources as the ascii traces, but unlike those the
+  // binary sinks do not need packet printing.
+  //
+  AsciiTraceHelper asciiTraceHelper;
+  uint32_t nodeid = nd->GetNode ()->GetId ();
+  uint32_t deviceid = nd->GetIfIndex ();
+
+  asciiTraceHelper.HookBinarySink<PointToPointNetDevice> (device, "MacRx", file, BinaryTraceFile::RECEIVE, nodeid, deviceid);
+
+  Ptr<Queue<Packet> > queue = device->GetQueue ();
+  asciiTraceHelper.HookBinarySink<Queue<Packet> > (queue, "Enqueue", file, BinaryTraceFile::ENQUEUE, nodeid, deviceid);
+  asciiTraceHelper.HookBinarySink<Queue<Packet> > (queue, "Drop", file, BinaryTraceFile::DROP, nodeid, deviceid);
+  asciiTraceHelper.HookBinarySink<Queue<Packet> > (queue, "Dequeue", file, BinaryTraceFile::DEQUEUE, nodeid, deviceid);
+
+  // PhyRxDrop trace source for "d" event
+  asciiTraceHelper.HookBinarySink<PointToPointNetDevice> (device, "PhyRxDrop", file, BinaryTraceFile::DROP, nodeid, deviceid);
+}
+
 NetDeviceContainer 
 PointToPointHelper::Install (NodeContainer c)
 {
@@ -164,6 +164,18 @@ private:
    */
   virtual void EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename);
 
+  /**
+   * \brief Enable pcapng output the indicated net device.
+   *
+   * NetDevice-specific implementation mechanism for declaring the device as
+   * an interface of a shared pcapng file and hooking its trace to it.
+   *
+   * \param file pcapng file shared by the traced devices.
+   * \param nd Net device for which you want to enable tracing.
+   * \param promiscuous If true capture all possible packets available at the device.
+   */
+  virtual void EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous);
+
   /**
    * \brief Enable ascii trace output on the indicated net device.
    *
@@ -181,6 +193,17 @@ private:
     Ptr<NetDevice> nd,
     bool explicitFilename);
 
+  /**
+   * \brief Enable binary trace output on the indicated net device.
+   *
+   * NetDevice-specific implementation mechanism for hooking the trace and
+   * writing to the binary trace file.
+   *
+   * \param file The binary trace file.
+   * \param nd Net device for which you want to enable tracing.
+   */
+  virtual void EnableBinaryInternal (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd);
+
   ObjectFactory m_queueFactory;         //!< Queue Factory
   ObjectFactory m_channelFactory;       //!< Channel Factory
   ObjectFactory m_remoteChannelFactory; //!< Remote Channel Factory
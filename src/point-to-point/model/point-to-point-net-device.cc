@@ -26,6 +26,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/tso-tag.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -284,7 +285,14 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  //
+  // A TCP super-segment stands for several segments on the wire, each one
+  // with its own framing and followed by an interframe gap.  It is received
+  // as a whole when its last segment is.
+  //
+  uint32_t nSegments;
+  uint32_t wireSize = TsoTag::GetWireSize (p, nSegments);
+  Time txTime = m_bps.CalculateBytesTxTime (wireSize) + m_tInterframeGap * int64_t (nSegments - 1);
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -641,6 +649,13 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsTso (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
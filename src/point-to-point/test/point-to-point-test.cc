@@ -24,6 +24,7 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/tso-tag.h"
 
 using namespace ns3;
 
@@ -101,6 +102,128 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the transmission time of a TCP super-segment
+ *
+ * A packet carrying a TsoTag must be received when its last wire segment
+ * would have been, every segment having its own PPP header and being
+ * followed by an interframe gap.
+ */
+class PointToPointTsoTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointTsoTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a packet
+   *
+   * \param device NetDevice to send to
+   * \param size payload size
+   * \param segmentSize segment size of the super-segment, 0 for a plain packet
+   */
+  void Send (Ptr<PointToPointNetDevice> device, uint32_t size, uint32_t segmentSize);
+
+  /**
+   * \brief Record the reception time of a packet
+   *
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  Time m_sent;            //!< Time the last packet was sent
+  Time m_txTime;          //!< Transmission time of the last packet received
+};
+
+PointToPointTsoTest::PointToPointTsoTest ()
+  : TestCase ("PointToPoint super-segment transmission time")
+{
+}
+
+void
+PointToPointTsoTest::Send (Ptr<PointToPointNetDevice> device, uint32_t size, uint32_t segmentSize)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  if (segmentSize > 0)
+    {
+      p->AddPacketTag (TsoTag (size, segmentSize));
+    }
+  m_sent = Simulator::Now ();
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointTsoTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_txTime = Simulator::Now () - m_sent;
+  return true;
+}
+
+void
+PointToPointTsoTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  // One byte per microsecond
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->SetInterframeGap (MicroSeconds (10));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointTsoTest::Receive, this));
+
+  Ptr<NetDeviceQueueInterface> ifaceA = CreateObject<NetDeviceQueueInterface> ();
+  devA->AggregateObject (ifaceA);
+  ifaceA->CreateTxQueues ();
+  Ptr<NetDeviceQueueInterface> ifaceB = CreateObject<NetDeviceQueueInterface> ();
+  devB->AggregateObject (ifaceB);
+  ifaceB->CreateTxQueues ();
+
+  // 1000 bytes and a 2 bytes PPP header; the transmission times are
+  // computed in floating point
+  Simulator::Schedule (Seconds (1.0), &PointToPointTsoTest::Send, this, devA, 1000, 0);
+  Simulator::Stop (Seconds (1.5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_txTime, MicroSeconds (1002), NanoSeconds (1), "wrong transmission time of a plain packet");
+
+  // Four segments of 1000 bytes, each with its own PPP header, and three
+  // interframe gaps between them
+  Simulator::Schedule (Seconds (0.5), &PointToPointTsoTest::Send, this, devA, 4000, 1000);
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_txTime, MicroSeconds (4 * 1002 + 3 * 10), NanoSeconds (1), "wrong transmission time of a super-segment");
+
+  // The last segment is shorter
+  Simulator::Schedule (Seconds (0.5), &PointToPointTsoTest::Send, this, devA, 3500, 1000);
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_txTime, MicroSeconds (3500 + 4 * 2 + 3 * 10), NanoSeconds (1), "wrong transmission time of a super-segment");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -117,6 +240,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointTsoTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
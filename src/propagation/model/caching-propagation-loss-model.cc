@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <limits>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/pointer.h"
+#include "caching-propagation-loss-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CachingPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED (CachingPropagationLossModel);
+
+TypeId
+CachingPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachingPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .SetGroupName ("Propagation")
+    .AddConstructor<CachingPropagationLossModel> ()
+    .AddAttribute ("Model",
+                   "The propagation loss model whose results are cached "
+                   "between nodes which do not move.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachingPropagationLossModel::SetModel,
+                                        &CachingPropagationLossModel::GetModel),
+                   MakePointerChecker<PropagationLossModel> ())
+  ;
+  return tid;
+}
+
+size_t
+CachingPropagationLossModel::MobilityHash::operator () (const MobilityModel *mobility) const
+{
+  // Objects are at least 8-byte aligned
+  return static_cast<size_t> (reinterpret_cast<uintptr_t> (mobility) >> 3);
+}
+
+CachingPropagationLossModel::CachingPropagationLossModel ()
+  : m_nEntries (0),
+    m_nHits (0),
+    m_nMisses (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CachingPropagationLossModel::~CachingPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+CachingPropagationLossModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+  m_model = 0;
+  PropagationLossModel::DoDispose ();
+}
+
+void
+CachingPropagationLossModel::SetModel (Ptr<PropagationLossModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  // The entries were computed by the previous model
+  m_entries.clear ();
+  m_nEntries = 0;
+}
+
+Ptr<PropagationLossModel>
+CachingPropagationLossModel::GetModel (void) const
+{
+  return m_model;
+}
+
+uint64_t
+CachingPropagationLossModel::GetNHits (void) const
+{
+  return m_nHits;
+}
+
+uint64_t
+CachingPropagationLossModel::GetNMisses (void) const
+{
+  return m_nMisses;
+}
+
+void
+CachingPropagationLossModel::Clear (void)
+{
+  // Same callback as the one connected by GetNode
+  const CachingPropagationLossModel *self = this;
+  for (std::vector<Node>::const_iterator it = m_nodes.begin (); it != m_nodes.end (); it++)
+    {
+      it->mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                   MakeCallback (&CachingPropagationLossModel::CourseChanged, self));
+    }
+  m_nodes.clear ();
+  m_nodeIndex.clear ();
+  m_entries.clear ();
+  m_nEntries = 0;
+}
+
+uint32_t
+CachingPropagationLossModel::GetNode (Ptr<MobilityModel> mobility) const
+{
+  std::pair<Nodes::iterator, bool> inserted = m_nodeIndex.insert (std::make_pair (PeekPointer (mobility), m_nodes.size ()));
+  if (inserted.second)
+    {
+      // The node keeps the mobility model alive, so that its address is
+      // not reused by another one
+      Node node;
+      node.mobility = mobility;
+      node.version = 0;
+      m_nodes.push_back (node);
+      mobility->TraceConnectWithoutContext ("CourseChange",
+                                            MakeCallback (&CachingPropagationLossModel::CourseChanged, this));
+    }
+  return inserted.first->second;
+}
+
+CachingPropagationLossModel::Entry *
+CachingPropagationLossModel::FindEntry (uint64_t key) const
+{
+  if ((m_nEntries + 1) * 2 > m_entries.size ())
+    {
+      std::vector<Entry> entries (std::max<size_t> (64, m_entries.size () * 2));
+      entries.swap (m_entries);
+      m_nEntries = 0;
+      for (std::vector<Entry>::const_iterator it = entries.begin (); it != entries.end (); it++)
+        {
+          if (it->key != 0)
+            {
+              *FindEntry (it->key) = *it;
+              m_nEntries++;
+            }
+        }
+    }
+
+  size_t mask = m_entries.size () - 1;
+  uint64_t hash = key * 0x9e3779b97f4a7c15ULL;
+  size_t i = static_cast<size_t> (hash ^ (hash >> 32)) & mask;
+  while (m_entries[i].key != 0 && m_entries[i].key != key)
+    {
+      i = (i + 1) & mask;
+    }
+  return &m_entries[i];
+}
+
+double
+CachingPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                            Ptr<MobilityModel> a,
+                                            Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model != 0, "CachingPropagationLossModel without a model to cache");
+
+  // Reading the velocities first lets the mobility models notify a
+  // pending course change
+  if (a->GetVelocity ().GetLength () > 0 || b->GetVelocity ().GetLength () > 0)
+    {
+      m_nMisses++;
+      return m_model->CalcRxPower (txPowerDbm, a, b);
+    }
+
+  uint32_t i = GetNode (a);
+  uint32_t j = GetNode (b);
+  uint32_t versionA = m_nodes[i].version;
+  uint32_t versionB = m_nodes[j].version;
+  uint64_t key = (static_cast<uint64_t> (i + 1) << 32) | (j + 1);
+  Entry *entry = FindEntry (key);
+  if (entry->key == key
+      && entry->versionA == versionA
+      && entry->versionB == versionB
+      && entry->txPowerDbm == txPowerDbm)
+    {
+      m_nHits++;
+      return entry->rxPowerDbm;
+    }
+
+  m_nMisses++;
+  double rxPowerDbm = m_model->CalcRxPower (txPowerDbm, a, b);
+  if (entry->key == 0)
+    {
+      entry->key = key;
+      m_nEntries++;
+    }
+  entry->versionA = versionA;
+  entry->versionB = versionB;
+  entry->txPowerDbm = txPowerDbm;
+  entry->rxPowerDbm = rxPowerDbm;
+  return rxPowerDbm;
+}
+
+int64_t
+CachingPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  if (m_model == 0)
+    {
+      return 0;
+    }
+  return m_model->AssignStreams (stream);
+}
+
+double
+CachingPropagationLossModel::DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const
+{
+  if (m_model == 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  return m_model->GetMaxRange (txPowerDbm, minRxPowerDbm);
+}
+
+void
+CachingPropagationLossModel::CourseChanged (Ptr<const MobilityModel> mobility) const
+{
+  Nodes::const_iterator it = m_nodeIndex.find (PeekPointer (mobility));
+  NS_ASSERT (it != m_nodeIndex.end ());
+  NS_LOG_LOGIC ("Course change of " << mobility << ", forgetting its entries");
+  m_nodes[it->second].version++;
+}
+
+} // namespace ns3
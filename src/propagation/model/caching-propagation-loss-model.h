@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef CACHING_PROPAGATION_LOSS_MODEL_H
+#define CACHING_PROPAGATION_LOSS_MODEL_H
+
+#include <vector>
+#include "ns3/sgi-hashmap.h"
+#include "ns3/mobility-model.h"
+#include "propagation-loss-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup propagation
+ *
+ * \brief Reuse the reception power computed by another propagation loss
+ * model between nodes which do not move.
+ *
+ * The reception power computed by the model of the Model attribute, and
+ * the models chained to it, is kept for each ordered pair of mobility
+ * models in an open addressing hash table.  It is reused for the same
+ * transmission power as long as neither mobility model notifies a course
+ * change.  Nothing is kept for a pair while either of its mobility models
+ * has a non-zero velocity.
+ *
+ * The cached model must always give the same loss between nodes which do
+ * not move: a random model such as NakagamiPropagationLossModel would keep
+ * its first draw for each pair of nodes.
+ */
+class CachingPropagationLossModel : public PropagationLossModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  CachingPropagationLossModel ();
+  virtual ~CachingPropagationLossModel ();
+
+  /**
+   * \param model the propagation loss model whose results are cached
+   */
+  void SetModel (Ptr<PropagationLossModel> model);
+  /**
+   * \return the propagation loss model whose results are cached
+   */
+  Ptr<PropagationLossModel> GetModel (void) const;
+
+  /**
+   * \return the number of reception powers found in the cache
+   */
+  uint64_t GetNHits (void) const;
+  /**
+   * \return the number of reception powers computed by the cached model
+   */
+  uint64_t GetNMisses (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  CachingPropagationLossModel (const CachingPropagationLossModel &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  CachingPropagationLossModel & operator = (const CachingPropagationLossModel &);
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const;
+
+  /**
+   * \brief A mobility model seen by the cache
+   */
+  struct Node
+  {
+    Ptr<MobilityModel> mobility; //!< Mobility model
+    uint32_t version;            //!< Course changes of the mobility model
+  };
+
+  /**
+   * \brief The reception power between a pair of nodes
+   */
+  struct Entry
+  {
+    uint64_t key;                //!< Key of the pair of nodes, zero for a free entry
+    uint32_t versionA;           //!< Version of the source when computed
+    uint32_t versionB;           //!< Version of the destination when computed
+    double txPowerDbm;           //!< Transmission power (in dBm)
+    double rxPowerDbm;           //!< Reception power (in dBm)
+  };
+
+  /**
+   * \brief Hash of a mobility model pointer
+   */
+  class MobilityHash : public std::unary_function<const MobilityModel *, size_t>
+  {
+public:
+    /**
+     * \brief Hash a mobility model pointer
+     * \param mobility the mobility model
+     * \return the hash
+     */
+    size_t operator () (const MobilityModel *mobility) const;
+  };
+
+  /// Index of the node of each mobility model
+  typedef sgi::hash_map<const MobilityModel *, uint32_t, MobilityHash> Nodes;
+
+  /**
+   * \brief Find the node of a mobility model, and follow its course
+   * changes the first time it is seen.
+   * \param mobility the mobility model
+   * \return the index of the node
+   */
+  uint32_t GetNode (Ptr<MobilityModel> mobility) const;
+  /**
+   * \brief Find the entry of a pair of nodes, or the free entry where it
+   * is to be added.  The table is grown beforehand if needed so that the
+   * free entry can be used.
+   * \param key the key of the pair of nodes
+   * \return the entry
+   */
+  Entry * FindEntry (uint64_t key) const;
+  /**
+   * \brief Record that a mobility model changed course.
+   * \param mobility the mobility model
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
+  /**
+   * \brief Stop following the mobility models and forget every entry.
+   */
+  void Clear (void);
+
+  Ptr<PropagationLossModel> m_model;      //!< Cached propagation loss model
+  mutable std::vector<Node> m_nodes;      //!< Nodes seen
+  mutable Nodes m_nodeIndex;              //!< Index of the node of each mobility model
+  mutable std::vector<Entry> m_entries;   //!< Hash table of the entries, with linear probing
+  mutable uint32_t m_nEntries;            //!< Entries used
+  mutable uint64_t m_nHits;               //!< Reception powers found in the cache
+  mutable uint64_t m_nMisses;             //!< Reception powers computed
+};
+
+} // namespace ns3
+
+#endif /* CACHING_PROPAGATION_LOSS_MODEL_H */
@@ -29,6 +29,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -82,6 +83,77 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+void
+PropagationLossModel::CalcRxPowerBatch (double txPowerDbm,
+                                        Ptr<MobilityModel> a,
+                                        const std::vector<Ptr<MobilityModel> > &b,
+                                        std::vector<double> &rxPowerDbm) const
+{
+  uint32_t n = b.size ();
+  Batch batch;
+  batch.a = a;
+  batch.b = &b;
+  batch.position = a->GetPosition ();
+  batch.x.resize (n);
+  batch.y.resize (n);
+  batch.z.resize (n);
+  batch.distance.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Vector position = b[i]->GetPosition ();
+      batch.x[i] = position.x;
+      batch.y[i] = position.y;
+      batch.z[i] = position.z;
+    }
+  // Same operations as MobilityModel::GetDistanceFrom
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = batch.x[i] - batch.position.x;
+      double dy = batch.y[i] - batch.position.y;
+      double dz = batch.z[i] - batch.position.z;
+      batch.distance[i] = std::sqrt (dx * dx + dy * dy + dz * dz);
+    }
+
+  rxPowerDbm.assign (n, txPowerDbm);
+  for (const PropagationLossModel *model = this; model != 0; model = PeekPointer (model->m_next))
+    {
+      model->DoCalcRxPowerBatch (batch, rxPowerDbm);
+    }
+}
+
+void
+PropagationLossModel::DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const
+{
+  for (uint32_t i = 0; i < rxPowerDbm.size (); i++)
+    {
+      rxPowerDbm[i] = DoCalcRxPower (rxPowerDbm[i], batch.a, (*batch.b)[i]);
+    }
+}
+
+double
+PropagationLossModel::GetMaxRange (double txPowerDbm, double minRxPowerDbm) const
+{
+  double self = DoGetMaxRange (txPowerDbm, minRxPowerDbm);
+  if (m_next != 0 && self != std::numeric_limits<double>::infinity ())
+    {
+      // Every model of the chain only removes power, so the range of the
+      // chain is the shortest, unless one of them may add power
+      double next = m_next->GetMaxRange (txPowerDbm, minRxPowerDbm);
+      if (next == std::numeric_limits<double>::infinity ())
+        {
+          return next;
+        }
+      self = std::min (self, next);
+    }
+  return self;
+}
+
+double
+PropagationLossModel::DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -225,6 +297,21 @@ double
 FriisPropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                           Ptr<MobilityModel> a,
                                           Ptr<MobilityModel> b) const
+{
+  return CalcRxPowerAtDistance (txPowerDbm, a->GetDistanceFrom (b));
+}
+
+void
+FriisPropagationLossModel::DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const
+{
+  for (uint32_t i = 0; i < rxPowerDbm.size (); i++)
+    {
+      rxPowerDbm[i] = CalcRxPowerAtDistance (rxPowerDbm[i], batch.distance[i]);
+    }
+}
+
+double
+FriisPropagationLossModel::CalcRxPowerAtDistance (double txPowerDbm, double distance) const
 {
   /*
    * Friis free space equation:
@@ -255,7 +342,6 @@ FriisPropagationLossModel::DoCalcRxPower (double txPowerDbm,
    * L: system loss (unit-less)
    * lambda: wavelength (m)
    */
-  double distance = a->GetDistanceFrom (b);
   if (distance < 3*m_lambda)
     {
       NS_LOG_WARN ("distance not within the far field region => inaccurate propagation loss value");
@@ -277,6 +363,22 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const
+{
+  if (m_minLoss < 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double maxLossDb = txPowerDbm - minRxPowerDbm;
+  if (maxLossDb < m_minLoss)
+    {
+      return 0;
+    }
+  // Distance at which the loss of DoCalcRxPower is maxLossDb
+  return m_lambda / (4 * M_PI) * std::sqrt (std::pow (10.0, maxLossDb / 10) / m_systemLoss);
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -375,6 +477,22 @@ double
 TwoRayGroundPropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                                  Ptr<MobilityModel> a,
                                                  Ptr<MobilityModel> b) const
+{
+  return CalcRxPowerAtDistance (txPowerDbm, a->GetDistanceFrom (b),
+                                a->GetPosition ().z, b->GetPosition ().z);
+}
+
+void
+TwoRayGroundPropagationLossModel::DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const
+{
+  for (uint32_t i = 0; i < rxPowerDbm.size (); i++)
+    {
+      rxPowerDbm[i] = CalcRxPowerAtDistance (rxPowerDbm[i], batch.distance[i], batch.position.z, batch.z[i]);
+    }
+}
+
+double
+TwoRayGroundPropagationLossModel::CalcRxPowerAtDistance (double txPowerDbm, double distance, double txZ, double rxZ) const
 {
   /*
    * Two-Ray Ground equation:
@@ -402,15 +520,14 @@ TwoRayGroundPropagationLossModel::DoCalcRxPower (double txPowerDbm,
    * rx = tx + 10 log10 (-----------------------)
    *                      (d * d * d * d) * L
    */
-  double distance = a->GetDistanceFrom (b);
   if (distance <= m_minDistance)
     {
       return txPowerDbm;
     }
 
   // Set the height of the Tx and Rx antennae
-  double txAntHeight = a->GetPosition ().z + m_heightAboveZ;
-  double rxAntHeight = b->GetPosition ().z + m_heightAboveZ;
+  double txAntHeight = txZ + m_heightAboveZ;
+  double rxAntHeight = rxZ + m_heightAboveZ;
 
   // Calculate a crossover distance, under which we use Friis
   /*
@@ -508,7 +625,21 @@ LogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                                 Ptr<MobilityModel> a,
                                                 Ptr<MobilityModel> b) const
 {
-  double distance = a->GetDistanceFrom (b);
+  return CalcRxPowerAtDistance (txPowerDbm, a->GetDistanceFrom (b));
+}
+
+void
+LogDistancePropagationLossModel::DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const
+{
+  for (uint32_t i = 0; i < rxPowerDbm.size (); i++)
+    {
+      rxPowerDbm[i] = CalcRxPowerAtDistance (rxPowerDbm[i], batch.distance[i]);
+    }
+}
+
+double
+LogDistancePropagationLossModel::CalcRxPowerAtDistance (double txPowerDbm, double distance) const
+{
   if (distance <= m_referenceDistance)
     {
       return txPowerDbm - m_referenceLoss;
@@ -540,6 +671,21 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const
+{
+  if (m_referenceLoss < 0 || m_exponent <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double maxLossDb = txPowerDbm - minRxPowerDbm;
+  if (maxLossDb < m_referenceLoss)
+    {
+      return 0;
+    }
+  return m_referenceDistance * std::pow (10.0, (maxLossDb - m_referenceLoss) / (10 * m_exponent));
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -600,7 +746,21 @@ ThreeLogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                                      Ptr<MobilityModel> a,
                                                      Ptr<MobilityModel> b) const
 {
-  double distance = a->GetDistanceFrom (b);
+  return CalcRxPowerAtDistance (txPowerDbm, a->GetDistanceFrom (b));
+}
+
+void
+ThreeLogDistancePropagationLossModel::DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const
+{
+  for (uint32_t i = 0; i < rxPowerDbm.size (); i++)
+    {
+      rxPowerDbm[i] = CalcRxPowerAtDistance (rxPowerDbm[i], batch.distance[i]);
+    }
+}
+
+double
+ThreeLogDistancePropagationLossModel::CalcRxPowerAtDistance (double txPowerDbm, double distance) const
+{
   NS_ASSERT (distance >= 0);
 
   // See doxygen comments for the formula and explanation
@@ -701,10 +861,24 @@ double
 NakagamiPropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                              Ptr<MobilityModel> a,
                                              Ptr<MobilityModel> b) const
+{
+  return CalcRxPowerAtDistance (txPowerDbm, a->GetDistanceFrom (b));
+}
+
+void
+NakagamiPropagationLossModel::DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const
+{
+  for (uint32_t i = 0; i < rxPowerDbm.size (); i++)
+    {
+      rxPowerDbm[i] = CalcRxPowerAtDistance (rxPowerDbm[i], batch.distance[i]);
+    }
+}
+
+double
+NakagamiPropagationLossModel::CalcRxPowerAtDistance (double txPowerDbm, double distance) const
 {
   // select m parameter
 
-  double distance = a->GetDistanceFrom (b);
   NS_ASSERT (distance >= 0);
 
   double m;
@@ -930,6 +1104,20 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+RangePropagationLossModel::DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const
+{
+  if (minRxPowerDbm <= -1000)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (txPowerDbm < minRxPowerDbm)
+    {
+      return 0;
+    }
+  return m_range;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
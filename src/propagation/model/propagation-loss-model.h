@@ -27,7 +27,9 @@
 
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
 #include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -93,6 +95,40 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * Returns the Rx Power of a transmission at several destinations, taking
+   * into account all the PropagationLossModel(s) chained to the current one.
+   *
+   * The result is the same as calling CalcRxPower for each destination in
+   * turn, but the chain is walked once per transmission, and the models
+   * which override DoCalcRxPowerBatch compute their loss over arrays of
+   * distances rather than with a virtual call per destination.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the mobility model of the source
+   * \param b the mobility models of the destinations
+   * \param rxPowerDbm the reception power at each destination after
+   * adding/multiplying propagation loss (in dBm)
+   */
+  void CalcRxPowerBatch (double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         const std::vector<Ptr<MobilityModel> > &b,
+                         std::vector<double> &rxPowerDbm) const;
+
+  /**
+   * Returns the distance beyond which the reception power, taking into
+   * account all the PropagationLossModel(s) chained to the current one,
+   * is always below a threshold.
+   *
+   * The distance is infinite when it is not known, for instance when one
+   * of the models may add power to the signal, like fading models do.
+   *
+   * \param txPowerDbm transmission power (in dBm)
+   * \param minRxPowerDbm reception power threshold (in dBm)
+   * \returns the maximum range (in meters)
+   */
+  double GetMaxRange (double txPowerDbm, double minRxPowerDbm) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -106,6 +142,22 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+protected:
+  /**
+   * \brief The source and destinations of a batch of CalcRxPower, with the
+   * positions of the destinations as a structure of arrays.
+   */
+  struct Batch
+  {
+    Ptr<MobilityModel> a;                        //!< Mobility model of the source
+    const std::vector<Ptr<MobilityModel> > *b;   //!< Mobility models of the destinations
+    Vector position;                             //!< Position of the source
+    std::vector<double> x;                       //!< x coordinate of each destination
+    std::vector<double> y;                       //!< y coordinate of each destination
+    std::vector<double> z;                       //!< z coordinate of each destination
+    std::vector<double> distance;                //!< Distance from the source to each destination
+  };
+
 private:
   /**
    * \brief Copy constructor
@@ -140,6 +192,35 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Returns the maximum range taking into account only the particular
+   * PropagationLossModel.
+   *
+   * Subclasses whose loss does not depend on the transmission power and
+   * never adds power to the signal can override this; the default is an
+   * infinite range.
+   *
+   * \param txPowerDbm transmission power (in dBm)
+   * \param minRxPowerDbm reception power threshold (in dBm)
+   * \returns the distance beyond which the reception power is below the threshold (in meters)
+   */
+  virtual double DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const;
+
+  /**
+   * Replaces the Rx Power at each destination of a batch with the Rx Power
+   * taking into account only the particular PropagationLossModel.
+   *
+   * The default calls DoCalcRxPower for each destination in turn.
+   * Subclasses can override this with a loop over the distances of the
+   * batch; they must draw their random variables in the order of the
+   * destinations.
+   *
+   * \param batch the source and destinations
+   * \param rxPowerDbm the current power at each destination (in dBm),
+   * replaced by the reception power (in dBm)
+   */
+  virtual void DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +403,14 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual void DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const;
+  /**
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the distance from the source to the destination (in meters)
+   * \returns the reception power after adding/multiplying propagation loss (in dBm)
+   */
+  double CalcRxPowerAtDistance (double txPowerDbm, double distance) const;
+  virtual double DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -442,6 +531,15 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual void DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const;
+  /**
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the distance from the source to the destination (in meters)
+   * \param txZ the height of the source (in meters)
+   * \param rxZ the height of the destination (in meters)
+   * \returns the reception power after adding/multiplying propagation loss (in dBm)
+   */
+  double CalcRxPowerAtDistance (double txPowerDbm, double distance, double txZ, double rxZ) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +628,14 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual void DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const;
+  /**
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the distance from the source to the destination (in meters)
+   * \returns the reception power after adding/multiplying propagation loss (in dBm)
+   */
+  double CalcRxPowerAtDistance (double txPowerDbm, double distance) const;
+  virtual double DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +719,13 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual void DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const;
+  /**
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the distance from the source to the destination (in meters)
+   * \returns the reception power after adding/multiplying propagation loss (in dBm)
+   */
+  double CalcRxPowerAtDistance (double txPowerDbm, double distance) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -684,6 +797,13 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual void DoCalcRxPowerBatch (const Batch &batch, std::vector<double> &rxPowerDbm) const;
+  /**
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the distance from the source to the destination (in meters)
+   * \returns the reception power after adding/multiplying propagation loss (in dBm)
+   */
+  double CalcRxPowerAtDistance (double txPowerDbm, double distance) const;
 
   double m_distance1; //!< Distance1
   double m_distance2; //!< Distance2
@@ -852,6 +972,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double minRxPowerDbm) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
@@ -21,9 +21,15 @@
 #include "ns3/test.h"
 #include "ns3/config.h"
 #include "ns3/double.h"
+#include "ns3/string.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/caching-propagation-loss-model.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/pointer.h"
 #include "ns3/simulator.h"
+#include <limits>
+#include <vector>
 
 using namespace ns3;
 
@@ -436,6 +442,286 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class MaxRangePropagationLossModelTestCase : public TestCase
+{
+public:
+  MaxRangePropagationLossModelTestCase ();
+  virtual ~MaxRangePropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the reception power just within and just beyond the maximum range.
+   * \param loss the loss model
+   * \param txPowerDbm the transmission power
+   * \param minRxPowerDbm the reception power threshold
+   */
+  void CheckMaxRange (Ptr<PropagationLossModel> loss, double txPowerDbm, double minRxPowerDbm);
+};
+
+MaxRangePropagationLossModelTestCase::MaxRangePropagationLossModelTestCase ()
+  : TestCase ("Test the maximum range of propagation loss models")
+{
+}
+
+MaxRangePropagationLossModelTestCase::~MaxRangePropagationLossModelTestCase ()
+{
+}
+
+void
+MaxRangePropagationLossModelTestCase::CheckMaxRange (Ptr<PropagationLossModel> loss, double txPowerDbm, double minRxPowerDbm)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  double range = loss->GetMaxRange (txPowerDbm, minRxPowerDbm);
+  NS_TEST_ASSERT_MSG_GT (range, 0, "Got unexpected maximum range");
+  b->SetPosition (Vector (range * 0.999, 0, 0));
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (loss->CalcRxPower (txPowerDbm, a, b), minRxPowerDbm, "Got unexpected rcv power within range");
+  b->SetPosition (Vector (range * 1.001, 0, 0));
+  NS_TEST_EXPECT_MSG_LT (loss->CalcRxPower (txPowerDbm, a, b), minRxPowerDbm, "Got unexpected rcv power beyond range");
+}
+
+void
+MaxRangePropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  CheckMaxRange (friis, 16.0206, -96);
+  CheckMaxRange (friis, 0, -120);
+
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  logDistance->SetPathLossExponent (3);
+  CheckMaxRange (logDistance, 16.0206, -96);
+  NS_TEST_EXPECT_MSG_EQ (logDistance->GetMaxRange (-100, -96), 0, "Got unexpected maximum range below the threshold");
+
+  Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+  range->SetAttribute ("MaxRange", DoubleValue (250));
+  NS_TEST_EXPECT_MSG_EQ_TOL (range->GetMaxRange (16, -96), 250, 1e-9, "Got unexpected maximum range");
+
+  // The range of a chain is the shortest range of its models
+  friis->SetNext (range);
+  NS_TEST_EXPECT_MSG_EQ_TOL (friis->GetMaxRange (16, -96), 250, 1e-9, "Got unexpected maximum range of a chain");
+  range->SetAttribute ("MaxRange", DoubleValue (1e6));
+  CheckMaxRange (friis, 16, -96);
+
+  // A random model may add power: the range is unknown
+  Ptr<NakagamiPropagationLossModel> nakagami = CreateObject<NakagamiPropagationLossModel> ();
+  range->SetNext (nakagami);
+  NS_TEST_EXPECT_MSG_EQ (friis->GetMaxRange (16, -96), std::numeric_limits<double>::infinity (),
+                         "Got unexpected maximum range of a chain with fading");
+  NS_TEST_EXPECT_MSG_EQ (nakagami->GetMaxRange (16, -96), std::numeric_limits<double>::infinity (),
+                         "Got unexpected maximum range of a fading model");
+  Simulator::Destroy ();
+}
+
+class BatchPropagationLossModelTestCase : public TestCase
+{
+public:
+  BatchPropagationLossModelTestCase ();
+  virtual ~BatchPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create one of the loss models, or chains of loss models, checked.
+   * \param i the index of the loss model
+   * \return the loss model, or zero beyond the last one
+   */
+  Ptr<PropagationLossModel> CreateLossModel (uint32_t i);
+};
+
+BatchPropagationLossModelTestCase::BatchPropagationLossModelTestCase ()
+  : TestCase ("Test the batches of reception power of propagation loss models")
+{
+}
+
+BatchPropagationLossModelTestCase::~BatchPropagationLossModelTestCase ()
+{
+}
+
+Ptr<PropagationLossModel>
+BatchPropagationLossModelTestCase::CreateLossModel (uint32_t i)
+{
+  Ptr<PropagationLossModel> loss;
+  switch (i)
+    {
+    case 0:
+      loss = CreateObject<FriisPropagationLossModel> ();
+      loss->SetAttribute ("MinLoss", DoubleValue (30));
+      break;
+    case 1:
+      loss = CreateObject<TwoRayGroundPropagationLossModel> ();
+      // Crossover distance within the distances of the receivers
+      loss->SetAttribute ("Frequency", DoubleValue (100e6));
+      loss->SetAttribute ("HeightAboveZ", DoubleValue (1.5));
+      break;
+    case 2:
+      loss = CreateObject<LogDistancePropagationLossModel> ();
+      break;
+    case 3:
+      loss = CreateObject<ThreeLogDistancePropagationLossModel> ();
+      break;
+    case 4:
+      loss = CreateObject<NakagamiPropagationLossModel> ();
+      loss->SetAttribute ("m1", DoubleValue (1.5));
+      break;
+    case 5:
+      {
+        // Models with and without batches, drawing random variables
+        loss = CreateObject<LogDistancePropagationLossModel> ();
+        Ptr<PropagationLossModel> nakagami = CreateObject<NakagamiPropagationLossModel> ();
+        loss->SetNext (nakagami);
+        Ptr<PropagationLossModel> random = CreateObject<RandomPropagationLossModel> ();
+        random->SetAttribute ("Variable", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=10.0]"));
+        nakagami->SetNext (random);
+        Ptr<PropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+        range->SetAttribute ("MaxRange", DoubleValue (1500));
+        random->SetNext (range);
+        break;
+      }
+    default:
+      return 0;
+    }
+  loss->AssignStreams (1);
+  return loss;
+}
+
+void
+BatchPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (10, 20, 5));
+  std::vector<Ptr<MobilityModel> > b;
+  for (uint32_t j = 0; j < 60; j++)
+    {
+      Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      // Distances from zero to 2 km, some heights below the source
+      mobility->SetPosition (Vector (10 + j * j * 0.5, 20 + (j % 7) * j * 0.3, (j * 13) % 40));
+      b.push_back (mobility);
+    }
+  b.push_back (a);
+
+  for (uint32_t i = 0; ; i++)
+    {
+      Ptr<PropagationLossModel> batchLoss = CreateLossModel (i);
+      Ptr<PropagationLossModel> loss = CreateLossModel (i);
+      if (loss == 0)
+        {
+          break;
+        }
+      std::vector<double> rxPowerDbm;
+      batchLoss->CalcRxPowerBatch (16.0206, a, b, rxPowerDbm);
+      NS_TEST_ASSERT_MSG_EQ (rxPowerDbm.size (), b.size (), "Got unexpected number of rcv powers");
+      for (uint32_t j = 0; j < b.size (); j++)
+        {
+          // The same operations in the same order
+          NS_TEST_EXPECT_MSG_EQ (rxPowerDbm[j], loss->CalcRxPower (16.0206, a, b[j]), "Got unexpected rcv power in batch " << i);
+        }
+    }
+  Simulator::Destroy ();
+}
+
+class CachingPropagationLossModelTestCase : public TestCase
+{
+public:
+  CachingPropagationLossModelTestCase ();
+  virtual ~CachingPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the reception power between each pair of nodes, cached or not.
+   * \param txPowerDbm the transmission power (in dBm)
+   */
+  void CheckAllPairs (double txPowerDbm);
+
+  Ptr<CachingPropagationLossModel> m_cache;     //!< Caching model
+  Ptr<PropagationLossModel> m_loss;             //!< Same loss model, without the cache
+  std::vector<Ptr<MobilityModel> > m_nodes;     //!< Mobility model of each node
+};
+
+CachingPropagationLossModelTestCase::CachingPropagationLossModelTestCase ()
+  : TestCase ("Test the cache of reception powers between nodes which do not move")
+{
+}
+
+CachingPropagationLossModelTestCase::~CachingPropagationLossModelTestCase ()
+{
+}
+
+void
+CachingPropagationLossModelTestCase::CheckAllPairs (double txPowerDbm)
+{
+  for (uint32_t i = 0; i < m_nodes.size (); i++)
+    {
+      for (uint32_t j = 0; j < m_nodes.size (); j++)
+        {
+          if (i != j)
+            {
+              NS_TEST_EXPECT_MSG_EQ (m_cache->CalcRxPower (txPowerDbm, m_nodes[i], m_nodes[j]),
+                                     m_loss->CalcRxPower (txPowerDbm, m_nodes[i], m_nodes[j]),
+                                     "Got unexpected rcv power from " << i << " to " << j);
+            }
+        }
+    }
+}
+
+void
+CachingPropagationLossModelTestCase::DoRun (void)
+{
+  m_loss = CreateObject<LogDistancePropagationLossModel> ();
+  m_loss->SetNext (CreateObject<TwoRayGroundPropagationLossModel> ());
+  Ptr<PropagationLossModel> cached = CreateObject<LogDistancePropagationLossModel> ();
+  cached->SetNext (CreateObject<TwoRayGroundPropagationLossModel> ());
+  m_cache = CreateObject<CachingPropagationLossModel> ();
+  m_cache->SetAttribute ("Model", PointerValue (cached));
+
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_nodes.push_back (CreateObject<ConstantPositionMobilityModel> ());
+      m_nodes[i]->SetPosition (Vector (100.0 * i, 50.0 * (i % 2), 1.5));
+    }
+  // Standing still, until its velocity is set
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  moving->SetPosition (Vector (0, 200, 1.5));
+  m_nodes.push_back (moving);
+  uint32_t nPairs = m_nodes.size () * (m_nodes.size () - 1);
+
+  CheckAllPairs (16.0206);
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNHits (), 0, "Got unexpected hits");
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNMisses (), nPairs, "Got unexpected misses");
+  CheckAllPairs (16.0206);
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNHits (), nPairs, "Pairs not cached");
+
+  // Another transmission power
+  CheckAllPairs (20);
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNMisses (), 2 * nPairs, "Pairs cached for another transmission power");
+
+  // Moving a node only forgets the pairs of the node
+  m_nodes[1]->SetPosition (Vector (300, 300, 1.5));
+  CheckAllPairs (20);
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNMisses (), 2 * nPairs + 2 * (m_nodes.size () - 1), "Pairs of a moved node cached");
+
+  // Nothing is kept for a node with a velocity
+  moving->SetVelocity (Vector (10, 0, 0));
+  CheckAllPairs (20);
+  CheckAllPairs (20);
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNMisses (), 2 * nPairs + 6 * (m_nodes.size () - 1), "Pairs of a moving node cached");
+  moving->SetVelocity (Vector (0, 0, 0));
+  CheckAllPairs (20);
+  CheckAllPairs (20);
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNMisses (), 2 * nPairs + 8 * (m_nodes.size () - 1), "Pairs of a stopped node not cached");
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNHits () + m_cache->GetNMisses (), 8 * nPairs, "Got unexpected number of rcv powers");
+
+  // The course changes are not followed once disposed
+  m_cache->Dispose ();
+  m_nodes[2]->SetPosition (Vector (0, 0, 0));
+  m_cache = 0;
+  m_loss = 0;
+  m_nodes.clear ();
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +736,9 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new MaxRangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new BatchPropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new CachingPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -34,6 +34,7 @@
 #include <ns3/propagation-delay-model.h>
 #include <ns3/antenna-model.h>
 #include <ns3/angles.h>
+#include <algorithm>
 #include <iostream>
 #include <utility>
 #include "multi-model-spectrum-channel.h"
@@ -212,7 +213,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
       std::pair<std::set<Ptr<SpectrumPhy> >::iterator, bool> ret2 = rxInfoIterator->second.m_rxPhySet.insert (phy);
       NS_ASSERT (ret2.second);
     }
-
+  AddRxToIndex (phy);
 }
 
 
@@ -270,7 +271,6 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   Ptr<SpectrumSignalParameters> txParamsTrace = txParams->Copy (); // copy it since traced value cannot be const (because of potential underlying DynamicCasts)
   m_txSigParamsTrace (txParamsTrace);
 
-  Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
   SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
   NS_LOG_LOGIC (" txSpectrumModelUid " << txSpectrumModelUid);
 
@@ -282,6 +282,23 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  double txPowerDbm = GetTxPowerDbm (txParams->psd);
+
+  // With the spatial index, the receivers in range of each RX SpectrumModel,
+  // in the order of m_rxPhySet
+  std::vector<Ptr<SpectrumPhy> > receivers;
+  std::vector<std::pair<SpectrumModelUid_t, Ptr<SpectrumPhy> > > candidates;
+  bool indexed = GetRxInRange (txParams, txPowerDbm, m_propagationLoss, m_maxLossDb, receivers);
+  if (indexed)
+    {
+      candidates.reserve (receivers.size ());
+      for (std::vector<Ptr<SpectrumPhy> >::const_iterator it = receivers.begin (); it != receivers.end (); ++it)
+        {
+          candidates.push_back (std::make_pair ((*it)->GetRxSpectrumModel ()->GetUid (), *it));
+        }
+      std::sort (candidates.begin (), candidates.end ());
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -289,6 +306,24 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC (" rxSpectrumModelUids " << rxSpectrumModelUid);
 
+      std::vector<std::pair<SpectrumModelUid_t, Ptr<SpectrumPhy> > >::const_iterator candidatesBegin = candidates.begin ();
+      std::vector<std::pair<SpectrumModelUid_t, Ptr<SpectrumPhy> > >::const_iterator candidatesEnd = candidates.end ();
+      if (indexed)
+        {
+          candidatesBegin = std::lower_bound (candidates.begin (), candidates.end (),
+                                              std::make_pair (rxSpectrumModelUid, Ptr<SpectrumPhy> ()));
+          candidatesEnd = candidatesBegin;
+          while (candidatesEnd != candidates.end () && candidatesEnd->first == rxSpectrumModelUid)
+            {
+              ++candidatesEnd;
+            }
+          if (candidatesBegin == candidatesEnd)
+            {
+              NS_LOG_LOGIC ("no receiver in range");
+              continue;
+            }
+        }
+
       Ptr <SpectrumValue> convertedTxPowerSpectrum;
       if (txSpectrumModelUid == rxSpectrumModelUid)
         {
@@ -307,87 +342,113 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
         }
 
-
-      for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
-           rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
-           ++rxPhyIterator)
+      if (indexed)
         {
-          NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
-                         "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
-
-          if ((*rxPhyIterator) != txParams->txPhy)
+          for (std::vector<std::pair<SpectrumModelUid_t, Ptr<SpectrumPhy> > >::const_iterator it = candidatesBegin;
+               it != candidatesEnd;
+               ++it)
+            {
+              StartTxTo (txParams, txPowerDbm, convertedTxPowerSpectrum, it->second);
+            }
+        }
+      else
+        {
+          for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
+               rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
+               ++rxPhyIterator)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
-
-              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
-
-              if (txMobility && receiverMobility)
-                {
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
-                    {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
-                    }
-                  Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
-                    {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
-                    }
-                  if (m_propagationLoss)
-                    {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
-                  m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
-                  if ( pathLossDb > m_maxLossDb)
-                    {
-                      // beyond range
-                      continue;
-                    }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
-
-                  if (m_spectrumPropagationLoss)
-                    {
-                      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
-                    }
-
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
-                }
-
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
-                {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
-                }
+              StartTxTo (txParams, txPowerDbm, convertedTxPowerSpectrum, *rxPhyIterator);
             }
         }
+    }
+
+}
+
+void
+MultiModelSpectrumChannel::StartTxTo (Ptr<SpectrumSignalParameters> txParams, double txPowerDbm,
+                                      Ptr<const SpectrumValue> convertedTxPowerSpectrum,
+                                      Ptr<SpectrumPhy> receiver)
+{
+  NS_ASSERT_MSG (receiver->GetRxSpectrumModel ()->GetUid () == convertedTxPowerSpectrum->GetSpectrumModelUid (),
+                 "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
+
+  if (receiver == txParams->txPhy)
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+  Time delay = MicroSeconds (0);
+  double pathGainLinear = 1;
+
+  if (txMobility && receiverMobility)
+    {
+      double pathLossDb = 0;
+      if (txParams->txAntenna != 0)
+        {
+          Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
+          double txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
+          NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+          pathLossDb -= txAntennaGain;
+        }
+      Ptr<AntennaModel> rxAntenna = receiver->GetRxAntenna ();
+      if (rxAntenna != 0)
+        {
+          Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
+          double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+          NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+          pathLossDb -= rxAntennaGain;
+        }
+      if (m_propagationLoss)
+        {
+          double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+          NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+          pathLossDb -= propagationGainDb;
+        }
+      NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
+      m_pathLossTrace (txParams->txPhy, receiver, pathLossDb);
+      if (IsCulled (txPowerDbm, pathLossDb, m_maxLossDb))
+        {
+          // beyond range
+          return;
+        }
+      pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+    }
+
+  NS_LOG_LOGIC (" copying signal parameters " << txParams);
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+  rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+
+  if (txMobility && receiverMobility)
+    {
+      *(rxParams->psd) *= pathGainLinear;
+
+      if (m_spectrumPropagationLoss)
+        {
+          rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+        }
 
+      if (m_propagationDelay)
+        {
+          delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+        }
     }
 
+  Ptr<NetDevice> netDev = receiver->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                      rxParams, receiver);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                           rxParams, receiver);
+    }
 }
 
 void
@@ -156,6 +156,20 @@ private:
    */
   TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
 
+  /**
+   * Compute the loss of a signal to a receiver, and schedule its reception
+   * unless it is culled.
+   *
+   * @param txParams The signal parameters.
+   * @param txPowerDbm The total power of the signal, in dBm.
+   * @param convertedTxPowerSpectrum The power spectral density of the signal
+   * in the SpectrumModel of the receiver.
+   * @param receiver A pointer to the receiver SpectrumPhy.
+   */
+  void StartTxTo (Ptr<SpectrumSignalParameters> txParams, double txPowerDbm,
+                  Ptr<const SpectrumValue> convertedTxPowerSpectrum,
+                  Ptr<SpectrumPhy> receiver);
+
   /**
    * Used internally to reschedule transmission after the propagation delay.
    *
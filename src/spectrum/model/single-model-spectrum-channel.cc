@@ -107,6 +107,7 @@ SingleModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
   m_phyList.push_back (phy);
+  AddRxToIndex (phy);
 }
 
 
@@ -133,9 +134,37 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
+  double txPowerDbm = GetTxPowerDbm (txParams->psd);
 
-  for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
-       rxPhyIterator != m_phyList.end ();
+  std::vector<Ptr<SpectrumPhy> > receivers;
+  const PhyList *rxPhyList = &m_phyList;
+  if (GetRxInRange (txParams, txPowerDbm, m_propagationLoss, m_maxLossDb, receivers))
+    {
+      rxPhyList = &receivers;
+    }
+
+  // One pass of the propagation loss models over all the receivers
+  std::vector<double> propagationGainsDb;
+  if (senderMobility && m_propagationLoss)
+    {
+      std::vector<Ptr<MobilityModel> > receiverMobilities;
+      receiverMobilities.reserve (rxPhyList->size ());
+      for (PhyList::const_iterator rxPhyIterator = rxPhyList->begin ();
+           rxPhyIterator != rxPhyList->end ();
+           ++rxPhyIterator)
+        {
+          Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+          if ((*rxPhyIterator) != txParams->txPhy && receiverMobility)
+            {
+              receiverMobilities.push_back (receiverMobility);
+            }
+        }
+      m_propagationLoss->CalcRxPowerBatch (0, senderMobility, receiverMobilities, propagationGainsDb);
+    }
+  std::vector<double>::const_iterator propagationGainDbIterator = propagationGainsDb.begin ();
+
+  for (PhyList::const_iterator rxPhyIterator = rxPhyList->begin ();
+       rxPhyIterator != rxPhyList->end ();
        ++rxPhyIterator)
     {
       if ((*rxPhyIterator) != txParams->txPhy)
@@ -143,16 +172,15 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           Time delay  = MicroSeconds (0);
 
           Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
-          NS_LOG_LOGIC ("copying signal parameters " << txParams);
-          Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+          Ptr<SpectrumSignalParameters> rxParams;
 
           if (senderMobility && receiverMobility)
             {
               double pathLossDb = 0;
-              if (rxParams->txAntenna != 0)
+              if (txParams->txAntenna != 0)
                 {
                   Angles txAngles (receiverMobility->GetPosition (), senderMobility->GetPosition ());
-                  double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+                  double txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
                   NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
                   pathLossDb -= txAntennaGain;
                 }
@@ -166,17 +194,19 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                 }
               if (m_propagationLoss)
                 {
-                  double propagationGainDb = m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobility);
+                  double propagationGainDb = *propagationGainDbIterator++;
                   NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
                   pathLossDb -= propagationGainDb;
                 }                    
               NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
               m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
-              if ( pathLossDb > m_maxLossDb)
+              if (IsCulled (txPowerDbm, pathLossDb, m_maxLossDb))
                 {
                   // beyond range
                   continue;
                 }
+              NS_LOG_LOGIC ("copying signal parameters " << txParams);
+              rxParams = txParams->Copy ();
               double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
               *(rxParams->psd) *= pathGainLinear;              
 
@@ -190,6 +220,11 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                   delay = m_propagationDelay->GetDelay (senderMobility, receiverMobility);
                 }
             }
+          else
+            {
+              NS_LOG_LOGIC ("copying signal parameters " << txParams);
+              rxParams = txParams->Copy ();
+            }
 
 
           Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
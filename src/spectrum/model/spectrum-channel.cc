@@ -18,11 +18,23 @@
  * Author: Nicola Baldo <nbaldo@cttc.es>
  */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ns3/log.h>
+#include <ns3/double.h>
+#include <ns3/boolean.h>
+#include <ns3/mobility-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-value.h>
 #include "spectrum-channel.h"
 
 
 namespace ns3 {
 
+NS_LOG_COMPONENT_DEFINE ("SpectrumChannel");
+
 
 NS_OBJECT_ENSURE_REGISTERED (SpectrumChannel);
 
@@ -32,12 +44,171 @@ SpectrumChannel::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::SpectrumChannel")
     .SetParent<Channel> ()
     .SetGroupName ("Spectrum")
+    .AddAttribute ("MinRxPower",
+                   "The total power in dBm, after the antenna gains and the "
+                   "single-frequency PropagationLossModel, of the weakest "
+                   "signals passed to the receiving PHY.  Like MaxLossDb, "
+                   "this value reduces the computational load by not "
+                   "propagating signals that are far beyond the "
+                   "interference range.  The default value corresponds to "
+                   "considering all signals for reception.",
+                   DoubleValue (-1.0e9),
+                   MakeDoubleAccessor (&SpectrumChannel::m_minRxPowerDbm),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SpatialIndex",
+                   "If true, the receivers are indexed by position, and only "
+                   "the receivers within the range set by MinRxPower, MaxLossDb "
+                   "and the single-frequency PropagationLossModel are visited.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&SpectrumChannel::m_spatialIndex),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxAntennaGain",
+                   "Upper bound in dB of the sum of the TX and RX antenna gains, "
+                   "used by the spatial index to find the range of the signals.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&SpectrumChannel::m_maxAntennaGainDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("GridCellSize",
+                   "The side of the cells of the spatial index, in meters.  "
+                   "If zero, the range of the first signal is used.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&SpectrumChannel::m_gridCellSize),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
+SpectrumChannel::SpectrumChannel ()
+  : m_nCulled (0),
+    m_nIndexed (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 SpectrumChannel::~SpectrumChannel ()
 {
 }
 
+void
+SpectrumChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_grid = 0;
+  m_rxList.clear ();
+  m_rxSet.clear ();
+  m_gridRx.clear ();
+  m_unindexedRx.clear ();
+  m_nIndexed = 0;
+  Channel::DoDispose ();
+}
+
+uint64_t
+SpectrumChannel::GetNCulledDeliveries (void) const
+{
+  return m_nCulled;
+}
+
+void
+SpectrumChannel::AddRxToIndex (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  if (m_rxSet.insert (phy).second)
+    {
+      m_rxList.push_back (phy);
+    }
+}
+
+bool
+SpectrumChannel::GetRxInRange (Ptr<const SpectrumSignalParameters> txParams, double txPowerDbm,
+                               Ptr<const PropagationLossModel> loss, double maxLossDb,
+                               std::vector<Ptr<SpectrumPhy> > &receivers)
+{
+  NS_LOG_FUNCTION (this << txParams << txPowerDbm << loss << maxLossDb);
+  if (!m_spatialIndex || loss == 0)
+    {
+      return false;
+    }
+  Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+  if (txMobility == 0)
+    {
+      return false;
+    }
+  // The loss models reduce the signal below the limits beyond this range
+  double range = loss->GetMaxRange (GetMaxPathLossDb (txPowerDbm, maxLossDb) + m_maxAntennaGainDb, 0);
+  if (range == std::numeric_limits<double>::infinity ())
+    {
+      return false;
+    }
+
+  if (m_grid == 0)
+    {
+      double cellSize = m_gridCellSize > 0 ? m_gridCellSize : std::max (range, 1.0);
+      NS_LOG_LOGIC ("Indexing the receiver positions with cells of " << cellSize << "m");
+      m_grid = Create<MobilityGrid> (cellSize);
+    }
+  // The receivers added since the last signal
+  for (; m_nIndexed < m_rxList.size (); m_nIndexed++)
+    {
+      Ptr<MobilityModel> mobility = m_rxList[m_nIndexed]->GetMobility ();
+      if (mobility != 0)
+        {
+          m_grid->Add (mobility);
+          m_gridRx.push_back (m_nIndexed);
+        }
+      else
+        {
+          m_unindexedRx.push_back (m_nIndexed);
+        }
+    }
+
+  std::vector<uint32_t> items;
+  m_grid->GetItemsInRange (txMobility->GetPosition (), range, items);
+  for (std::vector<uint32_t>::iterator it = items.begin (); it != items.end (); it++)
+    {
+      *it = m_gridRx[*it];
+    }
+  if (!m_unindexedRx.empty ())
+    {
+      items.insert (items.end (), m_unindexedRx.begin (), m_unindexedRx.end ());
+      std::sort (items.begin (), items.end ());
+    }
+  receivers.clear ();
+  receivers.reserve (items.size ());
+  for (std::vector<uint32_t>::const_iterator it = items.begin (); it != items.end (); it++)
+    {
+      receivers.push_back (m_rxList[*it]);
+    }
+  NS_LOG_DEBUG (receivers.size () << " of " << m_rxList.size () << " receivers within " << range << "m");
+  m_nCulled += m_rxList.size () - receivers.size ();
+  return true;
+}
+
+double
+SpectrumChannel::GetMaxPathLossDb (double txPowerDbm, double maxLossDb) const
+{
+  if (m_minRxPowerDbm <= -1.0e9)
+    {
+      // No power floor, even for signals without power
+      return maxLossDb;
+    }
+  return std::min (maxLossDb, txPowerDbm - m_minRxPowerDbm);
+}
+
+bool
+SpectrumChannel::IsCulled (double txPowerDbm, double pathLossDb, double maxLossDb)
+{
+  if (pathLossDb > GetMaxPathLossDb (txPowerDbm, maxLossDb))
+    {
+      m_nCulled++;
+      return true;
+    }
+  return false;
+}
+
+double
+SpectrumChannel::GetTxPowerDbm (Ptr<const SpectrumValue> psd)
+{
+  return 10 * std::log10 (Integral (*psd)) + 30;
+}
+
 } // namespace
@@ -22,9 +22,12 @@
 #ifndef SPECTRUM_CHANNEL_H
 #define SPECTRUM_CHANNEL_H
 
+#include <set>
+#include <vector>
 #include <ns3/object.h>
 #include <ns3/nstime.h>
 #include <ns3/channel.h>
+#include <ns3/mobility-grid.h>
 #include <ns3/spectrum-signal-parameters.h>
 
 namespace ns3 {
@@ -42,10 +45,19 @@ class PropagationDelayModel;
  *
  * Defines the interface for spectrum-aware channel implementations
  *
+ * This class also provides the implementations with the culling of the
+ * receivers of a signal.  A signal is not delivered to a receiver when
+ * its total power, after the antenna gains and the single-frequency
+ * propagation loss, is below the MinRxPower attribute.  When the
+ * SpatialIndex attribute is true, the receivers are kept in a
+ * MobilityGrid, and only those within the range where the signal may be
+ * above MinRxPower, or where the loss may be below the MaxLossDb attribute
+ * of the implementation, are visited.
  */
 class SpectrumChannel : public Channel
 {
 public:
+  SpectrumChannel ();
   virtual ~SpectrumChannel ();
 
   /**
@@ -112,7 +124,78 @@ public:
   typedef void (* LossTracedCallback)
     (Ptr<SpectrumPhy> txPhy, Ptr<SpectrumPhy> rxPhy,
      double lossDb);
-  
+
+  /**
+   * \return the number of deliveries of signals to receivers culled
+   * because of the MinRxPower or MaxLossDb attributes, or skipped by the
+   * spatial index
+   */
+  uint64_t GetNCulledDeliveries (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+  /**
+   * Make a receiver known to the spatial index.
+   *
+   * Implementations call this method for each receiver added to them.
+   *
+   * @param phy the receiver
+   */
+  void AddRxToIndex (Ptr<SpectrumPhy> phy);
+
+  /**
+   * Find the receivers a signal may be delivered to with the spatial index.
+   *
+   * @param txParams the parameters of the signal
+   * @param txPowerDbm the total power of the signal, in dBm
+   * @param loss the single-frequency propagation loss model of the channel
+   * @param maxLossDb the maximum loss of the signals delivered, in dB
+   * @param receivers the receivers within range of the transmitter, and the
+   * receivers without mobility model, in the order they were added
+   * @return false if the spatial index is disabled or the range is
+   * unknown: then every receiver must be visited
+   */
+  bool GetRxInRange (Ptr<const SpectrumSignalParameters> txParams, double txPowerDbm,
+                     Ptr<const PropagationLossModel> loss, double maxLossDb,
+                     std::vector<Ptr<SpectrumPhy> > &receivers);
+
+  /**
+   * Check whether a signal must not be delivered to a receiver, and count
+   * the culled deliveries.
+   *
+   * @param txPowerDbm the total power of the signal, in dBm
+   * @param pathLossDb the single-frequency loss to the receiver, antenna gains included, in dB
+   * @param maxLossDb the maximum loss of the signals delivered, in dB
+   * @return true if the signal must not be delivered
+   */
+  bool IsCulled (double txPowerDbm, double pathLossDb, double maxLossDb);
+
+  /**
+   * @param psd the power spectral density of a signal
+   * @return the total power of the signal, in dBm
+   */
+  static double GetTxPowerDbm (Ptr<const SpectrumValue> psd);
+
+private:
+  /**
+   * @param txPowerDbm the total power of a signal, in dBm
+   * @param maxLossDb the maximum loss of the signals delivered, in dB
+   * @return the maximum loss of the signal for it to be delivered, in dB
+   */
+  double GetMaxPathLossDb (double txPowerDbm, double maxLossDb) const;
+
+  bool m_spatialIndex;                        //!< Only visit the receivers in range
+  double m_minRxPowerDbm;                     //!< Power of the weakest signals delivered
+  double m_maxAntennaGainDb;                  //!< Highest sum of the antenna gains
+  double m_gridCellSize;                      //!< Side of the cells of the grid, zero for the first range
+  uint64_t m_nCulled;                         //!< Deliveries culled
+  std::vector<Ptr<SpectrumPhy> > m_rxList;    //!< Receivers, in the order they were added
+  std::set<Ptr<SpectrumPhy> > m_rxSet;        //!< Receivers added
+  uint32_t m_nIndexed;                        //!< Receivers of m_rxList in the grid or in m_unindexedRx
+  Ptr<MobilityGrid> m_grid;                   //!< Positions of the receivers
+  std::vector<uint32_t> m_gridRx;             //!< Receiver of each item of the grid
+  std::vector<uint32_t> m_unindexedRx;        //!< Receivers without mobility model
 };
 
 
@@ -0,0 +1,416 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <vector>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/boolean.h>
+#include <ns3/net-device.h>
+#include <ns3/antenna-model.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-model.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/single-model-spectrum-channel.h>
+#include <ns3/multi-model-spectrum-channel.h>
+
+using namespace ns3;
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief SpectrumPhy reporting the signals it receives.
+ */
+class CullingTestPhy : public SpectrumPhy
+{
+public:
+  /**
+   * Constructor
+   * \param index the index of the phy
+   * \param rxSpectrumModel the spectrum model of the phy
+   * \param rxCallback called with the indexes of the transmitter and of
+   * the receiver of each signal received
+   */
+  CullingTestPhy (uint32_t index, Ptr<const SpectrumModel> rxSpectrumModel,
+                  Callback<void, uint32_t, uint32_t> rxCallback);
+
+  // inherited from SpectrumPhy
+  virtual void SetDevice (Ptr<NetDevice> d);
+  virtual Ptr<NetDevice> GetDevice () const;
+  virtual void SetMobility (Ptr<MobilityModel> m);
+  virtual Ptr<MobilityModel> GetMobility ();
+  virtual void SetChannel (Ptr<SpectrumChannel> c);
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  virtual Ptr<AntennaModel> GetRxAntenna ();
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params);
+
+  /**
+   * \return the index of the phy
+   */
+  uint32_t GetIndex (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  uint32_t m_index;                                //!< Index of the phy
+  Ptr<const SpectrumModel> m_rxSpectrumModel;      //!< Spectrum model
+  Ptr<MobilityModel> m_mobility;                   //!< Mobility model
+  Callback<void, uint32_t, uint32_t> m_rxCallback; //!< Reception callback
+};
+
+CullingTestPhy::CullingTestPhy (uint32_t index, Ptr<const SpectrumModel> rxSpectrumModel,
+                                Callback<void, uint32_t, uint32_t> rxCallback)
+  : m_index (index),
+    m_rxSpectrumModel (rxSpectrumModel),
+    m_rxCallback (rxCallback)
+{
+}
+
+void
+CullingTestPhy::DoDispose (void)
+{
+  m_rxSpectrumModel = 0;
+  m_mobility = 0;
+  m_rxCallback = MakeNullCallback<void, uint32_t, uint32_t> ();
+  SpectrumPhy::DoDispose ();
+}
+
+void
+CullingTestPhy::SetDevice (Ptr<NetDevice> d)
+{
+}
+
+Ptr<NetDevice>
+CullingTestPhy::GetDevice () const
+{
+  return 0;
+}
+
+void
+CullingTestPhy::SetMobility (Ptr<MobilityModel> m)
+{
+  m_mobility = m;
+}
+
+Ptr<MobilityModel>
+CullingTestPhy::GetMobility ()
+{
+  return m_mobility;
+}
+
+void
+CullingTestPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+CullingTestPhy::GetRxSpectrumModel () const
+{
+  return m_rxSpectrumModel;
+}
+
+Ptr<AntennaModel>
+CullingTestPhy::GetRxAntenna ()
+{
+  return 0;
+}
+
+void
+CullingTestPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  Ptr<CullingTestPhy> txPhy = DynamicCast<CullingTestPhy> (params->txPhy);
+  m_rxCallback (txPhy->GetIndex (), m_index);
+}
+
+uint32_t
+CullingTestPhy::GetIndex (void) const
+{
+  return m_index;
+}
+
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief Check that a spectrum channel delivers the signals of transmitters
+ * spread over a grid only to the receivers above MinRxPower or below
+ * MaxLossDb, in the same order with and without the spatial index, while
+ * some of the receivers move.
+ */
+class SpectrumChannelCullingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param multiModel use a MultiModelSpectrumChannel, with phys on two
+   * overlapping spectrum models
+   * \param minRxPowerDbm the MinRxPower attribute of the channel
+   * \param maxLossDb the MaxLossDb attribute of the channel
+   */
+  SpectrumChannelCullingTestCase (bool multiModel, double minRxPowerDbm, double maxLossDb);
+
+private:
+  virtual void DoRun (void);
+
+  /// A signal received
+  struct Delivery
+  {
+    uint32_t tx;  //!< Index of the transmitter
+    uint32_t rx;  //!< Index of the receiver
+    Time time;    //!< Reception time
+
+    /**
+     * \param o the other delivery
+     * \return true if the deliveries are the same
+     */
+    bool operator == (const Delivery &o) const
+    {
+      return tx == o.tx && rx == o.rx && time == o.time;
+    }
+    /**
+     * \param o the other delivery
+     * \return true if this delivery is received first, or from an earlier
+     * transmitter or by an earlier receiver at the same time
+     */
+    bool operator < (const Delivery &o) const
+    {
+      if (time != o.time)
+        {
+          return time < o.time;
+        }
+      return tx < o.tx || (tx == o.tx && rx < o.rx);
+    }
+  };
+
+  /**
+   * Run a simulation
+   * \param spatialIndex the SpatialIndex attribute of the channel
+   * \param deliveries the signals received
+   * \param nCulled the culled deliveries counted by the channel
+   */
+  void Simulate (bool spatialIndex, std::vector<Delivery> &deliveries, uint64_t &nCulled);
+  /**
+   * Transmit a signal, and count the receivers it should reach
+   * \param i the index of the transmitter
+   */
+  void Transmit (uint32_t i);
+  /**
+   * Record a signal received
+   * \param tx the index of the transmitter
+   * \param rx the index of the receiver
+   */
+  void Receive (uint32_t tx, uint32_t rx);
+
+  bool m_multiModel;                           //!< Use a MultiModelSpectrumChannel
+  double m_minRxPowerDbm;                      //!< MinRxPower of the channel
+  double m_maxLossDb;                          //!< MaxLossDb of the channel
+  Ptr<SpectrumChannel> m_channel;              //!< The channel
+  Ptr<PropagationLossModel> m_loss;            //!< Loss model of the channel
+  std::vector<Ptr<CullingTestPhy> > m_phys;    //!< The phys
+  std::vector<Ptr<SpectrumValue> > m_txPsds;   //!< Transmission PSD of each phy
+  std::vector<Delivery> *m_deliveries;         //!< Signals received
+  uint32_t m_nExpected;                        //!< Signals which should be received
+};
+
+SpectrumChannelCullingTestCase::SpectrumChannelCullingTestCase (bool multiModel, double minRxPowerDbm, double maxLossDb)
+  : TestCase (std::string ("Check the culled receivers of a ")
+              + (multiModel ? "MultiModelSpectrumChannel" : "SingleModelSpectrumChannel")
+              + (minRxPowerDbm > -1.0e9 ? " with MinRxPower" : " with MaxLossDb")),
+    m_multiModel (multiModel),
+    m_minRxPowerDbm (minRxPowerDbm),
+    m_maxLossDb (maxLossDb)
+{
+}
+
+void
+SpectrumChannelCullingTestCase::Transmit (uint32_t i)
+{
+  Ptr<CullingTestPhy> txPhy = m_phys[i];
+  double txPowerDbm = 10 * std::log10 (Integral (*m_txPsds[i])) + 30;
+  for (uint32_t j = 0; j < m_phys.size (); j++)
+    {
+      if (j == i)
+        {
+          continue;
+        }
+      if (txPhy->GetMobility () == 0 || m_phys[j]->GetMobility () == 0)
+        {
+          // No loss
+          m_nExpected++;
+          continue;
+        }
+      double lossDb = txPowerDbm - m_loss->CalcRxPower (txPowerDbm, txPhy->GetMobility (), m_phys[j]->GetMobility ());
+      if (lossDb <= m_maxLossDb && txPowerDbm - lossDb >= m_minRxPowerDbm)
+        {
+          m_nExpected++;
+        }
+    }
+
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->duration = MilliSeconds (1);
+  params->psd = m_txPsds[i];
+  params->txPhy = txPhy;
+  m_channel->StartTx (params);
+}
+
+void
+SpectrumChannelCullingTestCase::Receive (uint32_t tx, uint32_t rx)
+{
+  Delivery delivery;
+  delivery.tx = tx;
+  delivery.rx = rx;
+  delivery.time = Simulator::Now ();
+  m_deliveries->push_back (delivery);
+}
+
+void
+SpectrumChannelCullingTestCase::Simulate (bool spatialIndex, std::vector<Delivery> &deliveries, uint64_t &nCulled)
+{
+  const uint32_t side = 10;
+  const double spacing = 150;
+
+  m_deliveries = &deliveries;
+  m_nExpected = 0;
+  if (m_multiModel)
+    {
+      m_channel = CreateObject<MultiModelSpectrumChannel> ();
+    }
+  else
+    {
+      m_channel = CreateObject<SingleModelSpectrumChannel> ();
+    }
+  m_channel->SetAttribute ("SpatialIndex", BooleanValue (spatialIndex));
+  m_channel->SetAttribute ("MinRxPower", DoubleValue (m_minRxPowerDbm));
+  m_channel->SetAttribute ("MaxLossDb", DoubleValue (m_maxLossDb));
+  m_loss = CreateObject<FriisPropagationLossModel> ();
+  m_loss->SetAttribute ("Frequency", DoubleValue (2.4e9));
+  m_channel->AddPropagationLossModel (m_loss);
+
+  // Two overlapping spectrum models of 10 bands of 1 MHz
+  std::vector<Ptr<SpectrumModel> > models;
+  for (uint32_t m = 0; m < 2; m++)
+    {
+      std::vector<double> centerFrequencies;
+      for (uint32_t b = 0; b < 10; b++)
+        {
+          centerFrequencies.push_back (2.4005e9 + m * 5.0e6 + b * 1.0e6);
+        }
+      models.push_back (Create<SpectrumModel> (centerFrequencies));
+    }
+
+  // A jittered grid of phys, and a phy without mobility model
+  for (uint32_t i = 0; i <= side * side; i++)
+    {
+      Ptr<SpectrumModel> model = models[m_multiModel ? i % 2 : 0];
+      Ptr<CullingTestPhy> phy = CreateObject<CullingTestPhy> (i, model,
+                                                              MakeCallback (&SpectrumChannelCullingTestCase::Receive, this));
+      if (i < side * side)
+        {
+          Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+          mobility->SetPosition (Vector ((i % side) * spacing + (i * 37) % 50, (i / side) * spacing + (i * 53) % 50, 0));
+          phy->SetMobility (mobility);
+        }
+      m_channel->AddRx (phy);
+      m_phys.push_back (phy);
+
+      // 20 dBm over 10 MHz
+      Ptr<SpectrumValue> txPsd = Create<SpectrumValue> (model);
+      (*txPsd) = 1.0e-8;
+      m_txPsds.push_back (txPsd);
+    }
+
+  for (uint32_t i = 0; i < m_phys.size (); i++)
+    {
+      Simulator::Schedule (Seconds (1) + MilliSeconds (10 * i), &SpectrumChannelCullingTestCase::Transmit, this, i);
+    }
+  // Move some phys across the grid in the middle of the transmissions
+  for (uint32_t i = 0; i < side * side; i += 7)
+    {
+      Ptr<MobilityModel> mobility = m_phys[i]->GetMobility ();
+      Simulator::Schedule (MilliSeconds (1505), &MobilityModel::SetPosition, mobility,
+                           Vector ((side - 1) * spacing - mobility->GetPosition ().y, mobility->GetPosition ().x, 0));
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  nCulled = m_channel->GetNCulledDeliveries ();
+  m_channel->Dispose ();
+  m_channel = 0;
+  m_loss = 0;
+  for (uint32_t i = 0; i < m_phys.size (); i++)
+    {
+      m_phys[i]->Dispose ();
+    }
+  m_phys.clear ();
+  m_txPsds.clear ();
+  m_deliveries = 0;
+}
+
+void
+SpectrumChannelCullingTestCase::DoRun (void)
+{
+  std::vector<Delivery> linearDeliveries;
+  uint64_t linearCulled;
+  Simulate (false, linearDeliveries, linearCulled);
+  uint32_t nExpected = m_nExpected;
+  uint32_t nSignals = 10 * 10 + 1;
+
+  NS_TEST_ASSERT_MSG_EQ (linearDeliveries.size (), nExpected, "wrong number of signals delivered");
+  NS_TEST_ASSERT_MSG_GT (linearCulled, nSignals * (nSignals - 1) / 4, "too few deliveries culled");
+  NS_TEST_EXPECT_MSG_EQ (linearCulled + linearDeliveries.size (), nSignals * (nSignals - 1), "wrong number of deliveries culled");
+
+  std::vector<Delivery> indexedDeliveries;
+  uint64_t indexedCulled;
+  Simulate (true, indexedDeliveries, indexedCulled);
+  NS_TEST_EXPECT_MSG_EQ (m_nExpected, nExpected, "signals transmitted differently");
+  NS_TEST_EXPECT_MSG_EQ (indexedDeliveries.size (), linearDeliveries.size (), "wrong number of signals delivered with the spatial index");
+  if (m_multiModel)
+    {
+      // The receivers of each spectrum model are visited in the order of
+      // their addresses, which differ between the simulations
+      std::sort (linearDeliveries.begin (), linearDeliveries.end ());
+      std::sort (indexedDeliveries.begin (), indexedDeliveries.end ());
+    }
+  NS_TEST_EXPECT_MSG_EQ ((indexedDeliveries == linearDeliveries), true, "signals delivered differently with the spatial index");
+  NS_TEST_EXPECT_MSG_EQ (indexedCulled, linearCulled, "wrong number of deliveries culled with the spatial index");
+}
+
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief Test suite for the culling of the receivers of the spectrum channels
+ */
+class SpectrumChannelCullingTestSuite : public TestSuite
+{
+public:
+  SpectrumChannelCullingTestSuite ();
+};
+
+SpectrumChannelCullingTestSuite::SpectrumChannelCullingTestSuite ()
+  : TestSuite ("spectrum-channel-culling", UNIT)
+{
+  AddTestCase (new SpectrumChannelCullingTestCase (false, -80, 1.0e9), TestCase::QUICK);
+  AddTestCase (new SpectrumChannelCullingTestCase (true, -80, 1.0e9), TestCase::QUICK);
+  AddTestCase (new SpectrumChannelCullingTestCase (false, -1.0e9, 95), TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static SpectrumChannelCullingTestSuite g_spectrumChannelCullingTestSuite;
@@ -215,11 +215,15 @@ InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
       m_niChanges.erase (++(m_niChanges.begin ()),
                          GetNextPosition (event->GetStartTime ()));
     }
-  auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
-  auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
-  for (auto i = first; i != last; ++i)
+  // Adding a NiChange may move the others: keep the index of the start,
+  // which is not moved by adding the end after it
+  auto it = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
+  size_t first = it - m_niChanges.begin ();
+  it = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
+  size_t last = it - m_niChanges.begin ();
+  for (size_t i = first; i != last; ++i)
     {
-      i->second.AddPower (event->GetRxPowerW ());
+      m_niChanges[i].second.AddPower (event->GetRxPowerW ());
     }
 }
 
@@ -242,17 +246,17 @@ double
 InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges *ni) const
 {
   double noiseInterference = m_firstPower;
-  auto it = m_niChanges.find (event->GetStartTime ());
+  auto it = Find (event->GetStartTime ());
   for (; it != m_niChanges.end () && it->second.GetEvent () != event; ++it)
     {
       noiseInterference = it->second.GetPower ();
     }
-  ni->emplace (event->GetStartTime (), NiChange (0, event));
+  ni->emplace_back (event->GetStartTime (), NiChange (0, event));
   while (++it != m_niChanges.end () && it->second.GetEvent () != event)
     {
-      ni->insert (*it);
+      ni->push_back (*it);
     }
-  ni->emplace (event->GetEndTime (), NiChange (0, event));
+  ni->emplace_back (event->GetEndTime (), NiChange (0, event));
   return noiseInterference;
 }
 
@@ -794,7 +798,8 @@ InterferenceHelper::EraseEvents (void)
 InterferenceHelper::NiChanges::const_iterator
 InterferenceHelper::GetNextPosition (Time moment) const
 {
-  return m_niChanges.upper_bound (moment);
+  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), moment,
+                           [] (Time t, const std::pair<Time, NiChange> &change) { return t < change.first; });
 }
 
 InterferenceHelper::NiChanges::const_iterator
@@ -807,6 +812,18 @@ InterferenceHelper::GetPreviousPosition (Time moment) const
   return it;
 }
 
+InterferenceHelper::NiChanges::const_iterator
+InterferenceHelper::Find (Time moment) const
+{
+  auto it = std::lower_bound (m_niChanges.begin (), m_niChanges.end (), moment,
+                              [] (const std::pair<Time, NiChange> &change, Time t) { return change.first < t; });
+  if (it != m_niChanges.end () && it->first != moment)
+    {
+      return m_niChanges.end ();
+    }
+  return it;
+}
+
 InterferenceHelper::NiChanges::iterator
 InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change)
 {
@@ -826,7 +843,7 @@ InterferenceHelper::NotifyRxEnd ()
   NS_LOG_FUNCTION (this);
   m_rxing = false;
   //Update m_firstPower for frame capture
-  auto it = m_niChanges.find (Simulator::Now ());
+  auto it = Find (Simulator::Now ());
   it--;
   m_firstPower = it->second.GetPower ();
 }
@@ -25,7 +25,7 @@
 #include "ns3/packet.h"
 #include "wifi-tx-vector.h"
 #include "error-rate-model.h"
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -243,9 +243,10 @@ private:
   };
 
   /**
-   * typedef for a multimap of NiChanges
+   * typedef for a vector of NiChanges, sorted by time.  The NiChanges of
+   * a same time are kept in the order they were added.
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  typedef std::vector<std::pair<Time, NiChange> > NiChanges;
 
   /**
    * Append the given Event.
@@ -335,6 +336,14 @@ private:
    * \returns an iterator to the list of NiChanges
    */
   NiChanges::const_iterator GetPreviousPosition (Time moment) const;
+  /**
+   * Returns an iterator to the first nichange at moment
+   *
+   * \param moment time to check
+   * \returns an iterator to the list of NiChanges, or the end of the list
+   *          if there is no nichange at moment
+   */
+  NiChanges::const_iterator Find (Time moment) const;
 
   /**
    * Add NiChange to the list at the appropriate position and
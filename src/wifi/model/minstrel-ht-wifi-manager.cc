@@ -41,6 +41,7 @@
 #include "ns3/boolean.h"
 #include "wifi-mac.h"
 #include "wifi-phy.h"
+#include <algorithm>
 #include <iomanip>
 
 #define Min(a,b) ((a < b) ? a : b)
@@ -65,11 +66,119 @@ struct MinstrelHtWifiRemoteStation : MinstrelWifiRemoteStation
   uint32_t m_ampduPacketCount; //!< Number of A-MPDUs transmitted.
 
   McsGroupData m_groupsTable;  //!< Table of groups with stats.
+  HtRateStats m_stats;         //!< Statistics of the rates of the supported groups.
   bool m_isHt;                 //!< If the station is HT capable.
 
   std::ofstream m_statsFile;   //!< File where statistics table is written.
 };
 
+/**
+ * Returns the index of the statistics of a rate in the HtRateStats of a station.
+ *
+ * \param station the minstrel HT wifi remote station
+ * \param groupId the group ID, of a group supported by the station
+ * \param rateId the rate ID
+ * \returns the index
+ */
+static inline uint32_t
+GetStatsIndex (const MinstrelHtWifiRemoteStation *station, uint32_t groupId, uint32_t rateId)
+{
+  NS_ASSERT (station->m_groupsTable[groupId].m_supported);
+  return station->m_groupsTable[groupId].m_statsIndex + rateId;
+}
+
+/**
+ * Return the average throughput of a rate.
+ *
+ * Do not account throughput if sucess prob is below 10%
+ * (as done in minstrel_ht linux implementation).
+ *
+ * For the throughput calculation, limit the probability value to 90% to
+ * account for collision related packet error rate fluctuation.
+ *
+ * \param ewmaProb the EWMA probability of the rate
+ * \param txTime the perfect transmission time of the rate (in seconds)
+ * \returns the throughput
+ */
+static inline double
+CalculateThroughput (double ewmaProb, double txTime)
+{
+  return ewmaProb < 10 ? 0 : std::min (ewmaProb, 90.0) / txTime;
+}
+
+/**
+ * Set a rate as the max throughput rate or the second max throughput rate
+ * if it is better than the current ones.
+ *
+ * If multiple rates provide equal throughput the sorting is based on their
+ * current success probability. Higher success probability is preferred among
+ * MCS groups.
+ *
+ * \param stats the statistics of the rates
+ * \param k the index of the statistics of the rate
+ * \param maxTp the index of the statistics of the max throughput rate
+ * \param maxTp2 the index of the statistics of the second max throughput rate
+ */
+static inline void
+SetBestThRates (const HtRateStats &stats, uint32_t k, uint32_t &maxTp, uint32_t &maxTp2)
+{
+  double th = stats.throughput[k];
+  double prob = stats.ewmaProb[k];
+  if (th > stats.throughput[maxTp] || (th == stats.throughput[maxTp] && prob > stats.ewmaProb[maxTp]))
+    {
+      maxTp2 = maxTp;
+      maxTp = k;
+    }
+  else if (th > stats.throughput[maxTp2] || (th == stats.throughput[maxTp2] && prob > stats.ewmaProb[maxTp2]))
+    {
+      maxTp2 = k;
+    }
+}
+
+/**
+ * Set a rate as the max probability rate if it is better than the current
+ * one: the rates with a success probability above 75% are compared on their
+ * throughput, the others on their probability.
+ *
+ * \param stats the statistics of the rates
+ * \param k the index of the statistics of the rate
+ * \param maxProb the index of the statistics of the max probability rate
+ */
+static inline void
+SetBestProbabilityRate (const HtRateStats &stats, uint32_t k, uint32_t &maxProb)
+{
+  if (stats.ewmaProb[k] > 75)
+    {
+      if (stats.throughput[k] > stats.throughput[maxProb])
+        {
+          maxProb = k;
+        }
+    }
+  else if (stats.ewmaProb[k] > stats.ewmaProb[maxProb])
+    {
+      maxProb = k;
+    }
+}
+
+void
+HtRateStats::Resize (uint32_t nRates)
+{
+  index.resize (nRates, 0);
+  supported.resize (nRates, false);
+  txTime.resize (nRates, 0);
+  numRateAttempt.resize (nRates, 0);
+  numRateSuccess.resize (nRates, 0);
+  prob.resize (nRates, 0);
+  ewmaProb.resize (nRates, 0);
+  ewmsdProb.resize (nRates, 0);
+  prevNumRateAttempt.resize (nRates, 0);
+  prevNumRateSuccess.resize (nRates, 0);
+  numSamplesSkipped.resize (nRates, 0);
+  successHist.resize (nRates, 0);
+  attemptHist.resize (nRates, 0);
+  throughput.resize (nRates, 0);
+}
+
 NS_OBJECT_ENSURE_REGISTERED (MinstrelHtWifiManager);
 
 TypeId
@@ -539,7 +648,7 @@ MinstrelHtWifiManager::DoReportDataFailed (WifiRemoteStation *st)
     {
       uint32_t rateId = GetRateId (station->m_txrate);
       uint32_t groupId = GetGroupId (station->m_txrate);
-      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateAttempt++; // Increment the attempts counter for the rate used.
+      station->m_stats.numRateAttempt[GetStatsIndex (station, groupId, rateId)]++; // Increment the attempts counter for the rate used.
       UpdateRate (station);
     }
 }
@@ -579,8 +688,9 @@ MinstrelHtWifiManager::DoReportDataOk (WifiRemoteStation *st, double ackSnr, Wif
     {
       uint32_t rateId = GetRateId (station->m_txrate);
       uint32_t groupId = GetGroupId (station->m_txrate);
-      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateSuccess++;
-      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateAttempt++;
+      uint32_t statsIndex = GetStatsIndex (station, groupId, rateId);
+      station->m_stats.numRateSuccess[statsIndex]++;
+      station->m_stats.numRateAttempt[statsIndex]++;
 
       UpdatePacketCounters (station, 1, 0);
 
@@ -678,8 +788,9 @@ MinstrelHtWifiManager::DoReportAmpduTxStatus (WifiRemoteStation *st, uint8_t nSu
 
   uint32_t rateId = GetRateId (station->m_txrate);
   uint32_t groupId = GetGroupId (station->m_txrate);
-  station->m_groupsTable[groupId].m_ratesTable[rateId].numRateSuccess += nSuccessfulMpdus;
-  station->m_groupsTable[groupId].m_ratesTable[rateId].numRateAttempt += nSuccessfulMpdus + nFailedMpdus;
+  uint32_t statsIndex = GetStatsIndex (station, groupId, rateId);
+  station->m_stats.numRateSuccess[statsIndex] += nSuccessfulMpdus;
+  station->m_stats.numRateAttempt[statsIndex] += nSuccessfulMpdus + nFailedMpdus;
 
   if (nSuccessfulMpdus == 0 && station->m_longRetry < CountRetries (station))
     {
@@ -1118,13 +1229,14 @@ MinstrelHtWifiManager::FindRate (MinstrelHtWifiRemoteStation *station)
            * Also do not sample if the probability is already higher than 95%
            * to avoid wasting airtime.
            */
-          HtRateInfo sampleRateInfo = station->m_groupsTable[sampleGroupId].m_ratesTable[sampleRateId];
+          const HtRateInfo &sampleRateInfo = station->m_groupsTable[sampleGroupId].m_ratesTable[sampleRateId];
+          uint32_t sampleStatsIndex = GetStatsIndex (station, sampleGroupId, sampleRateId);
 
           NS_LOG_DEBUG ("Use sample rate? MaxTpRate= " << station->m_maxTpRate << " CurrentRate= " << station->m_txrate <<
-                        " SampleRate= " << sampleIdx << " SampleProb= " << sampleRateInfo.ewmaProb);
+                        " SampleRate= " << sampleIdx << " SampleProb= " << station->m_stats.ewmaProb[sampleStatsIndex]);
 
           if (sampleIdx != station->m_maxTpRate && sampleIdx != station->m_maxTpRate2
-              && sampleIdx != station->m_maxProbRate && sampleRateInfo.ewmaProb <= 95)
+              && sampleIdx != station->m_maxProbRate && station->m_stats.ewmaProb[sampleStatsIndex] <= 95)
             {
 
               /**
@@ -1163,7 +1275,7 @@ MinstrelHtWifiManager::FindRate (MinstrelHtWifiRemoteStation *station)
               else
                 {
                   station->m_numSamplesSlow++;
-                  if (sampleRateInfo.numSamplesSkipped >= 20 && station->m_numSamplesSlow <= 2)
+                  if (station->m_stats.numSamplesSkipped[sampleStatsIndex] >= 20 && station->m_numSamplesSlow <= 2)
                     {
                       /// Set flag that we are currently sampling.
                       station->m_isSampling = true;
@@ -1199,8 +1311,6 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
   station->m_numSamplesSlow = 0;
   station->m_sampleCount = 0;
 
-  double tempProb;
-
   if (station->m_ampduPacketCount > 0)
     {
       double newLen = station->m_ampduLen / station->m_ampduPacketCount;
@@ -1211,10 +1321,68 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
 
   /* Initialize global rate indexes */
   station->m_maxTpRate = GetLowestIndex (station);
-  station->m_maxTpRate2 = GetLowestIndex (station);
-  station->m_maxProbRate = GetLowestIndex (station);
+  station->m_maxTpRate2 = station->m_maxTpRate;
+  station->m_maxProbRate = station->m_maxTpRate;
 
   /// Update throughput and EWMA for each rate inside each group.
+  HtRateStats &stats = station->m_stats;
+  uint32_t nRates = stats.supported.size ();
+  for (uint32_t k = 0; k < nRates; k++)
+    {
+      if (!stats.supported[k])
+        {
+          continue;
+        }
+      uint32_t attempts = stats.numRateAttempt[k];
+      uint32_t successes = stats.numRateSuccess[k];
+
+      /// If we've attempted something.
+      if (attempts > 0)
+        {
+          stats.numSamplesSkipped[k] = 0;
+          /**
+           * Calculate the probability of success.
+           * Assume probability scales from 0 to 100.
+           */
+          double prob = (100 * successes) / attempts;
+
+          /// Bookeeping.
+          stats.prob[k] = prob;
+
+          double ewmaProb = prob;
+          if (stats.successHist[k] != 0)
+            {
+              stats.ewmsdProb[k] = CalculateEwmsd (stats.ewmsdProb[k], prob, stats.ewmaProb[k], m_ewmaLevel);
+              /// EWMA probability
+              ewmaProb = (prob * (100 - m_ewmaLevel) + stats.ewmaProb[k] * m_ewmaLevel) / 100;
+            }
+          stats.ewmaProb[k] = ewmaProb;
+
+          stats.throughput[k] = CalculateThroughput (ewmaProb, stats.txTime[k]);
+
+          stats.successHist[k] += successes;
+          stats.attemptHist[k] += attempts;
+        }
+      else
+        {
+          stats.numSamplesSkipped[k]++;
+        }
+
+      /// Bookeeping.
+      stats.prevNumRateSuccess[k] = successes;
+      stats.prevNumRateAttempt[k] = attempts;
+      stats.numRateSuccess[k] = 0;
+      stats.numRateAttempt[k] = 0;
+    }
+
+  /**
+   * Find the best rates of the station and of each group.  The rates are
+   * compared in the same order as they were updated, so the rates already
+   * selected have all been updated.
+   */
+  uint32_t maxTp = GetStatsIndex (station, GetGroupId (station->m_maxTpRate), GetRateId (station->m_maxTpRate));
+  uint32_t maxTp2 = maxTp;
+  uint32_t maxProb = maxTp;
   for (uint8_t j = 0; j < m_numGroups; j++)
     {
       if (station->m_groupsTable[j].m_supported)
@@ -1222,9 +1390,9 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
           station->m_sampleCount++;
 
           /* (re)Initialize group rate indexes */
-          station->m_groupsTable[j].m_maxTpRate = GetLowestIndex (station, j);
-          station->m_groupsTable[j].m_maxTpRate2 = GetLowestIndex (station, j);
-          station->m_groupsTable[j].m_maxProbRate = GetLowestIndex (station, j);
+          uint32_t groupMaxTp = GetStatsIndex (station, j, GetRateId (GetLowestIndex (station, j)));
+          uint32_t groupMaxTp2 = groupMaxTp;
+          uint32_t groupMaxProb = groupMaxTp;
 
           for (uint8_t i = 0; i < m_numRates; i++)
             {
@@ -1232,63 +1400,29 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
                 {
                   station->m_groupsTable[j].m_ratesTable[i].retryUpdated = false;
 
+                  uint32_t k = GetStatsIndex (station, j, i);
                   NS_LOG_DEBUG (i << " " << GetMcsSupported (station,  station->m_groupsTable[j].m_ratesTable[i].mcsIndex) <<
-                                "\t attempt=" << station->m_groupsTable[j].m_ratesTable[i].numRateAttempt <<
-                                "\t success=" << station->m_groupsTable[j].m_ratesTable[i].numRateSuccess);
-
-                  /// If we've attempted something.
-                  if (station->m_groupsTable[j].m_ratesTable[i].numRateAttempt > 0)
-                    {
-                      station->m_groupsTable[j].m_ratesTable[i].numSamplesSkipped = 0;
-                      /**
-                       * Calculate the probability of success.
-                       * Assume probability scales from 0 to 100.
-                       */
-                      tempProb = (100 * station->m_groupsTable[j].m_ratesTable[i].numRateSuccess) / station->m_groupsTable[j].m_ratesTable[i].numRateAttempt;
-
-                      /// Bookeeping.
-                      station->m_groupsTable[j].m_ratesTable[i].prob = tempProb;
-
-                      if (station->m_groupsTable[j].m_ratesTable[i].successHist == 0)
-                        {
-                          station->m_groupsTable[j].m_ratesTable[i].ewmaProb = tempProb;
-                        }
-                      else
-                        {
-                          station->m_groupsTable[j].m_ratesTable[i].ewmsdProb = CalculateEwmsd (station->m_groupsTable[j].m_ratesTable[i].ewmsdProb,
-                                                                                                tempProb, station->m_groupsTable[j].m_ratesTable[i].ewmaProb,
-                                                                                                m_ewmaLevel);
-                          /// EWMA probability
-                          tempProb = (tempProb * (100 - m_ewmaLevel) + station->m_groupsTable[j].m_ratesTable[i].ewmaProb * m_ewmaLevel)  / 100;
-                          station->m_groupsTable[j].m_ratesTable[i].ewmaProb = tempProb;
-                        }
-
-                      station->m_groupsTable[j].m_ratesTable[i].throughput = CalculateThroughput (station, j, i, tempProb);
+                                "\t attempt=" << stats.prevNumRateAttempt[k] <<
+                                "\t success=" << stats.prevNumRateSuccess[k]);
 
-                      station->m_groupsTable[j].m_ratesTable[i].successHist += station->m_groupsTable[j].m_ratesTable[i].numRateSuccess;
-                      station->m_groupsTable[j].m_ratesTable[i].attemptHist += station->m_groupsTable[j].m_ratesTable[i].numRateAttempt;
-                    }
-                  else
-                    {
-                      station->m_groupsTable[j].m_ratesTable[i].numSamplesSkipped++;
-                    }
-
-                  /// Bookeeping.
-                  station->m_groupsTable[j].m_ratesTable[i].prevNumRateSuccess = station->m_groupsTable[j].m_ratesTable[i].numRateSuccess;
-                  station->m_groupsTable[j].m_ratesTable[i].prevNumRateAttempt = station->m_groupsTable[j].m_ratesTable[i].numRateAttempt;
-                  station->m_groupsTable[j].m_ratesTable[i].numRateSuccess = 0;
-                  station->m_groupsTable[j].m_ratesTable[i].numRateAttempt = 0;
-
-                  if (station->m_groupsTable[j].m_ratesTable[i].throughput != 0)
+                  if (stats.throughput[k] != 0)
                     {
-                      SetBestStationThRates (station, GetIndex (j, i));
-                      SetBestProbabilityRate (station, GetIndex (j, i));
+                      SetBestThRates (stats, k, maxTp, maxTp2);
+                      SetBestThRates (stats, k, groupMaxTp, groupMaxTp2);
+                      SetBestProbabilityRate (stats, k, maxProb);
+                      SetBestProbabilityRate (stats, k, groupMaxProb);
                     }
-
                 }
             }
+
+          station->m_groupsTable[j].m_maxTpRate = stats.index[groupMaxTp];
+          station->m_groupsTable[j].m_maxTpRate2 = stats.index[groupMaxTp2];
+          station->m_groupsTable[j].m_maxProbRate = stats.index[groupMaxProb];
         }
     }
+  station->m_maxTpRate = stats.index[maxTp];
+  station->m_maxTpRate2 = stats.index[maxTp2];
+  station->m_maxProbRate = stats.index[maxProb];
 
   //Try to sample all available rates during each interval.
   station->m_sampleCount *= 8;
@@ -1305,162 +1439,14 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
     }
 }
 
-double
-MinstrelHtWifiManager::CalculateThroughput (MinstrelHtWifiRemoteStation *station, uint32_t groupId, uint32_t rateId, double ewmaProb)
-{
-  /**
-  * Calculating throughput.
-  * Do not account throughput if sucess prob is below 10%
-  * (as done in minstrel_ht linux implementation).
-  */
-  if (ewmaProb < 10)
-    {
-      return 0;
-    }
-  else
-    {
-      /**
-       * For the throughput calculation, limit the probability value to 90% to
-       * account for collision related packet error rate fluctuation.
-       */
-      Time txTime =  station->m_groupsTable[groupId].m_ratesTable[rateId].perfectTxTime;
-      if (ewmaProb > 90)
-        {
-          return 90 / txTime.GetSeconds ();
-        }
-      else
-        {
-          return ewmaProb / txTime.GetSeconds ();
-        }
-    }
-}
-
-void
-MinstrelHtWifiManager::SetBestProbabilityRate (MinstrelHtWifiRemoteStation *station, uint32_t index)
-{
-  GroupInfo *group;
-  HtRateInfo rate;
-  uint32_t tmpGroupId, tmpRateId;
-  double tmpTh, tmpProb;
-  uint32_t groupId, rateId;
-  double currentTh;
-  // maximum group probability (GP) variables
-  uint32_t maxGPGroupId, maxGPRateId;
-  double maxGPTh;
-
-  groupId = GetGroupId (index);
-  rateId = GetRateId (index);
-  group = &station->m_groupsTable[groupId];
-  rate = group->m_ratesTable[rateId];
-
-  tmpGroupId = GetGroupId (station->m_maxProbRate);
-  tmpRateId = GetRateId (station->m_maxProbRate);
-  tmpProb = station->m_groupsTable[tmpGroupId].m_ratesTable[tmpRateId].ewmaProb;
-  tmpTh =  station->m_groupsTable[tmpGroupId].m_ratesTable[tmpRateId].throughput;
-
-  if (rate.ewmaProb > 75)
-    {
-      currentTh = station->m_groupsTable[groupId].m_ratesTable[rateId].throughput;
-      if (currentTh > tmpTh)
-        {
-          station->m_maxProbRate = index;
-        }
-
-      maxGPGroupId = GetGroupId (group->m_maxProbRate);
-      maxGPRateId = GetRateId (group->m_maxProbRate);
-      maxGPTh = station->m_groupsTable[maxGPGroupId].m_ratesTable[maxGPRateId].throughput;
-
-      if (currentTh > maxGPTh)
-        {
-          group->m_maxProbRate = index;
-        }
-    }
-  else
-    {
-      if (rate.ewmaProb > tmpProb)
-        {
-          station->m_maxProbRate = index;
-        }
-      maxGPRateId = GetRateId (group->m_maxProbRate);
-      if (rate.ewmaProb > group->m_ratesTable[maxGPRateId].ewmaProb)
-        {
-          group->m_maxProbRate = index;
-        }
-    }
-}
-
-/*
- * Find & sort topmost throughput rates
- *
- * If multiple rates provide equal throughput the sorting is based on their
- * current success probability. Higher success probability is preferred among
- * MCS groups.
- */
-void
-MinstrelHtWifiManager::SetBestStationThRates (MinstrelHtWifiRemoteStation *station, uint32_t index)
-{
-  uint32_t groupId, rateId;
-  double th, prob;
-  uint32_t maxTpGroupId, maxTpRateId;
-  uint32_t maxTp2GroupId, maxTp2RateId;
-  double maxTpTh, maxTpProb;
-  double maxTp2Th, maxTp2Prob;
-
-  groupId = GetGroupId (index);
-  rateId = GetRateId (index);
-  prob = station->m_groupsTable[groupId].m_ratesTable[rateId].ewmaProb;
-  th = station->m_groupsTable[groupId].m_ratesTable[rateId].throughput;
-
-  maxTpGroupId = GetGroupId (station->m_maxTpRate);
-  maxTpRateId = GetRateId (station->m_maxTpRate);
-  maxTpProb = station->m_groupsTable[maxTpGroupId].m_ratesTable[maxTpRateId].ewmaProb;
-  maxTpTh = station->m_groupsTable[maxTpGroupId].m_ratesTable[maxTpRateId].throughput;
-
-  maxTp2GroupId = GetGroupId (station->m_maxTpRate2);
-  maxTp2RateId = GetRateId (station->m_maxTpRate2);
-  maxTp2Prob = station->m_groupsTable[maxTp2GroupId].m_ratesTable[maxTp2RateId].ewmaProb;
-  maxTp2Th = station->m_groupsTable[maxTp2GroupId].m_ratesTable[maxTp2RateId].throughput;
-
-  if (th > maxTpTh || (th == maxTpTh && prob > maxTpProb))
-    {
-      station->m_maxTpRate2 = station->m_maxTpRate;
-      station->m_maxTpRate = index;
-    }
-  else if (th > maxTp2Th || (th == maxTp2Th && prob > maxTp2Prob))
-    {
-      station->m_maxTpRate2 = index;
-    }
-
-  //Find best rates per group
-
-  GroupInfo *group = &station->m_groupsTable[groupId];
-  maxTpGroupId = GetGroupId (group->m_maxTpRate);
-  maxTpRateId = GetRateId (group->m_maxTpRate);
-  maxTpProb = group->m_ratesTable[maxTpRateId].ewmaProb;
-  maxTpTh = station->m_groupsTable[maxTpGroupId].m_ratesTable[maxTpRateId].throughput;
-
-  maxTp2GroupId = GetGroupId (group->m_maxTpRate2);
-  maxTp2RateId = GetRateId (group->m_maxTpRate2);
-  maxTp2Prob = group->m_ratesTable[maxTp2RateId].ewmaProb;
-  maxTp2Th = station->m_groupsTable[maxTp2GroupId].m_ratesTable[maxTp2RateId].throughput;
-
-  if (th > maxTpTh || (th == maxTpTh && prob > maxTpProb))
-    {
-      group->m_maxTpRate2 = group->m_maxTpRate;
-      group->m_maxTpRate = index;
-    }
-  else if (th > maxTp2Th || (th == maxTp2Th && prob > maxTp2Prob))
-    {
-      group->m_maxTpRate2 = index;
-    }
-}
-
 void
 MinstrelHtWifiManager::RateInit (MinstrelHtWifiRemoteStation *station)
 {
   NS_LOG_FUNCTION (this << station);
 
   station->m_groupsTable = McsGroupData (m_numGroups);
+  station->m_stats = HtRateStats ();
+  uint32_t nRates = 0;
 
   /**
   * Initialize groups supported by the receiver.
@@ -1489,6 +1475,13 @@ MinstrelHtWifiManager::RateInit (MinstrelHtWifiRemoteStation *station)
                 {
                   station->m_groupsTable[groupId].m_ratesTable[i].supported = false;
                 }
+              station->m_groupsTable[groupId].m_statsIndex = nRates;                             ///Add the statistics of its rates.
+              nRates += m_numRates;
+              station->m_stats.Resize (nRates);
+              for (uint8_t i = 0; i < m_numRates; i++)
+                {
+                  station->m_stats.index[GetStatsIndex (station, groupId, i)] = GetIndex (groupId, i);
+                }
 
               // Initialize all modes supported by the remote station that belong to the current group.
               for (uint8_t i = 0; i < station->m_nModes; i++)
@@ -1511,19 +1504,22 @@ MinstrelHtWifiManager::RateInit (MinstrelHtWifiRemoteStation *station)
                     {
                       NS_LOG_DEBUG ("Mode " << i << ": " << mode << " isVht: " << m_minstrelGroups[groupId].isVht);
 
+                      uint32_t statsIndex = GetStatsIndex (station, groupId, rateId);
                       station->m_groupsTable[groupId].m_ratesTable[rateId].supported = true;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].mcsIndex = i;         ///Mapping between rateId and operationalMcsSet
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateAttempt = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateSuccess = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].prob = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].ewmaProb = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].prevNumRateAttempt = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].prevNumRateSuccess = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].numSamplesSkipped = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].successHist = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].attemptHist = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].throughput = 0;
+                      station->m_stats.supported[statsIndex] = true;
+                      station->m_stats.numRateAttempt[statsIndex] = 0;
+                      station->m_stats.numRateSuccess[statsIndex] = 0;
+                      station->m_stats.prob[statsIndex] = 0;
+                      station->m_stats.ewmaProb[statsIndex] = 0;
+                      station->m_stats.prevNumRateAttempt[statsIndex] = 0;
+                      station->m_stats.prevNumRateSuccess[statsIndex] = 0;
+                      station->m_stats.numSamplesSkipped[statsIndex] = 0;
+                      station->m_stats.successHist[statsIndex] = 0;
+                      station->m_stats.attemptHist[statsIndex] = 0;
+                      station->m_stats.throughput[statsIndex] = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].perfectTxTime = GetFirstMpduTxTime (groupId, GetMcsSupported (station, i));
+                      station->m_stats.txTime[statsIndex] = station->m_groupsTable[groupId].m_ratesTable[rateId].perfectTxTime.GetSeconds ();
                       station->m_groupsTable[groupId].m_ratesTable[rateId].retryCount = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].adjustedRetryCount = 0;
                       CalculateRetransmits (station, groupId, rateId);
@@ -1561,7 +1557,7 @@ MinstrelHtWifiManager::CalculateRetransmits (MinstrelHtWifiRemoteStation *statio
   Time slotTime = GetMac ()->GetSlot ();
   Time ackTime = GetMac ()->GetBasicBlockAckTimeout ();
 
-  if (station->m_groupsTable[groupId].m_ratesTable[rateId].ewmaProb < 1)
+  if (station->m_stats.ewmaProb[GetStatsIndex (station, groupId, rateId)] < 1)
     {
       station->m_groupsTable[groupId].m_ratesTable[rateId].retryCount = 1;
     }
@@ -1737,16 +1733,17 @@ MinstrelHtWifiManager::StatsDump (MinstrelHtWifiRemoteStation *station, uint32_t
           txTime = GetFirstMpduTxTime (groupId, GetMcsSupported (station, station->m_groupsTable[groupId].m_ratesTable[i].mcsIndex));
           of << std::setw (6) << txTime.GetMicroSeconds () << "  ";
 
-          of << std::setw (7) << CalculateThroughput (station, groupId, i, 100) / 100 << "   " <<
-            std::setw (7) << station->m_groupsTable[groupId].m_ratesTable[i].throughput / 100 << "   " <<
-            std::setw (7) << station->m_groupsTable[groupId].m_ratesTable[i].ewmaProb << "  " <<
-            std::setw (7) << station->m_groupsTable[groupId].m_ratesTable[i].ewmsdProb << "  " <<
-            std::setw (7) << station->m_groupsTable[groupId].m_ratesTable[i].prob << "  " <<
+          uint32_t statsIndex = GetStatsIndex (station, groupId, i);
+          of << std::setw (7) << CalculateThroughput (100, station->m_stats.txTime[statsIndex]) / 100 << "   " <<
+            std::setw (7) << station->m_stats.throughput[statsIndex] / 100 << "   " <<
+            std::setw (7) << station->m_stats.ewmaProb[statsIndex] << "  " <<
+            std::setw (7) << station->m_stats.ewmsdProb[statsIndex] << "  " <<
+            std::setw (7) << station->m_stats.prob[statsIndex] << "  " <<
             std::setw (2) << station->m_groupsTable[groupId].m_ratesTable[i].retryCount << "   " <<
-            std::setw (3) << station->m_groupsTable[groupId].m_ratesTable[i].prevNumRateSuccess << "  " <<
-            std::setw (3) << station->m_groupsTable[groupId].m_ratesTable[i].prevNumRateAttempt << "   " <<
-            std::setw (9) << station->m_groupsTable[groupId].m_ratesTable[i].successHist << "   " <<
-            std::setw (9) << station->m_groupsTable[groupId].m_ratesTable[i].attemptHist << "\n";
+            std::setw (3) << station->m_stats.prevNumRateSuccess[statsIndex] << "  " <<
+            std::setw (3) << station->m_stats.prevNumRateAttempt[statsIndex] << "   " <<
+            std::setw (9) << station->m_stats.successHist[statsIndex] << "   " <<
+            std::setw (9) << station->m_stats.attemptHist[statsIndex] << "\n";
         }
     }
 }
@@ -65,7 +65,8 @@ typedef std::vector<McsGroup> MinstrelMcsGroups;
 
 struct MinstrelHtWifiRemoteStation;
 /**
- * A struct to contain all statistics information related to a data rate.
+ * A struct to contain the information related to a data rate which is not
+ * updated with the statistics; these are held by HtRateStats.
  */
 struct HtRateInfo
 {
@@ -81,27 +82,8 @@ struct HtRateInfo
 
   uint32_t retryCount;          //!< Retry limit.
   uint32_t adjustedRetryCount;  //!< Adjust the retry limit for this rate.
-  uint32_t numRateAttempt;      //!< Number of transmission attempts so far.
-  uint32_t numRateSuccess;      //!< Number of successful frames transmitted so far.
-  double prob;                  //!< Current probability within last time interval. (# frame success )/(# total frames)
 
   bool retryUpdated;            //!< If number of retries was updated already.
-
-  /**
-   * Exponential weighted moving average of probability.
-   * EWMA calculation:
-   * ewma_prob =[prob *(100 - ewma_level) + (ewma_prob_old * ewma_level)]/100
-   */
-  double ewmaProb;
-
-  double ewmsdProb;             //!< Exponential weighted moving standard deviation of probability.
-
-  uint32_t prevNumRateAttempt;  //!< Number of transmission attempts with previous rate.
-  uint32_t prevNumRateSuccess;  //!< Number of successful frames transmitted with previous rate.
-  uint32_t numSamplesSkipped;   //!< Number of times this rate statistics were not updated because no attempts have been made.
-  uint64_t successHist;         //!< Aggregate of all transmission successes.
-  uint64_t attemptHist;         //!< Aggregate of all transmission attempts.
-  double throughput;            //!< Throughput of this rate (in pkts per second).
 };
 
 /**
@@ -127,6 +109,8 @@ struct GroupInfo
   uint32_t m_maxTpRate2;          //!< The second max throughput rate of this group.
   uint32_t m_maxProbRate;         //!< The highest success probability rate of this group.
 
+  uint32_t m_statsIndex;          //!< Index of the statistics of the first rate of this group in the HtRateStats of the station.
+
   HtMinstrelRate m_ratesTable;    //!< Information about rates of this group.
 };
 
@@ -136,6 +120,45 @@ struct GroupInfo
  */
 typedef std::vector<struct GroupInfo> McsGroupData;
 
+/**
+ * The statistics of all the rates of the groups supported by a station.
+ *
+ * Each statistic is kept in its own array, with the rates of each supported
+ * group following each other in the order of the groups, from the
+ * m_statsIndex of the group.  The statistics of a station are thus updated
+ * at the end of each interval in a single pass over contiguous arrays, and
+ * its best rates are then found from the statistics of the rates alone.
+ */
+struct HtRateStats
+{
+  std::vector<uint32_t> index;                //!< The global index of the rate.
+  std::vector<uint8_t> supported;             //!< If the rate is supported.
+  std::vector<double> txTime;                 //!< Perfect transmission time of the rate (in seconds).
+  std::vector<uint32_t> numRateAttempt;       //!< Number of transmission attempts so far.
+  std::vector<uint32_t> numRateSuccess;       //!< Number of successful frames transmitted so far.
+  std::vector<double> prob;                   //!< Current probability within last time interval. (# frame success )/(# total frames)
+  /**
+   * Exponential weighted moving average of probability.
+   * EWMA calculation:
+   * ewma_prob =[prob *(100 - ewma_level) + (ewma_prob_old * ewma_level)]/100
+   */
+  std::vector<double> ewmaProb;
+  std::vector<double> ewmsdProb;              //!< Exponential weighted moving standard deviation of probability.
+  std::vector<uint32_t> prevNumRateAttempt;   //!< Number of transmission attempts with previous rate.
+  std::vector<uint32_t> prevNumRateSuccess;   //!< Number of successful frames transmitted with previous rate.
+  std::vector<uint32_t> numSamplesSkipped;    //!< Number of times this rate statistics were not updated because no attempts have been made.
+  std::vector<uint64_t> successHist;          //!< Aggregate of all transmission successes.
+  std::vector<uint64_t> attemptHist;          //!< Aggregate of all transmission attempts.
+  std::vector<double> throughput;             //!< Throughput of this rate (in pkts per second).
+
+  /**
+   * Resize the arrays, the statistics of the rates added being zero.
+   *
+   * \param nRates the number of rates
+   */
+  void Resize (uint32_t nRates);
+};
+
 /**
  * Data structure for a Sample Rate table.
  * A vector of a vector uint32_t.
@@ -378,33 +401,6 @@ private:
    */
   void RateInit (MinstrelHtWifiRemoteStation *station);
 
-  /**
-   * Return the average throughput of the MCS defined by groupId and rateId.
-   *
-   * \param station the minstrel HT wifi remote station
-   * \param groupId the group ID
-   * \param rateId the rate ID
-   * \param ewmaProb
-   * \returns the throughput
-   */
-  double CalculateThroughput (MinstrelHtWifiRemoteStation *station, uint32_t groupId, uint32_t rateId, double ewmaProb);
-
-  /**
-   * Set index rate as maxTpRate or maxTp2Rate if is better than current values.
-   *
-   * \param station the minstrel HT wifi remote station
-   * \param index the index
-   */
-  void SetBestStationThRates (MinstrelHtWifiRemoteStation *station, uint32_t index);
-
-  /**
-   * Set index rate as maxProbRate if it is better than current value.
-   *
-   * \param station the minstrel HT wifi remote station
-   * \param index the index
-   */
-  void SetBestProbabilityRate (MinstrelHtWifiRemoteStation *station, uint32_t index);
-
   /**
    * Calculate the number of retransmissions to set for the index rate.
    *
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "table-error-rate-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TableErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TableErrorRateModel);
+
+TypeId
+TableErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TableErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TableErrorRateModel> ()
+    .AddAttribute ("Model",
+                   "The error rate model whose success rates are tabulated.",
+                   PointerValue (),
+                   MakePointerAccessor (&TableErrorRateModel::SetModel,
+                                        &TableErrorRateModel::GetModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MinSnr",
+                   "The SNR of the first point of the tables (dB).",
+                   DoubleValue (-20.0),
+                   MakeDoubleAccessor (&TableErrorRateModel::m_minSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The SNR of the last point of the tables (dB).",
+                   DoubleValue (50.0),
+                   MakeDoubleAccessor (&TableErrorRateModel::m_maxSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrStep",
+                   "The step between the points of the tables (dB).",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&TableErrorRateModel::m_step),
+                   MakeDoubleChecker<double> (0.001))
+    .AddAttribute ("Tolerance",
+                   "The relative error of the interpolated L allowed in the middle "
+                   "of a cell of the tables, above which the cell is left to the model.",
+                   DoubleValue (1e-3),
+                   MakeDoubleAccessor (&TableErrorRateModel::m_tolerance),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+TableErrorRateModel::TableErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TableErrorRateModel::~TableErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TableErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  m_tables.clear ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TableErrorRateModel::SetModel (Ptr<ErrorRateModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  // The tables were computed by the previous model
+  m_tables.clear ();
+}
+
+Ptr<ErrorRateModel>
+TableErrorRateModel::GetModel (void) const
+{
+  return m_model;
+}
+
+double
+TableErrorRateModel::GetPoint (WifiMode mode, WifiTxVector txVector, double snrDb) const
+{
+  double snr = std::pow (10.0, snrDb / 10.0);
+  // From +infinity where every bit is lost to -infinity where none is
+  return std::log (-std::log (m_model->GetChunkSuccessRate (mode, txVector, snr, 1)));
+}
+
+double
+TableErrorRateModel::Interpolate (double y0, double y1, double t)
+{
+  if (y0 == y1)
+    {
+      // Also where every bit or none is lost
+      return y0;
+    }
+  return y0 + t * (y1 - y0);
+}
+
+void
+TableErrorRateModel::Build (WifiMode mode, WifiTxVector txVector, Table &table) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector);
+  table.minSnrDb = m_minSnrDb;
+  table.step = m_step;
+  uint32_t nPoints = static_cast<uint32_t> (std::floor ((m_maxSnrDb - m_minSnrDb) / m_step + 0.5)) + 1;
+  NS_ASSERT_MSG (nPoints >= 2, "The tables of a TableErrorRateModel need at least two points");
+  table.points.resize (nPoints);
+  table.exact.resize (nPoints - 1);
+  for (uint32_t i = 0; i < nPoints; i++)
+    {
+      table.points[i] = GetPoint (mode, txVector, m_minSnrDb + i * m_step);
+    }
+  uint32_t nExact = 0;
+  for (uint32_t i = 0; i < nPoints - 1; i++)
+    {
+      double y0 = table.points[i];
+      double y1 = table.points[i + 1];
+      if (y0 == y1)
+        {
+          table.exact[i] = false;
+        }
+      else if (!std::isfinite (y0) || !std::isfinite (y1))
+        {
+          table.exact[i] = true;
+        }
+      else
+        {
+          double l = -std::exp (GetPoint (mode, txVector, m_minSnrDb + (i + 0.5) * m_step));
+          double interpolated = -std::exp (Interpolate (y0, y1, 0.5));
+          table.exact[i] = !(std::abs (interpolated - l) <= m_tolerance * std::abs (l));
+        }
+      nExact += table.exact[i];
+    }
+  NS_LOG_DEBUG (nExact << " of " << nPoints - 1 << " cells left to the model for " << mode);
+}
+
+double
+TableErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
+  NS_ASSERT_MSG (m_model != 0, "TableErrorRateModel without a model to tabulate");
+  if (nbits == 0)
+    {
+      return 1.0;
+    }
+
+  uint64_t key = (static_cast<uint64_t> (mode.GetUid ()) << 32)
+    | (static_cast<uint64_t> (txVector.GetGuardInterval ()) << 16)
+    | (static_cast<uint64_t> (txVector.GetChannelWidth ()) << 8)
+    | txVector.GetNss ();
+  Tables::iterator it = m_tables.find (key);
+  if (it == m_tables.end ())
+    {
+      it = m_tables.insert (std::make_pair (key, Table ())).first;
+      Build (mode, txVector, it->second);
+    }
+  const Table &table = it->second;
+
+  double x = (10.0 * std::log10 (snr) - table.minSnrDb) / table.step;
+  if (!(x >= 0) || x > table.points.size () - 1)
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  uint32_t i = std::min (static_cast<uint32_t> (x), static_cast<uint32_t> (table.points.size () - 2));
+  if (table.exact[i])
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  double y = Interpolate (table.points[i], table.points[i + 1], x - i);
+  return std::exp (-std::exp (y) * nbits);
+}
+
+} //namespace ns3
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TABLE_ERROR_RATE_MODEL_H
+#define TABLE_ERROR_RATE_MODEL_H
+
+#include <map>
+#include <vector>
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * \brief Interpolate the chunk success rates of another error rate model
+ * from tables precomputed over a grid of SNRs.
+ *
+ * The error rate models of this module, NistErrorRateModel and
+ * YansErrorRateModel as well as the DsssErrorRateModel functions they use
+ * for the DSSS modes, give success rates of the form exp (nbits * L (snr)).
+ * The first time a mode is used with a given channel width, guard interval
+ * and number of spatial streams, L is computed by the model of the Model
+ * attribute at every point of the SNR grid, from MinSnr to MaxSnr by steps
+ * of SnrStep.  The success rates are then interpolated linearly in dB on
+ * log (-L), which is nearly linear in the SNR for the modulations and
+ * codes of 802.11.
+ *
+ * L is also computed in the middle of each cell of the grid, and the cells
+ * where the interpolated L is off by more than the relative Tolerance, such
+ * as the ones holding a discontinuity of the model, are left to the model
+ * of the Model attribute, as are the SNRs outside of the grid.  Since
+ * x exp (-x) is at most 1/e, a relative error of L moves the success rate
+ * of a chunk by at most 0.37 times that error, whatever its size.
+ */
+class TableErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TableErrorRateModel ();
+  virtual ~TableErrorRateModel ();
+
+  /**
+   * \param model the error rate model whose success rates are tabulated
+   */
+  void SetModel (Ptr<ErrorRateModel> model);
+  /**
+   * \return the error rate model whose success rates are tabulated
+   */
+  Ptr<ErrorRateModel> GetModel (void) const;
+
+  double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+
+protected:
+  virtual void DoDispose (void);
+
+
+private:
+  /**
+   * \brief The points of the grid of SNRs for one mode
+   */
+  struct Table
+  {
+    double minSnrDb;             //!< SNR of the first point (in dB)
+    double step;                 //!< Step between the points (in dB)
+    std::vector<double> points;  //!< log (-L) at each point
+    std::vector<bool> exact;     //!< Whether each cell is left to the model
+  };
+
+  /**
+   * \brief Compute log (-L) with the tabulated model.
+   * \param mode the mode
+   * \param txVector the TXVECTOR of the chunks
+   * \param snrDb the SNR (in dB)
+   * \return log (-L)
+   */
+  double GetPoint (WifiMode mode, WifiTxVector txVector, double snrDb) const;
+  /**
+   * \brief Interpolate log (-L) in a cell.
+   * \param y0 log (-L) at the start of the cell
+   * \param y1 log (-L) at the end of the cell
+   * \param t position in the cell, from 0 to 1
+   * \return log (-L)
+   */
+  static double Interpolate (double y0, double y1, double t);
+
+  /**
+   * \brief Build the table of a mode.
+   * \param mode the mode
+   * \param txVector the TXVECTOR of the chunks
+   * \param table the table to fill
+   */
+  void Build (WifiMode mode, WifiTxVector txVector, Table &table) const;
+
+  /// Tables, by mode, channel width, guard interval and number of spatial streams
+  typedef std::map<uint64_t, Table> Tables;
+
+  Ptr<ErrorRateModel> m_model;  //!< Tabulated error rate model
+  double m_minSnrDb;            //!< SNR of the first point of the tables (in dB)
+  double m_maxSnrDb;            //!< SNR of the last point of the tables (in dB)
+  double m_step;                //!< Step between the points of the tables (in dB)
+  double m_tolerance;           //!< Relative error of L allowed in the cells
+  mutable Tables m_tables;      //!< Tables built
+};
+
+} //namespace ns3
+
+#endif /* TABLE_ERROR_RATE_MODEL_H */
@@ -387,6 +387,8 @@ WifiPhy::DoDispose (void)
   m_wifiRadioEnergyModel = 0;
   m_deviceRateSet.clear ();
   m_deviceMcsSet.clear ();
+  m_payloadDurations.clear ();
+  m_txDurations.clear ();
 }
 
 void
@@ -2005,8 +2007,54 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
   return GetPayloadDuration (size, txVector, frequency, NORMAL_MPDU, 0);
 }
 
+WifiPhy::TxDurationKey
+WifiPhy::GetTxDurationKey (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype)
+{
+  uint64_t first = (static_cast<uint64_t> (size) << 32) | txVector.GetMode ().GetUid ();
+  uint64_t second = static_cast<uint64_t> (txVector.GetChannelWidth ())
+    | (static_cast<uint64_t> (txVector.GetGuardInterval ()) << 8)
+    | (static_cast<uint64_t> (txVector.GetNss ()) << 24)
+    | (static_cast<uint64_t> (txVector.GetNess ()) << 32)
+    | (static_cast<uint64_t> (txVector.GetPreambleType ()) << 40)
+    | (static_cast<uint64_t> (mpdutype) << 48)
+    | (static_cast<uint64_t> (txVector.IsStbc ()) << 52)
+    | (static_cast<uint64_t> (Is2_4Ghz (frequency)) << 53);
+  return std::make_pair (first, second);
+}
+
+void
+WifiPhy::CacheTxDuration (TxDurations &durations, TxDurationKey key, Time duration)
+{
+  // Packet sizes vary a lot in some simulations: keep the most recent ones
+  if (durations.size () >= 4096)
+    {
+      durations.clear ();
+    }
+  durations.insert (std::make_pair (key, duration));
+}
+
 Time
 WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
+{
+  // The duration of the last MPDU of an A-MPDU depends on the previous
+  // ones, which are accumulated when incFlag is set
+  if (mpdutype == LAST_MPDU_IN_AGGREGATE || (mpdutype == MPDU_IN_AGGREGATE && incFlag == 1))
+    {
+      return ComputePayloadDuration (size, txVector, frequency, mpdutype, incFlag);
+    }
+  TxDurationKey key = GetTxDurationKey (size, txVector, frequency, mpdutype);
+  TxDurations::const_iterator it = m_payloadDurations.find (key);
+  if (it != m_payloadDurations.end ())
+    {
+      return it->second;
+    }
+  Time duration = ComputePayloadDuration (size, txVector, frequency, mpdutype, incFlag);
+  CacheTxDuration (m_payloadDurations, key, duration);
+  return duration;
+}
+
+Time
+WifiPhy::ComputePayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
 {
   WifiMode payloadMode = txVector.GetMode ();
   WifiPreamble preamble = txVector.GetPreambleType ();
@@ -2292,8 +2340,20 @@ WifiPhy::CalculatePlcpPreambleAndHeaderDuration (WifiTxVector txVector)
 Time
 WifiPhy::CalculateTxDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
 {
+  if (mpdutype == LAST_MPDU_IN_AGGREGATE || (mpdutype == MPDU_IN_AGGREGATE && incFlag == 1))
+    {
+      return CalculatePlcpPreambleAndHeaderDuration (txVector)
+             + GetPayloadDuration (size, txVector, frequency, mpdutype, incFlag);
+    }
+  TxDurationKey key = GetTxDurationKey (size, txVector, frequency, mpdutype);
+  TxDurations::const_iterator it = m_txDurations.find (key);
+  if (it != m_txDurations.end ())
+    {
+      return it->second;
+    }
   Time duration = CalculatePlcpPreambleAndHeaderDuration (txVector)
     + GetPayloadDuration (size, txVector, frequency, mpdutype, incFlag);
+  CacheTxDuration (m_txDurations, key, duration);
   return duration;
 }
 
@@ -2420,10 +2480,10 @@ WifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, MpduType m
 }
 
 void
-WifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet, double rxPowerW, Time rxDuration)
+WifiPhy::StartReceivePreambleAndHeader (Ptr<const Packet> packet, double rxPowerW, Time rxDuration)
 {
   WifiPhyTag tag;
-  bool found = packet->RemovePacketTag (tag);
+  bool found = packet->PeekPacketTag (tag);
   if (!found)
     {
       NS_FATAL_ERROR ("Received Wi-Fi Signal with no WifiPhyTag");
@@ -2565,7 +2625,7 @@ WifiPhy::MaybeCcaBusyDuration ()
 }
 
 void
-WifiPhy::StartReceivePacket (Ptr<Packet> packet,
+WifiPhy::StartReceivePacket (Ptr<const Packet> packet,
                              WifiTxVector txVector,
                              MpduType mpdutype,
                              Ptr<InterferenceHelper::Event> event)
@@ -2603,7 +2663,7 @@ WifiPhy::StartReceivePacket (Ptr<Packet> packet,
 }
 
 void
-WifiPhy::EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutype, Ptr<InterferenceHelper::Event> event)
+WifiPhy::EndReceive (Ptr<const Packet> packet, WifiPreamble preamble, MpduType mpdutype, Ptr<InterferenceHelper::Event> event)
 {
   NS_LOG_FUNCTION (this << packet << event);
   NS_ASSERT (IsStateRx ());
@@ -2614,6 +2674,12 @@ WifiPhy::EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutyp
   m_interference.NotifyRxEnd ();
   m_currentEvent = 0;
 
+  // The packet may be shared by all the receivers of the signal: the MAC
+  // gets its own copy, without the WifiPhyTag of the transmitter
+  Ptr<Packet> rxPacket = packet->Copy ();
+  WifiPhyTag tag;
+  rxPacket->RemovePacketTag (tag);
+
   if (m_plcpSuccess == true)
     {
       NS_LOG_DEBUG ("mode=" << (event->GetPayloadMode ().GetDataRate (event->GetTxVector ())) <<
@@ -2621,26 +2687,26 @@ WifiPhy::EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutyp
 
       if (m_random->GetValue () > snrPer.per)
         {
-          NotifyRxEnd (packet);
+          NotifyRxEnd (rxPacket);
           SignalNoiseDbm signalNoise;
           signalNoise.signal = RatioToDb (event->GetRxPowerW ()) + 30;
           signalNoise.noise = RatioToDb (event->GetRxPowerW () / snrPer.snr) + 30;
           MpduInfo aMpdu;
           aMpdu.type = mpdutype;
           aMpdu.mpduRefNumber = m_rxMpduReferenceNumber;
-          NotifyMonitorSniffRx (packet, GetFrequency (), event->GetTxVector (), aMpdu, signalNoise);
-          m_state->SwitchFromRxEndOk (packet, snrPer.snr, event->GetTxVector ());
+          NotifyMonitorSniffRx (rxPacket, GetFrequency (), event->GetTxVector (), aMpdu, signalNoise);
+          m_state->SwitchFromRxEndOk (rxPacket, snrPer.snr, event->GetTxVector ());
         }
       else
         {
           /* failure. */
-          NotifyRxDrop (packet);
-          m_state->SwitchFromRxEndError (packet, snrPer.snr);
+          NotifyRxDrop (rxPacket);
+          m_state->SwitchFromRxEndError (rxPacket, snrPer.snr);
         }
     }
   else
     {
-      m_state->SwitchFromRxEndError (packet, snrPer.snr);
+      m_state->SwitchFromRxEndError (rxPacket, snrPer.snr);
     }
 
   if (preamble == WIFI_PREAMBLE_NONE && mpdutype == LAST_MPDU_IN_AGGREGATE)
@@ -3680,7 +3746,7 @@ WifiPhy::AbortCurrentReception ()
 }
 
 void
-WifiPhy::StartRx (Ptr<Packet> packet, WifiTxVector txVector, MpduType mpdutype, double rxPowerW, Time rxDuration, Ptr<InterferenceHelper::Event> event)
+WifiPhy::StartRx (Ptr<const Packet> packet, WifiTxVector txVector, MpduType mpdutype, double rxPowerW, Time rxDuration, Ptr<InterferenceHelper::Event> event)
 {
   NS_LOG_FUNCTION (this << packet << txVector << +mpdutype << rxPowerW << rxDuration);
   if (rxPowerW > GetEdThresholdW ()) //checked here, no need to check in the payload reception (current implementation assumes constant rx power over the packet duration)
@@ -133,11 +133,15 @@ public:
   /**
    * Starting receiving the plcp of a packet (i.e. the first bit of the preamble has arrived).
    *
+   * The packet, tagged with the WifiPhyTag of the transmitter, is not
+   * modified: the channel can pass the same packet to every receiver, and
+   * it is copied only when handed up to the MAC at the end of the reception.
+   *
    * \param packet the arriving packet
    * \param rxPowerW the receive power in W
    * \param rxDuration the duration needed for the reception of the packet
    */
-  void StartReceivePreambleAndHeader (Ptr<Packet> packet,
+  void StartReceivePreambleAndHeader (Ptr<const Packet> packet,
                                       double rxPowerW,
                                       Time rxDuration);
 
@@ -149,7 +153,7 @@ public:
    * \param mpdutype the type of the MPDU as defined in WifiPhy::MpduType.
    * \param event the corresponding event of the first time the packet arrives
    */
-  void StartReceivePacket (Ptr<Packet> packet,
+  void StartReceivePacket (Ptr<const Packet> packet,
                            WifiTxVector txVector,
                            MpduType mpdutype,
                            Ptr<InterferenceHelper::Event> event);
@@ -162,7 +166,7 @@ public:
    * \param mpdutype the type of the MPDU as defined in WifiPhy::MpduType.
    * \param event the corresponding event of the first time the packet arrives
    */
-  void EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutype, Ptr<InterferenceHelper::Event> event);
+  void EndReceive (Ptr<const Packet> packet, WifiPreamble preamble, MpduType mpdutype, Ptr<InterferenceHelper::Event> event);
 
   /**
    * \param packet the packet to send
@@ -1653,6 +1657,39 @@ private:
    */
   void ConfigureChannelForStandard (WifiPhyStandard standard);
 
+  /// Key of the durations computed for a size, TXVECTOR, band and type of MPDU
+  typedef std::pair<uint64_t, uint64_t> TxDurationKey;
+  /// Durations computed, by key
+  typedef std::map<TxDurationKey, Time> TxDurations;
+
+  /**
+   * \param size the number of bytes in the packet to send
+   * \param txVector the TXVECTOR used for the transmission of this packet
+   * \param frequency the channel center frequency (MHz)
+   * \param mpdutype the type of the MPDU as defined in WifiPhy::MpduType.
+   *
+   * \return the key of the durations of the transmission in the caches
+   */
+  static TxDurationKey GetTxDurationKey (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype);
+  /**
+   * Add a duration to a cache, which is emptied first if it is full.
+   *
+   * \param durations the cache
+   * \param key the key of the duration
+   * \param duration the duration
+   */
+  static void CacheTxDuration (TxDurations &durations, TxDurationKey key, Time duration);
+  /**
+   * \param size the number of bytes in the packet to send
+   * \param txVector the TXVECTOR used for the transmission of this packet
+   * \param frequency the channel center frequency (MHz)
+   * \param mpdutype the type of the MPDU as defined in WifiPhy::MpduType.
+   * \param incFlag this flag is used to indicate that the static variables need to be update or not.
+   *
+   * \return the duration of the payload, computed without the caches
+   */
+  Time ComputePayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag);
+
   /**
    * Look for channel number matching the frequency and width
    * \param frequency The center frequency to use
@@ -1689,7 +1726,7 @@ private:
    * \param rxDuration the duration needed for the reception of the packet
    * \param event the corresponding event of the first time the packet arrives
    */
-  void StartRx (Ptr<Packet> packet,
+  void StartRx (Ptr<const Packet> packet,
                 WifiTxVector txVector,
                 MpduType mpdutype,
                 double rxPowerW,
@@ -1849,6 +1886,8 @@ private:
   Time m_channelSwitchDelay;     //!< Time required to switch between channel
   uint32_t m_totalAmpduSize;     //!< Total size of the previously transmitted MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
   double m_totalAmpduNumSymbols; //!< Number of symbols previously transmitted for the MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
+  TxDurations m_payloadDurations; //!< Cache of the payload durations which do not depend on the previous MPDUs of an A-MPDU
+  TxDurations m_txDurations;      //!< Cache of the transmission durations which do not depend on the previous MPDUs of an A-MPDU
 
   Ptr<NetDevice>     m_device;   //!< Pointer to the device
   Ptr<MobilityModel> m_mobility; //!< Pointer to the mobility model
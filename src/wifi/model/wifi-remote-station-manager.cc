@@ -1648,17 +1648,35 @@ WifiRemoteStationManager::GetInfo (Mac48Address address)
   return state->m_info;
 }
 
+size_t
+WifiRemoteStationManager::StationKeyHash::operator () (uint64_t key) const
+{
+  return static_cast<size_t> (key ^ (key >> 32));
+}
+
+uint64_t
+WifiRemoteStationManager::GetStationKey (Mac48Address address, uint8_t tid)
+{
+  uint8_t buffer[6];
+  address.CopyTo (buffer);
+  uint64_t key = 0;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      key = (key << 8) | buffer[i];
+    }
+  return (key << 8) | tid;
+}
+
 WifiRemoteStationState *
 WifiRemoteStationManager::LookupState (Mac48Address address) const
 {
   NS_LOG_FUNCTION (this << address);
-  for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+  uint64_t key = GetStationKey (address, 0);
+  StationStateIndex::const_iterator it = m_stateIndex.find (key);
+  if (it != m_stateIndex.end ())
     {
-      if ((*i)->m_address == address)
-        {
-          NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
-          return (*i);
-        }
+      NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
+      return it->second;
     }
   WifiRemoteStationState *state = new WifiRemoteStationState ();
   state->m_state = WifiRemoteStationState::BRAND_NEW;
@@ -1679,6 +1697,7 @@ WifiRemoteStationManager::LookupState (Mac48Address address) const
   state->m_vhtSupported = false;
   state->m_heSupported = false;
   const_cast<WifiRemoteStationManager *> (this)->m_states.push_back (state);
+  const_cast<WifiRemoteStationManager *> (this)->m_stateIndex[key] = state;
   NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning new state");
   return state;
 }
@@ -1702,13 +1721,11 @@ WifiRemoteStation *
 WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << address << +tid);
-  for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
+  uint64_t key = GetStationKey (address, tid);
+  StationIndex::const_iterator it = m_stationIndex.find (key);
+  if (it != m_stationIndex.end ())
     {
-      if ((*i)->m_tid == tid
-          && (*i)->m_state->m_address == address)
-        {
-          return (*i);
-        }
+      return it->second;
     }
   WifiRemoteStationState *state = LookupState (address);
 
@@ -1718,6 +1735,7 @@ WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
   station->m_ssrc = 0;
   station->m_slrc = 0;
   const_cast<WifiRemoteStationManager *> (this)->m_stations.push_back (station);
+  const_cast<WifiRemoteStationManager *> (this)->m_stationIndex[key] = station;
   return station;
 }
 
@@ -1870,11 +1888,13 @@ WifiRemoteStationManager::Reset (void)
       delete (*i);
     }
   m_states.clear ();
+  m_stateIndex.clear ();
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
       delete (*i);
     }
   m_stations.clear ();
+  m_stationIndex.clear ();
   m_bssBasicRateSet.clear ();
   m_bssBasicMcsSet.clear ();
 }
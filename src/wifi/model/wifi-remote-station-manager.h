@@ -26,6 +26,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
+#include "ns3/sgi-hashmap.h"
 #include "wifi-tx-vector.h"
 #include "ht-capabilities.h"
 #include "vht-capabilities.h"
@@ -1449,6 +1450,37 @@ private:
    */
   typedef std::vector <WifiRemoteStationState *> StationStates;
 
+  /**
+   * \brief Hash of the key of a station
+   */
+  class StationKeyHash : public std::unary_function<uint64_t, size_t>
+  {
+public:
+    /**
+     * \brief Hash the key of a station
+     * \param key the key
+     * \return the hash
+     */
+    size_t operator () (uint64_t key) const;
+  };
+
+  /**
+   * Index of the WifiRemoteStations, by address and TID
+   */
+  typedef sgi::hash_map<uint64_t, WifiRemoteStation *, StationKeyHash> StationIndex;
+  /**
+   * Index of the WifiRemoteStationStates, by address
+   */
+  typedef sgi::hash_map<uint64_t, WifiRemoteStationState *, StationKeyHash> StationStateIndex;
+
+  /**
+   * \param address the address of the station
+   * \param tid the TID
+   *
+   * \return the key of the station in the indexes
+   */
+  static uint64_t GetStationKey (Mac48Address address, uint8_t tid);
+
   /**
    * This is a pointer to the WifiPhy associated with this
    * WifiRemoteStationManager that is set on call to
@@ -1480,6 +1512,8 @@ private:
 
   StationStates m_states;  //!< States of known stations
   Stations m_stations;     //!< Information for each known stations
+  StationStateIndex m_stateIndex; //!< Index of the states of known stations
+  StationIndex m_stationIndex;    //!< Index of the information for each known stations
 
   WifiMode m_defaultTxMode; //!< The default transmission mode
   WifiMode m_defaultTxMcs;   //!< The default transmission modulation-coding scheme (MCS)
@@ -18,9 +18,12 @@
  * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <limits>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
@@ -47,6 +50,29 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("SpatialIndex",
+                   "If true, packets are only delivered to the PHYs within the maximum range of the transmission.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_spatialIndex),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxRange",
+                   "The maximum range of the transmissions when SpatialIndex is true, in meters.  "
+                   "If zero, the range is derived from the propagation loss model and MinRxPower.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MinRxPower",
+                   "The reception power, in dBm, below which the transmissions are not delivered "
+                   "when their maximum range is derived from the propagation loss model.",
+                   DoubleValue (-120),
+                   MakeDoubleAccessor (&YansWifiChannel::m_minRxPowerDbm),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("GridCellSize",
+                   "The side of the cells of the grid of the PHY positions, in meters.  "
+                   "If zero, the maximum range of the first transmission is used.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_gridCellSize),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
@@ -62,6 +88,14 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_grid = 0;
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
@@ -82,42 +116,86 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  uint8_t channelNumber = sender->GetChannelNumber ();
+  PhyList receivers;
+  std::vector<Ptr<MobilityModel> > receiverMobilities;
+  std::vector<uint32_t> inRange;
+  bool indexed = false;
+  if (m_spatialIndex)
+    {
+      double range = m_maxRange > 0 ? m_maxRange : m_loss->GetMaxRange (txPowerDbm, m_minRxPowerDbm);
+      if (range != std::numeric_limits<double>::infinity ())
+        {
+          GetGrid (range)->GetItemsInRange (senderMobility->GetPosition (), range, inRange);
+          NS_LOG_DEBUG (inRange.size () << " PHYs within " << range << "m");
+          indexed = true;
+        }
+    }
+  uint32_t nCandidates = indexed ? inRange.size () : m_phyList.size ();
+  receivers.reserve (nCandidates);
+  receiverMobilities.reserve (nCandidates);
+  for (uint32_t i = 0; i < nCandidates; i++)
     {
-      if (sender != (*i))
+      Ptr<YansWifiPhy> receiver = m_phyList[indexed ? inRange[i] : i];
+      //For now don't account for inter channel interference nor channel bonding
+      if (receiver != sender && receiver->GetChannelNumber () == channelNumber)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
-            {
-              continue;
-            }
-
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
-            {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
-            }
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+          receivers.push_back (receiver);
+          receiverMobilities.push_back (receiver->GetMobility ()->GetObject<MobilityModel> ());
         }
     }
+
+  // One pass of the propagation loss models over all the receivers
+  std::vector<double> rxPowerDbm;
+  m_loss->CalcRxPowerBatch (txPowerDbm, senderMobility, receiverMobilities, rxPowerDbm);
+  for (uint32_t i = 0; i < receivers.size (); i++)
+    {
+      SendTo (senderMobility, receivers[i], receiverMobilities[i], packet, rxPowerDbm[i], duration);
+    }
+}
+
+void
+YansWifiChannel::SendTo (Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver, Ptr<MobilityModel> receiverMobility,
+                         Ptr<const Packet> packet, double rxPowerDbm, Time duration) const
+{
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, packet, rxPowerDbm, duration);
+}
+
+Ptr<MobilityGrid>
+YansWifiChannel::GetGrid (double range) const
+{
+  if (m_grid == 0)
+    {
+      double cellSize = m_gridCellSize > 0 ? m_gridCellSize : std::max (range, 1.0);
+      NS_LOG_LOGIC ("Indexing the PHY positions with cells of " << cellSize << "m");
+      m_grid = Create<MobilityGrid> (cellSize);
+    }
+  // The PHYs added since the last transmission
+  for (uint32_t i = m_grid->GetNItems (); i < m_phyList.size (); i++)
+    {
+      m_grid->Add (m_phyList[i]->GetMobility ());
+    }
+  return m_grid;
 }
 
 void
-YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPowerDbm, Time duration)
+YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<const Packet> packet, double rxPowerDbm, Time duration)
 {
   NS_LOG_FUNCTION (phy << packet << rxPowerDbm << duration.GetSeconds ());
   phy->StartReceivePreambleAndHeader (packet, DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
@@ -22,6 +22,7 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/mobility-grid.h"
 #include "yans-wifi-phy.h"
 
 namespace ns3 {
@@ -38,6 +39,15 @@ class PropagationDelayModel;
  * class and supports an ns3::PropagationLossModel and an 
  * ns3::PropagationDelayModel.  By default, no propagation models are set; 
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * By default, every packet is delivered to all the other PHYs of the
+ * channel.  When the SpatialIndex attribute is true, a packet is only
+ * delivered to the PHYs within the maximum range of the transmission,
+ * found in a MobilityGrid of the PHY positions.  The maximum range is the
+ * MaxRange attribute, or, if it is zero, the distance beyond which the
+ * propagation loss model reduces the transmission power below MinRxPower;
+ * when the loss model does not know this distance (for instance with
+ * fading models), every PHY is visited as before.
  */
 class YansWifiChannel : public Channel
 {
@@ -108,15 +118,41 @@ private:
    * bit of the packet has arrived.
    *
    * \param receiver the device to which the packet is destined
-   * \param packet the packet being sent
+   * \param packet the packet being sent, shared by all the receivers
    * \param txPowerDbm the tx power associated to the packet being sent (dBm)
    * \param duration the transmission duration associated with the packet being sent
    */
-  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<const Packet> packet, double txPowerDbm, Time duration);
+
+  /**
+   * Schedule the reception of a packet by a YansWifiPhy.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param receiver the phy object receiving the packet
+   * \param receiverMobility the mobility model of the receiver
+   * \param packet the packet to send
+   * \param rxPowerDbm the rx power of the packet at the receiver, in dBm
+   * \param duration the transmission duration associated with the packet
+   */
+  void SendTo (Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver, Ptr<MobilityModel> receiverMobility,
+               Ptr<const Packet> packet, double rxPowerDbm, Time duration) const;
+
+  /**
+   * \param range the maximum range of the transmission being sent
+   * \return the index of the PHY positions, holding all the PHYs
+   */
+  Ptr<MobilityGrid> GetGrid (double range) const;
+
+  virtual void DoDispose (void);
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  bool m_spatialIndex;                 //!< Only deliver packets to the PHYs in range
+  double m_maxRange;                   //!< Maximum range of the transmissions, zero to use the loss model
+  double m_minRxPowerDbm;              //!< Reception power of the transmissions at their maximum range
+  double m_gridCellSize;               //!< Side of the cells of the grid, zero for the maximum range
+  mutable Ptr<MobilityGrid> m_grid;    //!< Index of the PHY positions
 };
 
 } //namespace ns3
@@ -426,6 +426,88 @@ TxDurationTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (retval, true, "an 802.11ax duration failed");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Tx Duration Cache Test
+ *
+ * The durations returned by a PHY which already computed them, in between
+ * the MPDUs of an A-MPDU, must be the ones computed by a new PHY.
+ */
+class TxDurationCacheTest : public TestCase
+{
+public:
+  TxDurationCacheTest ();
+  virtual ~TxDurationCacheTest ();
+  virtual void DoRun (void);
+};
+
+TxDurationCacheTest::TxDurationCacheTest ()
+  : TestCase ("Wifi TX Duration cache")
+{
+}
+
+TxDurationCacheTest::~TxDurationCacheTest ()
+{
+}
+
+void
+TxDurationCacheTest::DoRun (void)
+{
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  WifiTxVector txVector;
+  txVector.SetMode (WifiPhy::GetVhtMcs7 ());
+  txVector.SetPreambleType (WIFI_PREAMBLE_VHT);
+  txVector.SetChannelWidth (80);
+  txVector.SetGuardInterval (800);
+  txVector.SetNss (2);
+  txVector.SetNess (0);
+  txVector.SetStbc (0);
+
+  // The TXVECTORs which differ in a single parameter have different durations
+  WifiTxVector shortGi = txVector;
+  shortGi.SetGuardInterval (400);
+  WifiTxVector stbc = txVector;
+  stbc.SetStbc (1);
+  WifiTxVector oneStream = txVector;
+  oneStream.SetNss (1);
+  WifiTxVector txVectors[] = {txVector, shortGi, stbc, oneStream};
+  uint32_t sizes[] = {14, 1536, 7000};
+
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      for (uint32_t i = 0; i < sizeof (txVectors) / sizeof (txVectors[0]); i++)
+        {
+          for (uint32_t j = 0; j < sizeof (sizes) / sizeof (sizes[0]); j++)
+            {
+              Ptr<YansWifiPhy> newPhy = CreateObject<YansWifiPhy> ();
+              NS_TEST_EXPECT_MSG_EQ (phy->CalculateTxDuration (sizes[j], txVectors[i], CHANNEL_36_MHZ),
+                                     newPhy->CalculateTxDuration (sizes[j], txVectors[i], CHANNEL_36_MHZ),
+                                     "Wrong cached duration of " << sizes[j] << " bytes with " << txVectors[i]);
+              NS_TEST_EXPECT_MSG_EQ (phy->GetPayloadDuration (sizes[j], txVectors[i], CHANNEL_36_MHZ),
+                                     newPhy->GetPayloadDuration (sizes[j], txVectors[i], CHANNEL_36_MHZ),
+                                     "Wrong cached payload duration of " << sizes[j] << " bytes with " << txVectors[i]);
+            }
+        }
+
+      // An A-MPDU sent by both PHYs, the first one being asked for the
+      // durations of the MPDUs in between
+      Ptr<YansWifiPhy> newPhy = CreateObject<YansWifiPhy> ();
+      WifiTxVector noPreamble = txVector;
+      noPreamble.SetPreambleType (WIFI_PREAMBLE_NONE);
+      WifiTxVector mpdus[] = {txVector, noPreamble, noPreamble};
+      MpduType types[] = {MPDU_IN_AGGREGATE, MPDU_IN_AGGREGATE, LAST_MPDU_IN_AGGREGATE};
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          phy->CalculateTxDuration (sizes[i], mpdus[i], CHANNEL_36_MHZ, types[i], 0);
+          NS_TEST_EXPECT_MSG_EQ (phy->CalculateTxDuration (sizes[i], mpdus[i], CHANNEL_36_MHZ, types[i], 1),
+                                 newPhy->CalculateTxDuration (sizes[i], mpdus[i], CHANNEL_36_MHZ, types[i], 1),
+                                 "Wrong duration of MPDU " << i << " of an A-MPDU");
+        }
+    }
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -442,6 +524,7 @@ TxDurationTestSuite::TxDurationTestSuite ()
   : TestSuite ("devices-wifi-tx-duration", UNIT)
 {
   AddTestCase (new TxDurationTest, TestCase::QUICK);
+  AddTestCase (new TxDurationCacheTest, TestCase::QUICK);
 }
 
 static TxDurationTestSuite g_txDurationTestSuite; ///< the test suite
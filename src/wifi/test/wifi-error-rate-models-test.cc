@@ -21,6 +21,9 @@
 #include <cmath>
 #include "ns3/test.h"
 #include "ns3/nist-error-rate-model.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/table-error-rate-model.h"
+#include "ns3/wifi-phy.h"
 
 using namespace ns3;
 
@@ -289,6 +292,84 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi Error Rate Models Test Case Table
+ *
+ * Compare the success rates interpolated by TableErrorRateModel to the
+ * ones of the tabulated NistErrorRateModel and YansErrorRateModel.
+ */
+class WifiErrorRateModelsTestCaseTable : public TestCase
+{
+public:
+  WifiErrorRateModelsTestCaseTable ();
+  virtual ~WifiErrorRateModelsTestCaseTable ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check a tabulated error rate model over a range of SNRs.
+   * \param model the tabulated error rate model
+   * \param mode the mode of the chunks
+   * \param txVector the TXVECTOR of the chunks
+   */
+  void CheckModel (Ptr<ErrorRateModel> model, WifiMode mode, WifiTxVector txVector);
+};
+
+WifiErrorRateModelsTestCaseTable::WifiErrorRateModelsTestCaseTable ()
+  : TestCase ("WifiErrorRateModel test case Table")
+{
+}
+
+WifiErrorRateModelsTestCaseTable::~WifiErrorRateModelsTestCaseTable ()
+{
+}
+
+void
+WifiErrorRateModelsTestCaseTable::CheckModel (Ptr<ErrorRateModel> model, WifiMode mode, WifiTxVector txVector)
+{
+  Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+  table->SetModel (model);
+  uint64_t sizes[] = {1, 24, 1000 * 8, 65535 * 8};
+  // Steps which do not fall on the points of the tables
+  for (double snrDb = -25.0; snrDb < 55.0; snrDb += 0.0137)
+    {
+      double snr = std::pow (10.0, snrDb / 10.0);
+      for (uint32_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+        {
+          double expected = model->GetChunkSuccessRate (mode, txVector, snr, sizes[i]);
+          double ps = table->GetChunkSuccessRate (mode, txVector, snr, sizes[i]);
+          NS_TEST_ASSERT_MSG_EQ_TOL (ps, expected, 5e-4, "Not equal within tolerance for " << mode
+                                     << " at " << snrDb << " dB and " << sizes[i] << " bits");
+        }
+    }
+}
+
+void
+WifiErrorRateModelsTestCaseTable::DoRun (void)
+{
+  WifiMode modes[] = {WifiPhy::GetDsssRate1Mbps (), WifiPhy::GetDsssRate2Mbps (),
+                      WifiPhy::GetDsssRate5_5Mbps (), WifiPhy::GetDsssRate11Mbps (),
+                      WifiPhy::GetOfdmRate6Mbps (), WifiPhy::GetOfdmRate18Mbps (),
+                      WifiPhy::GetOfdmRate54Mbps (), WifiPhy::GetHtMcs7 (),
+                      WifiPhy::GetVhtMcs8 (), WifiPhy::GetHeMcs11 ()};
+  Ptr<ErrorRateModel> models[] = {CreateObject<NistErrorRateModel> (), CreateObject<YansErrorRateModel> ()};
+  for (uint32_t i = 0; i < sizeof (models) / sizeof (models[0]); i++)
+    {
+      for (uint32_t j = 0; j < sizeof (modes) / sizeof (modes[0]); j++)
+        {
+          WifiTxVector txVector;
+          txVector.SetMode (modes[j]);
+          txVector.SetChannelWidth (modes[j].GetModulationClass () == WIFI_MOD_CLASS_HE ? 80 : 20);
+          txVector.SetGuardInterval (800);
+          txVector.SetNss (1);
+          CheckModel (models[i], modes[j], txVector);
+        }
+    }
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -306,6 +387,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new WifiErrorRateModelsTestCaseTable, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite; ///< the test suite
@@ -42,6 +42,12 @@
 #include "ns3/multi-model-spectrum-channel.h"
 #include "ns3/wifi-spectrum-signal-parameters.h"
 #include "ns3/wifi-phy-tag.h"
+#include "ns3/interference-helper.h"
+#include "ns3/constant-rate-wifi-manager.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include <map>
 #include <tuple>
 #include <vector>
 
@@ -1514,6 +1520,375 @@ Bug2831TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_countOperationalChannelWidth40, 20, "Incorrect operational channel width after channel change");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that a YansWifiChannel with a spatial index only delivers
+ * packets to the PHYs within the maximum range, including a PHY moved
+ * into range during the simulation.
+ */
+class YansWifiChannelSpatialIndexTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param spatialIndex enable the spatial index of the channel
+   */
+  YansWifiChannelSpatialIndexTest (bool spatialIndex);
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Send one packet function
+   * \param dev the device
+   */
+  void SendOnePacket (Ptr<NetDevice> dev);
+  /**
+   * Receive callback of the devices
+   * \param dev the receiving device
+   * \param packet the packet
+   * \param protocol the protocol
+   * \param from the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  bool m_spatialIndex; ///< enable the spatial index
+  std::map<Ptr<NetDevice>, uint32_t> m_received; ///< packets received by each device
+};
+
+YansWifiChannelSpatialIndexTest::YansWifiChannelSpatialIndexTest (bool spatialIndex)
+  : TestCase (spatialIndex ? "Test YansWifiChannel with a spatial index" : "Test YansWifiChannel without spatial index"),
+    m_spatialIndex (spatialIndex)
+{
+}
+
+void
+YansWifiChannelSpatialIndexTest::SendOnePacket (Ptr<NetDevice> dev)
+{
+  dev->Send (Create<Packet> (100), dev->GetBroadcast (), 1);
+}
+
+bool
+YansWifiChannelSpatialIndexTest::Receive (Ptr<NetDevice> dev, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_received[dev]++;
+  return true;
+}
+
+void
+YansWifiChannelSpatialIndexTest::DoRun (void)
+{
+  // Every PHY receives at full power up to 5 km, but the channel does not
+  // deliver packets beyond 1 km
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<RangePropagationLossModel> loss = CreateObject<RangePropagationLossModel> ();
+  loss->SetAttribute ("MaxRange", DoubleValue (5000));
+  channel->SetPropagationLossModel (loss);
+  channel->SetAttribute ("SpatialIndex", BooleanValue (m_spatialIndex));
+  channel->SetAttribute ("MaxRange", DoubleValue (1000));
+  channel->SetAttribute ("GridCellSize", DoubleValue (100));
+
+  NodeContainer nodes;
+  nodes.Create (4);
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (50.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (0.0, 900.0, 100.0));
+  positionAlloc->Add (Vector (2000.0, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      devices.Get (i)->SetReceiveCallback (MakeCallback (&YansWifiChannelSpatialIndexTest::Receive, this));
+    }
+
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelSpatialIndexTest::SendOnePacket, this, devices.Get (0));
+  Simulator::Schedule (Seconds (1.5), &MobilityModel::SetPosition, nodes.Get (3)->GetObject<MobilityModel> (),
+                       Vector (500.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (2.0), &YansWifiChannelSpatialIndexTest::SendOnePacket, this, devices.Get (0));
+  Simulator::Stop (Seconds (3.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received[devices.Get (0)], 0, "the sender received its packets");
+  NS_TEST_ASSERT_MSG_EQ (m_received[devices.Get (1)], 2, "packets not received in range");
+  // 906 meters away, in range
+  NS_TEST_ASSERT_MSG_EQ (m_received[devices.Get (2)], 2, "packets not received in range");
+  NS_TEST_ASSERT_MSG_EQ (m_received[devices.Get (3)], (m_spatialIndex ? 1 : 2), "wrong packets received by the moving node");
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that a YansWifiChannel passes the same packet to all the PHYs
+ * receiving it, and that each PHY only copies the packet when it hands it
+ * up to the MAC, without the WifiPhyTag of the transmitter.
+ */
+class YansWifiChannelSharedPacketTest : public TestCase
+{
+public:
+  YansWifiChannelSharedPacketTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Send one packet function
+   * \param dev the device
+   */
+  void SendOnePacket (Ptr<NetDevice> dev);
+  /**
+   * PhyRxBegin trace sink
+   * \param packet the packet
+   */
+  void PhyRxBegin (Ptr<const Packet> packet);
+  /**
+   * PhyRxEnd trace sink
+   * \param packet the packet
+   */
+  void PhyRxEnd (Ptr<const Packet> packet);
+
+  std::vector<Ptr<const Packet> > m_rxBegin; ///< packets the PHYs started to receive
+  std::vector<Ptr<const Packet> > m_rxEnd;   ///< packets the PHYs handed up to the MAC
+};
+
+YansWifiChannelSharedPacketTest::YansWifiChannelSharedPacketTest ()
+  : TestCase ("Test the packet shared by the receivers of a YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelSharedPacketTest::SendOnePacket (Ptr<NetDevice> dev)
+{
+  dev->Send (Create<Packet> (100), dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelSharedPacketTest::PhyRxBegin (Ptr<const Packet> packet)
+{
+  m_rxBegin.push_back (packet);
+}
+
+void
+YansWifiChannelSharedPacketTest::PhyRxEnd (Ptr<const Packet> packet)
+{
+  m_rxEnd.push_back (packet);
+}
+
+void
+YansWifiChannelSharedPacketTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (10.0),
+                                 "GridWidth", UintegerValue (4));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  for (uint32_t i = 1; i < devices.GetN (); i++)
+    {
+      Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+      wifiPhy->TraceConnectWithoutContext ("PhyRxBegin", MakeCallback (&YansWifiChannelSharedPacketTest::PhyRxBegin, this));
+      wifiPhy->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&YansWifiChannelSharedPacketTest::PhyRxEnd, this));
+    }
+
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelSharedPacketTest::SendOnePacket, this, devices.Get (0));
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin.size (), 3, "packet not received by every PHY");
+  NS_TEST_ASSERT_MSG_EQ (m_rxEnd.size (), 3, "packet not handed up by every PHY");
+  WifiPhyTag tag;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxBegin[i], m_rxBegin[0], "packet copied by the channel");
+      NS_TEST_EXPECT_MSG_NE (m_rxEnd[i], m_rxBegin[0], "packet not copied for the MAC");
+      NS_TEST_EXPECT_MSG_EQ (m_rxEnd[i]->PeekPacketTag (tag), false, "WifiPhyTag handed up to the MAC");
+      for (uint32_t j = 0; j < i; j++)
+        {
+          NS_TEST_EXPECT_MSG_NE (m_rxEnd[i], m_rxEnd[j], "packet copy shared by two MACs");
+        }
+    }
+  m_rxBegin.clear ();
+  m_rxEnd.clear ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check the energy tracked by an InterferenceHelper for signals
+ * starting at the same time and overlapping, and after it drops the
+ * signals which ended.
+ */
+class InterferenceHelperEnergyTest : public TestCase
+{
+public:
+  InterferenceHelperEnergyTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Add a signal
+   * \param duration the duration of the signal
+   * \param rxPowerW the power of the signal, in W
+   */
+  void AddSignal (Time duration, double rxPowerW);
+  /**
+   * Check the time the energy stays above thresholds
+   * \param energyW the thresholds, in W
+   * \param expected the expected duration above each threshold
+   */
+  void CheckEnergyDuration (std::vector<double> energyW, std::vector<Time> expected);
+
+  InterferenceHelper m_interference; ///< the interference helper
+};
+
+InterferenceHelperEnergyTest::InterferenceHelperEnergyTest ()
+  : TestCase ("Test the energy tracked by the InterferenceHelper")
+{
+}
+
+void
+InterferenceHelperEnergyTest::AddSignal (Time duration, double rxPowerW)
+{
+  m_interference.AddForeignSignal (duration, rxPowerW);
+}
+
+void
+InterferenceHelperEnergyTest::CheckEnergyDuration (std::vector<double> energyW, std::vector<Time> expected)
+{
+  for (uint32_t i = 0; i < energyW.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_interference.GetEnergyDuration (energyW[i]), expected[i],
+                             "wrong duration above " << energyW[i] << " W at " << Simulator::Now ());
+    }
+}
+
+void
+InterferenceHelperEnergyTest::DoRun (void)
+{
+  Time start = Seconds (1);
+  // 6 nW until 1.0005 s, 4 nW until 1.001 s
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::AddSignal, this, MicroSeconds (1000), 4e-9);
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::AddSignal, this, MicroSeconds (500), 2e-9);
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::CheckEnergyDuration, this,
+                       std::vector<double> {7e-9, 5e-9, 3e-9},
+                       std::vector<Time> {MicroSeconds (0), MicroSeconds (500), MicroSeconds (1000)});
+  // Then 7 nW until 1.0005 s, 5 nW until 1.001 s and 1 nW until 1.0012 s
+  start += MicroSeconds (200);
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::AddSignal, this, MicroSeconds (1000), 1e-9);
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::CheckEnergyDuration, this,
+                       std::vector<double> {6.5e-9, 4.5e-9, 0.5e-9},
+                       std::vector<Time> {MicroSeconds (300), MicroSeconds (800), MicroSeconds (1000)});
+  // The signals ended before the next one are dropped
+  start += MicroSeconds (2000);
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::AddSignal, this, MicroSeconds (100), 3e-9);
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::AddSignal, this, MicroSeconds (300), 3e-9);
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::CheckEnergyDuration, this,
+                       std::vector<double> {5e-9, 2e-9, 0.5e-9},
+                       std::vector<Time> {MicroSeconds (100), MicroSeconds (300), MicroSeconds (300)});
+  start += MicroSeconds (200);
+  Simulator::Schedule (start, &InterferenceHelperEnergyTest::CheckEnergyDuration, this,
+                       std::vector<double> {5e-9, 2e-9, 0.5e-9},
+                       std::vector<Time> {MicroSeconds (0), MicroSeconds (100), MicroSeconds (100)});
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_interference.EraseEvents ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that a WifiRemoteStationManager keeps a state for each of
+ * many stations, and an RTS retry count for each of their TIDs.
+ */
+class WifiRemoteStationLookupTest : public TestCase
+{
+public:
+  WifiRemoteStationLookupTest ();
+
+  virtual void DoRun (void);
+};
+
+WifiRemoteStationLookupTest::WifiRemoteStationLookupTest ()
+  : TestCase ("Test the lookup of the remote stations")
+{
+}
+
+void
+WifiRemoteStationLookupTest::DoRun (void)
+{
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+  manager->SetAttribute ("MaxSsrc", UintegerValue (1));
+  manager->SetupPhy (phy);
+
+  uint32_t nStations = 300;
+  std::vector<Mac48Address> addresses;
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      addresses.push_back (Mac48Address::Allocate ());
+    }
+  Ptr<Packet> packet = Create<Packet> (100);
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_QOSDATA);
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      if (i % 3 == 0)
+        {
+          manager->RecordGotAssocTxOk (addresses[i]);
+        }
+      header.SetQosTid (i % 8);
+      manager->ReportRtsFailed (addresses[i], &header);
+    }
+
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (manager->IsAssociated (addresses[i]), (i % 3 == 0),
+                             "wrong state of station " << i);
+      for (uint8_t tid = 0; tid < 8; tid++)
+        {
+          header.SetQosTid (tid);
+          NS_TEST_EXPECT_MSG_EQ (manager->NeedRtsRetransmission (addresses[i], &header, packet), (tid != i % 8),
+                                 "wrong RTS retry count of TID " << +tid << " of station " << i);
+        }
+    }
+  manager->Dispose ();
+  phy->Dispose ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1538,6 +1913,11 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2222TestCase, TestCase::QUICK); //Bug 2222
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
+  AddTestCase (new YansWifiChannelSpatialIndexTest (true), TestCase::QUICK);
+  AddTestCase (new YansWifiChannelSpatialIndexTest (false), TestCase::QUICK);
+  AddTestCase (new YansWifiChannelSharedPacketTest, TestCase::QUICK);
+  AddTestCase (new InterferenceHelperEnergyTest, TestCase::QUICK);
+  AddTestCase (new WifiRemoteStationLookupTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
@@ -0,0 +1,310 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * An 802.11ac ad hoc node sends UDP traffic to many stations scattered
+ * around it, choosing the rate of each station with the
+ * MinstrelHtWifiManager, which updates the statistics of all the rates of
+ * each station at every update interval.  For each number of stations
+ * given, the rate changes, the wall clock time and the goodput are
+ * printed.
+ *
+ * Since every frame is then received by all the stations, the
+ * MinstrelHtWifiManager alone is also run with as many stations, without
+ * any channel: the status of each A-MPDU sent at the rate it chose is
+ * reported right away, each MPDU being received with a probability which
+ * depends on how the data rate compares with the capacity of the link to
+ * the station.  For each number of stations given, the rate changes, the
+ * wall clock time and the MPDUs received are printed.
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+
+using namespace ns3;
+
+static uint64_t g_rateChanges = 0; //!< Rate changes of the sender
+
+/**
+ * Count a rate change of the sender.
+ * \param rate the new rate
+ * \param address the station
+ */
+static void
+RateChange (uint64_t rate, Mac48Address address)
+{
+  g_rateChanges++;
+}
+
+/**
+ * Run the scenario once.
+ * \param nStations number of stations
+ * \param duration simulated time
+ * \param dataRate rate of the traffic sent to each station
+ * \param interval interval between the updates of the statistics
+ */
+static void
+RunOnce (uint32_t nStations, Time duration, DataRate dataRate, Time interval)
+{
+  g_rateChanges = 0;
+  RngSeedManager::SetRun (1);
+
+  NodeContainer sender;
+  sender.Create (1);
+  NodeContainer stations;
+  stations.Create (nStations);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
+  wifi.SetRemoteStationManager ("ns3::MinstrelHtWifiManager",
+                                "UpdateStatistics", TimeValue (interval));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, sender);
+  devices.Add (wifi.Install (phy, mac, stations));
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomDiscPositionAllocator",
+                                 "Rho", StringValue ("ns3::UniformRandomVariable[Min=5|Max=60]"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (sender);
+  mobility.Install (stations);
+
+  InternetStackHelper stack;
+  stack.Install (sender);
+  stack.Install (stations);
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  ApplicationContainer sinks;
+  ApplicationContainer sources;
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+      sinks.Add (sink.Install (stations.Get (i)));
+      OnOffHelper source ("ns3::UdpSocketFactory", InetSocketAddress (interfaces.GetAddress (i + 1), 9));
+      source.SetConstantRate (dataRate, 1000);
+      sources.Add (source.Install (sender.Get (0)));
+    }
+  sinks.Start (Seconds (0));
+  sources.Start (Seconds (0.1));
+
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/$ns3::MinstrelHtWifiManager/RateChange",
+                                 MakeCallback (&RateChange));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (duration);
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  uint64_t received = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      received += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  Simulator::Destroy ();
+
+  std::cout << std::setw (10) << nStations
+            << std::setw (14) << g_rateChanges
+            << std::setw (10) << elapsed
+            << std::setw (12) << std::fixed << std::setprecision (2)
+            << received * 8 / duration.GetSeconds () / 1e6
+            << std::endl;
+}
+
+/**
+ * A-MPDUs sent to many stations, at the rates chosen by a
+ * MinstrelHtWifiManager.
+ */
+class RateControlBench
+{
+public:
+  /**
+   * \param nStations number of stations
+   * \param nAmpdus number of A-MPDUs sent to each station
+   * \param interval interval between the updates of the statistics
+   */
+  RateControlBench (uint32_t nStations, uint32_t nAmpdus, Time interval);
+
+  /**
+   * Send the A-MPDUs.
+   * \return the fraction of the MPDUs received
+   */
+  double Run (void);
+
+private:
+  /// Send an A-MPDU to the next station, and report its status
+  void Send (void);
+
+  NodeContainer m_node;                       //!< Sender
+  Ptr<WifiRemoteStationManager> m_manager;    //!< Rate control of the sender
+  Ptr<UniformRandomVariable> m_rng;           //!< Random capacities and receptions
+  std::vector<Mac48Address> m_stations;       //!< Stations
+  std::vector<double> m_capacities;           //!< Capacity of the link to each station (in bit/s)
+  uint32_t m_next;                            //!< Next station to send to
+  uint32_t m_nAmpdus;                         //!< A-MPDUs left to send
+  uint64_t m_sent;                            //!< MPDUs sent
+  uint64_t m_received;                        //!< MPDUs received
+};
+
+RateControlBench::RateControlBench (uint32_t nStations, uint32_t nAmpdus, Time interval)
+  : m_next (0),
+    m_nAmpdus (nStations * nAmpdus),
+    m_sent (0),
+    m_received (0)
+{
+  m_node.Create (1);
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
+  wifi.SetRemoteStationManager ("ns3::MinstrelHtWifiManager",
+                                "UpdateStatistics", TimeValue (interval));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (wifi.Install (phy, mac, m_node).Get (0));
+  m_manager = device->GetRemoteStationManager ();
+  Ptr<RegularWifiMac> regularMac = DynamicCast<RegularWifiMac> (device->GetMac ());
+
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      // As the AdhocWifiMac does for a new destination
+      Mac48Address address = Mac48Address::Allocate ();
+      m_manager->AddAllSupportedMcs (address);
+      m_manager->AddStationHtCapabilities (address, regularMac->GetHtCapabilities ());
+      m_manager->AddStationVhtCapabilities (address, regularMac->GetVhtCapabilities ());
+      m_manager->AddAllSupportedModes (address);
+      m_manager->RecordDisassociated (address);
+      m_stations.push_back (address);
+      m_capacities.push_back (m_rng->GetValue (6.5e6, 433.3e6));
+    }
+}
+
+double
+RateControlBench::Run (void)
+{
+  Simulator::Schedule (Seconds (1), &RateControlBench::Send, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return static_cast<double> (m_received) / m_sent;
+}
+
+void
+RateControlBench::Send (void)
+{
+  Mac48Address address = m_stations[m_next];
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_QOSDATA);
+  header.SetAddr1 (address);
+  header.SetQosTid (0);
+  WifiTxVector txVector = m_manager->GetDataTxVector (address, &header, Create<Packet> (1000));
+
+  double capacity = m_capacities[m_next];
+  uint64_t rate = txVector.GetMode ().GetDataRate (txVector);
+  double probability = rate <= capacity ? 0.95 : rate <= 1.2 * capacity ? 0.5 : 0.05;
+  uint8_t nMpdus = 8;
+  uint8_t nReceived = 0;
+  for (uint8_t i = 0; i < nMpdus; i++)
+    {
+      nReceived += m_rng->GetValue () < probability;
+    }
+  m_manager->ReportAmpduTxStatus (address, 0, nReceived, nMpdus - nReceived, 0, 0);
+  m_sent += nMpdus;
+  m_received += nReceived;
+
+  m_next = (m_next + 1) % m_stations.size ();
+  if (--m_nAmpdus > 0)
+    {
+      Simulator::Schedule (MicroSeconds (20), &RateControlBench::Send, this);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string stations = "100,500";
+  double duration = 5;
+  std::string dataRate = "50kbps";
+  double interval = 100;
+  uint32_t ampdus = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("stations", "Comma separated numbers of stations", stations);
+  cmd.AddValue ("duration", "Simulated time, in seconds", duration);
+  cmd.AddValue ("dataRate", "Rate of the traffic sent to each station", dataRate);
+  cmd.AddValue ("interval", "Interval between the updates of the statistics, in milliseconds", interval);
+  cmd.AddValue ("ampdus", "A-MPDUs sent to each station by the rate control alone", ampdus);
+  cmd.Parse (argc, argv);
+
+  std::cout << duration << "s, " << dataRate << " per station" << std::endl;
+  std::cout << std::setw (10) << "stations"
+            << std::setw (14) << "rate changes"
+            << std::setw (10) << "wall ms"
+            << std::setw (12) << "Mbps"
+            << std::endl;
+
+  std::istringstream list (stations);
+  std::string value;
+  while (std::getline (list, value, ','))
+    {
+      uint32_t nStations;
+      std::istringstream (value) >> nStations;
+      RunOnce (nStations, Seconds (duration), DataRate (dataRate), MilliSeconds (interval));
+    }
+
+  std::cout << std::endl << ampdus << " A-MPDUs per station" << std::endl;
+  std::cout << std::setw (10) << "stations"
+            << std::setw (14) << "rate changes"
+            << std::setw (10) << "wall ms"
+            << std::setw (12) << "received"
+            << std::endl;
+  list.clear ();
+  list.str (stations);
+  while (std::getline (list, value, ','))
+    {
+      uint32_t nStations;
+      std::istringstream (value) >> nStations;
+      g_rateChanges = 0;
+      RateControlBench bench (nStations, ampdus, MilliSeconds (interval));
+      Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/$ns3::MinstrelHtWifiManager/RateChange",
+                                     MakeCallback (&RateChange));
+      SystemWallClockMs clock;
+      clock.Start ();
+      double received = bench.Run ();
+      int64_t elapsed = clock.End ();
+      std::cout << std::setw (10) << nStations
+                << std::setw (14) << g_rateChanges
+                << std::setw (10) << elapsed
+                << std::setw (12) << std::setprecision (4) << received
+                << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Many bulk TCP flows share a dumbbell bottleneck.  The simulation is run
+ * with the TCP timers scheduled as simulator events, then kept on a timer
+ * wheel of each granularity given, and the scheduler operations, the
+ * wall clock time and the goodput of each run are printed.  The wheel is
+ * disabled by default, so every run sets TcpL4Protocol::TimerGranularity.
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+/// MapScheduler counting the scheduler operations
+class CountingScheduler : public MapScheduler
+{
+public:
+  /**
+   * Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+  static uint64_t g_inserts;    //!< Events inserted
+  static uint64_t g_removes;    //!< Events removed before their time
+  static uint64_t g_executed;   //!< Events run
+  static uint64_t g_cancelled;  //!< Cancelled events popped without running
+};
+
+uint64_t CountingScheduler::g_inserts = 0;
+uint64_t CountingScheduler::g_removes = 0;
+uint64_t CountingScheduler::g_executed = 0;
+uint64_t CountingScheduler::g_cancelled = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+void
+CountingScheduler::Insert (const Scheduler::Event &ev)
+{
+  g_inserts++;
+  MapScheduler::Insert (ev);
+}
+
+Scheduler::Event
+CountingScheduler::RemoveNext (void)
+{
+  Scheduler::Event ev = MapScheduler::RemoveNext ();
+  if (ev.impl->IsCancelled ())
+    {
+      g_cancelled++;
+    }
+  else
+    {
+      g_executed++;
+    }
+  return ev;
+}
+
+void
+CountingScheduler::Remove (const Scheduler::Event &ev)
+{
+  g_removes++;
+  MapScheduler::Remove (ev);
+}
+
+/**
+ * Run the scenario once.
+ * \param granularity TcpL4Protocol::TimerGranularity, zero for simulator events
+ * \param label name of the run
+ * \param nFlows number of flows
+ * \param duration simulated time
+ */
+static void
+RunOnce (Time granularity, std::string label, uint32_t nFlows, Time duration)
+{
+  CountingScheduler::g_inserts = 0;
+  CountingScheduler::g_removes = 0;
+  CountingScheduler::g_executed = 0;
+  CountingScheduler::g_cancelled = 0;
+
+  ObjectFactory factory;
+  factory.SetTypeId (CountingScheduler::GetTypeId ());
+  Simulator::SetScheduler (factory);
+  Config::SetDefault ("ns3::TcpL4Protocol::TimerGranularity", TimeValue (granularity));
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+
+  NodeContainer routers;
+  routers.Create (2);
+  NodeContainer left;
+  left.Create (nFlows);
+  NodeContainer right;
+  right.Create (nFlows);
+  InternetStackHelper stack;
+  stack.Install (routers);
+  stack.Install (left);
+  stack.Install (right);
+
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  address.Assign (bottleneck.Install (routers));
+  std::vector<Ipv4Address> rightAddresses;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      address.NewNetwork ();
+      address.Assign (access.Install (left.Get (i), routers.Get (0)));
+      address.NewNetwork ();
+      Ipv4InterfaceContainer interfaces = address.Assign (access.Install (right.Get (i), routers.Get (1)));
+      rightAddresses.push_back (interfaces.GetAddress (0));
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  ApplicationContainer sinks;
+  ApplicationContainer sources;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 5000));
+      sinks.Add (sink.Install (right.Get (i)));
+      BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (rightAddresses[i], 5000));
+      sources.Add (source.Install (left.Get (i)));
+    }
+  sinks.Start (Seconds (0));
+  sources.Start (Seconds (0.1));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (duration);
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  uint64_t received = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      received += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  Simulator::Destroy ();
+
+  std::cout << std::left << std::setw (16) << label << std::right
+            << std::setw (12) << CountingScheduler::g_inserts
+            << std::setw (12) << CountingScheduler::g_executed
+            << std::setw (12) << CountingScheduler::g_cancelled
+            << std::setw (10) << CountingScheduler::g_removes
+            << std::setw (10) << elapsed
+            << std::setw (12) << std::fixed << std::setprecision (2)
+            << received * 8 / duration.GetSeconds () / 1e6
+            << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nFlows = 100;
+  double duration = 2;
+  std::string granularities = "0,1ms,10ms";
+
+  CommandLine cmd;
+  cmd.AddValue ("flows", "Number of TCP flows", nFlows);
+  cmd.AddValue ("duration", "Simulated time, in seconds", duration);
+  cmd.AddValue ("granularities", "Comma separated timer wheel granularities, 0 for simulator events", granularities);
+  cmd.Parse (argc, argv);
+
+  std::cout << nFlows << " flows, " << duration << "s" << std::endl;
+  std::cout << std::left << std::setw (16) << "timers" << std::right
+            << std::setw (12) << "inserted"
+            << std::setw (12) << "executed"
+            << std::setw (12) << "cancelled"
+            << std::setw (10) << "removed"
+            << std::setw (10) << "wall ms"
+            << std::setw (12) << "Mbps"
+            << std::endl;
+
+  std::istringstream list (granularities);
+  std::string value;
+  while (std::getline (list, value, ','))
+    {
+      Time granularity (value);
+      RunOnce (granularity, granularity.IsZero () ? "events" : "wheel " + value, nFlows, Seconds (duration));
+    }
+  return 0;
+}
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Dense 802.11ax ad hoc networks: every station is in range of all the
+ * others and sends saturating UDP traffic to its neighbour, so that every
+ * PHY tracks many overlapping signals in its InterferenceHelper.  For each
+ * number of stations given, the receptions started by the PHYs, the wall
+ * clock time and the goodput are printed.
+ *
+ * The InterferenceHelper alone is then run on receptions of long frames
+ * overlapped by many signals, and for each number of overlapping signals
+ * given, the wall clock time and the mean packet error rates of the
+ * headers and payloads of the frames are printed.  With --table, the error
+ * rates are interpolated by a TableErrorRateModel rather than computed by
+ * the NistErrorRateModel.
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/interference-helper.h"
+
+using namespace ns3;
+
+static uint64_t g_rxBegin = 0; //!< Receptions started by the PHYs
+
+/**
+ * Count a reception started by a PHY.
+ * \param packet the packet
+ */
+static void
+PhyRxBegin (Ptr<const Packet> packet)
+{
+  g_rxBegin++;
+}
+
+/**
+ * Run the scenario once.
+ * \param nStations number of stations
+ * \param duration simulated time
+ */
+static void
+RunOnce (uint32_t nStations, Time duration)
+{
+  g_rxBegin = 0;
+  RngSeedManager::SetRun (1);
+
+  NodeContainer nodes;
+  nodes.Create (nStations);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ax_5GHZ);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("HeMcs7"),
+                                "ControlMode", StringValue ("HeMcs0"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                 "X", StringValue ("ns3::UniformRandomVariable[Min=0|Max=30]"),
+                                 "Y", StringValue ("ns3::UniformRandomVariable[Min=0|Max=30]"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  ApplicationContainer sinks;
+  ApplicationContainer sources;
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+      sinks.Add (sink.Install (nodes.Get (i)));
+      OnOffHelper source ("ns3::UdpSocketFactory", InetSocketAddress (interfaces.GetAddress ((i + 1) % nStations), 9));
+      source.SetConstantRate (DataRate ("20Mbps"), 1000);
+      sources.Add (source.Install (nodes.Get (i)));
+    }
+  sinks.Start (Seconds (0));
+  sources.Start (Seconds (0.1));
+
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxBegin",
+                                 MakeCallback (&PhyRxBegin));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (duration);
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  uint64_t received = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      received += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  Simulator::Destroy ();
+
+  std::cout << std::setw (10) << nStations
+            << std::setw (14) << g_rxBegin
+            << std::setw (10) << elapsed
+            << std::setw (12) << std::fixed << std::setprecision (2)
+            << received * 8 / duration.GetSeconds () / 1e6
+            << std::endl;
+}
+
+/**
+ * Receptions of long frames, each overlapped by signals starting at random
+ * times during the frame.
+ */
+class InterferenceBench
+{
+public:
+  /**
+   * \param nSignals number of signals overlapping each frame
+   * \param nReceptions number of frames received
+   * \param errorRateModel the error rate model
+   */
+  InterferenceBench (uint32_t nSignals, uint32_t nReceptions, Ptr<ErrorRateModel> errorRateModel);
+
+  /**
+   * Run the receptions.
+   * \param headerPer the mean packet error rate of the headers of the frames
+   * \param per the mean packet error rate of the payloads of the frames
+   */
+  void Run (double &headerPer, double &per);
+
+private:
+  /// Start receiving a frame, and the signals overlapping it
+  void StartReception (void);
+  /// Compute the error rate of the PLCP header of the frame
+  void EndHeader (void);
+  /// Compute the error rate of the payload of the frame, and receive the next one
+  void EndReception (void);
+
+  InterferenceHelper m_interference;          //!< Interference helper
+  Ptr<UniformRandomVariable> m_rng;           //!< Random times and powers
+  WifiTxVector m_txVector;                    //!< TXVECTOR of the frames
+  Time m_duration;                            //!< Duration of the frames
+  Ptr<InterferenceHelper::Event> m_event;     //!< Frame being received
+  uint32_t m_nSignals;                        //!< Signals overlapping each frame
+  uint32_t m_nReceptions;                     //!< Frames left to receive
+  double m_headerPer;                         //!< Sum of the error rates of the headers
+  double m_per;                               //!< Sum of the error rates of the payloads
+};
+
+InterferenceBench::InterferenceBench (uint32_t nSignals, uint32_t nReceptions, Ptr<ErrorRateModel> errorRateModel)
+  : m_duration (MilliSeconds (2)),
+    m_nSignals (nSignals),
+    m_nReceptions (nReceptions),
+    m_headerPer (0),
+    m_per (0)
+{
+  m_interference.SetNoiseFigure (std::pow (10.0, 0.7));
+  m_interference.SetErrorRateModel (errorRateModel);
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+  m_txVector.SetMode (WifiPhy::GetHeMcs7 ());
+  m_txVector.SetPreambleType (WIFI_PREAMBLE_HE_SU);
+  m_txVector.SetChannelWidth (20);
+  m_txVector.SetGuardInterval (800);
+  m_txVector.SetNss (1);
+  m_txVector.SetNTx (1);
+}
+
+void
+InterferenceBench::Run (double &headerPer, double &per)
+{
+  uint32_t nReceptions = m_nReceptions;
+  Simulator::Schedule (Seconds (1), &InterferenceBench::StartReception, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_event = 0;
+  m_interference.EraseEvents ();
+  headerPer = m_headerPer / nReceptions;
+  per = m_per / nReceptions;
+}
+
+void
+InterferenceBench::StartReception (void)
+{
+  m_event = m_interference.Add (Create<Packet> (1000), m_txVector, m_duration, 1e-9);
+  m_interference.NotifyRxStart ();
+  for (uint32_t i = 0; i < m_nSignals; i++)
+    {
+      Time start = MicroSeconds (m_rng->GetInteger (0, m_duration.GetMicroSeconds ()));
+      Time duration = MicroSeconds (m_rng->GetInteger (50, 1000));
+      Simulator::Schedule (start, &InterferenceHelper::AddForeignSignal, &m_interference,
+                           duration, m_rng->GetValue (1e-15, 1e-13));
+    }
+  Simulator::Schedule (WifiPhy::CalculatePlcpPreambleAndHeaderDuration (m_txVector),
+                       &InterferenceBench::EndHeader, this);
+  Simulator::Schedule (m_duration, &InterferenceBench::EndReception, this);
+}
+
+void
+InterferenceBench::EndHeader (void)
+{
+  m_headerPer += m_interference.CalculatePlcpHeaderSnrPer (m_event).per;
+}
+
+void
+InterferenceBench::EndReception (void)
+{
+  m_per += m_interference.CalculatePlcpPayloadSnrPer (m_event).per;
+  m_interference.NotifyRxEnd ();
+  if (--m_nReceptions > 0)
+    {
+      Simulator::Schedule (MicroSeconds (10), &InterferenceBench::StartReception, this);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string stations = "10,50,100";
+  double duration = 2;
+  std::string signals = "10,100,1000";
+  uint32_t receptions = 1000;
+  bool table = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("stations", "Comma separated numbers of stations", stations);
+  cmd.AddValue ("duration", "Simulated time, in seconds", duration);
+  cmd.AddValue ("signals", "Comma separated numbers of signals overlapping each frame", signals);
+  cmd.AddValue ("receptions", "Frames received for each number of signals", receptions);
+  cmd.AddValue ("table", "Interpolate the error rates of the InterferenceHelper from a TableErrorRateModel", table);
+  cmd.Parse (argc, argv);
+
+  std::cout << duration << "s" << std::endl;
+  std::cout << std::setw (10) << "stations"
+            << std::setw (14) << "receptions"
+            << std::setw (10) << "wall ms"
+            << std::setw (12) << "Mbps"
+            << std::endl;
+
+  std::istringstream list (stations);
+  std::string value;
+  while (std::getline (list, value, ','))
+    {
+      uint32_t nStations;
+      std::istringstream (value) >> nStations;
+      RunOnce (nStations, Seconds (duration));
+    }
+
+  std::cout << std::endl << receptions << " receptions" << std::endl;
+  std::cout << std::setw (10) << "signals"
+            << std::setw (10) << "wall ms"
+            << std::setw (12) << "header PER"
+            << std::setw (12) << "PER"
+            << std::endl;
+  list.clear ();
+  list.str (signals);
+  while (std::getline (list, value, ','))
+    {
+      uint32_t nSignals;
+      std::istringstream (value) >> nSignals;
+      Ptr<ErrorRateModel> errorRateModel = CreateObject<NistErrorRateModel> ();
+      if (table)
+        {
+          Ptr<TableErrorRateModel> tableModel = CreateObject<TableErrorRateModel> ();
+          tableModel->SetModel (errorRateModel);
+          errorRateModel = tableModel;
+        }
+      InterferenceBench bench (nSignals, receptions, errorRateModel);
+      SystemWallClockMs clock;
+      clock.Start ();
+      double headerPer;
+      double per;
+      bench.Run (headerPer, per);
+      int64_t elapsed = clock.End ();
+      std::cout << std::setw (10) << nSignals
+                << std::setw (10) << elapsed
+                << std::setw (12) << std::setprecision (6) << headerPer
+                << std::setw (12) << per
+                << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program converts a binary trace file, as written by the
+// EnableBinary methods of the device helpers, into ASCII trace lines.
+// Sample usage:  ./waf --run 'binary-trace-to-ascii --input=trace.bin --output=trace.tr'
+// If no output file is given, the lines are printed on the standard output.
+
+#include "ns3/command-line.h"
+#include "ns3/binary-trace-file.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a binary trace file to ASCII trace lines");
+  cmd.AddValue ("input", "binary trace file to read", input);
+  cmd.AddValue ("output", "ASCII file to write (default: standard output)", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "Error-- an input file must be given with --input" << std::endl;
+      return 1;
+    }
+
+  bool ok;
+  if (output.empty ())
+    {
+      ok = BinaryTraceFile::ConvertToAscii (input, std::cout);
+    }
+  else
+    {
+      std::ofstream os (output.c_str ());
+      if (!os.is_open ())
+        {
+          std::cerr << "Error-- unable to open " << output << std::endl;
+          return 1;
+        }
+      ok = BinaryTraceFile::ConvertToAscii (input, os);
+    }
+
+  if (!ok)
+    {
+      std::cerr << "Error-- " << input << " is not a readable binary trace file" << std::endl;
+      return 1;
+    }
+  return 0;
+}